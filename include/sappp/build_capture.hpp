@@ -9,8 +9,12 @@
  */
 
 #include "sappp/common.hpp"
+#include "sappp/file_hash_cache.hpp"
 
+#include <cstddef>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
@@ -37,16 +41,82 @@ private:
     nlohmann::json m_json;
 };
 
+/**
+ * @brief Result of capturing against a previous snapshot
+ */
+struct BuildDelta
+{
+    BuildSnapshot snapshot;
+    /// build_change_set.v1: added/removed/modified tu_ids relative to the base snapshot.
+    nlohmann::json change_set;
+};
+
 class BuildCapture
 {
 public:
-    explicit BuildCapture(std::string repo_root = {}, std::string schema_dir = "schemas");
+    /**
+     * @param jobs Worker threads normalizing compile database entries (0 = hardware concurrency)
+     */
+    explicit BuildCapture(std::string repo_root = {},
+                          std::string schema_dir = "schemas",
+                          std::size_t jobs = 0);
+
+    // The shared FileHashCache is borrowed, so copies observe the same cache.
+    BuildCapture(const BuildCapture&) = default;
+    BuildCapture& operator=(const BuildCapture&) = default;
+    BuildCapture(BuildCapture&&) noexcept = default;
+    BuildCapture& operator=(BuildCapture&&) noexcept = default;
+    ~BuildCapture() = default;
+
+    /**
+     * @brief Share a persistent digest cache for input_digest (not owned)
+     * @param cache Cache outliving capture(), or nullptr to hash the input directly
+     */
+    void set_file_hash_cache(common::FileHashCache* cache) noexcept { m_file_hashes = cache; }
 
+    /**
+     * @brief Stream compile_commands.json into a build snapshot
+     *
+     * Entries are normalized on the worker pool while the file is parsed; compile units
+     * are sorted by tu_id, so the result does not depend on the job count.
+     */
     [[nodiscard]] sappp::Result<BuildSnapshot> capture(const std::string& compile_commands_path);
 
+    /**
+     * @brief Capture relative to @p base, reusing its units for unchanged entries
+     *
+     * Entries whose cwd, argv and language match a unit of @p base take that unit (and its
+     * tu_id) verbatim instead of being rehashed; units are only reused when @p base was
+     * written by the same tool build. The snapshot equals a full capture() of the same input.
+     * When @p base records dependencies, the change set also lists the kept units whose
+     * header closure changed since (see invalidated_units()).
+     */
+    [[nodiscard]] sappp::Result<BuildDelta> capture_delta(const std::string& compile_commands_path,
+                                                          const BuildSnapshot& base);
+
 private:
+    [[nodiscard]] sappp::Result<BuildSnapshot> run(const std::string& compile_commands_path,
+                                                   const nlohmann::json* base_snapshot);
+
     std::string m_repo_root;
     std::string m_schema_dir;
+    std::size_t m_jobs;
+    common::FileHashCache* m_file_hashes = nullptr;
 };
 
+/**
+ * @brief tu_ids whose recorded header closure no longer matches the file system
+ *
+ * Reads the optional build_deps.v1 "dependencies" field; units without a recorded closure
+ * (or snapshots without the field) are always reported. Relative dependency paths are
+ * resolved against @p repo_root, and a missing file counts as changed.
+ *
+ * @param jobs Worker threads hashing changed files (0 = hardware concurrency)
+ * @return Sorted tu_ids of the affected compile units
+ */
+[[nodiscard]] std::vector<std::string> invalidated_units(const BuildSnapshot& snapshot,
+                                                         common::FileHashCache& hashes,
+                                                         std::string_view repo_root = {},
+                                                         std::size_t jobs = 0);
+
 }  // namespace sappp::build_capture
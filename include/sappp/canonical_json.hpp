@@ -15,6 +15,7 @@
 #include "sappp/common.hpp"
 
 #include <string>
+#include <string_view>
 
 #include <nlohmann/json.hpp>
 
@@ -46,6 +47,27 @@ enum class HashScope {
  */
 [[nodiscard]] sappp::Result<std::string> hash_canonical(const nlohmann::json& j);
 
+/**
+ * Parsed canonical document together with the hash of its bytes
+ */
+struct CanonicalDocument
+{
+    nlohmann::json value;  ///< Parsed JSON value
+    std::string hash;      ///< "sha256:" + hex hash of the input bytes
+};
+
+/**
+ * Parse bytes that must already be in canonical form
+ *
+ * A single scan checks that @p bytes are exactly what canonicalize() would
+ * produce (sorted unique keys, no whitespace, integers only, minimal string
+ * escapes, no trailing bytes). The raw bytes are then hashed and parsed, so
+ * the returned hash equals hash_canonical(value) without re-serializing.
+ * @param bytes Serialized JSON
+ * @return Parsed document, or "NonCanonicalJson" / "ParseError" error
+ */
+[[nodiscard]] sappp::Result<CanonicalDocument> parse_canonical(std::string_view bytes);
+
 /**
  * Sort JSON object keys recursively
  * @param j JSON value (modified in place)
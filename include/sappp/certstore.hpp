@@ -8,9 +8,13 @@
  * - Using std::expected for error handling
  */
 
+#include "sappp/canonical_json.hpp"
 #include "sappp/common.hpp"
 
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <unordered_set>
 
 #include <nlohmann/json.hpp>
 
@@ -20,9 +24,17 @@ class CertStore
 {
 public:
     explicit CertStore(std::string base_dir, std::string schema_dir = "schemas");
+    ~CertStore();
+
+    CertStore(const CertStore&) = delete;
+    CertStore& operator=(const CertStore&) = delete;
+    CertStore(CertStore&&) noexcept;
+    CertStore& operator=(CertStore&&) noexcept;
 
     /**
      * @brief Store a certificate and return its hash
+     *
+     * An object already stored in this session is not written again.
      * @return Hash of the stored certificate or error
      */
     [[nodiscard]] sappp::Result<std::string> put(const nlohmann::json& cert);
@@ -39,21 +51,46 @@ public:
      */
     [[nodiscard]] sappp::VoidResult bind_po(const std::string& po_id, const std::string& cert_hash);
 
+    /**
+     * @brief Defer file writes to a background worker pool
+     *
+     * put()/bind_po() still validate, canonicalize and hash on the calling
+     * thread and return immediately; only the writes are queued. Objects
+     * already queued in this session are not written again unless their write
+     * failed, and writes to the same path are applied in submission order.
+     * On Linux builds with io_uring, one worker submits the queued writes in
+     * batches through the ring instead.
+     * @param workers Number of writer threads (0 = hardware concurrency)
+     */
+    void enable_async_writes(std::size_t workers = 0);
+
+    /**
+     * @brief Wait for all queued writes
+     * @return Success, or an error listing every failed write in submission order
+     */
+    [[nodiscard]] sappp::VoidResult flush();
+
 private:
+    class AsyncWriter;
+
     std::string m_base_dir;
     std::string m_schema_dir;
+    std::unique_ptr<AsyncWriter> m_writer;
+    /// Objects written by synchronous put() calls; the async writer keeps its own set.
+    std::unordered_set<std::string> m_written_objects;
 
     [[nodiscard]] std::string cert_schema_path() const;
     [[nodiscard]] std::string index_schema_path() const;
 
-    [[nodiscard]] static sappp::Result<std::string> canonical_hash(const nlohmann::json& cert);
-
     [[nodiscard]] sappp::Result<std::string> object_path_for_hash(const std::string& hash) const;
     [[nodiscard]] std::string index_path_for_po(const std::string& po_id) const;
 
-    [[nodiscard]] static sappp::VoidResult write_json_file(const std::string& path,
-                                                           const nlohmann::json& payload);
-    [[nodiscard]] static sappp::Result<nlohmann::json> read_json_file(const std::string& path);
+    /// @param object_hash Hash of the object at @p path (empty for index files); an async
+    ///        write that fails forgets it so a later put() writes the object again.
+    [[nodiscard]] sappp::VoidResult
+    write_canonical_file(std::string path, std::string bytes, std::string object_hash = {});
+    [[nodiscard]] static sappp::Result<sappp::canonical::CanonicalDocument>
+    read_canonical_file(const std::string& path);
 };
 
 }  // namespace sappp::certstore
@@ -5,6 +5,8 @@
  * @brief Common utilities: hash, path normalization, stable sort
  */
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
 #include <string>
@@ -62,6 +64,30 @@ namespace sappp::common {
  */
 [[nodiscard]] std::string sha256_prefixed(std::string_view data);
 
+/**
+ * Incremental SHA-256 for data that is produced piecewise
+ *
+ * Feeding the pieces of a buffer yields the same digest as sha256() of the whole buffer.
+ */
+class Sha256Hasher
+{
+public:
+    Sha256Hasher();
+
+    void update(std::string_view data);
+
+    /// Hex-encoded hash of everything passed to update(); the hasher must not be reused.
+    [[nodiscard]] std::string finish();
+
+private:
+    void transform();
+
+    std::array<std::uint32_t, 8> m_state;
+    std::array<std::uint8_t, 64> m_buffer;
+    std::size_t m_buffer_len = 0;
+    std::uint64_t m_count = 0;
+};
+
 // ============================================================================
 // Path Normalization
 // ============================================================================
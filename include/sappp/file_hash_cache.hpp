@@ -0,0 +1,105 @@
+#pragma once
+
+/**
+ * @file file_hash_cache.hpp
+ * @brief Persistent file content-hash cache keyed by (path, inode, size, mtime_ns)
+ *
+ * Shared by PO generation, build capture and pack so that a rerun only rehashes
+ * files whose identity stamp changed since the digest was recorded.
+ */
+
+#include "sappp/common.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sappp::common {
+
+/**
+ * @brief File identity used to decide whether a cached digest is still valid
+ */
+struct FileStamp
+{
+    std::uint64_t inode = 0;
+    std::uint64_t size = 0;
+    std::int64_t mtime_ns = 0;
+
+    friend bool operator==(const FileStamp&, const FileStamp&) = default;
+};
+
+/**
+ * @brief Thread-safe cache of "sha256:<hex>" file digests
+ *
+ * Misses are hashed through a read-only memory mapping. Entries whose mtime is too
+ * recent to rule out a same-tick rewrite are served in memory but not persisted.
+ * Persisted entries remember when they were last used; save() drops entries unused for
+ * kMaxEntryAge and then keeps at most max_entries of the most recently used ones.
+ */
+class FileHashCache
+{
+public:
+    static constexpr std::size_t kDefaultMaxEntries = std::size_t{1} << 18;
+    static constexpr std::chrono::hours kMaxEntryAge{24 * 30};
+
+    /// In-memory cache; save() is a no-op.
+    FileHashCache();
+
+    /// Cache persisted at @p cache_file; a missing or unreadable file starts empty.
+    explicit FileHashCache(std::filesystem::path cache_file,
+                           std::size_t max_entries = kDefaultMaxEntries);
+
+    ~FileHashCache();
+
+    FileHashCache(const FileHashCache&) = delete;
+    FileHashCache& operator=(const FileHashCache&) = delete;
+    FileHashCache(FileHashCache&&) = delete;
+    FileHashCache& operator=(FileHashCache&&) = delete;
+
+    /**
+     * @brief Cache file shared by every subcommand, if persistence was requested
+     *
+     * $SAPPP_CACHE_DIR/file_hashes.json when SAPPP_CACHE_DIR is set and non-empty;
+     * otherwise std::nullopt and digests only live for one run.
+     */
+    [[nodiscard]] static std::optional<std::filesystem::path> default_path();
+
+    /// Digest of @p path, rehashing only when its stamp changed.
+    [[nodiscard]] Result<std::string> digest(const std::filesystem::path& path);
+
+    /// Digests of @p paths in input order; misses are hashed on @p jobs workers (0 = auto).
+    [[nodiscard]] std::vector<Result<std::string>>
+    digest_all(std::span<const std::filesystem::path> paths, std::size_t jobs = 0);
+
+    /// Prune and write the cache back atomically when it changed (no-op in memory).
+    [[nodiscard]] VoidResult save() const;
+
+    [[nodiscard]] std::size_t hits() const noexcept { return m_hits.load(); }
+    [[nodiscard]] std::size_t misses() const noexcept { return m_misses.load(); }
+
+private:
+    struct Slot;
+
+    [[nodiscard]] Slot& find_or_create(const std::string& key);
+    void load();
+
+    std::optional<std::filesystem::path> m_cache_file;
+    std::size_t m_max_entries;
+    std::int64_t m_opened_ns;
+    mutable std::mutex m_mutex;
+    std::unordered_map<std::string, std::unique_ptr<Slot>> m_slots;
+    std::atomic<std::size_t> m_hits;
+    std::atomic<std::size_t> m_misses;
+    std::atomic<bool> m_dirty;
+};
+
+}  // namespace sappp::common
@@ -0,0 +1,63 @@
+#pragma once
+
+/**
+ * @file mapped_file.hpp
+ * @brief Read-only whole-file view backed by a memory mapping
+ */
+
+#include "sappp/common.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+namespace sappp::common {
+
+/**
+ * @brief Read-only contents of a regular file
+ *
+ * POSIX builds map the file (empty files need no mapping); other platforms read it into
+ * an owned buffer. The view stays valid for the lifetime of the object. inode() and
+ * mtime_ns() describe the same open file the view was read from.
+ */
+class MappedFile
+{
+public:
+    /// Map @p path; fails with "IOError" when it cannot be opened, stat'ed or mapped.
+    [[nodiscard]] static Result<MappedFile> open(const std::filesystem::path& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    [[nodiscard]] std::string_view view() const noexcept
+    {
+        return m_mapping != nullptr
+                   ? std::string_view(static_cast<const char*>(m_mapping), m_size)
+                   : std::string_view(m_buffer);
+    }
+
+    /// Inode of the opened file (0 where the platform does not report one).
+    [[nodiscard]] std::uint64_t inode() const noexcept { return m_inode; }
+
+    /// Modification time of the opened file in nanoseconds since the epoch.
+    [[nodiscard]] std::int64_t mtime_ns() const noexcept { return m_mtime_ns; }
+
+private:
+    MappedFile() = default;
+
+    void reset() noexcept;
+
+    void* m_mapping = nullptr;
+    std::size_t m_size = 0;
+    std::string m_buffer = {};
+    std::uint64_t m_inode = 0;
+    std::int64_t m_mtime_ns = 0;
+};
+
+}  // namespace sappp::common
@@ -0,0 +1,187 @@
+#pragma once
+
+/**
+ * @file pack.hpp
+ * @brief Deterministic reproducibility pack archives (ustar + gzip)
+ */
+
+#include "sappp/common.hpp"
+#include "sappp/mapped_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sappp::pack {
+
+/// Directory every member of a reproducibility pack lives under.
+inline constexpr std::string_view kPackRootPrefix = "pack/";
+
+/// True when @p path names a pack archive (".tar.gz", ".tgz") rather than an output directory.
+[[nodiscard]] bool is_pack_archive(const std::filesystem::path& path);
+
+/// Sidecar index written next to @p archive (pack.tar.gz -> pack.tar.gz.idx).
+[[nodiscard]] std::filesystem::path pack_index_path(const std::filesystem::path& archive);
+
+/// Digest and size a streamed file must still have when it is archived.
+struct PackEntryDigest
+{
+    /// "sha256:" + hex-encoded hash
+    std::string sha256;
+    std::uint64_t size = 0;
+};
+
+/// One regular file in the archive.
+struct PackEntry
+{
+    /// Archive path ('/'-separated, relative, no "." or ".." components)
+    std::string name;
+    /// File streamed into the archive (ignored when @ref contents is set)
+    std::filesystem::path source;
+    /// Inline contents, for generated members such as the manifest
+    std::optional<std::string> contents;
+    /// Values recorded for @ref source beforehand (e.g. in a manifest); the bytes are
+    /// hashed as they are archived and must match
+    std::optional<PackEntryDigest> expected = std::nullopt;
+};
+
+struct PackWriteOptions
+{
+    /// Compression worker threads (0 = hardware concurrency); never affects the output bytes
+    std::size_t jobs = 0;
+    /// zlib compression level (1-9)
+    int level = 6;
+};
+
+/**
+ * @brief Write @p entries as a gzip-compressed ustar archive
+ *
+ * Members are emitted in name order, together with an entry for every parent directory,
+ * with zero mtime/uid/gid, empty owner names and fixed modes (0644 files, 0755
+ * directories). Files are read once and streamed straight into the archive.
+ *
+ * The tar stream is cut into fixed-size blocks that are deflated in parallel and joined
+ * into a single gzip member (no name, zero mtime). Each block is primed with the preceding
+ * 32 KiB of input, except every few blocks, where deflate starts afresh so PackReader can
+ * resume there. Block boundaries do not depend on @p options.jobs, so the archive is
+ * byte-identical for every thread count.
+ *
+ * The member table and those access points are written to pack_index_path(@p output).
+ * Both files are written to temporary siblings and renamed over the targets.
+ * Errors: "IOError" (read/write failures, a source that no longer matches its
+ * PackEntry::expected digest or size), "InvalidPackEntry" (bad or duplicate names, names
+ * that do not fit a ustar header, files of 8 GiB or more).
+ */
+[[nodiscard]] VoidResult write_pack(const std::filesystem::path& output,
+                                    std::vector<PackEntry> entries,
+                                    const PackWriteOptions& options = {});
+
+/// One regular file found in an archive.
+struct PackMember
+{
+    /// Archive path, without a leading "./"
+    std::string name;
+    /// Offset of the member data in the uncompressed tar stream
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+};
+
+/**
+ * @brief Random-access reader for gzip-compressed tar archives
+ *
+ * open() loads the sidecar index written by write_pack() when it is not older than the
+ * archive and matches its size and gzip trailer. Otherwise (archives made by other tools,
+ * stale indexes) it decompresses the archive once without storing any data: it records
+ * every regular file member (ustar, GNU long names and pax "path" records are understood)
+ * together with access points roughly every MiB of the tar stream, each holding the 32 KiB
+ * deflate window needed to resume decompression there. A member is then read by inflating
+ * from the nearest preceding access point, so nothing is ever extracted to disk.
+ *
+ * All reads are const and may run concurrently.
+ * Errors: "IOError" (unreadable archive or unknown member), "InvalidPack" (corrupt gzip
+ * or tar data).
+ */
+class PackReader
+{
+public:
+    [[nodiscard]] static Result<PackReader> open(const std::filesystem::path& archive);
+
+    [[nodiscard]] const std::filesystem::path& path() const noexcept { return m_path; }
+
+    /// Regular file members sorted by name (for duplicates, the last one in the archive).
+    [[nodiscard]] const std::vector<PackMember>& members() const noexcept { return m_members; }
+
+    [[nodiscard]] const PackMember* find(std::string_view name) const;
+
+    [[nodiscard]] Result<std::string> read(std::string_view name) const;
+
+    /// Sequential reader over one member that inflates only as much as is read.
+    class MemberStream
+    {
+    public:
+        MemberStream(const MemberStream&) = delete;
+        MemberStream& operator=(const MemberStream&) = delete;
+        MemberStream(MemberStream&&) noexcept;
+        MemberStream& operator=(MemberStream&&) noexcept;
+        ~MemberStream();
+
+        /// Copy the next bytes of the member into @p dest; returns the count, 0 at the end.
+        [[nodiscard]] Result<std::size_t> read(std::span<char> dest);
+
+        /// Restart from the first byte of the member.
+        [[nodiscard]] VoidResult rewind();
+
+    private:
+        friend class PackReader;
+        struct State;
+
+        explicit MemberStream(std::unique_ptr<State> state);
+
+        std::unique_ptr<State> m_state;
+    };
+
+    /// Stream member @p name; the reader must stay in place while the stream is used.
+    [[nodiscard]] Result<MemberStream> open_member(std::string_view name) const;
+
+    /**
+     * @brief Stream every member accepted by @p wanted to @p sink in archive order
+     *
+     * Uses a single decompression pass, which is cheaper than one read() per member when
+     * most of the archive is needed. Stops at the first error returned by @p sink.
+     */
+    [[nodiscard]] VoidResult
+    read_each(const std::function<bool(const PackMember&)>& wanted,
+              const std::function<VoidResult(const PackMember&, std::string)>& sink) const;
+
+    /// Position in the compressed stream where inflation can resume.
+    struct AccessPoint
+    {
+        /// Uncompressed offset
+        std::uint64_t out = 0;
+        /// Compressed offset of the first full byte
+        std::uint64_t in = 0;
+        /// Bits of the byte before @ref in that belong to the next deflate block
+        int bits = 0;
+        /// Up to 32 KiB of uncompressed data preceding @ref out
+        std::string window;
+    };
+
+private:
+    PackReader(std::filesystem::path path, common::MappedFile archive);
+
+    [[nodiscard]] Result<std::string> read_member(const PackMember& member) const;
+
+    std::filesystem::path m_path;
+    common::MappedFile m_archive;
+    std::vector<PackMember> m_members;
+    std::vector<AccessPoint> m_points;
+};
+
+}  // namespace sappp::pack
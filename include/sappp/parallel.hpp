@@ -0,0 +1,74 @@
+#pragma once
+
+/**
+ * @file parallel.hpp
+ * @brief Index-parallel loops with deterministic error reporting
+ */
+
+#include "sappp/common.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace sappp::common {
+
+/// Workers to use for @p count items when asked for @p jobs (0 = hardware concurrency).
+[[nodiscard]] std::size_t resolve_worker_count(std::size_t jobs, std::size_t count) noexcept;
+
+/**
+ * @brief Run @p fn(i) for every i < @p count on up to @p jobs workers
+ *
+ * @p fn returns VoidResult and may throw. With one worker the items run in order and the
+ * first failure stops the loop. Otherwise every item runs, and the failure of the lowest
+ * index is reported: a thrown exception is rethrown on the caller's thread, and an error
+ * is returned. Either way the outcome is the one a serial run would have produced.
+ */
+template <typename Fn>
+[[nodiscard]] VoidResult parallel_for_each_index(std::size_t count,
+                                                std::size_t jobs,
+                                                const Fn& fn)
+{
+    const std::size_t worker_count = resolve_worker_count(jobs, count);
+    if (worker_count <= 1) {
+        for (std::size_t i = 0; i < count; ++i) {
+            if (auto result = fn(i); !result) {
+                return result;
+            }
+        }
+        return {};
+    }
+
+    std::vector<VoidResult> results(count);
+    std::vector<std::exception_ptr> failures(count);
+    std::atomic<std::size_t> next{0};
+    {
+        std::vector<std::jthread> workers;
+        workers.reserve(worker_count);
+        for (std::size_t w = 0; w < worker_count; ++w) {
+            workers.emplace_back([&] {
+                for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+                    try {
+                        results[i] = fn(i);
+                    } catch (...) {
+                        failures[i] = std::current_exception();
+                    }
+                }
+            });
+        }
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        if (failures[i]) {
+            std::rethrow_exception(failures[i]);
+        }
+        if (!results[i]) {
+            return std::move(results[i]);
+        }
+    }
+    return {};
+}
+
+}  // namespace sappp::common
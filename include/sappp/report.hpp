@@ -6,18 +6,300 @@
  */
 
 #include "sappp/common.hpp"
+#include "sappp/mapped_file.hpp"
+#include "sappp/schema_validate.hpp"
 
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
 #include <optional>
+#include <ostream>
+#include <span>
+#include <string>
 #include <string_view>
 
 #include <nlohmann/json.hpp>
 
 namespace sappp::report {
 
+/// Document bytes produced in order, for documents that are not mapped in memory.
+struct DocumentStream
+{
+    /// Copy the next bytes into @p dest; returns the count, 0 only at the end.
+    std::function<sappp::Result<std::size_t>(std::span<char> dest)> read = {};
+    /// Restart from the first byte.
+    std::function<sappp::VoidResult()> rewind = {};
+};
+
+/**
+ * Sequential reader over serialized validated_results JSON.
+ *
+ * Only the top-level members other than "results" are parsed up front; the
+ * entries of "results" are parsed one at a time, so memory stays constant in
+ * the number of POs. Other documents with one large top-level array (such as
+ * the "unknowns" of unknown_ledger) are read by naming that array instead.
+ *
+ * A mapped document must outlive the reader. A streamed document is read
+ * through a buffer that holds only the current entry and some read-ahead;
+ * open() streams it once to collect the header, and every rewind() restarts
+ * the stream.
+ */
+class ResultsReader
+{
+public:
+    /// Scan @p document; fails with "ParseError" when its structure is not a JSON object.
+    [[nodiscard]] static sappp::Result<ResultsReader> open(std::string_view document,
+                                                           std::string_view array_key = "results");
+
+    /// Scan the document produced by @p stream, as open(std::string_view, std::string_view).
+    [[nodiscard]] static sappp::Result<ResultsReader> open(DocumentStream stream,
+                                                           std::string_view array_key = "results");
+
+    /// Top-level members except the entry array.
+    [[nodiscard]] const nlohmann::json& header() const { return m_header; }
+
+    /// True when the document has the entry array.
+    [[nodiscard]] bool has_results() const { return m_results_begin.has_value(); }
+
+    /// Next entry, or std::nullopt after the last one.
+    [[nodiscard]] sappp::Result<std::optional<nlohmann::json>> next();
+
+    /**
+     * Unparsed bytes of the next entry, or std::nullopt at the end.
+     *
+     * The view points into a mapped document, or into the stream buffer, where
+     * it stays valid until the next call.
+     */
+    [[nodiscard]] sappp::Result<std::optional<std::string_view>> next_bytes();
+
+    /// Restart from the first entry; a stream is restarted by the next read.
+    void rewind();
+
+private:
+    /// Scans the document bytes [base, base + text.size()) from an offset.
+    using ScanFn = sappp::Result<std::size_t> (*)(std::string_view text,
+                                                  std::size_t base,
+                                                  std::size_t pos);
+
+    ResultsReader(std::string_view document, std::optional<DocumentStream> stream);
+
+    [[nodiscard]] sappp::VoidResult parse_header(std::string_view array_key);
+
+    /// Run @p scan from document offset @p pos, reading more of a stream until it completes.
+    [[nodiscard]] sappp::Result<std::size_t> scan(std::size_t pos, ScanFn scan_fn);
+
+    /// Byte at document offset @p pos, which a preceding scan() has buffered.
+    [[nodiscard]] std::optional<char> byte_at(std::size_t pos) const;
+
+    /// Document bytes [begin, end), which a preceding scan() has buffered.
+    [[nodiscard]] std::string_view bytes(std::size_t begin, std::size_t end) const;
+
+    /// Drop the stream bytes before @p keep_from and append the next chunk.
+    [[nodiscard]] sappp::VoidResult refill(std::size_t keep_from);
+
+    std::string_view m_document;
+    std::optional<DocumentStream> m_stream;
+    std::string m_buffer;
+    std::size_t m_buffer_begin = 0;   ///< Document offset of m_buffer[0]
+    bool m_stream_ended = false;
+    bool m_restart_pending = false;
+    nlohmann::json m_header;
+    std::optional<std::size_t> m_results_begin;  ///< Offset just past the '[' of the array
+    std::size_t m_pos = 0;
+};
+
+/// Produces result entries in po_id order; std::nullopt marks the end.
+using ResultCursor = std::function<sappp::Result<std::optional<nlohmann::json>>()>;
+
+/// Receives diff changes as they are produced.
+using ChangeSink = std::function<sappp::VoidResult(nlohmann::json change)>;
+
+/**
+ * Merge-join two po_id-sorted result sequences into diff changes.
+ *
+ * Changes reach @p sink in po_id order while both cursors are walked once.
+ * Entries without po_id are skipped, and of repeated po_ids on one side only
+ * the first counts.
+ * @return "UnsortedResults" when a cursor yields a po_id below its predecessor
+ */
+[[nodiscard]] sappp::VoidResult merge_diff_changes(const ResultCursor& before,
+                                                   const ResultCursor& after,
+                                                   std::string_view reason,
+                                                   const ChangeSink& sink);
+
+/// DOM form of merge_diff_changes(); inputs need not be sorted.
 [[nodiscard]] sappp::Result<nlohmann::json> build_diff_changes(const nlohmann::json& before_results,
                                                                const nlohmann::json& after_results,
                                                                std::string_view reason);
 
+/// Receives serialized output in order.
+using ChunkSink = std::function<void(std::string_view chunk)>;
+
+/**
+ * Emit canonical JSON for @p header with the array @p array_key spliced in.
+ *
+ * @p write_elements emits the array body (elements and separating commas)
+ * through the same sink, so large arrays never exist as one JSON value.
+ */
+[[nodiscard]] sappp::VoidResult
+write_canonical_with_array(const nlohmann::json& header,
+                           std::string_view array_key,
+                           const ChunkSink& out,
+                           const std::function<sappp::VoidResult()>& write_elements);
+
+struct DiffResultsScan
+{
+    std::string digest = {};  ///< hash_canonical() of the whole document
+    bool sorted = true;       ///< Entries are in non-decreasing po_id order
+};
+
+/**
+ * Schema-check validated_results one entry at a time and hash it canonically.
+ *
+ * Each entry is validated inside a copy of the header, so the document is
+ * never materialized; an empty "results" is validated as such. The reader is
+ * rewound first and left at its end.
+ * @return "SchemaInvalid" naming @p schema_name and the failing entry
+ */
+[[nodiscard]] sappp::Result<DiffResultsScan>
+scan_diff_results(ResultsReader& reader,
+                  const sappp::common::SchemaValidator& schema,
+                  std::string_view schema_name);
+
+/// Produces every change of the diff through the given sink, in po_id order.
+using DiffChangeSource = std::function<sappp::VoidResult(const ChangeSink&)>;
+
+/**
+ * Write diff.json canonically while the changes are produced.
+ *
+ * Every change is schema-checked inside a copy of @p header before it is
+ * written; a partially written file is removed on failure.
+ */
+[[nodiscard]] sappp::VoidResult write_diff_json(const std::filesystem::path& path,
+                                                const nlohmann::json& header,
+                                                const sappp::common::SchemaValidator& schema,
+                                                const DiffChangeSource& changes);
+
+/// Sidecar index of @p ledger_path (unknown_ledger.json -> unknown_ledger.idx).
+[[nodiscard]] std::filesystem::path unknown_index_path(const std::filesystem::path& ledger_path);
+
+/**
+ * Serialize the lookup index of serialized unknown_ledger JSON.
+ *
+ * Little-endian layout: the magic "SAPPPUX1", then the ledger size, the
+ * po_id and unknown_stable_id record counts, the offset and size of the
+ * canonical ledger header (every member but "unknowns"), then both record
+ * tables and a key pool. A record is (key offset, key size, entry offset,
+ * entry size); each table is sorted by key and then by ledger position.
+ */
+[[nodiscard]] sappp::Result<std::string> build_unknown_index(std::string_view ledger);
+
+/**
+ * Point lookups into serialized unknown_ledger JSON through its serialized index.
+ *
+ * Neither document is owned. A lookup binary-searches one record table and
+ * parses only the matching entries.
+ */
+class UnknownIndexView
+{
+public:
+    /**
+     * Check @p index against @p ledger.
+     *
+     * Fails with "StaleIndex" when the index is malformed or describes a
+     * ledger of another size.
+     */
+    [[nodiscard]] static sappp::Result<UnknownIndexView> open(std::string_view ledger,
+                                                              std::string_view index);
+
+    /// Ledger document holding the header and the entries with @p po_id.
+    [[nodiscard]] sappp::Result<nlohmann::json> find_by_po_id(std::string_view po_id) const;
+
+    /// Ledger document holding the header and the entries with @p unknown_id.
+    [[nodiscard]] sappp::Result<nlohmann::json>
+    find_by_unknown_id(std::string_view unknown_id) const;
+
+    /// Entries with @p po_id in ledger order, without the ledger header.
+    [[nodiscard]] sappp::Result<nlohmann::json> entries_by_po_id(std::string_view po_id) const;
+
+private:
+    friend class UnknownIndex;
+
+    UnknownIndexView(std::string_view ledger, std::string_view index);
+
+    [[nodiscard]] sappp::Result<nlohmann::json>
+    entries(std::size_t table, std::string_view key, std::string_view field) const;
+
+    [[nodiscard]] sappp::Result<nlohmann::json>
+    find(std::size_t table, std::string_view key, std::string_view field) const;
+
+    std::string_view m_ledger;
+    std::string_view m_index;
+};
+
+/**
+ * Point lookups into unknown_ledger.json through its sidecar index.
+ *
+ * Both files are mapped and searched through an UnknownIndexView.
+ */
+class UnknownIndex
+{
+public:
+    /**
+     * Map @p ledger_path and its sidecar index.
+     *
+     * Fails with "IOError" when either file is missing and with "StaleIndex"
+     * when the index is older than the ledger or describes another size.
+     */
+    [[nodiscard]] static sappp::Result<UnknownIndex> open(const std::filesystem::path& ledger_path);
+
+    /// Ledger document holding the header and the entries with @p po_id.
+    [[nodiscard]] sappp::Result<nlohmann::json> find_by_po_id(std::string_view po_id) const;
+
+    /// Ledger document holding the header and the entries with @p unknown_id.
+    [[nodiscard]] sappp::Result<nlohmann::json>
+    find_by_unknown_id(std::string_view unknown_id) const;
+
+    /// View over the mapped files, valid while this object is alive.
+    [[nodiscard]] UnknownIndexView view() const;
+
+private:
+    UnknownIndex(sappp::common::MappedFile ledger, sappp::common::MappedFile index);
+
+    sappp::common::MappedFile m_ledger;
+    sappp::common::MappedFile m_index;
+};
+
+/// Serialized documents of one analysis output that write_sarif() joins.
+struct SarifInputs
+{
+    std::string_view validated_results;  ///< validated_results JSON; empty before validate
+    std::string_view unknown_ledger;     ///< unknown_ledger JSON
+    std::string_view po_list;            ///< po_list JSON
+    std::string_view source_map;         ///< source_map JSON; empty when unavailable
+    nlohmann::json tool;                 ///< Tool metadata ("name", "version")
+    /// Index of unknown_ledger; built in memory when unset
+    std::optional<UnknownIndexView> unknown_index = std::nullopt;
+};
+
+/**
+ * Write a SARIF 2.1.0 log for one analysis output in a single pass.
+ *
+ * Validated results and po_list are merge-joined by po_id (both are written
+ * sorted) and every BUG/UNKNOWN result is written as soon as it is joined;
+ * SAFE results are omitted. Without validated results, the POs listed in the
+ * unknown ledger are reported as UNKNOWN. Ledger entries are looked up by
+ * po_id through the ledger index. Locations come from the expansion location
+ * in source_map (sorted by IR position), binary-searched over the byte ranges
+ * of its entries. Only those ranges and the interned tables are held in
+ * memory. Rules (PO kinds) and artifacts (files) are interned and written
+ * after the results, so each appears once and is referenced by index.
+ * @return Number of SARIF results, or "UnsortedResults" / "ParseError" /
+ *         "StaleIndex"
+ */
+[[nodiscard]] sappp::Result<std::size_t> write_sarif(const SarifInputs& inputs, std::ostream& out);
+
 [[nodiscard]] sappp::Result<nlohmann::json>
 filter_unknowns(const nlohmann::json& unknown_ledger,
                 const std::optional<nlohmann::json>& validated_results,
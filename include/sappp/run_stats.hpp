@@ -0,0 +1,86 @@
+#pragma once
+
+/**
+ * @file run_stats.hpp
+ * @brief Per-run counters, phase timings and resource usage for stats.json
+ *
+ * Counters are process-wide and updated with relaxed atomics by the libraries
+ * that do the work; RunStats reports how much they moved during one command.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace sappp::common::stats {
+
+enum class Counter : std::uint8_t {
+    kSchemaValidations,  ///< Documents checked against a JSON Schema
+    kCertsWritten,       ///< Certificate objects written to a certstore
+    kCertsDeduplicated,  ///< Certificate objects already written or queued in this session
+    kBytesWritten,       ///< Bytes of certificates and JSON artifacts written
+};
+
+inline constexpr std::size_t kCounterCount = 4;
+
+/// Add @p amount to @p counter (thread-safe).
+void add(Counter counter, std::uint64_t amount = 1) noexcept;
+
+/// Current value of @p counter.
+[[nodiscard]] std::uint64_t value(Counter counter) noexcept;
+
+struct ResourceUsage
+{
+    std::chrono::microseconds cpu_time{0};  ///< User + system time of all threads
+    std::uint64_t peak_rss_bytes = 0;       ///< 0 where the platform does not report it
+};
+
+[[nodiscard]] ResourceUsage resource_usage() noexcept;
+
+/**
+ * @brief Timings and counter deltas of one CLI command
+ *
+ * Phases are consecutive: begin_phase() ends the running phase. CPU time is
+ * process-wide, so it includes background threads working during a phase.
+ */
+class RunStats
+{
+public:
+    explicit RunStats(std::string command);
+
+    void begin_phase(std::string_view name);
+    void end_phase();
+
+    /**
+     * @brief Stats document (schema_version stats.v1)
+     *
+     * Ends the running phase. Durations are integer microseconds so the document
+     * can be written canonically.
+     */
+    [[nodiscard]] nlohmann::json to_json();
+
+private:
+    struct Phase
+    {
+        std::string name;
+        std::chrono::microseconds wall_time{0};
+        std::chrono::microseconds cpu_time{0};
+    };
+
+    std::string m_command;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::microseconds m_start_cpu;
+    std::array<std::uint64_t, kCounterCount> m_start_counters;
+    std::vector<Phase> m_phases;
+    bool m_in_phase = false;
+    std::chrono::steady_clock::time_point m_phase_start;
+    std::chrono::microseconds m_phase_start_cpu;
+};
+
+}  // namespace sappp::common::stats
@@ -7,12 +7,54 @@
 
 #include "sappp/common.hpp"
 
+#include <memory>
 #include <string>
 
 #include <nlohmann/json.hpp>
 
+namespace valijson {
+class Schema;
+}  // namespace valijson
+
 namespace sappp::common {
 
+/**
+ * JSON Schema compiled once and reused for many documents.
+ *
+ * validate_json() rebuilds the schema on every call; callers validating
+ * thousands of fragments against the same schema should load it here.
+ */
+class SchemaValidator
+{
+public:
+    /**
+     * Read and compile the schema file (and the sappp:schema/ documents it references).
+     *
+     * @param schema_path Path to JSON Schema file
+     * @return Compiled validator, or the same errors validate_json() reports
+     */
+    [[nodiscard]] static sappp::Result<SchemaValidator> load(const std::string& schema_path);
+
+    SchemaValidator(const SchemaValidator&) = delete;
+    SchemaValidator& operator=(const SchemaValidator&) = delete;
+    SchemaValidator(SchemaValidator&& other) noexcept;
+    SchemaValidator& operator=(SchemaValidator&& other) noexcept;
+    ~SchemaValidator();
+
+    /**
+     * Validate JSON against the compiled schema.
+     *
+     * @param j JSON document to validate
+     * @return Empty on success, "SchemaValidationFailed" error on failure
+     */
+    [[nodiscard]] sappp::VoidResult validate(const nlohmann::json& j) const;
+
+private:
+    explicit SchemaValidator(std::unique_ptr<valijson::Schema> schema);
+
+    std::unique_ptr<valijson::Schema> m_schema;
+};
+
 /**
  * Validate JSON against a JSON Schema file.
  *
@@ -6,8 +6,11 @@
  */
 
 #include "sappp/common.hpp"
+#include "sappp/file_hash_cache.hpp"
 
+#include <cstddef>
 #include <filesystem>
+#include <functional>
 #include <string>
 
 #include <nlohmann/json.hpp>
@@ -21,6 +24,15 @@ struct BuildOptions
     std::filesystem::path schema_dir;
     std::string generated_at;
     nlohmann::json tool;
+    /// Worker threads loading spec inputs (0 = hardware concurrency).
+    std::size_t jobs = 0;
+    /// Directory persisting normalized contracts per input file (empty = no cache).
+    std::filesystem::path cache_dir = {};
+    /// Shared digest cache for spec inputs (not owned; nullptr hashes files directly).
+    common::FileHashCache* file_hashes = nullptr;
+    /// Asked once before the contract cache is written back; false skips the write
+    /// (empty = always write). Lets a caller building speculatively keep it unwritten.
+    std::function<bool()> may_save_cache = {};
 };
 
 [[nodiscard]] sappp::Result<nlohmann::json>
@@ -0,0 +1,74 @@
+#pragma once
+
+/**
+ * @file trace.hpp
+ * @brief Process-wide Chrome trace-event recorder
+ *
+ * Spans are no-ops until start() is called, so instrumented code pays one atomic
+ * load per span when tracing is off. Recording never touches analysis outputs.
+ */
+
+#include "sappp/common.hpp"
+
+#include <chrono>
+#include <concepts>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace sappp::common::trace {
+
+/// Begin recording spans; timestamps are relative to this call.
+void start();
+
+/// True while spans are being recorded.
+[[nodiscard]] bool enabled() noexcept;
+
+/**
+ * @brief Stop recording and write the spans to @p path
+ *
+ * The file is Chrome/Perfetto trace-event JSON ("X" events, microsecond
+ * timestamps). Threads are numbered in the order they first record a span.
+ */
+[[nodiscard]] VoidResult write(const std::filesystem::path& path);
+
+/**
+ * @brief Complete event covering the lifetime of the object
+ *
+ * @p detail (e.g. a file, function or PO id) is recorded as the "detail" argument.
+ * A detail that has to be built (a path conversion, a JSON lookup) is passed as a
+ * callable instead, which only runs while tracing is enabled. A span that cannot be
+ * recorded (out of memory) is dropped.
+ */
+class Span
+{
+public:
+    Span(std::string_view category, std::string_view name, std::string_view detail = {});
+
+    template <std::invocable MakeDetail>
+        requires std::assignable_from<std::string&, std::invoke_result_t<MakeDetail>>
+    Span(std::string_view category, std::string_view name, MakeDetail&& make_detail)
+        : Span(category, name)
+    {
+        if (m_active) {
+            m_detail = std::forward<MakeDetail>(make_detail)();
+        }
+    }
+
+    ~Span();
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+    Span(Span&&) = delete;
+    Span& operator=(Span&&) = delete;
+
+private:
+    bool m_active;
+    std::chrono::steady_clock::time_point m_begin;
+    std::string m_category;
+    std::string m_name;
+    std::string m_detail;
+};
+
+}  // namespace sappp::common::trace
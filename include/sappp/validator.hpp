@@ -21,6 +21,16 @@ public:
                        std::string schema_dir = "schemas",
                        sappp::VersionTriple versions = sappp::default_version_triple());
 
+    /**
+     * @brief Use a persistent result cache in @p cache_dir (default: disabled).
+     *
+     * validate() then reuses results for index entries whose root, versions,
+     * strict flag, schemas and NIR are unchanged and whose certificate objects
+     * still hash to the recorded values. The directory must lie outside the
+     * input; an empty string disables the cache.
+     */
+    void set_result_cache_dir(std::string cache_dir);
+
     [[nodiscard]] sappp::Result<nlohmann::json> validate(bool strict);
     [[nodiscard]] sappp::VoidResult write_results(const nlohmann::json& results,
                                                   const std::string& output_path) const;
@@ -29,6 +39,7 @@ private:
     std::string m_input_dir;
     std::string m_schema_dir;
     sappp::VersionTriple m_versions;
+    std::string m_result_cache_dir;
 };
 
 }  // namespace sappp::validator
@@ -8,12 +8,14 @@
 #include "sappp/certstore.hpp"
 #include "sappp/common.hpp"
 #include "sappp/schema_validate.hpp"
+#include "sappp/trace.hpp"
 
 #include <algorithm>
 #include <array>
 #include <chrono>
 #include <cstddef>
 #include <deque>
+#include <functional>
 #include <iterator>
 #include <limits>
 #include <map>
@@ -111,20 +113,47 @@ struct ContractInfo
     bool has_concurrency = false;
 };
 
+// Hash for string-keyed maps that can be probed with a std::string_view.
+struct StringKeyHash
+{
+    using is_transparent = void;
+
+    [[nodiscard]] std::size_t operator()(std::string_view key) const noexcept
+    {
+        return std::hash<std::string_view>{}(key);
+    }
+};
+
+template <typename Value>
+using StringKeyMap = std::unordered_map<std::string, Value, StringKeyHash, std::equal_to<>>;
+
+using ContractBucket = StringKeyMap<std::vector<const ContractInfo*>>;
+
+// Contracts are stored once, ordered by contract_id; the buckets point into that arena.
 struct ContractIndex
 {
-    std::map<std::string, std::vector<ContractInfo>> by_usr;
-    std::map<std::string, std::vector<ContractInfo>> by_mangled;
-    std::map<std::string, std::vector<ContractInfo>> by_display_name;
+    std::vector<ContractInfo> contracts;
+    ContractBucket by_usr;
+    ContractBucket by_mangled;
+    ContractBucket by_display_name;
 
     ContractIndex()
         // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
-        : by_usr()
+        : contracts()
+        // NOLINTNEXTLINE(readability-redundant-member-init)
+        , by_usr()
         // NOLINTNEXTLINE(readability-redundant-member-init)
         , by_mangled()
         // NOLINTNEXTLINE(readability-redundant-member-init)
         , by_display_name()
     {}
+
+    // Moving keeps the arena's storage, so bucket pointers stay valid; copying would not.
+    ContractIndex(const ContractIndex&) = delete;
+    ContractIndex& operator=(const ContractIndex&) = delete;
+    ContractIndex(ContractIndex&&) noexcept = default;
+    ContractIndex& operator=(ContractIndex&&) noexcept = default;
+    ~ContractIndex() = default;
 };
 
 using VCallCandidateSetMap = std::map<std::string, std::vector<std::string>>;
@@ -502,33 +531,29 @@ build_contract_index(const nlohmann::json* specdb_snapshot)
         return std::unexpected(contracts_array.error());
     }
 
+    index.contracts.reserve((*contracts_array)->size());
     for (const auto& entry : **contracts_array) {
         auto contract_info = parse_contract_entry(entry);
         if (!contract_info) {
             return std::unexpected(contract_info.error());
         }
-        index.by_usr[contract_info->target_usr].push_back(*contract_info);
-        if (!contract_info->target_mangled.empty()) {
-            index.by_mangled[contract_info->target_mangled].push_back(*contract_info);
-        }
-        if (!contract_info->target_display_name.empty()) {
-            index.by_display_name[contract_info->target_display_name].push_back(*contract_info);
-        }
+        index.contracts.push_back(std::move(*contract_info));
     }
+    // Sorting the arena once leaves every bucket ordered by contract_id as well.
+    std::ranges::stable_sort(index.contracts,
+                             [](const ContractInfo& a, const ContractInfo& b) noexcept {
+                                 return a.contract_id < b.contract_id;
+                             });
 
-    auto sort_bucket = [](auto& bucket) {
-        for (auto& [key, contracts] : bucket) {
-            (void)key;
-            std::ranges::stable_sort(contracts,
-                                     [](const ContractInfo& a, const ContractInfo& b) noexcept {
-                                         return a.contract_id < b.contract_id;
-                                     });
+    for (const auto& contract : index.contracts) {
+        index.by_usr[contract.target_usr].push_back(&contract);
+        if (!contract.target_mangled.empty()) {
+            index.by_mangled[contract.target_mangled].push_back(&contract);
         }
-    };
-
-    sort_bucket(index.by_usr);
-    sort_bucket(index.by_mangled);
-    sort_bucket(index.by_display_name);
+        if (!contract.target_display_name.empty()) {
+            index.by_display_name[contract.target_display_name].push_back(&contract);
+        }
+    }
 
     return index;
 }
@@ -557,13 +582,6 @@ build_contract_index(const nlohmann::json* specdb_snapshot)
     return args.at(0).get<std::string>();
 }
 
-struct ContractSelection;
-struct ContractLookup;
-
-[[nodiscard]] ContractSelection select_contracts_for_target(const ContractLookup& lookup,
-                                                            const ContractIndex& contract_index,
-                                                            const ContractMatchContext& context);
-
 // NOLINTNEXTLINE(readability-function-size) - Parse vcall candidate tables.
 [[nodiscard]] VCallCandidateSetMap collect_vcall_candidate_sets(const nlohmann::json& func)
 {
@@ -822,20 +840,19 @@ evaluate_contract_candidate(const ContractInfo& contract, const ContractMatchCon
 }
 
 // NOLINTBEGIN(readability-function-size) - Matching rules are explicitly staged.
-[[nodiscard]] ContractSelection
-select_contracts_for_key(std::string_view key,
-                         const std::map<std::string, std::vector<ContractInfo>>& bucket,
-                         const ContractMatchContext& context)
+[[nodiscard]] ContractSelection select_contracts_for_key(std::string_view key,
+                                                         const ContractBucket& bucket,
+                                                         const ContractMatchContext& context)
 {
-    auto it = bucket.find(std::string(key));
+    auto it = bucket.find(key);
     if (it == bucket.end()) {
         return {};
     }
 
     std::vector<ContractMatchCandidate> candidates;
     candidates.reserve(it->second.size());
-    for (const auto& contract : it->second) {
-        auto candidate = evaluate_contract_candidate(contract, context);
+    for (const ContractInfo* contract : it->second) {
+        auto candidate = evaluate_contract_candidate(*contract, context);
         if (!candidate) {
             continue;
         }
@@ -932,10 +949,46 @@ select_contracts_for_key(std::string_view key,
 }
 // NOLINTEND(readability-function-size)
 
+// Memoized select_contracts_for_target for one index and one normalized match context.
+// POs touching the same callee share a single selection instead of re-running the
+// specificity and priority filters.
+struct ContractResolver
+{
+    const ContractIndex* index = nullptr;
+    ContractMatchContext context;
+    StringKeyMap<ContractSelection> selections;
+
+    ContractResolver(const ContractIndex& index_in, const ContractMatchContext& context_in)
+        : index(&index_in)
+        , context(normalize_match_context(context_in))
+        , selections()  // NOLINT(readability-redundant-member-init) - -Weffc++.
+    {}
+
+    ContractResolver(const ContractResolver&) = delete;
+    ContractResolver& operator=(const ContractResolver&) = delete;
+    ContractResolver(ContractResolver&&) = delete;
+    ContractResolver& operator=(ContractResolver&&) = delete;
+    ~ContractResolver() = default;
+
+    [[nodiscard]] const ContractSelection& select(const ContractLookup& lookup)
+    {
+        std::string key;
+        key.reserve(lookup.usr.size() + lookup.mangled.size() + lookup.display_name.size() + 2);
+        key.append(lookup.usr).push_back('\0');
+        key.append(lookup.mangled).push_back('\0');
+        key.append(lookup.display_name);
+        auto it = selections.find(key);
+        if (it == selections.end()) {
+            it = selections
+                     .emplace(std::move(key), select_contracts_for_target(lookup, *index, context))
+                     .first;
+        }
+        return it->second;
+    }
+};
+
 [[nodiscard]] sappp::Result<ContractMatchSummary>
-match_contracts_for_po(const nlohmann::json& po,
-                       const ContractIndex& contract_index,
-                       const ContractMatchContext& context)
+match_contracts_for_po(const nlohmann::json& po, ContractResolver& resolver)
 {
     auto function_obj =
         require_object(JsonFieldContext{.obj = &po, .key = "function", .context = "po"});
@@ -959,7 +1012,7 @@ match_contracts_for_po(const nlohmann::json& po,
         .mangled = *mangled,
         .display_name = std::string_view{},
     };
-    auto selection = select_contracts_for_target(lookup, contract_index, context);
+    const auto& selection = resolver.select(lookup);
     summary.conflict = selection.conflict;
     if (selection.contracts.empty()) {
         return summary;
@@ -1779,6 +1832,8 @@ void compute_lifetime_fixpoint(FunctionLifetimeAnalysis& analysis, BudgetTracker
 
         FunctionLifetimeAnalysis analysis;
         analysis.function_uid = func.at("function_uid").get<std::string>();
+        const sappp::common::trace::Span span(
+            "analyzer", "lifetime_cache", analysis.function_uid);
         if (cfg.contains("entry") && cfg.at("entry").is_string()) {
             analysis.entry_block = cfg.at("entry").get<std::string>();
         }
@@ -2288,6 +2343,8 @@ void compute_init_fixpoint(FunctionInitAnalysis& analysis, BudgetTracker* budget
 
         FunctionInitAnalysis analysis;
         analysis.function_uid = func.at("function_uid").get<std::string>();
+        const sappp::common::trace::Span span(
+            "analyzer", "init_cache", analysis.function_uid);
         if (cfg.contains("entry") && cfg.at("entry").is_string()) {
             analysis.entry_block = cfg.at("entry").get<std::string>();
         }
@@ -2886,6 +2943,8 @@ build_points_to_analysis_cache(const nlohmann::json& nir_json,  // NOLINT(readab
 
         FunctionPointsToAnalysis analysis;
         analysis.function_uid = func.at("function_uid").get<std::string>();
+        const sappp::common::trace::Span span(
+            "analyzer", "points_to_cache", analysis.function_uid);
         if (cfg.contains("entry") && cfg.at("entry").is_string()) {
             analysis.entry_block = cfg.at("entry").get<std::string>();
         }
@@ -3404,6 +3463,8 @@ build_heap_lifetime_analysis_cache(const nlohmann::json& nir_json, BudgetTracker
 
         FunctionHeapLifetimeAnalysis analysis;
         analysis.function_uid = func.at("function_uid").get<std::string>();
+        const sappp::common::trace::Span span(
+            "analyzer", "heap_lifetime_cache", analysis.function_uid);
         if (cfg.contains("entry") && cfg.at("entry").is_string()) {
             analysis.entry_block = cfg.at("entry").get<std::string>();
         }
@@ -4576,8 +4637,7 @@ struct PoProcessingContext
     sappp::certstore::CertStore* cert_store = nullptr;
     const std::unordered_map<std::string, std::string>* function_uid_map = nullptr;
     const FunctionFeatureCache* feature_cache = nullptr;
-    const ContractIndex* contract_index = nullptr;
-    const ContractMatchContext* match_context = nullptr;
+    ContractResolver* contract_resolver = nullptr;
     const VCallSummaryMap* vcall_summaries = nullptr;
     std::unordered_map<std::string, std::string>* contract_ref_cache = nullptr;
     const LifetimeAnalysisCache* lifetime_cache = nullptr;
@@ -5456,10 +5516,7 @@ resolve_vcall_candidates_for_po(const nlohmann::json& po,
 
     resolved.methods = candidates;
 
-    if (context.contract_index != nullptr) {
-        ContractMatchContext fallback;
-        const ContractMatchContext& match_context =
-            context.match_context == nullptr ? fallback : *context.match_context;
+    if (context.contract_resolver != nullptr) {
         for (const auto& method : candidates) {
             bool has_pre = false;
             ContractLookup lookup{
@@ -5467,8 +5524,7 @@ resolve_vcall_candidates_for_po(const nlohmann::json& po,
                 .mangled = method,
                 .display_name = std::string_view{},
             };
-            auto selection =
-                select_contracts_for_target(lookup, *context.contract_index, match_context);
+            const auto& selection = context.contract_resolver->select(lookup);
             if (selection.conflict) {
                 resolved.missing_contract_targets.push_back(method);
                 continue;
@@ -5531,7 +5587,7 @@ resolve_vcall_unknown_details(const nlohmann::json& po, const PoProcessingContex
         return std::optional<UnknownDetails>(build_vcall_empty_candidates_details());
     }
     if (!resolved_candidates->missing_contract_targets.empty()) {
-        if (context.contract_index != nullptr && context.function_uid_map != nullptr) {
+        if (context.contract_resolver != nullptr && context.function_uid_map != nullptr) {
             auto function_uid = resolve_function_uid(*context.function_uid_map, po);
             if (!function_uid) {
                 return std::unexpected(function_uid.error());
@@ -5665,13 +5721,10 @@ resolve_vcall_unknown_details(const nlohmann::json& po, const PoProcessingContex
 [[nodiscard]] sappp::Result<ContractMatchSummary>
 resolve_contracts(const nlohmann::json& po, const PoProcessingContext& context)
 {
-    if (context.contract_index == nullptr) {
+    if (context.contract_resolver == nullptr) {
         return ContractMatchSummary{};
     }
-    ContractMatchContext fallback;
-    const ContractMatchContext& match_context =
-        context.match_context == nullptr ? fallback : *context.match_context;
-    return match_contracts_for_po(po, *context.contract_index, match_context);
+    return match_contracts_for_po(po, *context.contract_resolver);
 }
 
 // NOLINTNEXTLINE(readability-function-size) - Aggregates PO artifacts.
@@ -5719,7 +5772,7 @@ resolve_contracts(const nlohmann::json& po, const PoProcessingContext& context)
     auto contracts_for_proof =
         decision_value.is_safe ? filter_trusted_contracts(merged_contracts) : merged_contracts;
     std::vector<std::string> contract_hashes;
-    if (context.contract_ref_cache != nullptr && context.contract_index != nullptr) {
+    if (context.contract_ref_cache != nullptr && context.contract_resolver != nullptr) {
         contract_hashes.reserve(contracts_for_proof.size());
         for (const auto* contract : contracts_for_proof) {
             auto hash = ensure_contract_ref(*contract, context);
@@ -5817,17 +5870,96 @@ ensure_unknowns(std::vector<nlohmann::json>& unknowns,
     return {};
 }
 
+/// Count the functions, CFG blocks and instructions of @p nir_json.
+void count_program_size(const nlohmann::json& nir_json, AnalyzeStats& stats)
+{
+    if (!nir_json.contains("functions") || !nir_json.at("functions").is_array()) {
+        return;
+    }
+    for (const auto& func : nir_json.at("functions")) {
+        ++stats.functions;
+        if (!func.is_object() || !func.contains("cfg") || !func.at("cfg").is_object()) {
+            continue;
+        }
+        const auto& cfg = func.at("cfg");
+        if (!cfg.contains("blocks") || !cfg.at("blocks").is_array()) {
+            continue;
+        }
+        for (const auto& block : cfg.at("blocks")) {
+            ++stats.blocks;
+            if (block.is_object() && block.contains("insts") && block.at("insts").is_array()) {
+                stats.instructions += block.at("insts").size();
+            }
+        }
+    }
+}
+
 }  // namespace
 
+sappp::Result<DomainStats> run_fixpoint(FixpointDomain domain,
+                                        const nlohmann::json& nir_json,
+                                        const AnalyzerConfig::AnalysisBudget& budget)
+{
+    BudgetTracker budget_tracker(budget);
+    switch (domain) {
+        case FixpointDomain::kLifetime:
+            (void)build_lifetime_analysis_cache(nir_json, &budget_tracker);
+            break;
+        case FixpointDomain::kHeapLifetime:
+            (void)build_heap_lifetime_analysis_cache(nir_json, &budget_tracker);
+            break;
+        case FixpointDomain::kInit:
+            (void)build_init_analysis_cache(nir_json, &budget_tracker);
+            break;
+        case FixpointDomain::kPointsTo:
+            if (auto cache = build_points_to_analysis_cache(nir_json, &budget_tracker); !cache) {
+                return std::unexpected(cache.error());
+            }
+            break;
+        default:
+            return std::unexpected(sappp::Error::make(
+                "InvalidArgument",
+                "Unknown fixpoint domain: " + std::to_string(std::to_underlying(domain))));
+    }
+    return DomainStats{.iterations = budget_tracker.iterations, .states = budget_tracker.states};
+}
+
 Analyzer::Analyzer(AnalyzerConfig config)
     : m_config(std::move(config))
 {}
 
-// NOLINTNEXTLINE(readability-function-size) - Top-level analysis.
 sappp::Result<AnalyzeOutput> Analyzer::analyze(const nlohmann::json& nir_json,
                                                const nlohmann::json& po_list_json,
                                                const nlohmann::json* specdb_snapshot,
                                                const ContractMatchContext& match_context) const
+{
+    const sappp::common::trace::Span analyze_span("analyzer", "analyze");
+    sappp::certstore::CertStore cert_store(m_config.certstore_dir, m_config.schema_dir);
+    // Certificate writes overlap with PO processing; every exit path flushes them.
+    cert_store.enable_async_writes();
+    auto output =
+        analyze_with_store(nir_json, po_list_json, specdb_snapshot, match_context, cert_store);
+    auto flushed = cert_store.flush();
+    if (!output) {
+        if (!flushed) {
+            return std::unexpected(Error::make(
+                output.error().code, output.error().message + "; " + flushed.error().message));
+        }
+        return std::unexpected(output.error());
+    }
+    if (!flushed) {
+        return std::unexpected(flushed.error());
+    }
+    return output;
+}
+
+// NOLINTNEXTLINE(readability-function-size) - Top-level analysis.
+sappp::Result<AnalyzeOutput>
+Analyzer::analyze_with_store(const nlohmann::json& nir_json,
+                             const nlohmann::json& po_list_json,
+                             const nlohmann::json* specdb_snapshot,
+                             const ContractMatchContext& match_context,
+                             sappp::certstore::CertStore& cert_store) const
 {
     auto tu_id =
         require_string(JsonFieldContext{.obj = &nir_json, .key = "tu_id", .context = "nir"});
@@ -5850,19 +5982,39 @@ sappp::Result<AnalyzeOutput> Analyzer::analyze(const nlohmann::json& nir_json,
     nlohmann::json unknown_ledger =
         build_unknown_ledger_base(nir_json, po_list_json, m_config.versions, *tool_obj, *tu_id);
 
-    sappp::certstore::CertStore cert_store(m_config.certstore_dir, m_config.schema_dir);
     BudgetTracker budget_tracker(m_config.budget);
+    AnalyzeStats stats;
+    count_program_size(nir_json, stats);
+    stats.pos = ordered_pos_value.size();
+    // Attribute the budget consumed while building one domain's cache to that domain.
+    const auto measure_domain = [&](std::string_view domain, const auto& build) {
+        const auto iterations = budget_tracker.iterations;
+        const auto states = budget_tracker.states;
+        auto cache = build();
+        stats.domains[std::string(domain)] =
+            DomainStats{.iterations = budget_tracker.iterations - iterations,
+                        .states = budget_tracker.states - states};
+        return cache;
+    };
     const auto function_uid_map = build_function_uid_map(nir_json);
     auto contract_index = build_contract_index(specdb_snapshot);
     if (!contract_index) {
         return std::unexpected(contract_index.error());
     }
-    ContractMatchContext normalized_context = normalize_match_context(match_context);
+    ContractResolver contract_resolver(*contract_index, match_context);
     const auto vcall_summaries = build_vcall_summary_map(nir_json);
-    const auto lifetime_cache = build_lifetime_analysis_cache(nir_json, &budget_tracker);
-    const auto heap_lifetime_cache = build_heap_lifetime_analysis_cache(nir_json, &budget_tracker);
-    const auto init_cache = build_init_analysis_cache(nir_json, &budget_tracker);
-    auto points_to_cache = build_points_to_analysis_cache(nir_json, &budget_tracker);
+    const auto lifetime_cache = measure_domain("lifetime", [&] {
+        return build_lifetime_analysis_cache(nir_json, &budget_tracker);
+    });
+    const auto heap_lifetime_cache = measure_domain("heap_lifetime", [&] {
+        return build_heap_lifetime_analysis_cache(nir_json, &budget_tracker);
+    });
+    const auto init_cache = measure_domain("init", [&] {
+        return build_init_analysis_cache(nir_json, &budget_tracker);
+    });
+    auto points_to_cache = measure_domain("points_to", [&] {
+        return build_points_to_analysis_cache(nir_json, &budget_tracker);
+    });
     if (!points_to_cache) {
         return std::unexpected(points_to_cache.error());
     }
@@ -5884,8 +6036,7 @@ sappp::Result<AnalyzeOutput> Analyzer::analyze(const nlohmann::json& nir_json,
     PoProcessingContext context{.cert_store = &cert_store,
                                 .function_uid_map = &function_uid_map,
                                 .feature_cache = &feature_cache,
-                                .contract_index = &(*contract_index),
-                                .match_context = &normalized_context,
+                                .contract_resolver = &contract_resolver,
                                 .vcall_summaries = &vcall_summaries,
                                 .contract_ref_cache = &contract_ref_cache,
                                 .lifetime_cache = &lifetime_cache,
@@ -5900,6 +6051,9 @@ sappp::Result<AnalyzeOutput> Analyzer::analyze(const nlohmann::json& nir_json,
 
     for (const nlohmann::json* po_entry : ordered_pos_value) {
         const nlohmann::json& po = *po_entry;
+        const sappp::common::trace::Span span("analyzer", "process_po", [&po] {
+            return po.at("po_id").get_ref<const std::string&>();
+        });
         auto processed = process_po(po, context);
         if (!processed) {
             return std::unexpected(processed.error());
@@ -5926,7 +6080,10 @@ sappp::Result<AnalyzeOutput> Analyzer::analyze(const nlohmann::json& nir_json,
         return std::unexpected(validation.error());
     }
 
-    return AnalyzeOutput{.unknown_ledger = std::move(unknown_ledger)};
+    stats.unknowns = unknowns.size();
+    stats.summary_nodes = budget_tracker.summary_nodes;
+    stats.budget_exceeded = budget_tracker.limit_reason();
+    return AnalyzeOutput{.unknown_ledger = std::move(unknown_ledger), .stats = std::move(stats)};
 }
 
 }  // namespace sappp::analyzer
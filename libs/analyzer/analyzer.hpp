@@ -9,12 +9,17 @@
 #include "sappp/version.hpp"
 
 #include <cstdint>
+#include <map>
 #include <optional>
 #include <string>
 #include <vector>
 
 #include <nlohmann/json.hpp>
 
+namespace sappp::certstore {
+class CertStore;
+}  // namespace sappp::certstore
+
 namespace sappp::analyzer {
 
 struct AnalyzerConfig
@@ -32,9 +37,50 @@ struct AnalyzerConfig
     std::optional<std::string> memory_domain;
 };
 
+/// Fixpoint work of one abstract domain, as counted against the analysis budget.
+struct DomainStats
+{
+    std::uint64_t iterations = 0;
+    std::uint64_t states = 0;
+};
+
+/// Size of the analyzed program and the work spent on it.
+struct AnalyzeStats
+{
+    std::uint64_t functions = 0;
+    std::uint64_t blocks = 0;
+    std::uint64_t instructions = 0;
+    std::uint64_t pos = 0;
+    std::uint64_t unknowns = 0;
+    std::uint64_t summary_nodes = 0;
+    /// Keyed by domain: "lifetime", "heap_lifetime", "init", "points_to".
+    std::map<std::string, DomainStats> domains{};
+    std::optional<std::string> budget_exceeded{};
+};
+
+/// Abstract domains whose fixpoints analyze() computes before deciding POs.
+enum class FixpointDomain : std::uint8_t {
+    kLifetime,
+    kHeapLifetime,
+    kInit,
+    kPointsTo,
+};
+
+/**
+ * @brief Compute one domain's fixpoint over every function of @p nir_json
+ *
+ * Builds exactly the per-function states analyze() builds for that domain, without
+ * deciding POs or writing certificates. Lets benchmarks measure domains in isolation.
+ */
+[[nodiscard]] sappp::Result<DomainStats>
+run_fixpoint(FixpointDomain domain,
+             const nlohmann::json& nir_json,
+             const AnalyzerConfig::AnalysisBudget& budget = {});
+
 struct AnalyzeOutput
 {
     nlohmann::json unknown_ledger;
+    AnalyzeStats stats{};
 };
 
 struct ContractMatchContext
@@ -56,6 +102,14 @@ public:
             const ContractMatchContext& match_context = ContractMatchContext{}) const;
 
 private:
+    /// Body of analyze(); writes certificates through @p cert_store without flushing it.
+    [[nodiscard]] sappp::Result<AnalyzeOutput>
+    analyze_with_store(const nlohmann::json& nir_json,
+                       const nlohmann::json& po_list_json,
+                       const nlohmann::json* specdb_snapshot,
+                       const ContractMatchContext& match_context,
+                       sappp::certstore::CertStore& cert_store) const;
+
     AnalyzerConfig m_config;
 };
 
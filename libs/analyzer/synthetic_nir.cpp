@@ -0,0 +1,315 @@
+/**
+ * @file synthetic_nir.cpp
+ * @brief Deterministic synthetic NIR for analyzer benchmarks
+ */
+
+#include "synthetic_nir.hpp"
+
+#include "sappp/common.hpp"
+#include "sappp/version.hpp"
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace sappp::analyzer {
+
+namespace {
+
+/// PO tokens understood by PoGenerator; each one is decided by a different domain.
+constexpr std::array<std::string_view, 5> kPoTokens{
+    {"uaf", "uninit", "null", "oob", "double_free"}
+};
+constexpr std::array<std::string_view, 3> kPointerTargets{
+    {"inbounds", "null", "oob"}
+};
+constexpr auto kPoTokenCount = static_cast<std::uint32_t>(kPoTokens.size());
+constexpr auto kPointerTargetCount = static_cast<std::uint32_t>(kPointerTargets.size());
+constexpr std::uint32_t kVCallCandidateSets = 3;
+constexpr std::uint64_t kGoldenGamma = 0x9E37'79B9'7F4A'7C15ULL;
+
+/// splitmix64: unlike <random> distributions, its output is specified bit for bit.
+class SplitMix64
+{
+public:
+    explicit SplitMix64(std::uint64_t seed) noexcept
+        : m_state(seed)
+    {}
+
+    [[nodiscard]] std::uint64_t next() noexcept
+    {
+        m_state += kGoldenGamma;
+        std::uint64_t z = m_state;
+        z = (z ^ (z >> 30U)) * 0xBF58'476D'1CE4'E5B9ULL;
+        z = (z ^ (z >> 27U)) * 0x94D0'49BB'1331'11EBULL;
+        return z ^ (z >> 31U);
+    }
+
+    [[nodiscard]] std::uint32_t below(std::uint32_t bound) noexcept
+    {
+        return bound == 0 ? 0 : static_cast<std::uint32_t>(next() % bound);
+    }
+
+    [[nodiscard]] bool percent(std::uint32_t chance) noexcept { return below(100) < chance; }
+
+private:
+    std::uint64_t m_state;
+};
+
+[[nodiscard]] std::string indexed(std::string_view prefix, std::uint32_t index)
+{
+    return std::string(prefix) + std::to_string(index);
+}
+
+[[nodiscard]] std::string function_uid(std::uint32_t index)
+{
+    return indexed("usr::synthetic::fn", index);
+}
+
+[[nodiscard]] nlohmann::json ref_expr(const std::string& name)
+{
+    return nlohmann::json{
+        {  "op", "ref"},
+        {"name",  name}
+    };
+}
+
+[[nodiscard]] nlohmann::json points_to_effect(const std::string& pointer,
+                                              const std::vector<std::string>& targets)
+{
+    return nlohmann::json{
+        {"points_to", nlohmann::json::array({nlohmann::json{{"ptr", pointer}, {"targets", targets}}})}
+    };
+}
+
+class FunctionBuilder
+{
+public:
+    FunctionBuilder(const SyntheticNirOptions& options, std::uint32_t index)
+        : m_options(options)
+        , m_index(index)
+        , m_rng(options.seed ^ (kGoldenGamma * (static_cast<std::uint64_t>(index) + 1U)))
+        , m_variables(std::max<std::uint32_t>(options.variables, 1U))
+        , m_block_count(std::max<std::uint32_t>(options.blocks_per_function, 2U))
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_insts()
+        , m_allocated(m_variables, false)
+    {}
+
+    [[nodiscard]] nlohmann::json build()
+    {
+        std::vector<bool> invokes(m_block_count, false);
+        for (std::uint32_t site = 0; site < m_options.exception_edges; ++site) {
+            invokes[1U + m_rng.below(m_block_count - 1U)] = true;
+        }
+
+        nlohmann::json blocks = nlohmann::json::array();
+        nlohmann::json edges = nlohmann::json::array();
+        const std::uint32_t landing_pad = m_block_count;
+        bool has_vcall = false;
+        for (std::uint32_t block = 0; block < m_block_count; ++block) {
+            if (block == 0) {
+                emit_entry();
+            } else {
+                has_vcall = emit_body() || has_vcall;
+            }
+            if (invokes[block]) {
+                emit("invoke", {function_uid((m_index + 1U) % m_options.functions)});
+                edges.push_back(edge(block, landing_pad, "exception"));
+            }
+            if (block + 1U == m_block_count) {
+                emit("ret", nlohmann::json::array());
+            } else {
+                edges.push_back(edge(block, block + 1U, "succ0"));
+            }
+            blocks.push_back(take_block(block));
+        }
+        // Nested loops: back edge d jumps from latch N-2-d to header 1+d.
+        for (std::uint32_t depth = 0; depth < m_options.loop_depth; ++depth) {
+            const std::uint32_t header = 1U + depth;
+            if (header + depth + 2U > m_block_count) {
+                break;
+            }
+            edges.push_back(edge(m_block_count - 2U - depth, header, "succ1"));
+        }
+        if (std::ranges::find(invokes, true) != invokes.end()) {
+            emit("landingpad", nlohmann::json::array());
+            emit("lifetime.end", {indexed("v", 0)});
+            emit("resume", nlohmann::json::array());
+            blocks.push_back(take_block(landing_pad));
+        }
+
+        nlohmann::json cfg = {
+            { "entry",             "B0"},
+            {"blocks", std::move(blocks)},
+            { "edges",  std::move(edges)}
+        };
+        nlohmann::json func = {
+            {"function_uid",      function_uid(m_index)},
+            {"mangled_name", indexed("_Z3fn", m_index)},
+            {         "cfg",             std::move(cfg)}
+        };
+        if (has_vcall) {
+            func["tables"] = {
+                {"vcall_candidates", vcall_candidates()}
+            };
+        }
+        return func;
+    }
+
+private:
+    void emit(std::string_view op, nlohmann::json args, nlohmann::json effects = nullptr)
+    {
+        nlohmann::json inst = {
+            {  "id", indexed("I", m_next_inst++)},
+            {  "op",           std::string(op)},
+            {"args",           std::move(args)}
+        };
+        if (!effects.is_null()) {
+            inst["effects"] = std::move(effects);
+        }
+        m_insts.push_back(std::move(inst));
+    }
+
+    [[nodiscard]] nlohmann::json take_block(std::uint32_t block)
+    {
+        nlohmann::json result = {
+            {   "id", indexed("B", block)},
+            {"insts",    std::move(m_insts)}
+        };
+        m_insts = nlohmann::json::array();
+        return result;
+    }
+
+    [[nodiscard]] static nlohmann::json edge(std::uint32_t from, std::uint32_t to, std::string_view kind)
+    {
+        return nlohmann::json{
+            {"from", indexed("B", from)},
+            {  "to",   indexed("B", to)},
+            {"kind",   std::string(kind)}
+        };
+    }
+
+    void emit_entry()
+    {
+        for (std::uint32_t var = 0; var < m_variables; ++var) {
+            const auto name = indexed("v", var);
+            emit("lifetime.begin", {name});
+            auto declared = ref_expr(name);
+            declared["has_init"] = var % 2U == 0U;
+            emit("assign", {std::move(declared)});
+            const auto pointer = indexed("p", var);
+            emit("store", {ref_expr(pointer)}, points_to_effect(pointer, {"inbounds"}));
+        }
+    }
+
+    /// Straight-line work of a non-entry block; returns whether a vcall was emitted.
+    bool emit_body()
+    {
+        const auto var = m_rng.below(m_variables);
+        const auto name = indexed("v", var);
+        const auto pointer = indexed("p", var);
+        emit("store", {ref_expr(name)});
+        if (m_rng.percent(25)) {
+            emit("move", {ref_expr(indexed("v", m_rng.below(m_variables))), name});
+        }
+        if (m_rng.percent(15)) {
+            emit("lifetime.end", {name});
+        } else if (m_rng.percent(15)) {
+            emit("lifetime.begin", {name});
+        }
+
+        std::vector<std::string> targets{
+            std::string(kPointerTargets[m_rng.below(kPointerTargetCount)])};
+        if (m_rng.percent(30)) {
+            targets.emplace_back(kPointerTargets[m_rng.below(kPointerTargetCount)]);
+        }
+        emit("store", {ref_expr(pointer)}, points_to_effect(pointer, targets));
+
+        if (m_rng.percent(m_options.alloc_percent)) {
+            const auto slot = m_rng.below(m_variables);
+            const auto label = indexed("h", slot);
+            if (m_allocated[slot]) {
+                emit("free", {label});
+            } else {
+                emit("alloc", {label}, points_to_effect(indexed("p", slot), {label}));
+            }
+            m_allocated[slot] = !m_allocated[slot];
+        }
+
+        bool has_vcall = false;
+        if (m_rng.percent(m_options.vcall_percent)) {
+            emit("vcall", {pointer, indexed("vc", m_rng.below(kVCallCandidateSets))});
+            has_vcall = true;
+        }
+
+        const auto token = kPoTokens[m_rng.below(kPoTokenCount)];
+        std::string target = name;
+        if (token == "null" || token == "oob") {
+            target = pointer;
+        } else if (token == "double_free") {
+            target = indexed("h", var);
+        }
+        emit("sink.marker", {std::string(token), std::move(target)});
+        return has_vcall;
+    }
+
+    [[nodiscard]] nlohmann::json vcall_candidates() const
+    {
+        nlohmann::json sets = nlohmann::json::array();
+        for (std::uint32_t set = 0; set < kVCallCandidateSets; ++set) {
+            nlohmann::json methods = nlohmann::json::array();
+            for (std::uint32_t method = 0; method <= set; ++method) {
+                methods.push_back(function_uid((m_index + method + 1U) % m_options.functions));
+            }
+            sets.push_back({
+                {     "id", indexed("vc", set)},
+                {"methods",  std::move(methods)}
+            });
+        }
+        return sets;
+    }
+
+    const SyntheticNirOptions& m_options;
+    std::uint32_t m_index;
+    SplitMix64 m_rng;
+    std::uint32_t m_variables;
+    std::uint32_t m_block_count;
+    nlohmann::json m_insts;
+    std::vector<bool> m_allocated;
+    std::uint32_t m_next_inst = 0;
+};
+
+}  // namespace
+
+nlohmann::json make_synthetic_nir(const SyntheticNirOptions& options)
+{
+    nlohmann::json functions = nlohmann::json::array();
+    for (std::uint32_t index = 0; index < options.functions; ++index) {
+        functions.push_back(FunctionBuilder(options, index).build());
+    }
+
+    const std::string shape = std::to_string(options.functions) + "/"
+                              + std::to_string(options.blocks_per_function) + "/"
+                              + std::to_string(options.loop_depth) + "/"
+                              + std::to_string(options.exception_edges) + "/"
+                              + std::to_string(options.variables) + "/"
+                              + std::to_string(options.vcall_percent) + "/"
+                              + std::to_string(options.alloc_percent) + "/"
+                              + std::to_string(options.seed);
+    return nlohmann::json{
+        {      "schema_version",                                                  "nir.v1"},
+        {                "tool", nlohmann::json{{"name", "sappp"}, {"version", kVersion}}},
+        {        "generated_at",                                    "1970-01-01T00:00:00Z"},
+        {               "tu_id",            common::sha256_prefixed("synthetic:" + shape)},
+        {   "semantics_version",                                         kSemanticsVersion},
+        {"proof_system_version",                                       kProofSystemVersion},
+        {     "profile_version",                                           kProfileVersion},
+        {           "functions",                                      std::move(functions)}
+    };
+}
+
+}  // namespace sappp::analyzer
@@ -0,0 +1,36 @@
+#pragma once
+
+/**
+ * @file synthetic_nir.hpp
+ * @brief Deterministic synthetic NIR for analyzer benchmarks
+ */
+
+#include <cstdint>
+
+#include <nlohmann/json.hpp>
+
+namespace sappp::analyzer {
+
+/// Shape of a generated program; every knob scales one dimension of analyzer work.
+struct SyntheticNirOptions
+{
+    std::uint32_t functions = 16;
+    std::uint32_t blocks_per_function = 8;  ///< At least 2 (entry and exit)
+    std::uint32_t loop_depth = 1;           ///< Nested back edges per function
+    std::uint32_t exception_edges = 1;      ///< Invoke blocks unwinding to a landing pad
+    std::uint32_t variables = 4;            ///< Locals tracked by the lifetime/init domains
+    std::uint32_t vcall_percent = 10;       ///< Share of blocks with a virtual call
+    std::uint32_t alloc_percent = 20;       ///< Share of blocks allocating heap memory
+    std::uint64_t seed = 0;
+};
+
+/**
+ * @brief NIR document (schema_version nir.v1) shaped by @p options
+ *
+ * The same options always produce the same document on every platform. Blocks carry
+ * lifetime, init, heap and points-to effects plus sink.marker PO sites, so
+ * PoGenerator yields a po_list that exercises every decision path of the analyzer.
+ */
+[[nodiscard]] nlohmann::json make_synthetic_nir(const SyntheticNirOptions& options);
+
+}  // namespace sappp::analyzer
@@ -7,7 +7,9 @@
 
 #include "sappp/canonical_json.hpp"
 #include "sappp/common.hpp"
+#include "sappp/parallel.hpp"
 #include "sappp/schema_validate.hpp"
+#include "sappp/trace.hpp"
 #include "sappp/version.hpp"
 
 #include <algorithm>
@@ -15,35 +17,41 @@
 #include <cctype>
 #include <chrono>
 #include <cstddef>
+#include <exception>
 #include <filesystem>
 #include <format>
 #include <fstream>
 #include <iomanip>
 #include <iterator>
+#include <limits>
+#include <map>
+#include <optional>
 #include <ranges>
+#include <set>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace sappp::build_capture {
 
 namespace {
 
-[[nodiscard]] sappp::Result<std::string> read_file(const std::string& path)
-{
-    std::ifstream in(path, std::ios::binary);
-    if (!in) {
-        return std::unexpected(Error::make("CompileCommandsOpenFailed",
-                                           "Failed to open compile_commands.json: " + path));
-    }
-    return std::string{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
-}
-
 [[nodiscard]] std::string current_time_utc()
 {
     const auto now = std::chrono::system_clock::now();
     return std::format("{:%Y-%m-%dT%H:%M:%SZ}", std::chrono::floor<std::chrono::seconds>(now));
 }
 
+[[nodiscard]] nlohmann::json tool_metadata()
+{
+    return {
+        {    "name",          "sappp"},
+        { "version",  sappp::kVersion},
+        {"build_id", sappp::kBuildId}
+    };
+}
+
 [[nodiscard]] std::string detect_os()
 {
 #if defined(_WIN32)
@@ -180,16 +188,22 @@ constexpr std::array<TripleEntry, 10> kDefaultTriples = {
     return args;
 }
 
-[[nodiscard]] std::string detect_lang_from_file(const std::string& file_path)
+[[nodiscard]] std::string lowercase_extension(std::string_view file_path)
 {
     auto pos = file_path.find_last_of('.');
-    if (pos == std::string::npos) {
-        return "c++";
+    if (pos == std::string_view::npos) {
+        return {};
     }
-    std::string ext = file_path.substr(pos + 1);
+    std::string ext(file_path.substr(pos + 1));
     std::ranges::transform(ext, ext.begin(), [](unsigned char c) noexcept {
         return static_cast<char>(std::tolower(c));
     });
+    return ext;
+}
+
+[[nodiscard]] std::string detect_lang_from_file(const std::string& file_path)
+{
+    const std::string ext = lowercase_extension(file_path);
     if (ext == "c") {
         return "c";
     }
@@ -226,23 +240,91 @@ constexpr std::array<TripleEntry, 10> kDefaultTriples = {
     return hash_input;
 }
 
-[[nodiscard]] sappp::Result<nlohmann::json> parse_compile_database(const std::string& raw)
+[[nodiscard]] bool is_source_file(std::string_view path)
 {
-    nlohmann::json compile_db;
-    try {
-        compile_db = nlohmann::json::parse(raw);
-    } catch (const std::exception& ex) {
-        return std::unexpected(
-            Error::make("CompileCommandsParseFailed",
-                        std::string("Failed to parse compile_commands.json: ") + ex.what()));
-    }
-    if (!compile_db.is_array() || compile_db.empty()) {
-        return std::unexpected(Error::make("CompileCommandsInvalid",
-                                           "compile_commands.json must be a non-empty array"));
+    const std::string ext = lowercase_extension(path);
+    return ext == "c" || ext == "cpp" || ext == "cc" || ext == "cxx" || ext == "c++" || ext == "cp";
+}
+
+/// Identifies the translation unit a compile unit builds, independent of its flags.
+[[nodiscard]] std::string unit_source_key(const nlohmann::json& unit)
+{
+    const auto& argv = unit.at("argv");
+    std::string source;
+    for (std::size_t i = 1; i < argv.size(); ++i) {
+        const auto& arg = argv[i].get_ref<const std::string&>();
+        if (!arg.starts_with('-') && is_source_file(arg)) {
+            source = arg;
+        }
     }
-    return compile_db;
+    std::string key = unit.at("cwd").get<std::string>();
+    key += '\0';
+    key += source.empty() ? unit.at("tu_id").get<std::string>() : source;
+    return key;
 }
 
+/**
+ * @brief Units of a base snapshot addressable by the inputs their tu_id was derived from
+ *
+ * A unit is indexed only when it was produced by this exact tool build for the current
+ * target with no environment or response-file inputs; for those, equal cwd, lang and argv
+ * imply an identical unit, so the unit (and its tu_id) can be reused without rehashing.
+ */
+class BaseUnitIndex
+{
+public:
+    BaseUnitIndex(const nlohmann::json& base_snapshot, const nlohmann::json& target)
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        : m_units()
+    {
+        if (!base_snapshot.contains("tool") || base_snapshot.at("tool") != tool_metadata()
+            || !base_snapshot.contains("compile_units")) {
+            return;
+        }
+        const auto& units = base_snapshot.at("compile_units");
+        m_units.reserve(units.size());
+        for (const auto& unit : units) {
+            if (unit.at("target") != target || !unit.at("env_delta").empty()
+                || !unit.at("response_files").empty()) {
+                continue;
+            }
+            m_units.emplace(key(unit.at("cwd").get_ref<const std::string&>(),
+                                unit.at("lang").get_ref<const std::string&>(),
+                                unit.at("argv").get<std::vector<std::string>>()),
+                            &unit);
+        }
+    }
+
+    [[nodiscard]] const nlohmann::json* find(std::string_view cwd,
+                                             std::string_view lang,
+                                             const std::vector<std::string>& argv) const
+    {
+        auto it = m_units.find(key(cwd, lang, argv));
+        return it == m_units.end() ? nullptr : it->second;
+    }
+
+private:
+    // Length-prefixed fields keep the key unambiguous for arbitrary argument text.
+    [[nodiscard]] static std::string
+    key(std::string_view cwd, std::string_view lang, const std::vector<std::string>& argv)
+    {
+        std::string result;
+        const auto append = [&result](std::string_view field) {
+            result += std::to_string(field.size());
+            result += ':';
+            result += field;
+        };
+        append(cwd);
+        append(lang);
+        for (const auto& arg : argv) {
+            append(arg);
+        }
+        return result;
+    }
+
+    std::unordered_map<std::string, const nlohmann::json*> m_units;
+};
+
 [[nodiscard]] sappp::Result<std::vector<std::string>> extract_argv(const nlohmann::json& entry,
                                                                    std::size_t index)
 {
@@ -271,6 +353,7 @@ constexpr std::array<TripleEntry, 10> kDefaultTriples = {
 [[nodiscard]] sappp::Result<nlohmann::json> build_compile_unit(const nlohmann::json& entry,
                                                                std::string_view repo_root,
                                                                const nlohmann::json& target,
+                                                               const BaseUnitIndex* base,
                                                                std::size_t index)
 {
     if (!entry.is_object()) {
@@ -300,6 +383,11 @@ constexpr std::array<TripleEntry, 10> kDefaultTriples = {
     std::string cwd = common::normalize_path(directory, repo_root);
     std::string normalized_file = common::normalize_path(file_path, repo_root);
     std::string lang = detect_lang_from_file(normalized_file);
+    if (base != nullptr) {
+        if (const nlohmann::json* reused = base->find(cwd, lang, *argv); reused != nullptr) {
+            return *reused;
+        }
+    }
     std::string std_value = extract_std(*argv, lang);
     nlohmann::json frontend = default_frontend(*argv);
 
@@ -324,64 +412,334 @@ constexpr std::array<TripleEntry, 10> kDefaultTriples = {
     return unit;
 }
 
-[[nodiscard]] sappp::Result<std::vector<nlohmann::json>>
-build_compile_units(const nlohmann::json& compile_db,
-                    std::string_view repo_root,
-                    const nlohmann::json& target)
+/**
+ * @brief Normalizes compile database entries on worker threads while they are parsed
+ *
+ * Entries arrive one at a time from the streaming parser and are buffered in fixed-size
+ * chunks; once a wave of chunks is full, its chunks are normalized on the workers, so
+ * peak memory tracks the produced units rather than the input. Results are merged in
+ * input order and the first failing entry in input order is reported.
+ */
+class CompileUnitPipeline
 {
-    std::vector<nlohmann::json> units;
-    units.reserve(compile_db.size());
-    for (auto [index, entry] : std::views::enumerate(compile_db)) {
-        auto unit = build_compile_unit(entry, repo_root, target, static_cast<std::size_t>(index));
-        if (!unit) {
-            return std::unexpected(unit.error());
+public:
+    CompileUnitPipeline(std::string_view repo_root,
+                        const nlohmann::json& target,
+                        const BaseUnitIndex* base,
+                        std::size_t jobs)
+        : m_repo_root(repo_root)
+        , m_target(target)
+        , m_base(base)
+        , m_jobs(jobs)
+        , m_wave_capacity(
+              kChunkSize * kChunksPerWorker
+              * common::resolve_worker_count(jobs, std::numeric_limits<std::size_t>::max()))
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_wave()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_units()
+    {}
+
+    ~CompileUnitPipeline() = default;
+
+    CompileUnitPipeline(const CompileUnitPipeline&) = delete;
+    CompileUnitPipeline& operator=(const CompileUnitPipeline&) = delete;
+    CompileUnitPipeline(CompileUnitPipeline&&) = delete;
+    CompileUnitPipeline& operator=(CompileUnitPipeline&&) = delete;
+
+    [[nodiscard]] std::size_t size() const noexcept { return m_entry_count; }
+
+    void push(nlohmann::json entry)
+    {
+        ++m_entry_count;
+        if (!m_status || m_failure) {
+            return;
+        }
+        m_wave.push_back(std::move(entry));
+        if (m_wave.size() == m_wave_capacity) {
+            run_wave();
+        }
+    }
+
+    /// Units of every entry in input order, or the error of the first failing entry.
+    [[nodiscard]] sappp::Result<nlohmann::json::array_t> finish()
+    {
+        run_wave();
+        if (m_failure) {
+            std::rethrow_exception(m_failure);
+        }
+        if (!m_status) {
+            return std::unexpected(m_status.error());
+        }
+        return std::move(m_units);
+    }
+
+private:
+    static constexpr std::size_t kChunkSize = 256;
+    static constexpr std::size_t kChunksPerWorker = 2;
+
+    /// Normalize the buffered entries. Exceptions are kept for finish(), which runs on the
+    /// caller's thread outside the parser callback.
+    void run_wave()
+    {
+        if (m_wave.empty() || !m_status || m_failure) {
+            return;
+        }
+        const std::size_t chunk_count = (m_wave.size() + kChunkSize - 1) / kChunkSize;
+        std::vector<std::vector<nlohmann::json>> chunks(chunk_count);
+        try {
+            m_status = common::parallel_for_each_index(
+                chunk_count,
+                m_jobs,
+                [&](std::size_t chunk) -> sappp::VoidResult {
+                    const std::size_t first = chunk * kChunkSize;
+                    const std::size_t last = std::min(first + kChunkSize, m_wave.size());
+                    chunks[chunk].reserve(last - first);
+                    for (std::size_t i = first; i < last; ++i) {
+                        auto unit = build_compile_unit(m_wave[i],
+                                                       m_repo_root,
+                                                       m_target,
+                                                       m_base,
+                                                       m_wave_first_index + i);
+                        if (!unit) {
+                            return std::unexpected(unit.error());
+                        }
+                        chunks[chunk].push_back(std::move(*unit));
+                    }
+                    return {};
+                });
+        } catch (...) {
+            // Malformed entries throw from json::get(); rethrown by finish().
+            m_failure = std::current_exception();
+        }
+        m_wave_first_index += m_wave.size();
+        m_wave.clear();
+        for (auto& units : chunks) {
+            std::ranges::move(units, std::back_inserter(m_units));
         }
-        units.push_back(std::move(*unit));
+    }
+
+    std::string_view m_repo_root;
+    const nlohmann::json& m_target;
+    const BaseUnitIndex* m_base;
+    std::size_t m_jobs;
+    std::size_t m_wave_capacity;
+    std::vector<nlohmann::json> m_wave;
+    std::size_t m_wave_first_index = 0;
+    std::size_t m_entry_count = 0;
+    nlohmann::json::array_t m_units;
+    sappp::VoidResult m_status = {};
+    std::exception_ptr m_failure = nullptr;
+};
+
+/// tu_ids only present in one snapshot, grouped by the source they build.
+using UnitsBySource = std::map<std::string, std::vector<std::string>>;
+
+[[nodiscard]] std::map<std::string, const nlohmann::json*>
+units_by_tu_id(const nlohmann::json& snapshot)
+{
+    std::map<std::string, const nlohmann::json*> units;
+    for (const auto& unit : snapshot.at("compile_units")) {
+        units.emplace(unit.at("tu_id").get<std::string>(), &unit);
     }
     return units;
 }
 
+[[nodiscard]] nlohmann::json build_change_set(const nlohmann::json& base_snapshot,
+                                              const nlohmann::json& snapshot)
+{
+    const auto base_units = units_by_tu_id(base_snapshot);
+    const auto units = units_by_tu_id(snapshot);
+
+    std::size_t unchanged = 0;
+    UnitsBySource removed_by_source;
+    for (const auto& [tu_id, unit] : base_units) {
+        if (units.contains(tu_id)) {
+            ++unchanged;
+        } else {
+            removed_by_source[unit_source_key(*unit)].push_back(tu_id);
+        }
+    }
+    UnitsBySource added_by_source;
+    for (const auto& [tu_id, unit] : units) {
+        if (!base_units.contains(tu_id)) {
+            added_by_source[unit_source_key(*unit)].push_back(tu_id);
+        }
+    }
+
+    // A source that lost exactly one unit and gained exactly one was recompiled with
+    // different flags; anything more ambiguous is reported as plain removals/additions.
+    std::vector<std::string> added;
+    std::vector<std::string> removed;
+    std::vector<std::pair<std::string, std::string>> modified;
+    for (const auto& [source, tu_ids] : added_by_source) {
+        auto it = removed_by_source.find(source);
+        if (tu_ids.size() == 1 && it != removed_by_source.end() && it->second.size() == 1) {
+            modified.emplace_back(tu_ids.front(), it->second.front());
+            removed_by_source.erase(it);
+            continue;
+        }
+        std::ranges::copy(tu_ids, std::back_inserter(added));
+    }
+    for (const auto& tu_ids : removed_by_source | std::views::values) {
+        std::ranges::copy(tu_ids, std::back_inserter(removed));
+    }
+    std::ranges::sort(added);
+    std::ranges::sort(removed);
+    std::ranges::sort(modified);
+
+    nlohmann::json modified_json = nlohmann::json::array();
+    for (const auto& [tu_id, base_tu_id] : modified) {
+        modified_json.push_back({
+            {"base_tu_id", base_tu_id},
+            {     "tu_id",      tu_id}
+        });
+    }
+    nlohmann::json change_set = {
+        {"schema_version",       "build_change_set.v1"},
+        {          "tool",             tool_metadata()},
+        {  "generated_at",          current_time_utc()},
+        {  "input_digest", snapshot.at("input_digest")},
+        {         "added",                       added},
+        {       "removed",                     removed},
+        {      "modified",               modified_json},
+        {     "unchanged",                   unchanged}
+    };
+    if (base_snapshot.contains("input_digest")) {
+        change_set["base_input_digest"] = base_snapshot.at("input_digest");
+    }
+    return change_set;
+}
+
 }  // namespace
 
 BuildSnapshot::BuildSnapshot(nlohmann::json json)
     : m_json(std::move(json))
 {}
 
-BuildCapture::BuildCapture(std::string repo_root, std::string schema_dir)
+BuildCapture::BuildCapture(std::string repo_root, std::string schema_dir, std::size_t jobs)
     : m_repo_root(std::move(repo_root))
     , m_schema_dir(std::move(schema_dir))
+    , m_jobs(jobs)
 {}
 
 sappp::Result<BuildSnapshot> BuildCapture::capture(const std::string& compile_commands_path)
 {
-    auto raw = read_file(compile_commands_path);
-    if (!raw) {
-        return std::unexpected(raw.error());
+    return run(compile_commands_path, nullptr);
+}
+
+sappp::Result<BuildDelta> BuildCapture::capture_delta(const std::string& compile_commands_path,
+                                                      const BuildSnapshot& base)
+{
+    auto snapshot = run(compile_commands_path, &base.json());
+    if (!snapshot) {
+        return std::unexpected(snapshot.error());
+    }
+
+    nlohmann::json change_set = build_change_set(base.json(), snapshot->json());
+    // Units kept verbatim may still read a header that changed since the base was scanned.
+    if (base.json().contains("dependencies")) {
+        common::FileHashCache local_hashes;
+        common::FileHashCache& hashes = m_file_hashes != nullptr ? *m_file_hashes : local_hashes;
+        const auto stale = invalidated_units(base, hashes, m_repo_root, m_jobs);
+        std::set<std::string> current;
+        for (const auto& unit : snapshot->json().at("compile_units")) {
+            current.insert(unit.at("tu_id").get<std::string>());
+        }
+        nlohmann::json dependency_changed = nlohmann::json::array();
+        for (const auto& tu_id : stale) {
+            if (current.contains(tu_id)) {
+                dependency_changed.push_back(tu_id);
+            }
+        }
+        change_set["dependency_changed"] = std::move(dependency_changed);
+    }
+    std::filesystem::path schema_path =
+        std::filesystem::path(m_schema_dir) / "build_change_set.v1.schema.json";
+    if (auto result = common::validate_json(change_set, schema_path.string()); !result) {
+        return std::unexpected(result.error());
+    }
+    return BuildDelta{.snapshot = std::move(*snapshot), .change_set = std::move(change_set)};
+}
+
+// NOLINTNEXTLINE(readability-function-size) - parse, normalize and assemble stay together.
+sappp::Result<BuildSnapshot> BuildCapture::run(const std::string& compile_commands_path,
+                                               const nlohmann::json* base_snapshot)
+{
+    const common::trace::Span span("capture", "build_capture", compile_commands_path);
+    std::ifstream in(compile_commands_path, std::ios::binary);
+    if (!in) {
+        return std::unexpected(
+            Error::make("CompileCommandsOpenFailed",
+                        "Failed to open compile_commands.json: " + compile_commands_path));
     }
-    auto compile_db = parse_compile_database(*raw);
-    if (!compile_db) {
-        return std::unexpected(compile_db.error());
+
+    common::FileHashCache local_hashes;
+    auto input_digest = (m_file_hashes != nullptr ? *m_file_hashes : local_hashes)
+                            .digest(compile_commands_path);
+    if (!input_digest) {
+        return std::unexpected(input_digest.error());
     }
 
-    nlohmann::json target = default_target();
+    const nlohmann::json target = default_target();
+    std::optional<BaseUnitIndex> base_index;
+    if (base_snapshot != nullptr) {
+        base_index.emplace(*base_snapshot, target);
+    }
+    CompileUnitPipeline pipeline(m_repo_root,
+                                 target,
+                                 base_index ? &*base_index : nullptr,
+                                 m_jobs);
+
+    // Stream the top-level array: each complete entry is moved to the pipeline and
+    // discarded from the DOM, so at most one wave of entries is resident at a time.
+    bool top_level_array = false;
+    nlohmann::json compile_db;
+    try {
+        compile_db = nlohmann::json::parse(
+            in,
+            [&](int depth, nlohmann::json::parse_event_t event, nlohmann::json& parsed) {
+                using Event = nlohmann::json::parse_event_t;
+                if (depth == 0 && event == Event::array_start) {
+                    top_level_array = true;
+                    return true;
+                }
+                if (depth != 1 || !top_level_array
+                    || (event != Event::object_end && event != Event::array_end
+                        && event != Event::value)) {
+                    return true;
+                }
+                pipeline.push(std::move(parsed));
+                return false;
+            });
+    } catch (const std::exception& ex) {
+        return std::unexpected(
+            Error::make("CompileCommandsParseFailed",
+                        std::string("Failed to parse compile_commands.json: ") + ex.what()));
+    }
+    if (!compile_db.is_array() || pipeline.size() == 0) {
+        return std::unexpected(Error::make("CompileCommandsInvalid",
+                                           "compile_commands.json must be a non-empty array"));
+    }
 
-    auto units = build_compile_units(*compile_db, m_repo_root, target);
+    auto units = pipeline.finish();
     if (!units) {
         return std::unexpected(units.error());
     }
 
     std::ranges::stable_sort(*units, [](const nlohmann::json& a, const nlohmann::json& b) {
-        return a.at("tu_id").get<std::string>() < b.at("tu_id").get<std::string>();
+        return a.at("tu_id").get_ref<const std::string&>()
+               < b.at("tu_id").get_ref<const std::string&>();
     });
 
     nlohmann::json snapshot = {
-        {"schema_version",                                                              "build_snapshot.v1"},
-        {          "tool", {{"name", "sappp"}, {"version", sappp::kVersion}, {"build_id", sappp::kBuildId}}},
-        {  "generated_at",                                                               current_time_utc()},
-        {          "host",                                   {{"os", detect_os()}, {"arch", detect_arch()}}},
-        { "compile_units",                                                                           *units}
+        {"schema_version",                            "build_snapshot.v1"},
+        {          "tool",                                tool_metadata()},
+        {  "generated_at",                             current_time_utc()},
+        {          "host", {{"os", detect_os()}, {"arch", detect_arch()}}}
     };
-    snapshot["input_digest"] = common::sha256_prefixed(*raw);
+    snapshot["compile_units"] = std::move(*units);
+    snapshot["input_digest"] = *input_digest;
 
     std::filesystem::path schema_path =
         std::filesystem::path(m_schema_dir) / "build_snapshot.v1.schema.json";
@@ -392,4 +750,49 @@ sappp::Result<BuildSnapshot> BuildCapture::capture(const std::string& compile_co
     return BuildSnapshot(std::move(snapshot));
 }
 
+std::vector<std::string> invalidated_units(const BuildSnapshot& snapshot,
+                                           common::FileHashCache& hashes,
+                                           std::string_view repo_root,
+                                           std::size_t jobs)
+{
+    const auto& json = snapshot.json();
+    std::set<std::string> invalidated;
+    for (const auto& unit : json.at("compile_units")) {
+        invalidated.insert(unit.at("tu_id").get<std::string>());
+    }
+    if (!json.contains("dependencies")) {
+        return {invalidated.begin(), invalidated.end()};
+    }
+    const auto& recorded = json.at("dependencies").at("units");
+
+    // Each distinct dependency is hashed once, however many units include it.
+    std::map<std::string, std::size_t> path_index;
+    std::vector<std::filesystem::path> paths;
+    for (const auto& entry : recorded) {
+        for (const auto& file : entry.at("files")) {
+            const auto& path = file.at("path").get_ref<const std::string&>();
+            if (!path_index.try_emplace(path, paths.size()).second) {
+                continue;
+            }
+            std::filesystem::path resolved(path);
+            if (resolved.is_relative() && !repo_root.empty()) {
+                resolved = std::filesystem::path(repo_root) / resolved;
+            }
+            paths.push_back(std::move(resolved));
+        }
+    }
+    const auto digests = hashes.digest_all(paths, jobs);
+
+    const auto is_current = [&](const nlohmann::json& file) {
+        const auto& digest = digests[path_index.at(file.at("path").get<std::string>())];
+        return digest && *digest == file.at("sha256").get_ref<const std::string&>();
+    };
+    for (const auto& entry : recorded) {
+        if (std::ranges::all_of(entry.at("files"), is_current)) {
+            invalidated.erase(entry.at("tu_id").get<std::string>());
+        }
+    }
+    return {invalidated.begin(), invalidated.end()};
+}
+
 }  // namespace sappp::build_capture
@@ -14,8 +14,11 @@
 #include "sappp/common.hpp"
 
 #include <algorithm>
+#include <charconv>
+#include <cstdint>
 #include <format>
 #include <ranges>
+#include <string_view>
 
 namespace sappp::canonical {
 
@@ -78,6 +81,302 @@ sappp::VoidResult validate_no_float(const nlohmann::json& j, std::string_view pa
     return j;
 }
 
+/**
+ * @brief Single-pass checker for the exact byte form produced by canonicalize()
+ *
+ * Mirrors nlohmann::json::dump(-1) with ensure_ascii=false: control characters
+ * are the only escaped code points (short escapes where JSON has one, otherwise
+ * lowercase \u00xx), and everything else is emitted raw. UTF-8 validity is
+ * left to the subsequent parse.
+ */
+class CanonicalScanner
+{
+public:
+    explicit CanonicalScanner(std::string_view bytes)
+        : m_bytes(bytes)
+    {}
+
+    [[nodiscard]] sappp::VoidResult scan()
+    {
+        if (auto result = scan_value(0); !result) {
+            return result;
+        }
+        if (m_pos != m_bytes.size()) {
+            return std::unexpected(non_canonical("trailing bytes after value"));
+        }
+        return {};
+    }
+
+private:
+    static constexpr std::size_t kMaxDepth = 512;
+
+    [[nodiscard]] Error non_canonical(std::string_view what) const
+    {
+        return Error::make("NonCanonicalJson",
+                           std::format("Non-canonical JSON at byte {}: {}", m_pos, what));
+    }
+
+    [[nodiscard]] Error parse_error(std::string_view what) const
+    {
+        return Error::make("ParseError", std::format("Invalid JSON at byte {}: {}", m_pos, what));
+    }
+
+    [[nodiscard]] bool at_end() const { return m_pos >= m_bytes.size(); }
+
+    [[nodiscard]] char peek() const { return m_bytes[m_pos]; }
+
+    [[nodiscard]] static bool is_whitespace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    [[nodiscard]] std::unexpected<Error> unexpected_byte() const
+    {
+        if (at_end()) {
+            return std::unexpected(parse_error("unexpected end of input"));
+        }
+        if (is_whitespace(peek())) {
+            return std::unexpected(non_canonical("whitespace is not allowed"));
+        }
+        return std::unexpected(parse_error(std::format("unexpected character '{}'", peek())));
+    }
+
+    [[nodiscard]] sappp::VoidResult scan_value(std::size_t depth)
+    {
+        if (at_end()) {
+            return unexpected_byte();
+        }
+        switch (peek()) {
+            case '{':
+                return scan_object(depth + 1);
+            case '[':
+                return scan_array(depth + 1);
+            case '"':
+                return scan_string(nullptr);
+            case 't':
+                return scan_literal("true");
+            case 'f':
+                return scan_literal("false");
+            case 'n':
+                return scan_literal("null");
+            default:
+                if (peek() == '-' || (peek() >= '0' && peek() <= '9')) {
+                    return scan_number();
+                }
+                return unexpected_byte();
+        }
+    }
+
+    [[nodiscard]] sappp::VoidResult scan_object(std::size_t depth)
+    {
+        if (depth > kMaxDepth) {
+            return std::unexpected(parse_error("nesting too deep"));
+        }
+        ++m_pos;
+        if (!at_end() && peek() == '}') {
+            ++m_pos;
+            return {};
+        }
+        std::string previous_key;
+        for (bool first = true;; first = false) {
+            if (at_end() || peek() != '"') {
+                return unexpected_byte();
+            }
+            std::string key;
+            if (auto result = scan_string(&key); !result) {
+                return result;
+            }
+            if (!first && !(previous_key < key)) {
+                return std::unexpected(non_canonical(key == previous_key
+                                                         ? "duplicate object key"
+                                                         : "object keys are not sorted"));
+            }
+            previous_key = std::move(key);
+            if (at_end() || peek() != ':') {
+                return unexpected_byte();
+            }
+            ++m_pos;
+            if (auto result = scan_value(depth); !result) {
+                return result;
+            }
+            if (at_end()) {
+                return unexpected_byte();
+            }
+            if (peek() == '}') {
+                ++m_pos;
+                return {};
+            }
+            if (peek() != ',') {
+                return unexpected_byte();
+            }
+            ++m_pos;
+        }
+    }
+
+    [[nodiscard]] sappp::VoidResult scan_array(std::size_t depth)
+    {
+        if (depth > kMaxDepth) {
+            return std::unexpected(parse_error("nesting too deep"));
+        }
+        ++m_pos;
+        if (!at_end() && peek() == ']') {
+            ++m_pos;
+            return {};
+        }
+        while (true) {
+            if (auto result = scan_value(depth); !result) {
+                return result;
+            }
+            if (at_end()) {
+                return unexpected_byte();
+            }
+            if (peek() == ']') {
+                ++m_pos;
+                return {};
+            }
+            if (peek() != ',') {
+                return unexpected_byte();
+            }
+            ++m_pos;
+        }
+    }
+
+    /// Scan a string starting at the opening quote; decodes into @p decoded when non-null.
+    [[nodiscard]] sappp::VoidResult scan_string(std::string* decoded)
+    {
+        ++m_pos;
+        while (!at_end()) {
+            const char c = peek();
+            if (c == '"') {
+                ++m_pos;
+                return {};
+            }
+            if (static_cast<unsigned char>(c) < 0x20U) {
+                return std::unexpected(parse_error("unescaped control character in string"));
+            }
+            if (c != '\\') {
+                if (decoded != nullptr) {
+                    decoded->push_back(c);
+                }
+                ++m_pos;
+                continue;
+            }
+            ++m_pos;
+            if (at_end()) {
+                return unexpected_byte();
+            }
+            auto unescaped = scan_escape();
+            if (!unescaped) {
+                return std::unexpected(unescaped.error());
+            }
+            if (decoded != nullptr) {
+                decoded->push_back(*unescaped);
+            }
+        }
+        return unexpected_byte();
+    }
+
+    /// Scan the escape sequence following a backslash and return the escaped character.
+    [[nodiscard]] sappp::Result<char> scan_escape()
+    {
+        const char e = peek();
+        ++m_pos;
+        switch (e) {
+            case '"':
+                return '"';
+            case '\\':
+                return '\\';
+            case 'b':
+                return '\b';
+            case 'f':
+                return '\f';
+            case 'n':
+                return '\n';
+            case 'r':
+                return '\r';
+            case 't':
+                return '\t';
+            case 'u':
+                break;
+            default:
+                return std::unexpected(non_canonical("escape is not canonical"));
+        }
+        constexpr std::size_t kHexDigits = 4;
+        if (m_bytes.size() - m_pos < kHexDigits) {
+            return std::unexpected(parse_error("truncated \\u escape"));
+        }
+        const std::string_view hex = m_bytes.substr(m_pos, kHexDigits);
+        unsigned int code_point = 0;
+        const char* begin = hex.data();
+        const char* end = hex.data() + hex.size();
+        auto [ptr, ec] = std::from_chars(begin, end, code_point, 16);
+        if (ec != std::errc{} || ptr != end) {
+            return std::unexpected(parse_error("invalid \\u escape"));
+        }
+        const bool short_form = code_point == 0x08U || code_point == 0x09U || code_point == 0x0AU
+                                || code_point == 0x0CU || code_point == 0x0DU;
+        if (code_point >= 0x20U || short_form
+            || std::ranges::any_of(hex, [](char h) noexcept { return h >= 'A' && h <= 'F'; })) {
+            return std::unexpected(non_canonical("\\u escape is not canonical"));
+        }
+        m_pos += kHexDigits;
+        return static_cast<char>(code_point);
+    }
+
+    [[nodiscard]] sappp::VoidResult scan_number()
+    {
+        const std::size_t start = m_pos;
+        if (peek() == '-') {
+            ++m_pos;
+        }
+        const std::size_t digits_start = m_pos;
+        while (!at_end() && peek() >= '0' && peek() <= '9') {
+            ++m_pos;
+        }
+        const std::string_view digits = m_bytes.substr(digits_start, m_pos - digits_start);
+        if (digits.empty()) {
+            return unexpected_byte();
+        }
+        if (digits.size() > 1 && digits.front() == '0') {
+            return std::unexpected(parse_error("leading zero in number"));
+        }
+        if (!at_end() && (peek() == '.' || peek() == 'e' || peek() == 'E')) {
+            return std::unexpected(non_canonical("floating point numbers are not allowed"));
+        }
+        const std::string_view text = m_bytes.substr(start, m_pos - start);
+        if (text == "-0") {
+            return std::unexpected(non_canonical("negative zero"));
+        }
+        // Integers outside int64/uint64 would be read back as floating point.
+        const char* begin = text.data();
+        const char* end = text.data() + text.size();
+        std::errc ec{};
+        if (text.front() == '-') {
+            std::int64_t value = 0;
+            ec = std::from_chars(begin, end, value).ec;
+        } else {
+            std::uint64_t value = 0;
+            ec = std::from_chars(begin, end, value).ec;
+        }
+        if (ec != std::errc{}) {
+            return std::unexpected(non_canonical("integer out of range"));
+        }
+        return {};
+    }
+
+    [[nodiscard]] sappp::VoidResult scan_literal(std::string_view literal)
+    {
+        if (m_bytes.substr(m_pos, literal.size()) != literal) {
+            return std::unexpected(parse_error(std::format("expected '{}'", literal)));
+        }
+        m_pos += literal.size();
+        return {};
+    }
+
+    std::string_view m_bytes;
+    std::size_t m_pos = 0;
+};
+
 }  // namespace
 
 sappp::Result<std::string> canonicalize(const nlohmann::json& j)
@@ -103,6 +402,23 @@ sappp::Result<std::string> hash_canonical(const nlohmann::json& j)
     return common::sha256_prefixed(*canonical);
 }
 
+sappp::Result<CanonicalDocument> parse_canonical(std::string_view bytes)
+{
+    CanonicalScanner scanner(bytes);
+    if (auto result = scanner.scan(); !result) {
+        return std::unexpected(result.error());
+    }
+
+    CanonicalDocument document{.value = nlohmann::json{}, .hash = common::sha256_prefixed(bytes)};
+    try {
+        document.value = nlohmann::json::parse(bytes);
+    } catch (const std::exception& ex) {
+        return std::unexpected(
+            Error::make("ParseError", std::format("Failed to parse JSON: {}", ex.what())));
+    }
+    return document;
+}
+
 void sort_keys_recursive(nlohmann::json& j)
 {
     if (j.is_object()) {
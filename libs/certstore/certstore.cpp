@@ -9,12 +9,27 @@
 
 #include "sappp/certstore.hpp"
 
+#include "io_uring_batch.hpp"
 #include "sappp/canonical_json.hpp"
+#include "sappp/run_stats.hpp"
 #include "sappp/schema_validate.hpp"
+#include "sappp/trace.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
 #include <filesystem>
+#include <format>
 #include <fstream>
 #include <iterator>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace sappp::certstore {
 
@@ -22,41 +37,364 @@ namespace {
 
 namespace fs = std::filesystem;
 
-void ensure_parent_dir(const fs::path& path)
+[[nodiscard]] sappp::VoidResult create_parent_dir(const fs::path& path)
 {
     fs::path parent = path.parent_path();
-    if (!parent.empty()) {
-        fs::create_directories(parent);
+    if (parent.empty()) {
+        return {};
     }
+    std::error_code ec;
+    fs::create_directories(parent, ec);
+    if (ec) {
+        return std::unexpected(Error::make(
+            "IOError", "Failed to create directory: " + parent.string() + ": " + ec.message()));
+    }
+    return {};
+}
+
+[[nodiscard]] sappp::VoidResult write_file_bytes(const fs::path& path, std::string_view bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        return std::unexpected(
+            Error::make("IOError", "Failed to open file for write: " + path.string()));
+    }
+    out << bytes;
+    if (!out) {
+        return std::unexpected(Error::make("IOError", "Failed to write file: " + path.string()));
+    }
+    sappp::common::stats::add(sappp::common::stats::Counter::kBytesWritten, bytes.size());
+    return {};
 }
 
 }  // namespace
 
+/**
+ * @brief Worker pool that performs queued certstore writes
+ *
+ * Jobs carry a submission sequence number so that errors are reported in a
+ * deterministic order regardless of which worker hit them. A job for a path
+ * that is still in flight is parked behind it and queued once the earlier
+ * write completes, so submit() never blocks the caller.
+ *
+ * When an io_uring is available a single worker drains the queue in batches
+ * and submits each batch's open/write/close calls through the ring; otherwise
+ * every worker writes one file at a time.
+ */
+class CertStore::AsyncWriter
+{
+public:
+    explicit AsyncWriter(std::size_t workers)
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        : m_mutex()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_work_cv()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_done_cv()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_queue()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_inflight_paths()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_parked()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_submitted_objects()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_created_dirs()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_errors()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_ring()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_threads()
+    {
+        if (auto ring = IoUringBatch::create(kRingEntries)) {
+            m_ring = std::move(*ring);
+            workers = 1;
+        }
+        m_threads.reserve(workers);
+        for (std::size_t i = 0; i < workers; ++i) {
+            m_threads.emplace_back([this](std::stop_token stop) { run(stop); });
+        }
+    }
+
+    ~AsyncWriter()
+    {
+        for (auto& thread : m_threads) {
+            thread.request_stop();
+        }
+        m_work_cv.notify_all();
+        // std::jthread joins on destruction; workers drain the queue first.
+    }
+
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+    AsyncWriter(AsyncWriter&&) = delete;
+    AsyncWriter& operator=(AsyncWriter&&) = delete;
+
+    /// Record @p hash as submitted; false when it was already queued or written.
+    [[nodiscard]] bool mark_object_submitted(const std::string& hash)
+    {
+        std::lock_guard lock(m_mutex);
+        return m_submitted_objects.insert(hash).second;
+    }
+
+    [[nodiscard]] bool is_object_submitted(const std::string& hash)
+    {
+        std::lock_guard lock(m_mutex);
+        return m_submitted_objects.contains(hash);
+    }
+
+    /// Queue a write; @p object_hash (if any) is unmarked when the write fails.
+    void submit(std::string path, std::string bytes, std::string object_hash)
+    {
+        std::unique_lock lock(m_mutex);
+        Job job{.sequence = m_next_sequence++,
+                .path = std::move(path),
+                .bytes = std::move(bytes),
+                .object_hash = std::move(object_hash)};
+        if (!m_inflight_paths.insert(job.path).second) {
+            m_parked[job.path].push_back(std::move(job));
+            return;
+        }
+        m_queue.push_back(std::move(job));
+        lock.unlock();
+        m_work_cv.notify_one();
+    }
+
+    /// Block until no write for @p path is pending.
+    void wait_for(const std::string& path)
+    {
+        std::unique_lock lock(m_mutex);
+        m_done_cv.wait(lock, [&] { return !m_inflight_paths.contains(path); });
+    }
+
+    [[nodiscard]] sappp::VoidResult flush()
+    {
+        std::unique_lock lock(m_mutex);
+        m_done_cv.wait(lock, [&] { return m_inflight_paths.empty(); });
+        if (m_errors.empty()) {
+            return {};
+        }
+        auto errors = std::exchange(m_errors, {});
+        lock.unlock();
+
+        std::ranges::sort(errors, {}, &JobError::sequence);
+        std::string message = std::format("{} certificate write(s) failed", errors.size());
+        for (const auto& failure : errors) {
+            message += "; ";
+            message += failure.error.message;
+        }
+        return std::unexpected(Error::make(errors.front().error.code, message));
+    }
+
+private:
+    /// Ring size, and with it the number of files written per io_uring batch.
+    static constexpr unsigned kRingEntries = 64;
+
+    struct Job
+    {
+        std::uint64_t sequence = 0;
+        std::string path = {};
+        std::string bytes = {};
+        std::string object_hash = {};
+    };
+
+    struct JobError
+    {
+        std::uint64_t sequence = 0;
+        Error error;
+    };
+
+    void run(const std::stop_token& stop)
+    {
+        const std::size_t batch_size = m_ring ? m_ring->capacity() : 1;
+        std::vector<Job> batch;
+        while (true) {
+            batch.clear();
+            {
+                std::unique_lock lock(m_mutex);
+                if (!m_work_cv.wait(lock, stop, [&] { return !m_queue.empty(); })) {
+                    return;
+                }
+                while (!m_queue.empty() && batch.size() < batch_size) {
+                    batch.push_back(std::move(m_queue.front()));
+                    m_queue.pop_front();
+                }
+            }
+
+            auto results = write(batch);
+
+            bool queued_parked = false;
+            {
+                std::lock_guard lock(m_mutex);
+                for (std::size_t i = 0; i < batch.size(); ++i) {
+                    const Job& job = batch[i];
+                    const auto& result = results[i];
+                    if (!result) {
+                        m_errors.push_back(
+                            JobError{.sequence = job.sequence, .error = result.error()});
+                        // Nothing was stored, so a later put() of this object must write again.
+                        if (!job.object_hash.empty()) {
+                            m_submitted_objects.erase(job.object_hash);
+                        }
+                    } else if (!job.object_hash.empty()) {
+                        sappp::common::stats::add(sappp::common::stats::Counter::kCertsWritten);
+                    }
+                    queued_parked = complete(job.path) || queued_parked;
+                }
+            }
+            if (queued_parked) {
+                m_work_cv.notify_all();
+            }
+            m_done_cv.notify_all();
+        }
+    }
+
+    /// Queue the next parked write for @p path, or retire the path; needs m_mutex.
+    [[nodiscard]] bool complete(const std::string& path)
+    {
+        auto parked = m_parked.find(path);
+        if (parked == m_parked.end()) {
+            m_inflight_paths.erase(path);
+            return false;
+        }
+        m_queue.push_back(std::move(parked->second.front()));
+        parked->second.pop_front();
+        if (parked->second.empty()) {
+            m_parked.erase(parked);
+        }
+        return true;
+    }
+
+    [[nodiscard]] sappp::VoidResult create_dir_once(const fs::path& path)
+    {
+        std::string parent = path.parent_path().string();
+        {
+            std::lock_guard lock(m_mutex);
+            if (m_created_dirs.contains(parent)) {
+                return {};
+            }
+        }
+        if (auto result = create_parent_dir(path); !result) {
+            return result;
+        }
+        std::lock_guard lock(m_mutex);
+        m_created_dirs.insert(std::move(parent));
+        return {};
+    }
+
+    [[nodiscard]] std::vector<sappp::VoidResult> write(const std::vector<Job>& batch)
+    {
+        const sappp::common::trace::Span span("certstore", "write", batch.front().path);
+        std::vector<sappp::VoidResult> results;
+        results.reserve(batch.size());
+        std::vector<FileWrite> ring_files;
+        std::vector<std::size_t> ring_owners;
+        for (const auto& job : batch) {
+            results.push_back(create_dir_once(fs::path(job.path)));
+            if (!results.back()) {
+                continue;
+            }
+            if (m_ring) {
+                ring_files.push_back(FileWrite{.path = &job.path, .bytes = &job.bytes});
+                ring_owners.push_back(results.size() - 1);
+            } else {
+                results.back() = write_file_bytes(fs::path(job.path), job.bytes);
+            }
+        }
+        if (!ring_files.empty()) {
+            auto written = m_ring->write_files(ring_files);
+            for (std::size_t i = 0; i < ring_owners.size(); ++i) {
+                results[ring_owners[i]] = std::move(written[i]);
+            }
+        }
+        return results;
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable_any m_work_cv;
+    std::condition_variable m_done_cv;
+    std::deque<Job> m_queue;
+    std::unordered_set<std::string> m_inflight_paths;
+    /// Writes waiting for an in-flight write to the same path, in submission order.
+    std::unordered_map<std::string, std::deque<Job>> m_parked;
+    std::unordered_set<std::string> m_submitted_objects;
+    std::unordered_set<std::string> m_created_dirs;
+    std::vector<JobError> m_errors;
+    std::uint64_t m_next_sequence = 0;
+    std::unique_ptr<IoUringBatch> m_ring;
+    // Declared last so workers stop before the state they use is destroyed.
+    std::vector<std::jthread> m_threads;
+};
+
 CertStore::CertStore(std::string base_dir, std::string schema_dir)
     : m_base_dir(std::move(base_dir))
     , m_schema_dir(std::move(schema_dir))
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    , m_writer()
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    , m_written_objects()
 {}
 
+CertStore::~CertStore() = default;
+CertStore::CertStore(CertStore&&) noexcept = default;
+CertStore& CertStore::operator=(CertStore&&) noexcept = default;
+
+void CertStore::enable_async_writes(std::size_t workers)
+{
+    if (m_writer) {
+        return;
+    }
+    if (workers == 0) {
+        workers = std::max(1U, std::thread::hardware_concurrency());
+    }
+    m_writer = std::make_unique<AsyncWriter>(workers);
+}
+
+sappp::VoidResult CertStore::flush()
+{
+    if (!m_writer) {
+        return {};
+    }
+    return m_writer->flush();
+}
+
 sappp::Result<std::string> CertStore::put(const nlohmann::json& cert)
 {
+    const sappp::common::trace::Span span("certstore", "put");
     if (auto result = sappp::common::validate_json(cert, cert_schema_path()); !result) {
         return std::unexpected(
             Error::make(result.error().code,
                         "Certificate schema validation failed: " + result.error().message));
     }
 
-    auto hash = canonical_hash(cert);
-    if (!hash) {
-        return std::unexpected(hash.error());
+    auto canonical = sappp::canonical::canonicalize(cert);
+    if (!canonical) {
+        return std::unexpected(canonical.error());
     }
-    auto object_path = object_path_for_hash(*hash);
+    std::string hash = sappp::common::sha256_prefixed(*canonical);
+    auto object_path = object_path_for_hash(hash);
     if (!object_path) {
         return std::unexpected(object_path.error());
     }
-    if (auto result = write_json_file(*object_path, cert); !result) {
+    const bool duplicate = m_writer ? !m_writer->mark_object_submitted(hash)
+                                    : m_written_objects.contains(hash);
+    if (duplicate) {
+        sappp::common::stats::add(sappp::common::stats::Counter::kCertsDeduplicated);
+        return hash;
+    }
+    if (auto result =
+            write_canonical_file(std::move(*object_path), std::move(*canonical), hash);
+        !result) {
         return std::unexpected(result.error());
     }
-    return *hash;
+    // A queued object is counted by the writer once its write has succeeded.
+    if (!m_writer) {
+        m_written_objects.insert(hash);
+        sappp::common::stats::add(sappp::common::stats::Counter::kCertsWritten);
+    }
+    return hash;
 }
 
 sappp::Result<nlohmann::json> CertStore::get(const std::string& hash) const
@@ -65,34 +403,32 @@ sappp::Result<nlohmann::json> CertStore::get(const std::string& hash) const
     if (!object_path) {
         return std::unexpected(object_path.error());
     }
+    if (m_writer) {
+        m_writer->wait_for(*object_path);
+    }
     if (!fs::exists(*object_path)) {
         return std::unexpected(Error::make("NotFound", "Certificate not found: " + hash));
     }
 
-    auto cert_result = read_json_file(*object_path);
-    if (!cert_result) {
-        return std::unexpected(cert_result.error());
+    // Stored objects are canonical bytes, so hashing them avoids re-serializing the document.
+    auto document = read_canonical_file(*object_path);
+    if (!document) {
+        return std::unexpected(document.error());
     }
 
-    const nlohmann::json& cert = *cert_result;
-
-    if (auto result = sappp::common::validate_json(cert, cert_schema_path()); !result) {
+    if (auto result = sappp::common::validate_json(document->value, cert_schema_path()); !result) {
         return std::unexpected(
             Error::make(result.error().code,
                         "Stored certificate schema validation failed: " + result.error().message));
     }
 
-    auto computed_hash = canonical_hash(cert);
-    if (!computed_hash) {
-        return std::unexpected(computed_hash.error());
-    }
-    if (*computed_hash != hash) {
+    if (document->hash != hash) {
         return std::unexpected(
             Error::make("HashMismatch",
-                        "Certificate hash mismatch: expected " + hash + ", got " + *computed_hash));
+                        "Certificate hash mismatch: expected " + hash + ", got " + document->hash));
     }
 
-    return cert;
+    return std::move(document->value);
 }
 
 sappp::VoidResult CertStore::bind_po(const std::string& po_id, const std::string& cert_hash)
@@ -101,7 +437,8 @@ sappp::VoidResult CertStore::bind_po(const std::string& po_id, const std::string
     if (!object_path) {
         return std::unexpected(object_path.error());
     }
-    if (!fs::exists(*object_path)) {
+    const bool queued = m_writer && m_writer->is_object_submitted(cert_hash);
+    if (!queued && !fs::exists(*object_path)) {
         return std::unexpected(Error::make("NotFound", "Certificate hash not found: " + cert_hash));
     }
 
@@ -117,7 +454,11 @@ sappp::VoidResult CertStore::bind_po(const std::string& po_id, const std::string
                         "Certificate index schema validation failed: " + result.error().message));
     }
 
-    return write_json_file(index_path_for_po(po_id), index);
+    auto canonical = sappp::canonical::canonicalize(index);
+    if (!canonical) {
+        return std::unexpected(canonical.error());
+    }
+    return write_canonical_file(index_path_for_po(po_id), std::move(*canonical));
 }
 
 std::string CertStore::cert_schema_path() const
@@ -130,11 +471,6 @@ std::string CertStore::index_schema_path() const
     return (fs::path(m_schema_dir) / "cert_index.v1.schema.json").string();
 }
 
-sappp::Result<std::string> CertStore::canonical_hash(const nlohmann::json& cert)
-{
-    return sappp::canonical::hash_canonical(cert);
-}
-
 sappp::Result<std::string> CertStore::object_path_for_hash(const std::string& hash) const
 {
     // Allow hashes with or without a "sha256:" prefix, but always shard based on
@@ -161,31 +497,23 @@ std::string CertStore::index_path_for_po(const std::string& po_id) const
     return index_path.string();
 }
 
-sappp::VoidResult CertStore::write_json_file(const std::string& path, const nlohmann::json& payload)
+sappp::VoidResult
+CertStore::write_canonical_file(std::string path, std::string bytes, std::string object_hash)
 {
-    fs::path out_path(path);
-    ensure_parent_dir(out_path);
-
-    std::ofstream out(out_path, std::ios::binary | std::ios::trunc);
-    if (!out.is_open()) {
-        return std::unexpected(
-            Error::make("IOError", "Failed to open file for write: " + out_path.string()));
-    }
-
-    auto canonical = sappp::canonical::canonicalize(payload);
-    if (!canonical) {
-        return std::unexpected(canonical.error());
+    if (m_writer) {
+        m_writer->submit(std::move(path), std::move(bytes), std::move(object_hash));
+        return {};
     }
-    out << *canonical;
-    if (!out) {
-        return std::unexpected(
-            Error::make("IOError", "Failed to write file: " + out_path.string()));
+    const sappp::common::trace::Span span("certstore", "write", path);
+    const fs::path out_path(path);
+    if (auto result = create_parent_dir(out_path); !result) {
+        return result;
     }
-
-    return {};
+    return write_file_bytes(out_path, bytes);
 }
 
-sappp::Result<nlohmann::json> CertStore::read_json_file(const std::string& path)
+sappp::Result<sappp::canonical::CanonicalDocument>
+CertStore::read_canonical_file(const std::string& path)
 {
     std::ifstream in(path, std::ios::binary);
     if (!in.is_open()) {
@@ -194,12 +522,13 @@ sappp::Result<nlohmann::json> CertStore::read_json_file(const std::string& path)
 
     std::string content{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
 
-    try {
-        return nlohmann::json::parse(content);
-    } catch (const std::exception& ex) {
-        return std::unexpected(
-            Error::make("ParseError", "Failed to parse JSON from " + path + ": " + ex.what()));
+    auto document = sappp::canonical::parse_canonical(content);
+    if (!document) {
+        return std::unexpected(Error::make(document.error().code,
+                                           "Failed to read canonical JSON from " + path + ": "
+                                               + document.error().message));
     }
+    return document;
 }
 
 }  // namespace sappp::certstore
@@ -0,0 +1,485 @@
+/**
+ * @file io_uring_batch.cpp
+ * @brief Batched file writes through a Linux io_uring
+ */
+
+#include "io_uring_batch.hpp"
+
+#include "sappp/run_stats.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#if defined(SAPPP_HAS_IO_URING)
+    #include <atomic>
+
+    #include <fcntl.h>
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace sappp::certstore {
+
+#if defined(SAPPP_HAS_IO_URING)
+
+namespace {
+
+/// Largest single write request; longer files are written in several rounds.
+constexpr std::size_t kMaxWriteChunk = std::size_t{1} << 30U;
+
+/// Result slot of an operation that never ran (not submitted or not reaped).
+constexpr int kNotCompleted = std::numeric_limits<int>::min();
+
+[[nodiscard]] std::string errno_message(int error)
+{
+    return std::generic_category().message(error);
+}
+
+struct Operation
+{
+    std::uint8_t opcode = IORING_OP_NOP;
+    int fd = -1;
+    const void* addr = nullptr;
+    std::uint32_t len = 0;
+    std::uint64_t offset = 0;
+    std::uint32_t open_flags = 0;
+};
+
+struct FreeDeleter
+{
+    // NOLINTNEXTLINE(cppcoreguidelines-no-malloc) - pairs with the calloc below.
+    void operator()(void* ptr) const noexcept { std::free(ptr); }
+};
+
+[[nodiscard]] bool supports_required_ops(int ring_fd)
+{
+    constexpr unsigned kProbeOps = 256;
+    const std::size_t size = sizeof(io_uring_probe) + (kProbeOps * sizeof(io_uring_probe_op));
+    std::unique_ptr<io_uring_probe, FreeDeleter> probe(
+        // NOLINTNEXTLINE(cppcoreguidelines-no-malloc) - the probe ends in a flexible array.
+        static_cast<io_uring_probe*>(std::calloc(1, size)));
+    if (!probe) {
+        return false;
+    }
+    if (syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_PROBE, probe.get(), kProbeOps)
+        < 0) {
+        return false;
+    }
+    constexpr std::array<std::uint8_t, 3> kRequiredOps{
+        {IORING_OP_OPENAT, IORING_OP_WRITE, IORING_OP_CLOSE}
+    };
+    return std::ranges::all_of(kRequiredOps, [&probe](std::uint8_t op) noexcept {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index) - kernel array.
+        return op < probe->ops_len && (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+    });
+}
+
+}  // namespace
+
+struct IoUringBatch::Ring
+{
+    int fd = -1;
+    void* sq_map = MAP_FAILED;
+    std::size_t sq_map_size = 0;
+    void* cq_map = MAP_FAILED;
+    std::size_t cq_map_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    std::size_t sqes_size = 0;
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned entries = 0;
+    /// Set when in-flight operations could not be drained; the ring is not reused.
+    bool broken = false;
+
+    Ring() = default;
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+    Ring(Ring&&) = delete;
+    Ring& operator=(Ring&&) = delete;
+
+    ~Ring()
+    {
+        if (sqes != nullptr) {
+            munmap(sqes, sqes_size);
+        }
+        if (cq_map != MAP_FAILED && cq_map != sq_map) {
+            munmap(cq_map, cq_map_size);
+        }
+        if (sq_map != MAP_FAILED) {
+            munmap(sq_map, sq_map_size);
+        }
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+
+    template <typename T>
+    [[nodiscard]] static T* at(void* base, std::uint32_t offset)
+    {
+        return static_cast<T*>(static_cast<void*>(static_cast<char*>(base) + offset));
+    }
+
+    [[nodiscard]] sappp::VoidResult map(const io_uring_params& params)
+    {
+        sq_map_size = params.sq_off.array + (params.sq_entries * sizeof(unsigned));
+        cq_map_size = params.cq_off.cqes + (params.cq_entries * sizeof(io_uring_cqe));
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+        }
+        sq_map = mmap(nullptr,
+                      sq_map_size,
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE,
+                      fd,
+                      IORING_OFF_SQ_RING);
+        if (sq_map == MAP_FAILED) {
+            return std::unexpected(Error::make("Unsupported", "io_uring SQ ring mmap failed"));
+        }
+        cq_map = single_mmap ? sq_map
+                             : mmap(nullptr,
+                                    cq_map_size,
+                                    PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE,
+                                    fd,
+                                    IORING_OFF_CQ_RING);
+        if (cq_map == MAP_FAILED) {
+            return std::unexpected(Error::make("Unsupported", "io_uring CQ ring mmap failed"));
+        }
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes_map = mmap(nullptr,
+                              sqes_size,
+                              PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE,
+                              fd,
+                              IORING_OFF_SQES);
+        if (sqes_map == MAP_FAILED) {
+            return std::unexpected(Error::make("Unsupported", "io_uring SQE array mmap failed"));
+        }
+        sqes = static_cast<io_uring_sqe*>(sqes_map);
+        sq_head = at<unsigned>(sq_map, params.sq_off.head);
+        sq_tail = at<unsigned>(sq_map, params.sq_off.tail);
+        sq_mask = at<unsigned>(sq_map, params.sq_off.ring_mask);
+        sq_array = at<unsigned>(sq_map, params.sq_off.array);
+        cq_head = at<unsigned>(cq_map, params.cq_off.head);
+        cq_tail = at<unsigned>(cq_map, params.cq_off.tail);
+        cq_mask = at<unsigned>(cq_map, params.cq_off.ring_mask);
+        cqes = at<io_uring_cqe>(cq_map, params.cq_off.cqes);
+        entries = params.sq_entries;
+        return {};
+    }
+
+    /// @return The number of SQEs the kernel consumed.
+    [[nodiscard]] sappp::Result<unsigned> enter(unsigned to_submit, unsigned min_complete) const
+    {
+        while (true) {
+            const long rc = syscall(__NR_io_uring_enter,
+                                    fd,
+                                    to_submit,
+                                    min_complete,
+                                    IORING_ENTER_GETEVENTS,
+                                    nullptr,
+                                    0);
+            if (rc >= 0) {
+                return static_cast<unsigned>(rc);
+            }
+            if (errno != EINTR) {
+                return std::unexpected(
+                    Error::make("IOError", "io_uring_enter failed: " + errno_message(errno)));
+            }
+        }
+    }
+
+    /// Store every available completion in @p results and return how many there were.
+    unsigned reap(std::vector<int>& results) const
+    {
+        unsigned head = *cq_head;
+        const unsigned ready = std::atomic_ref<unsigned>(*cq_tail).load(std::memory_order_acquire);
+        unsigned reaped = 0;
+        for (; head != ready; ++head, ++reaped) {
+            const io_uring_cqe& cqe = cqes[head & *cq_mask];
+            results[cqe.user_data] = cqe.res;
+        }
+        std::atomic_ref<unsigned>(*cq_head).store(head, std::memory_order_release);
+        return reaped;
+    }
+
+    /// Withdraw the SQEs the kernel has not consumed and wait for the @p in_flight
+    /// ones it has, so that the next batch starts from an empty ring.
+    void abandon(std::vector<int>& results, unsigned in_flight)
+    {
+        std::atomic_ref<unsigned>(*sq_tail).store(
+            std::atomic_ref<unsigned>(*sq_head).load(std::memory_order_acquire),
+            std::memory_order_release);
+        while (in_flight > 0) {
+            auto entered = enter(0, in_flight);
+            if (!entered) {
+                broken = true;
+                return;
+            }
+            in_flight -= reap(results);
+        }
+    }
+
+    /**
+     * @brief Submit @p ops (at most @c entries) and store each result in @p results
+     *
+     * On failure @p results still holds the result of every operation that ran;
+     * the others are kNotCompleted.
+     */
+    [[nodiscard]] sappp::VoidResult run(std::span<const Operation> ops, std::vector<int>& results)
+    {
+        results.assign(ops.size(), kNotCompleted);
+        if (broken) {
+            return std::unexpected(
+                Error::make("IOError", "io_uring is unusable after a failed batch"));
+        }
+        const unsigned tail = *sq_tail;
+        for (std::size_t i = 0; i < ops.size(); ++i) {
+            const Operation& op = ops[i];
+            io_uring_sqe& sqe = sqes[i];
+            sqe = io_uring_sqe{};
+            sqe.opcode = op.opcode;
+            sqe.fd = op.fd;
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast) - kernel ABI.
+            sqe.addr = reinterpret_cast<std::uintptr_t>(op.addr);
+            sqe.len = op.len;
+            sqe.off = op.offset;
+            sqe.open_flags = op.open_flags;
+            sqe.user_data = i;
+            sq_array[(tail + i) & *sq_mask] = static_cast<unsigned>(i);
+        }
+        const auto count = static_cast<unsigned>(ops.size());
+        std::atomic_ref<unsigned>(*sq_tail).store(tail + count, std::memory_order_release);
+
+        unsigned submitted = 0;
+        unsigned reaped = 0;
+        bool stalled = false;
+        while (reaped < count) {
+            const unsigned pending = count - submitted;
+            const unsigned in_flight = submitted - reaped;
+            // Wait only for operations the kernel accepted; while some are still
+            // queued, block for one completion after a submission made no progress.
+            const unsigned wait = pending == 0 ? in_flight : (stalled ? 1U : 0U);
+            auto entered = enter(pending, wait);
+            if (entered && pending != 0 && *entered == 0 && in_flight == 0) {
+                entered = std::unexpected(
+                    Error::make("IOError", "io_uring_enter accepted no submissions"));
+            }
+            if (!entered) {
+                abandon(results, in_flight - reap(results));
+                return std::unexpected(entered.error());
+            }
+            stalled = pending != 0 && *entered == 0;
+            submitted += *entered;
+            reaped += reap(results);
+        }
+        return {};
+    }
+};
+
+IoUringBatch::IoUringBatch(std::unique_ptr<Ring> ring)
+    : m_ring(std::move(ring))
+{}
+
+IoUringBatch::~IoUringBatch() = default;
+
+sappp::Result<std::unique_ptr<IoUringBatch>> IoUringBatch::create(unsigned entries)
+{
+    auto ring = std::make_unique<Ring>();
+    io_uring_params params{};
+    const long fd = syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) {
+        return std::unexpected(
+            Error::make("Unsupported", "io_uring_setup failed: " + errno_message(errno)));
+    }
+    ring->fd = static_cast<int>(fd);
+    if (!supports_required_ops(ring->fd)) {
+        return std::unexpected(
+            Error::make("Unsupported", "io_uring lacks openat/write/close support"));
+    }
+    if (auto mapped = ring->map(params); !mapped) {
+        return std::unexpected(mapped.error());
+    }
+    return std::unique_ptr<IoUringBatch>(new IoUringBatch(std::move(ring)));
+}
+
+std::size_t IoUringBatch::capacity() const noexcept
+{
+    return m_ring->entries;
+}
+
+// NOLINTNEXTLINE(readability-function-size) - Three phases of one batch.
+std::vector<sappp::VoidResult> IoUringBatch::write_files(std::span<const FileWrite> files)
+{
+    std::vector<sappp::VoidResult> results(files.size());
+    for (std::size_t start = 0; start < files.size(); start += capacity()) {
+        const auto chunk = files.subspan(start, std::min(capacity(), files.size() - start));
+        const auto fail = [&](std::size_t i, std::string_view what, int error) {
+            if (results[start + i]) {
+                results[start + i] = std::unexpected(Error::make(
+                    "IOError", std::string(what) + *chunk[i].path + ": " + errno_message(error)));
+            }
+        };
+        const auto fail_chunk = [&](const Error& error) {
+            for (std::size_t i = 0; i < chunk.size(); ++i) {
+                if (results[start + i]) {
+                    results[start + i] = std::unexpected(error);
+                }
+            }
+        };
+
+        std::vector<Operation> ops;
+        ops.reserve(chunk.size());
+        std::vector<std::size_t> owners;
+        owners.reserve(chunk.size());
+        std::vector<int> fds(chunk.size(), -1);
+
+        // Phase 1: open (create or truncate) every file of the chunk.
+        for (const auto& file : chunk) {
+            ops.push_back(Operation{.opcode = IORING_OP_OPENAT,
+                                    .fd = AT_FDCWD,
+                                    .addr = file.path->c_str(),
+                                    .len = 0644,
+                                    .open_flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC});
+        }
+        std::vector<int> done;
+        if (auto opened = m_ring->run(ops, done); !opened) {
+            // Close and remove the files this chunk already created or truncated.
+            for (std::size_t i = 0; i < chunk.size(); ++i) {
+                if (done[i] >= 0) {
+                    close(done[i]);
+                    unlink(chunk[i].path->c_str());
+                }
+            }
+            fail_chunk(opened.error());
+            continue;
+        }
+        for (std::size_t i = 0; i < chunk.size(); ++i) {
+            if (done[i] < 0) {
+                fail(i, "Failed to open file for write: ", -done[i]);
+            } else {
+                fds[i] = done[i];
+            }
+        }
+
+        // Phase 2: write; short writes are resubmitted until every file is complete.
+        std::vector<std::size_t> written(chunk.size(), 0);
+        while (true) {
+            ops.clear();
+            owners.clear();
+            for (std::size_t i = 0; i < chunk.size(); ++i) {
+                const std::string& bytes = *chunk[i].bytes;
+                if (fds[i] < 0 || !results[start + i] || written[i] == bytes.size()) {
+                    continue;
+                }
+                ops.push_back(Operation{
+                    .opcode = IORING_OP_WRITE,
+                    .fd = fds[i],
+                    .addr = bytes.data() + written[i],
+                    .len = static_cast<std::uint32_t>(
+                        std::min(bytes.size() - written[i], kMaxWriteChunk)),
+                    .offset = written[i]});
+                owners.push_back(i);
+            }
+            if (ops.empty()) {
+                break;
+            }
+            if (auto wrote = m_ring->run(ops, done); !wrote) {
+                fail_chunk(wrote.error());
+                break;
+            }
+            for (std::size_t k = 0; k < owners.size(); ++k) {
+                const int res = done[k];
+                if (res <= 0) {
+                    fail(owners[k], "Failed to write file: ", res < 0 ? -res : EIO);
+                } else {
+                    written[owners[k]] += static_cast<std::size_t>(res);
+                }
+            }
+        }
+
+        // Phase 3: close; a failed close can lose data, so it fails the write.
+        ops.clear();
+        owners.clear();
+        for (std::size_t i = 0; i < chunk.size(); ++i) {
+            if (fds[i] >= 0) {
+                ops.push_back(Operation{.opcode = IORING_OP_CLOSE, .fd = fds[i]});
+                owners.push_back(i);
+            }
+        }
+        if (!ops.empty()) {
+            if (auto closed = m_ring->run(ops, done); !closed) {
+                // Close what the ring did not; its fd numbers may already be reused.
+                for (std::size_t k = 0; k < owners.size(); ++k) {
+                    if (done[k] == kNotCompleted) {
+                        close(fds[owners[k]]);
+                    }
+                }
+                fail_chunk(closed.error());
+            } else {
+                for (std::size_t k = 0; k < owners.size(); ++k) {
+                    if (done[k] < 0) {
+                        fail(owners[k], "Failed to close file: ", -done[k]);
+                    }
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < chunk.size(); ++i) {
+            if (results[start + i]) {
+                sappp::common::stats::add(sappp::common::stats::Counter::kBytesWritten,
+                                          chunk[i].bytes->size());
+            }
+        }
+    }
+    return results;
+}
+
+#else  // !SAPPP_HAS_IO_URING
+
+struct IoUringBatch::Ring
+{};
+
+IoUringBatch::IoUringBatch(std::unique_ptr<Ring> ring)
+    : m_ring(std::move(ring))
+{}
+
+IoUringBatch::~IoUringBatch() = default;
+
+sappp::Result<std::unique_ptr<IoUringBatch>> IoUringBatch::create(unsigned /*entries*/)
+{
+    return std::unexpected(Error::make("Unsupported", "Built without io_uring support"));
+}
+
+std::size_t IoUringBatch::capacity() const noexcept
+{
+    return 0;
+}
+
+std::vector<sappp::VoidResult> IoUringBatch::write_files(std::span<const FileWrite> files)
+{
+    return std::vector<sappp::VoidResult>(
+        files.size(),
+        std::unexpected(Error::make("Unsupported", "Built without io_uring support")));
+}
+
+#endif  // SAPPP_HAS_IO_URING
+
+}  // namespace sappp::certstore
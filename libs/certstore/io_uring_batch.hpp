@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+ * @file io_uring_batch.hpp
+ * @brief Batched file writes through a Linux io_uring (certstore internal)
+ */
+
+#include "sappp/common.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace sappp::certstore {
+
+/// One whole-file write: create or truncate @p path and store @p bytes.
+struct FileWrite
+{
+    const std::string* path = nullptr;
+    const std::string* bytes = nullptr;
+};
+
+/**
+ * @brief Submits the open/write/close calls of many files in a few syscalls
+ *
+ * Each phase (openat, write, close) of a batch is queued on the ring and
+ * submitted with a single io_uring_enter, so a batch of N small certificates
+ * costs a handful of syscalls instead of 3N. The ring is driven through the
+ * raw kernel interface; no liburing dependency is needed.
+ */
+class IoUringBatch
+{
+public:
+    /**
+     * @brief Set up a ring with room for @p entries writes per phase
+     * @return The ring, or "Unsupported" when io_uring or one of the required
+     *         opcodes is unavailable (not built in, kernel too old, or blocked)
+     */
+    [[nodiscard]] static sappp::Result<std::unique_ptr<IoUringBatch>> create(unsigned entries);
+
+    ~IoUringBatch();
+
+    IoUringBatch(const IoUringBatch&) = delete;
+    IoUringBatch& operator=(const IoUringBatch&) = delete;
+    IoUringBatch(IoUringBatch&&) = delete;
+    IoUringBatch& operator=(IoUringBatch&&) = delete;
+
+    /// Maximum number of files handed to one write_files() call.
+    [[nodiscard]] std::size_t capacity() const noexcept;
+
+    /// Write every file in @p files; the result at index i belongs to files[i].
+    [[nodiscard]] std::vector<sappp::VoidResult> write_files(std::span<const FileWrite> files);
+
+private:
+    struct Ring;
+
+    explicit IoUringBatch(std::unique_ptr<Ring> ring);
+
+    std::unique_ptr<Ring> m_ring;
+};
+
+}  // namespace sappp::certstore
@@ -0,0 +1,368 @@
+/**
+ * @file file_hash_cache.cpp
+ * @brief Persistent file content-hash cache keyed by (path, inode, size, mtime_ns)
+ */
+
+#include "sappp/file_hash_cache.hpp"
+
+#include "sappp/mapped_file.hpp"
+#include "sappp/parallel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#if !defined(_WIN32)
+    #include <sys/stat.h>
+#endif
+
+namespace sappp::common {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::string_view kFormat = "file_hash_cache.v2";
+
+// Files modified this recently may be rewritten within the same mtime tick without
+// changing their stamp, so their digests are not persisted.
+constexpr std::int64_t kRacyWindowNs = 2'000'000'000;
+
+// Hits refresh an entry's last-use time at this granularity, so a warm rerun does not
+// rewrite the cache file just to record that it ran.
+constexpr std::int64_t kUseRefreshNs = std::chrono::nanoseconds(std::chrono::hours{24}).count();
+
+struct HashedFile
+{
+    FileStamp stamp = {};
+    std::string digest = {};
+};
+
+[[nodiscard]] Error io_error(const fs::path& path, std::string_view what)
+{
+    return Error::make("IOError", std::string(what) + ": " + path.string());
+}
+
+[[nodiscard]] std::int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+[[nodiscard]] std::string cache_key(const fs::path& path)
+{
+    std::error_code ec;
+    fs::path absolute = fs::absolute(path, ec);
+    if (ec) {
+        absolute = path;
+    }
+    return absolute.lexically_normal().generic_string();
+}
+
+#if !defined(_WIN32)
+
+[[nodiscard]] FileStamp stamp_from_stat(const struct stat& st)
+{
+    #if defined(__APPLE__)
+    const auto& mtime = st.st_mtimespec;
+    #else
+    const auto& mtime = st.st_mtim;
+    #endif
+    return FileStamp{.inode = static_cast<std::uint64_t>(st.st_ino),
+                     .size = static_cast<std::uint64_t>(st.st_size),
+                     .mtime_ns = (static_cast<std::int64_t>(mtime.tv_sec) * 1'000'000'000)
+                                 + static_cast<std::int64_t>(mtime.tv_nsec)};
+}
+
+[[nodiscard]] Result<FileStamp> stat_file(const fs::path& path)
+{
+    struct stat st = {};
+    if (::stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+        return std::unexpected(io_error(path, "Failed to stat file"));
+    }
+    return stamp_from_stat(st);
+}
+
+/// Hash through a read-only mapping; the stamp comes from the same descriptor.
+[[nodiscard]] Result<HashedFile> hash_file(const fs::path& path)
+{
+    auto file = MappedFile::open(path);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+    const std::string_view bytes = file->view();
+    return HashedFile{.stamp = FileStamp{.inode = file->inode(),
+                                         .size = bytes.size(),
+                                         .mtime_ns = file->mtime_ns()},
+                      .digest = sha256_prefixed(bytes)};
+}
+
+#else
+
+[[nodiscard]] Result<FileStamp> stat_file(const fs::path& path)
+{
+    std::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    if (ec) {
+        return std::unexpected(io_error(path, "Failed to stat file"));
+    }
+    const auto mtime = fs::last_write_time(path, ec);
+    if (ec) {
+        return std::unexpected(io_error(path, "Failed to stat file"));
+    }
+    return FileStamp{
+        .inode = 0,
+        .size = static_cast<std::uint64_t>(size),
+        .mtime_ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count()};
+}
+
+[[nodiscard]] Result<HashedFile> hash_file(const fs::path& path)
+{
+    auto stamp = stat_file(path);
+    if (!stamp) {
+        return std::unexpected(stamp.error());
+    }
+    auto file = MappedFile::open(path);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+    return HashedFile{.stamp = *stamp, .digest = sha256_prefixed(file->view())};
+}
+
+#endif
+
+}  // namespace
+
+struct FileHashCache::Slot
+{
+    std::mutex mutex;
+    std::optional<FileStamp> stamp;
+    std::string digest;
+    bool persist = false;
+    std::int64_t used_ns = 0;
+
+    Slot()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        : mutex()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , stamp()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , digest()
+    {}
+};
+
+FileHashCache::FileHashCache()
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    : m_cache_file()
+    , m_max_entries(kDefaultMaxEntries)
+    , m_opened_ns(now_ns())
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    , m_mutex()
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    , m_slots()
+    , m_hits(0)
+    , m_misses(0)
+    , m_dirty(false)
+{}
+
+FileHashCache::FileHashCache(fs::path cache_file, std::size_t max_entries)
+    : m_cache_file(std::move(cache_file))
+    , m_max_entries(max_entries)
+    , m_opened_ns(now_ns())
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    , m_mutex()
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    , m_slots()
+    , m_hits(0)
+    , m_misses(0)
+    , m_dirty(false)
+{
+    load();
+}
+
+FileHashCache::~FileHashCache() = default;
+
+std::optional<fs::path> FileHashCache::default_path()
+{
+    // NOLINTNEXTLINE(concurrency-mt-unsafe) - read once before any worker starts.
+    const char* dir = std::getenv("SAPPP_CACHE_DIR");
+    if (dir == nullptr || *dir == '\0') {
+        return std::nullopt;
+    }
+    return fs::path(dir) / "file_hashes.json";
+}
+
+Result<std::string> FileHashCache::digest(const fs::path& path)
+{
+    auto stamp = stat_file(path);
+    if (!stamp) {
+        return std::unexpected(stamp.error());
+    }
+
+    Slot& slot = find_or_create(cache_key(path));
+    std::lock_guard lock(slot.mutex);
+    if (slot.stamp && *slot.stamp == *stamp) {
+        ++m_hits;
+        if (slot.persist && m_opened_ns - slot.used_ns > kUseRefreshNs) {
+            slot.used_ns = m_opened_ns;
+            m_dirty = true;
+        }
+        return slot.digest;
+    }
+
+    auto hashed = hash_file(path);
+    if (!hashed) {
+        return std::unexpected(hashed.error());
+    }
+    ++m_misses;
+    slot.stamp = hashed->stamp;
+    slot.digest = std::move(hashed->digest);
+    slot.persist = now_ns() - slot.stamp->mtime_ns > kRacyWindowNs;
+    slot.used_ns = m_opened_ns;
+    m_dirty = true;
+    return slot.digest;
+}
+
+std::vector<Result<std::string>> FileHashCache::digest_all(std::span<const fs::path> paths,
+                                                           std::size_t jobs)
+{
+    std::vector<Result<std::string>> results(paths.size());
+    // Per-path failures are reported through results; the loop itself never fails.
+    (void)parallel_for_each_index(paths.size(), jobs, [&](std::size_t i) -> VoidResult {
+        results[i] = digest(paths[i]);
+        return {};
+    });
+    return results;
+}
+
+VoidResult FileHashCache::save() const
+{
+    if (!m_cache_file || !m_dirty.load()) {
+        return {};
+    }
+
+    struct Kept
+    {
+        std::string key = {};
+        FileStamp stamp = {};
+        std::string digest = {};
+        std::int64_t used_ns = 0;
+    };
+    const std::int64_t oldest_ns = m_opened_ns - std::chrono::nanoseconds(kMaxEntryAge).count();
+    std::vector<Kept> kept;
+    {
+        std::lock_guard lock(m_mutex);
+        kept.reserve(m_slots.size());
+        for (const auto& [key, slot] : m_slots) {
+            std::lock_guard slot_lock(slot->mutex);
+            if (slot->stamp && slot->persist && slot->used_ns >= oldest_ns) {
+                kept.push_back({.key = key,
+                                .stamp = *slot->stamp,
+                                .digest = slot->digest,
+                                .used_ns = slot->used_ns});
+            }
+        }
+    }
+    if (kept.size() > m_max_entries) {
+        // Most recently used first; the key breaks ties so pruning is deterministic.
+        std::ranges::nth_element(kept,
+                                 kept.begin() + static_cast<std::ptrdiff_t>(m_max_entries),
+                                 [](const Kept& a, const Kept& b) noexcept {
+                                     return a.used_ns != b.used_ns ? a.used_ns > b.used_ns
+                                                                   : a.key < b.key;
+                                 });
+        kept.resize(m_max_entries);
+    }
+    nlohmann::json entries = nlohmann::json::object();
+    for (auto& entry : kept) {
+        entries[entry.key] = nlohmann::json{
+            {   "inode",    entry.stamp.inode},
+            {    "size",     entry.stamp.size},
+            {"mtime_ns", entry.stamp.mtime_ns},
+            { "used_ns",        entry.used_ns},
+            {  "sha256", std::move(entry.digest)}
+        };
+    }
+    const nlohmann::json document = {
+        { "format", kFormat},
+        {"entries", entries}
+    };
+
+    std::error_code ec;
+    fs::create_directories(m_cache_file->parent_path(), ec);
+    if (ec) {
+        return std::unexpected(io_error(m_cache_file->parent_path(), "Failed to create directory"));
+    }
+    fs::path temp_path = *m_cache_file;
+    temp_path += ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return std::unexpected(io_error(temp_path, "Failed to write file"));
+        }
+        out << document.dump();
+        if (!out) {
+            return std::unexpected(io_error(temp_path, "Failed to write file"));
+        }
+    }
+    fs::rename(temp_path, *m_cache_file, ec);
+    if (ec) {
+        fs::remove(temp_path, ec);
+        return std::unexpected(io_error(*m_cache_file, "Failed to replace file"));
+    }
+    return {};
+}
+
+FileHashCache::Slot& FileHashCache::find_or_create(const std::string& key)
+{
+    std::lock_guard lock(m_mutex);
+    auto& slot = m_slots[key];
+    if (!slot) {
+        slot = std::make_unique<Slot>();
+    }
+    return *slot;
+}
+
+void FileHashCache::load()
+{
+    std::ifstream in(*m_cache_file, std::ios::binary);
+    if (!in) {
+        return;
+    }
+    // A stale or corrupt cache is simply rebuilt.
+    nlohmann::json document = nlohmann::json::parse(in, nullptr, false);
+    if (document.is_discarded() || !document.is_object() || !document.contains("format")
+        || document.at("format") != kFormat || !document.contains("entries")
+        || !document.at("entries").is_object()) {
+        return;
+    }
+    for (const auto& [key, entry] : document.at("entries").items()) {
+        if (!entry.is_object() || !entry.contains("inode") || !entry.contains("size")
+            || !entry.contains("mtime_ns") || !entry.contains("sha256")
+            || !entry.at("inode").is_number_unsigned() || !entry.at("size").is_number_unsigned()
+            || !entry.at("mtime_ns").is_number_integer() || !entry.at("sha256").is_string()
+            || !entry.contains("used_ns") || !entry.at("used_ns").is_number_integer()) {
+            continue;
+        }
+        auto slot = std::make_unique<Slot>();
+        slot->stamp = FileStamp{.inode = entry.at("inode").get<std::uint64_t>(),
+                                .size = entry.at("size").get<std::uint64_t>(),
+                                .mtime_ns = entry.at("mtime_ns").get<std::int64_t>()};
+        slot->digest = entry.at("sha256").get<std::string>();
+        slot->persist = true;
+        slot->used_ns = entry.at("used_ns").get<std::int64_t>();
+        m_slots.emplace(key, std::move(slot));
+    }
+}
+
+}  // namespace sappp::common
@@ -0,0 +1,120 @@
+/**
+ * @file mapped_file.cpp
+ * @brief Read-only whole-file view backed by a memory mapping
+ */
+
+#include "sappp/mapped_file.hpp"
+
+#include <utility>
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#else
+    #include <chrono>
+    #include <fstream>
+    #include <iterator>
+    #include <system_error>
+#endif
+
+namespace sappp::common {
+
+namespace {
+
+[[nodiscard]] Error io_error(const std::filesystem::path& path, std::string_view what)
+{
+    return Error::make("IOError", std::string(what) + ": " + path.string());
+}
+
+}  // namespace
+
+Result<MappedFile> MappedFile::open(const std::filesystem::path& path)
+{
+    MappedFile file;
+#if !defined(_WIN32)
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg) - POSIX open(2).
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::unexpected(io_error(path, "Failed to open file"));
+    }
+    struct stat st = {};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return std::unexpected(io_error(path, "Failed to stat file"));
+    }
+    #if defined(__APPLE__)
+    const auto& mtime = st.st_mtimespec;
+    #else
+    const auto& mtime = st.st_mtim;
+    #endif
+    file.m_inode = st.st_ino;
+    file.m_mtime_ns = (static_cast<std::int64_t>(mtime.tv_sec) * 1'000'000'000)
+                      + static_cast<std::int64_t>(mtime.tv_nsec);
+    const auto size = static_cast<std::size_t>(st.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return file;
+    }
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return std::unexpected(io_error(path, "Failed to map file"));
+    }
+    file.m_mapping = mapping;
+    file.m_size = size;
+#else
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return std::unexpected(io_error(path, "Failed to open file"));
+    }
+    file.m_buffer.assign(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+    std::error_code ec;
+    const auto mtime = std::filesystem::last_write_time(path, ec);
+    if (!ec) {
+        file.m_mtime_ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count();
+    }
+#endif
+    return file;
+}
+
+MappedFile::~MappedFile()
+{
+    reset();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_mapping(std::exchange(other.m_mapping, nullptr))
+    , m_size(std::exchange(other.m_size, 0))
+    , m_buffer(std::move(other.m_buffer))
+    , m_inode(other.m_inode)
+    , m_mtime_ns(other.m_mtime_ns)
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        reset();
+        m_mapping = std::exchange(other.m_mapping, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_buffer = std::move(other.m_buffer);
+        m_inode = other.m_inode;
+        m_mtime_ns = other.m_mtime_ns;
+    }
+    return *this;
+}
+
+void MappedFile::reset() noexcept
+{
+#if !defined(_WIN32)
+    if (m_mapping != nullptr) {
+        ::munmap(m_mapping, m_size);
+    }
+#endif
+    m_mapping = nullptr;
+    m_size = 0;
+}
+
+}  // namespace sappp::common
@@ -0,0 +1,21 @@
+/**
+ * @file parallel.cpp
+ * @brief Index-parallel loops with deterministic error reporting
+ */
+
+#include "sappp/parallel.hpp"
+
+#include <algorithm>
+
+namespace sappp::common {
+
+std::size_t resolve_worker_count(std::size_t jobs, std::size_t count) noexcept
+{
+    std::size_t workers = jobs;
+    if (workers == 0) {
+        workers = std::max(1U, std::thread::hardware_concurrency());
+    }
+    return std::max<std::size_t>(1, std::min(workers, count));
+}
+
+}  // namespace sappp::common
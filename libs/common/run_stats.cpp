@@ -0,0 +1,138 @@
+/**
+ * @file run_stats.cpp
+ * @brief Per-run counters, phase timings and resource usage for stats.json
+ */
+
+#include "sappp/run_stats.hpp"
+
+#include <atomic>
+#include <utility>
+
+#if !defined(_WIN32)
+    #include <sys/resource.h>
+#endif
+
+namespace sappp::common::stats {
+
+namespace {
+
+[[nodiscard]] std::array<std::atomic<std::uint64_t>, kCounterCount>& counters()
+{
+    static std::array<std::atomic<std::uint64_t>, kCounterCount> instance{};
+    return instance;
+}
+
+[[nodiscard]] std::array<std::uint64_t, kCounterCount> counter_values()
+{
+    std::array<std::uint64_t, kCounterCount> values{};
+    for (std::size_t i = 0; i < kCounterCount; ++i) {
+        values[i] = counters()[i].load(std::memory_order_relaxed);
+    }
+    return values;
+}
+
+[[nodiscard]] std::chrono::microseconds elapsed_us(std::chrono::steady_clock::time_point from)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now()
+                                                                 - from);
+}
+
+}  // namespace
+
+void add(Counter counter, std::uint64_t amount) noexcept
+{
+    counters()[static_cast<std::size_t>(counter)].fetch_add(amount, std::memory_order_relaxed);
+}
+
+std::uint64_t value(Counter counter) noexcept
+{
+    return counters()[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+}
+
+ResourceUsage resource_usage() noexcept
+{
+    ResourceUsage usage;
+#if !defined(_WIN32)
+    rusage self = {};
+    if (::getrusage(RUSAGE_SELF, &self) == 0) {
+        const auto to_us = [](const timeval& tv) {
+            return std::chrono::seconds(tv.tv_sec) + std::chrono::microseconds(tv.tv_usec);
+        };
+        usage.cpu_time = to_us(self.ru_utime) + to_us(self.ru_stime);
+    #if defined(__APPLE__)
+        usage.peak_rss_bytes = static_cast<std::uint64_t>(self.ru_maxrss);
+    #else
+        // Linux reports ru_maxrss in kilobytes.
+        usage.peak_rss_bytes = static_cast<std::uint64_t>(self.ru_maxrss) * 1024U;
+    #endif
+    }
+#endif
+    return usage;
+}
+
+RunStats::RunStats(std::string command)
+    : m_command(std::move(command))
+    , m_start(std::chrono::steady_clock::now())
+    , m_start_cpu(resource_usage().cpu_time)
+    , m_start_counters(counter_values())
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    , m_phases()
+    , m_phase_start(m_start)
+    , m_phase_start_cpu(m_start_cpu)
+{}
+
+void RunStats::begin_phase(std::string_view name)
+{
+    end_phase();
+    m_phases.push_back(Phase{.name = std::string(name)});
+    m_in_phase = true;
+    m_phase_start = std::chrono::steady_clock::now();
+    m_phase_start_cpu = resource_usage().cpu_time;
+}
+
+void RunStats::end_phase()
+{
+    if (!m_in_phase) {
+        return;
+    }
+    m_in_phase = false;
+    m_phases.back().wall_time = elapsed_us(m_phase_start);
+    m_phases.back().cpu_time = resource_usage().cpu_time - m_phase_start_cpu;
+}
+
+nlohmann::json RunStats::to_json()
+{
+    end_phase();
+    const auto usage = resource_usage();
+    const auto values = counter_values();
+    const auto delta = [&](Counter counter) {
+        const auto index = static_cast<std::size_t>(counter);
+        return values[index] - m_start_counters[index];
+    };
+
+    nlohmann::json phases = nlohmann::json::array();
+    for (const auto& phase : m_phases) {
+        phases.push_back({
+            {   "name",            phase.name},
+            {"wall_us", phase.wall_time.count()},
+            { "cpu_us",  phase.cpu_time.count()}
+        });
+    }
+    const nlohmann::json counter_deltas = {
+        {"schema_validations", delta(Counter::kSchemaValidations)},
+        {     "certs_written",      delta(Counter::kCertsWritten)},
+        {"certs_deduplicated", delta(Counter::kCertsDeduplicated)},
+        {     "bytes_written",      delta(Counter::kBytesWritten)}
+    };
+    return nlohmann::json{
+        {"schema_version",                             "stats.v1"},
+        {       "command",                              m_command},
+        {       "wall_us",            elapsed_us(m_start).count()},
+        {        "cpu_us", (usage.cpu_time - m_start_cpu).count()},
+        {"peak_rss_bytes",                   usage.peak_rss_bytes},
+        {        "phases",                      std::move(phases)},
+        {      "counters",                         counter_deltas}
+    };
+}
+
+}  // namespace sappp::common::stats
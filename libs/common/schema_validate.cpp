@@ -5,10 +5,16 @@
 
 #include "sappp/schema_validate.hpp"
 
+#include "sappp/run_stats.hpp"
+#include "sappp/trace.hpp"
+
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <memory>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include <valijson/adapters/nlohmann_json_adapter.hpp>
 #include <valijson/schema.hpp>
@@ -85,8 +91,17 @@ std::string format_validation_errors(valijson::ValidationResults& results)
 
 }  // namespace
 
-sappp::VoidResult validate_json(const nlohmann::json& j, const std::string& schema_path)
+SchemaValidator::SchemaValidator(std::unique_ptr<valijson::Schema> schema)
+    : m_schema(std::move(schema))
+{}
+
+SchemaValidator::SchemaValidator(SchemaValidator&& other) noexcept = default;
+SchemaValidator& SchemaValidator::operator=(SchemaValidator&& other) noexcept = default;
+SchemaValidator::~SchemaValidator() = default;
+
+sappp::Result<SchemaValidator> SchemaValidator::load(const std::string& schema_path)
 {
+    const trace::Span span("schema", "load", schema_path);
     std::ifstream schema_stream(schema_path);
     if (!schema_stream) {
         return std::unexpected(
@@ -104,9 +119,8 @@ sappp::VoidResult validate_json(const nlohmann::json& j, const std::string& sche
 
     normalize_schema_defs(schema_json);
 
-    valijson::Schema schema;
+    auto schema = std::make_unique<valijson::Schema>();
     valijson::SchemaParser parser;
-
     const std::filesystem::path schema_dir = std::filesystem::path(schema_path).parent_path();
     auto fetch_doc = [&schema_dir](const std::string& uri) -> const nlohmann::json* {
         constexpr std::string_view kSchemaPrefix = "sappp:schema/";
@@ -143,17 +157,24 @@ sappp::VoidResult validate_json(const nlohmann::json& j, const std::string& sche
 
     try {
         valijson::adapters::NlohmannJsonAdapter schema_adapter(schema_json);
-        parser.populateSchema(schema_adapter, schema, fetch_doc, free_doc);
+        parser.populateSchema(schema_adapter, *schema, fetch_doc, free_doc);
     } catch (const std::exception& ex) {
         return std::unexpected(
             Error::make("SchemaBuildFailed", std::string("Failed to build schema: ") + ex.what()));
     }
 
+    return SchemaValidator(std::move(schema));
+}
+
+sappp::VoidResult SchemaValidator::validate(const nlohmann::json& j) const
+{
+    const trace::Span span("schema", "validate");
+    stats::add(stats::Counter::kSchemaValidations);
     valijson::Validator validator;
     valijson::ValidationResults results;
     valijson::adapters::NlohmannJsonAdapter target_adapter(j);
 
-    if (!validator.validate(schema, target_adapter, &results)) {
+    if (!validator.validate(*m_schema, target_adapter, &results)) {
         std::string error = format_validation_errors(results);
         if (error.empty()) {
             error = "Schema validation failed.";
@@ -164,4 +185,13 @@ sappp::VoidResult validate_json(const nlohmann::json& j, const std::string& sche
     return {};
 }
 
+sappp::VoidResult validate_json(const nlohmann::json& j, const std::string& schema_path)
+{
+    auto validator = SchemaValidator::load(schema_path);
+    if (!validator) {
+        return std::unexpected(validator.error());
+    }
+    return validator->validate(j);
+}
+
 }  // namespace sappp::common
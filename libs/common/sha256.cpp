@@ -18,7 +18,6 @@
 #include <cstring>
 #include <format>
 #include <ranges>
-#include <span>
 
 namespace sappp::common {
 
@@ -70,158 +69,142 @@ constexpr std::array<uint32_t, 64> kRoundConstants = {
     return std::rotr(x, 17U) ^ std::rotr(x, 19U) ^ (x >> 10U);
 }
 
-class SHA256
+[[nodiscard]] std::string to_hex(const std::array<uint8_t, 32>& hash)
 {
-public:
-    SHA256() { reset(); }
-
-    void reset()
-    {
-        m_state = std::array<uint32_t, 8>{
-            {0x6a'09'e6'67,
-             0xbb'67'ae'85, 0x3c'6e'f3'72,
-             0xa5'4f'f5'3a, 0x51'0e'52'7f,
-             0x9b'05'68'8c, 0x1f'83'd9'ab,
-             0x5b'e0'cd'19}
-        };
-        m_count = 0;
-        m_buffer_len = 0;
-    }
-
-    void update(std::span<const std::byte> data)
-    {
-        for (auto byte : data) {
-            m_buffer.at(m_buffer_len) = std::to_integer<uint8_t>(byte);
-            ++m_buffer_len;
-            if (m_buffer_len == m_buffer.size()) {
-                transform();
-                m_count += 512;
-                m_buffer_len = 0;
-            }
-        }
+    std::string result;
+    result.reserve(64);
+    for (uint8_t b : hash) {
+        result += std::format("{:02x}", b);
     }
+    return result;
+}
 
-    void update(std::span<const uint8_t> data) { update(std::as_bytes(data)); }
-
-    void update(std::string_view data) { update(std::as_bytes(std::span(data))); }
-
-    std::array<uint8_t, 32> finalize()
-    {
-        uint64_t total_bits = m_count + (m_buffer_len * 8);
+}  // namespace
 
-        // Padding
-        m_buffer.at(m_buffer_len) = 0x80;
+Sha256Hasher::Sha256Hasher()
+    : m_state{{0x6a'09'e6'67,
+               0xbb'67'ae'85,
+               0x3c'6e'f3'72,
+               0xa5'4f'f5'3a,
+               0x51'0e'52'7f,
+               0x9b'05'68'8c,
+               0x1f'83'd9'ab,
+               0x5b'e0'cd'19}}
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    , m_buffer()
+{}
+
+void Sha256Hasher::update(std::string_view data)
+{
+    for (const char byte : data) {
+        m_buffer.at(m_buffer_len) = static_cast<uint8_t>(byte);
         ++m_buffer_len;
-        if (m_buffer_len > 56) {
-            while (m_buffer_len < 64) {
-                m_buffer.at(m_buffer_len) = 0;
-                ++m_buffer_len;
-            }
+        if (m_buffer_len == m_buffer.size()) {
             transform();
+            m_count += 512;
             m_buffer_len = 0;
         }
-        while (m_buffer_len < 56) {
-            m_buffer.at(m_buffer_len) = 0;
-            ++m_buffer_len;
-        }
+    }
+}
+
+std::string Sha256Hasher::finish()
+{
+    uint64_t total_bits = m_count + (m_buffer_len * 8);
 
-        // Length (big-endian)
-        for (auto i : std::views::iota(0, 8) | std::views::reverse) {
-            const auto shift = static_cast<uint64_t>(i) * 8U;
-            m_buffer.at(m_buffer_len) = static_cast<uint8_t>(total_bits >> shift);
+    // Padding
+    m_buffer.at(m_buffer_len) = 0x80;
+    ++m_buffer_len;
+    if (m_buffer_len > 56) {
+        while (m_buffer_len < 64) {
+            m_buffer.at(m_buffer_len) = 0;
             ++m_buffer_len;
         }
         transform();
-
-        // Output (big-endian) using views::enumerate
-        std::array<uint8_t, 32> hash{};
-        for (auto [i, state] : std::views::enumerate(m_state)) {
-            const std::size_t idx = static_cast<std::size_t>(i) * std::size_t{4};
-            hash.at(idx) = static_cast<uint8_t>(state >> 24);
-            hash.at(idx + std::size_t{1}) = static_cast<uint8_t>(state >> 16);
-            hash.at(idx + std::size_t{2}) = static_cast<uint8_t>(state >> 8);
-            hash.at(idx + std::size_t{3}) = static_cast<uint8_t>(state);
-        }
-        return hash;
+        m_buffer_len = 0;
+    }
+    while (m_buffer_len < 56) {
+        m_buffer.at(m_buffer_len) = 0;
+        ++m_buffer_len;
     }
 
-private:
-    void transform()
-    {
-        std::array<uint32_t, 64> schedule{};
-
-        // Prepare message schedule using std::byteswap for big-endian conversion
-        for (std::size_t i = 0; i < 16; ++i) {
-            const std::size_t buffer_index = i * std::size_t{4};
-            uint32_t val{};
-            std::memcpy(&val, &m_buffer.at(buffer_index), sizeof(val));
-            if constexpr (std::endian::native == std::endian::little) {
-                schedule.at(i) = std::byteswap(val);
-            } else {
-                schedule.at(i) = val;
-            }
-        }
-        for (std::size_t i = 16; i < schedule.size(); ++i) {
-            schedule.at(i) = gamma1(schedule.at(i - 2)) + schedule.at(i - 7)
-                             + gamma0(schedule.at(i - 15)) + schedule.at(i - 16);
-        }
+    // Length (big-endian)
+    for (auto i : std::views::iota(0, 8) | std::views::reverse) {
+        const auto shift = static_cast<uint64_t>(i) * 8U;
+        m_buffer.at(m_buffer_len) = static_cast<uint8_t>(total_bits >> shift);
+        ++m_buffer_len;
+    }
+    transform();
+
+    // Output (big-endian) using views::enumerate
+    std::array<uint8_t, 32> hash{};
+    for (auto [i, state] : std::views::enumerate(m_state)) {
+        const std::size_t idx = static_cast<std::size_t>(i) * std::size_t{4};
+        hash.at(idx) = static_cast<uint8_t>(state >> 24);
+        hash.at(idx + std::size_t{1}) = static_cast<uint8_t>(state >> 16);
+        hash.at(idx + std::size_t{2}) = static_cast<uint8_t>(state >> 8);
+        hash.at(idx + std::size_t{3}) = static_cast<uint8_t>(state);
+    }
+    return to_hex(hash);
+}
 
-        uint32_t a = m_state.at(0);
-        uint32_t b = m_state.at(1);
-        uint32_t c = m_state.at(2);
-        uint32_t d = m_state.at(3);
-        uint32_t e = m_state.at(4);
-        uint32_t f = m_state.at(5);
-        uint32_t g = m_state.at(6);
-        uint32_t h = m_state.at(7);
-
-        for (auto [i, w_val] : std::views::enumerate(schedule)) {
-            const auto idx = static_cast<std::size_t>(i);
-            uint32_t t1 = h + sigma1(e) + ch(e, f, g) + kRoundConstants.at(idx) + w_val;
-            uint32_t t2 = sigma0(a) + maj(a, b, c);
-            h = g;
-            g = f;
-            f = e;
-            e = d + t1;
-            d = c;
-            c = b;
-            b = a;
-            a = t1 + t2;
+void Sha256Hasher::transform()
+{
+    std::array<uint32_t, 64> schedule{};
+
+    // Prepare message schedule using std::byteswap for big-endian conversion
+    for (std::size_t i = 0; i < 16; ++i) {
+        const std::size_t buffer_index = i * std::size_t{4};
+        uint32_t val{};
+        std::memcpy(&val, &m_buffer.at(buffer_index), sizeof(val));
+        if constexpr (std::endian::native == std::endian::little) {
+            schedule.at(i) = std::byteswap(val);
+        } else {
+            schedule.at(i) = val;
         }
-
-        m_state.at(0) += a;
-        m_state.at(1) += b;
-        m_state.at(2) += c;
-        m_state.at(3) += d;
-        m_state.at(4) += e;
-        m_state.at(5) += f;
-        m_state.at(6) += g;
-        m_state.at(7) += h;
+    }
+    for (std::size_t i = 16; i < schedule.size(); ++i) {
+        schedule.at(i) = gamma1(schedule.at(i - 2)) + schedule.at(i - 7)
+                         + gamma0(schedule.at(i - 15)) + schedule.at(i - 16);
     }
 
-    std::array<uint32_t, 8> m_state{};
-    std::array<uint8_t, 64> m_buffer{};
-    std::size_t m_buffer_len = 0;
-    uint64_t m_count = 0;
-};
-
-[[nodiscard]] std::string to_hex(const std::array<uint8_t, 32>& hash)
-{
-    std::string result;
-    result.reserve(64);
-    for (uint8_t b : hash) {
-        result += std::format("{:02x}", b);
+    uint32_t a = m_state.at(0);
+    uint32_t b = m_state.at(1);
+    uint32_t c = m_state.at(2);
+    uint32_t d = m_state.at(3);
+    uint32_t e = m_state.at(4);
+    uint32_t f = m_state.at(5);
+    uint32_t g = m_state.at(6);
+    uint32_t h = m_state.at(7);
+
+    for (auto [i, w_val] : std::views::enumerate(schedule)) {
+        const auto idx = static_cast<std::size_t>(i);
+        uint32_t t1 = h + sigma1(e) + ch(e, f, g) + kRoundConstants.at(idx) + w_val;
+        uint32_t t2 = sigma0(a) + maj(a, b, c);
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
     }
-    return result;
-}
 
-}  // namespace
+    m_state.at(0) += a;
+    m_state.at(1) += b;
+    m_state.at(2) += c;
+    m_state.at(3) += d;
+    m_state.at(4) += e;
+    m_state.at(5) += f;
+    m_state.at(6) += g;
+    m_state.at(7) += h;
+}
 
 std::string sha256(std::string_view data)
 {
-    SHA256 hasher;
+    Sha256Hasher hasher;
     hasher.update(data);
-    return to_hex(hasher.finalize());
+    return hasher.finish();
 }
 
 std::string sha256_prefixed(std::string_view data)
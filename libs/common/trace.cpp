@@ -0,0 +1,167 @@
+/**
+ * @file trace.cpp
+ * @brief Process-wide Chrome trace-event recorder
+ */
+
+#include "sappp/trace.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace sappp::common::trace {
+
+namespace {
+
+struct Event
+{
+    std::string category;
+    std::string name;
+    std::string detail;
+    std::int64_t begin_ns = 0;
+    std::int64_t duration_ns = 0;
+    std::uint32_t tid = 0;
+};
+
+struct Recorder
+{
+    std::atomic<bool> enabled{false};
+    std::atomic<std::uint32_t> next_tid{0};
+    std::mutex mutex{};
+    std::chrono::steady_clock::time_point origin = {};
+    std::vector<Event> events = {};
+};
+
+/// Events reserved by start(), so short runs never grow the buffer from a span destructor.
+constexpr std::size_t kReservedEvents = 4096;
+
+[[nodiscard]] Recorder& recorder()
+{
+    static Recorder instance;
+    return instance;
+}
+
+[[nodiscard]] std::uint32_t current_tid()
+{
+    thread_local std::uint32_t tid = 0;
+    if (tid == 0) {
+        tid = recorder().next_tid.fetch_add(1) + 1;
+    }
+    return tid;
+}
+
+[[nodiscard]] std::int64_t elapsed_ns(std::chrono::steady_clock::time_point from,
+                                      std::chrono::steady_clock::time_point to)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+}
+
+[[nodiscard]] double to_microseconds(std::int64_t ns)
+{
+    return static_cast<double>(ns) / 1000.0;
+}
+
+}  // namespace
+
+void start()
+{
+    auto& state = recorder();
+    {
+        std::lock_guard lock(state.mutex);
+        state.events.clear();
+        state.events.reserve(kReservedEvents);
+        state.origin = std::chrono::steady_clock::now();
+    }
+    state.enabled.store(true);
+}
+
+bool enabled() noexcept
+{
+    return recorder().enabled.load(std::memory_order_relaxed);
+}
+
+VoidResult write(const std::filesystem::path& path)
+{
+    auto& state = recorder();
+    state.enabled.store(false);
+    std::vector<Event> events = {};
+    {
+        std::lock_guard lock(state.mutex);
+        events.swap(state.events);
+    }
+
+    nlohmann::json trace_events = nlohmann::json::array();
+    for (const auto& event : events) {
+        nlohmann::json entry = {
+            { "cat",                     event.category},
+            {"name",                         event.name},
+            {  "ph",                                "X"},
+            { "pid",                                  1},
+            { "tid",                          event.tid},
+            {  "ts",    to_microseconds(event.begin_ns)},
+            { "dur", to_microseconds(event.duration_ns)}
+        };
+        if (!event.detail.empty()) {
+            entry["args"] = {
+                {"detail", event.detail}
+            };
+        }
+        trace_events.push_back(std::move(entry));
+    }
+    const nlohmann::json document = {
+        {"displayTimeUnit",                    "ms"},
+        {    "traceEvents", std::move(trace_events)}
+    };
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return std::unexpected(
+            Error::make("IOError", "Failed to open trace file: " + path.string()));
+    }
+    out << document.dump() << "\n";
+    if (!out) {
+        return std::unexpected(
+            Error::make("IOError", "Failed to write trace file: " + path.string()));
+    }
+    return {};
+}
+
+Span::Span(std::string_view category, std::string_view name, std::string_view detail)
+    : m_active(enabled())
+    , m_begin(m_active ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{})
+    , m_category(m_active ? category : std::string_view{})
+    , m_name(m_active ? name : std::string_view{})
+    , m_detail(m_active ? detail : std::string_view{})
+{}
+
+Span::~Span()
+{
+    if (!m_active) {
+        return;
+    }
+    const auto end = std::chrono::steady_clock::now();
+    auto& state = recorder();
+    Event event{.category = std::move(m_category),
+                .name = std::move(m_name),
+                .detail = std::move(m_detail),
+                .begin_ns = 0,
+                .duration_ns = elapsed_ns(m_begin, end),
+                .tid = current_tid()};
+    // Destructors must not throw: a span that cannot be stored is dropped.
+    try {
+        std::lock_guard lock(state.mutex);
+        event.begin_ns = elapsed_ns(state.origin, m_begin);
+        state.events.push_back(std::move(event));
+    } catch (const std::exception&) {
+        return;
+    }
+}
+
+}  // namespace sappp::common::trace
@@ -0,0 +1,176 @@
+/**
+ * @file dependency_scanner.cpp
+ * @brief Compile unit header closure via clang's dependency directives scanner
+ */
+
+#include "frontend_clang/dependency_scanner.hpp"
+
+#include "sappp/common.hpp"
+#include "sappp/parallel.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <clang/Tooling/DependencyScanning/DependencyScanningService.h>
+#include <clang/Tooling/DependencyScanning/DependencyScanningTool.h>
+#include <clang/Tooling/DependencyScanning/ModuleDepCollector.h>
+#include <llvm/ADT/DenseSet.h>
+#include <llvm/Support/Error.h>
+
+namespace sappp::frontend_clang {
+
+namespace {
+
+namespace deps = clang::tooling::dependencies;
+namespace fs = std::filesystem;
+
+[[nodiscard]] fs::path resolve_path(std::string_view path, const fs::path& base)
+{
+    fs::path resolved(path);
+    if (resolved.is_relative()) {
+        resolved = base / resolved;
+    }
+    return resolved.lexically_normal();
+}
+
+/// Absolute paths of every file the unit reads, in scanner order.
+[[nodiscard]] sappp::Result<std::vector<fs::path>> scan_unit(deps::DependencyScanningTool& tool,
+                                                             const nlohmann::json& unit,
+                                                             const fs::path& root)
+{
+    const auto argv = unit.at("argv").get<std::vector<std::string>>();
+    const fs::path cwd = resolve_path(unit.at("cwd").get<std::string>(), root);
+    const llvm::DenseSet<deps::ModuleID> already_seen;
+    auto result = tool.getTranslationUnitDependencies(
+        argv,
+        cwd.string(),
+        already_seen,
+        [](const deps::ModuleID&, deps::ModuleOutputKind) { return std::string(); });
+    if (!result) {
+        return std::unexpected(
+            Error::make("DependencyScanFailed",
+                        std::format("Dependency scan failed for {}: {}",
+                                    unit.at("tu_id").get<std::string>(),
+                                    llvm::toString(result.takeError()))));
+    }
+    std::vector<fs::path> files;
+    files.reserve(result->FileDeps.size());
+    for (const auto& file : result->FileDeps) {
+        files.push_back(resolve_path(file, cwd));
+    }
+    return files;
+}
+
+}  // namespace
+
+DependencyScanner::DependencyScanner(std::string repo_root, std::size_t jobs)
+    : m_repo_root(std::move(repo_root))
+    , m_jobs(jobs)
+{}
+
+// NOLINTNEXTLINE(readability-function-size) - scan, hash and assemble stay together.
+sappp::Result<nlohmann::json> DependencyScanner::scan(const nlohmann::json& build_snapshot) const
+{
+    std::vector<const nlohmann::json*> units;
+    for (const auto& unit : build_snapshot.at("compile_units")) {
+        units.push_back(&unit);
+    }
+    std::ranges::sort(units, [](const nlohmann::json* a, const nlohmann::json* b) {
+        return a->at("tu_id").get_ref<const std::string&>()
+               < b->at("tu_id").get_ref<const std::string&>();
+    });
+    const auto [first_duplicate, last] =
+        std::ranges::unique(units, [](const nlohmann::json* a, const nlohmann::json* b) {
+            return a->at("tu_id") == b->at("tu_id");
+        });
+    units.erase(first_duplicate, last);
+
+    const fs::path root = m_repo_root.empty() ? fs::current_path() : fs::path(m_repo_root);
+    deps::DependencyScanningService service(deps::ScanningMode::DependencyDirectivesScan,
+                                            deps::ScanningOutputFormat::Full);
+
+    // Scanning tools are reused across units, one per concurrent scan; the service (and
+    // its file cache) is shared by all of them.
+    std::vector<sappp::Result<std::vector<fs::path>>> scans(units.size());
+    std::mutex tools_mutex;
+    std::vector<std::unique_ptr<deps::DependencyScanningTool>> idle_tools;
+    auto scanned = common::parallel_for_each_index(
+        units.size(),
+        m_jobs,
+        [&](std::size_t i) -> sappp::VoidResult {
+            std::unique_ptr<deps::DependencyScanningTool> tool;
+            {
+                std::lock_guard lock(tools_mutex);
+                if (!idle_tools.empty()) {
+                    tool = std::move(idle_tools.back());
+                    idle_tools.pop_back();
+                }
+            }
+            if (!tool) {
+                tool = std::make_unique<deps::DependencyScanningTool>(service);
+            }
+            scans[i] = scan_unit(*tool, *units[i], root);
+            {
+                std::lock_guard lock(tools_mutex);
+                idle_tools.push_back(std::move(tool));
+            }
+            if (!scans[i]) {
+                return std::unexpected(scans[i].error());
+            }
+            return {};
+        });
+    if (!scanned) {
+        return std::unexpected(scanned.error());
+    }
+
+    // Each distinct file is hashed once, however many units include it.
+    std::map<fs::path, std::size_t> path_index;
+    std::vector<fs::path> paths;
+    for (std::size_t i = 0; i < units.size(); ++i) {
+        for (const auto& file : *scans[i]) {
+            if (path_index.try_emplace(file, paths.size()).second) {
+                paths.push_back(file);
+            }
+        }
+    }
+    common::FileHashCache local_hashes;
+    const auto digests =
+        (m_file_hashes != nullptr ? *m_file_hashes : local_hashes).digest_all(paths, m_jobs);
+
+    nlohmann::json recorded = nlohmann::json::array();
+    for (std::size_t i = 0; i < units.size(); ++i) {
+        std::map<std::string, std::string> files;
+        for (const auto& file : *scans[i]) {
+            const auto& digest = digests[path_index.at(file)];
+            if (!digest) {
+                return std::unexpected(digest.error());
+            }
+            files.emplace(common::normalize_path(file.generic_string(), m_repo_root), *digest);
+        }
+        nlohmann::json files_json = nlohmann::json::array();
+        for (const auto& [path, digest] : files) {
+            files_json.push_back({
+                {  "path",   path},
+                {"sha256", digest}
+            });
+        }
+        recorded.push_back({
+            {"tu_id", units[i]->at("tu_id")},
+            {"files",           files_json}
+        });
+    }
+
+    return nlohmann::json{
+        {"schema_version", "build_deps.v1"},
+        {         "units",        recorded}
+    };
+}
+
+}  // namespace sappp::frontend_clang
@@ -0,0 +1,60 @@
+#pragma once
+
+/**
+ * @file dependency_scanner.hpp
+ * @brief Header closure of compile units via clang's dependency directives scanner
+ */
+
+#include "sappp/common.hpp"
+#include "sappp/file_hash_cache.hpp"
+
+#include <cstddef>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace sappp::frontend_clang {
+
+/**
+ * @brief Records the files each compile unit reads, with content digests
+ *
+ * Units are preprocessed in clang's minimized directives mode (no parsing, no codegen)
+ * on a worker pool sharing one scanning service, so file contents and directive tokens
+ * are cached across units. The result is the build_deps.v1 object stored in the
+ * build snapshot's "dependencies" field.
+ */
+class DependencyScanner
+{
+public:
+    /**
+     * @param repo_root Root that recorded paths are made relative to (empty = absolute)
+     * @param jobs Scanner worker threads (0 = hardware concurrency)
+     */
+    explicit DependencyScanner(std::string repo_root = {}, std::size_t jobs = 0);
+
+    // The shared FileHashCache is borrowed, so copies observe the same cache.
+    DependencyScanner(const DependencyScanner&) = default;
+    DependencyScanner& operator=(const DependencyScanner&) = default;
+    DependencyScanner(DependencyScanner&&) noexcept = default;
+    DependencyScanner& operator=(DependencyScanner&&) noexcept = default;
+    ~DependencyScanner() = default;
+
+    /**
+     * @brief Share a persistent digest cache for dependency digests (not owned)
+     * @param cache Cache outliving scan(), or nullptr to hash files directly
+     */
+    void set_file_hash_cache(common::FileHashCache* cache) noexcept { m_file_hashes = cache; }
+
+    /**
+     * @brief Scan every compile unit of @p build_snapshot
+     * @return build_deps.v1 object with units sorted by tu_id and files sorted by path
+     */
+    [[nodiscard]] sappp::Result<nlohmann::json> scan(const nlohmann::json& build_snapshot) const;
+
+private:
+    std::string m_repo_root;
+    std::size_t m_jobs;
+    common::FileHashCache* m_file_hashes = nullptr;
+};
+
+}  // namespace sappp::frontend_clang
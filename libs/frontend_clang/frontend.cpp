@@ -9,6 +9,7 @@
 #include "sappp/canonical_json.hpp"
 #include "sappp/common.hpp"
 #include "sappp/schema_validate.hpp"
+#include "sappp/trace.hpp"
 #include "sappp/version.hpp"
 
 #include <algorithm>
@@ -1917,6 +1918,7 @@ public:
     void HandleTranslationUnit(clang::ASTContext& context) override
     {
         if (m_builder != nullptr) {
+            const sappp::common::trace::Span span("frontend", "nir_build");
             m_builder->build(context);
         }
     }
@@ -2004,6 +2006,8 @@ struct UnitAnalysisResult
             Error::make("SourceFileNotFound", "Source file not found: " + file_path));
     }
 
+    // Covers parsing; the nested "nir_build" span is the NIR lowering of the parsed TU.
+    const sappp::common::trace::Span span("frontend", "clang_tool", file_path);
     clang::tooling::FixedCompilationDatabase comp_db(cwd, command.args);
     clang::tooling::ClangTool tool(comp_db, {file_path});
 
@@ -2198,6 +2202,7 @@ sappp::Result<FrontendResult> FrontendClang::analyze(const nlohmann::json& build
     }
     const auto& tu_id = *tu_id_result;
 
+    const sappp::common::trace::Span span("frontend", "assemble_outputs");
     auto nir_json =
         build_nir_json(build_snapshot, tu_id, std::move(functions), schema_dir, versions);
     if (!nir_json) {
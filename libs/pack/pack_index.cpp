@@ -0,0 +1,163 @@
+/**
+ * @file pack_index.cpp
+ * @brief Sidecar member/access point index of a pack archive
+ */
+
+#include "pack_index.hpp"
+
+#include <format>
+#include <optional>
+#include <utility>
+
+namespace sappp::pack {
+
+namespace {
+
+constexpr std::string_view kIndexMagic = "SAPPPPI1";
+constexpr std::size_t kFieldSize = 8;
+
+// Header fields following the magic.
+constexpr std::size_t kArchiveSizeField = 0;
+constexpr std::size_t kStreamSizeField = 1;
+constexpr std::size_t kCrcField = 2;
+constexpr std::size_t kPointCountField = 3;
+constexpr std::size_t kMemberCountField = 4;
+constexpr std::size_t kHeaderFieldCount = 5;
+constexpr std::size_t kIndexHeaderSize = kIndexMagic.size() + (kHeaderFieldCount * kFieldSize);
+
+constexpr std::size_t kPointRecordSize = 2 * kFieldSize;
+constexpr std::size_t kMemberRecordSize = 4 * kFieldSize;
+// CRC-32 and ISIZE, little-endian.
+constexpr std::size_t kGzipTrailerSize = 8;
+
+void put_u64(std::string& out, std::uint64_t value)
+{
+    for (std::size_t i = 0; i < kFieldSize; ++i) {
+        out.push_back(static_cast<char>((value >> (i * 8U)) & 0xFFU));
+    }
+}
+
+[[nodiscard]] std::uint64_t get_uint(std::string_view bytes, std::size_t offset, std::size_t width)
+{
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < width; ++i) {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[offset + i]))
+                 << (i * 8U);
+    }
+    return value;
+}
+
+[[nodiscard]] std::uint64_t get_u64(std::string_view bytes, std::size_t offset)
+{
+    return get_uint(bytes, offset, kFieldSize);
+}
+
+/// Bytes [offset, offset + size) of @p bytes, or std::nullopt when out of range.
+[[nodiscard]] std::optional<std::string_view>
+slice(std::string_view bytes, std::uint64_t offset, std::uint64_t size)
+{
+    if (offset > bytes.size() || size > bytes.size() - offset) {
+        return std::nullopt;
+    }
+    return bytes.substr(offset, size);
+}
+
+[[nodiscard]] Error stale_index(std::string_view what)
+{
+    return Error::make("StaleIndex", std::format("Pack index is stale: {}", what));
+}
+
+}  // namespace
+
+std::string serialize_pack_index(const PackIndex& index)
+{
+    const std::size_t pool_begin = kIndexHeaderSize + (index.points.size() * kPointRecordSize)
+                                   + (index.members.size() * kMemberRecordSize);
+    std::string pool;
+    std::string bytes(kIndexMagic);
+    put_u64(bytes, index.archive_size);
+    put_u64(bytes, index.stream_size);
+    put_u64(bytes, index.crc);
+    put_u64(bytes, index.points.size());
+    put_u64(bytes, index.members.size());
+    for (const auto& point : index.points) {
+        put_u64(bytes, point.out);
+        put_u64(bytes, point.in);
+    }
+    for (const auto& member : index.members) {
+        put_u64(bytes, pool_begin + pool.size());
+        put_u64(bytes, member.name.size());
+        put_u64(bytes, member.offset);
+        put_u64(bytes, member.size);
+        pool += member.name;
+    }
+    bytes += pool;
+    return bytes;
+}
+
+// NOLINTNEXTLINE(readability-function-size) - every record is range-checked in one pass.
+Result<PackIndex> parse_pack_index(std::string_view bytes, std::string_view archive)
+{
+    if (bytes.size() < kIndexHeaderSize || !bytes.starts_with(kIndexMagic)) {
+        return std::unexpected(stale_index("unrecognized format"));
+    }
+    auto header_field = [&](std::size_t field) {
+        return get_u64(bytes, kIndexMagic.size() + (field * kFieldSize));
+    };
+    PackIndex index;
+    index.archive_size = header_field(kArchiveSizeField);
+    index.stream_size = header_field(kStreamSizeField);
+    index.crc = header_field(kCrcField);
+    if (index.archive_size != archive.size() || archive.size() < kGzipTrailerSize) {
+        return std::unexpected(stale_index("archive size differs"));
+    }
+    const std::size_t trailer = archive.size() - kGzipTrailerSize;
+    if (get_uint(archive, trailer, 4) != index.crc
+        || get_uint(archive, trailer + 4, 4) != (index.stream_size & 0xFFFFFFFFU)) {
+        return std::unexpected(stale_index("gzip trailer differs"));
+    }
+
+    const std::uint64_t point_count = header_field(kPointCountField);
+    const std::uint64_t member_count = header_field(kMemberCountField);
+    const std::uint64_t records = bytes.size() - kIndexHeaderSize;
+    if (point_count == 0 || point_count > records / kPointRecordSize
+        || member_count > (records - (point_count * kPointRecordSize)) / kMemberRecordSize) {
+        return std::unexpected(stale_index("truncated"));
+    }
+
+    std::size_t record = kIndexHeaderSize;
+    index.points.reserve(point_count);
+    for (std::uint64_t i = 0; i < point_count; ++i, record += kPointRecordSize) {
+        PackReader::AccessPoint point{.out = get_u64(bytes, record),
+                                      .in = get_u64(bytes, record + kFieldSize),
+                                      .bits = 0,
+                                      .window = {}};
+        const bool ordered = index.points.empty()
+                                 ? point.out == 0
+                                 : point.out > index.points.back().out
+                                       && point.in > index.points.back().in;
+        if (!ordered || point.out > index.stream_size || point.in > trailer) {
+            return std::unexpected(stale_index("access point out of range"));
+        }
+        index.points.push_back(std::move(point));
+    }
+
+    index.members.reserve(member_count);
+    for (std::uint64_t i = 0; i < member_count; ++i, record += kMemberRecordSize) {
+        auto name = slice(bytes, get_u64(bytes, record), get_u64(bytes, record + kFieldSize));
+        PackMember member{.name = std::string(name.value_or(std::string_view{})),
+                          .offset = get_u64(bytes, record + (2 * kFieldSize)),
+                          .size = get_u64(bytes, record + (3 * kFieldSize))};
+        if (!name || member.offset > index.stream_size
+            || member.size > index.stream_size - member.offset) {
+            return std::unexpected(stale_index("member out of range"));
+        }
+        if (!index.members.empty() && !(index.members.back().name < member.name)) {
+            return std::unexpected(stale_index("members are not sorted"));
+        }
+        index.members.push_back(std::move(member));
+    }
+    return index;
+}
+
+}  // namespace sappp::pack
@@ -0,0 +1,52 @@
+#pragma once
+
+/**
+ * @file pack_index.hpp
+ * @brief Sidecar member/access point index of a pack archive (pack internal)
+ */
+
+#include "sappp/common.hpp"
+#include "sappp/pack.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sappp::pack {
+
+/// Everything PackReader needs to serve reads without decompressing the archive first.
+struct PackIndex
+{
+    /// Compressed archive size, gzip header and trailer included
+    std::uint64_t archive_size = 0;
+    /// Size of the uncompressed tar stream
+    std::uint64_t stream_size = 0;
+    /// CRC-32 of the uncompressed tar stream, as stored in the gzip trailer
+    std::uint64_t crc = 0;
+    /// Regular file members sorted by name
+    std::vector<PackMember> members = {};
+    /// Access points sorted by offset; the first one is at uncompressed offset 0
+    std::vector<PackReader::AccessPoint> points = {};
+};
+
+/**
+ * Serialize @p index.
+ *
+ * Little-endian layout: the magic "SAPPPPI1", then the archive size, the tar stream size,
+ * its CRC-32, the access point and member counts, then the access point records (tar
+ * offset, compressed offset), the member records (name offset, name size, tar offset,
+ * size) and a name pool. Only byte-aligned access points without a window can be stored.
+ */
+[[nodiscard]] std::string serialize_pack_index(const PackIndex& index);
+
+/**
+ * Parse a serialized index and check it against the mapped @p archive.
+ *
+ * Errors: "StaleIndex" when the format is unknown, a record is out of range or unsorted,
+ * or the archive size or gzip trailer differs from the recorded values.
+ */
+[[nodiscard]] Result<PackIndex> parse_pack_index(std::string_view bytes,
+                                                 std::string_view archive);
+
+}  // namespace sappp::pack
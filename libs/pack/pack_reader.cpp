@@ -0,0 +1,718 @@
+/**
+ * @file pack_reader.cpp
+ * @brief Indexed random access into gzip-compressed tar archives
+ */
+
+#include "pack_index.hpp"
+
+#include "sappp/pack.hpp"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <limits>
+#include <memory>
+#include <span>
+#include <system_error>
+#include <utility>
+
+#define ZLIB_CONST
+#include <zlib.h>
+
+namespace sappp::pack {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr std::size_t kTarBlockSize = 512;
+constexpr std::size_t kWindowSize = std::size_t{32} * 1024;
+// Uncompressed distance between access points; bounds the work of a single read().
+constexpr std::uint64_t kAccessSpan = std::uint64_t{1024} * 1024;
+constexpr std::size_t kMaxInflateInput = std::size_t{1} << 30U;
+
+[[nodiscard]] Error invalid_pack(const fs::path& path, std::string_view what)
+{
+    return Error::make("InvalidPack", std::string(what) + ": " + path.string());
+}
+
+[[nodiscard]] const Bytef* as_bytes(const char* data)
+{
+    return static_cast<const Bytef*>(static_cast<const void*>(data));
+}
+
+[[nodiscard]] Bytef* as_bytes(char* data)
+{
+    return static_cast<Bytef*>(static_cast<void*>(data));
+}
+
+// --- tar headers -----------------------------------------------------------
+
+using TarHeader = std::array<char, kTarBlockSize>;
+
+[[nodiscard]] std::string_view get_field(const TarHeader& header,
+                                         std::size_t offset,
+                                         std::size_t width)
+{
+    const std::string_view field(header.data() + offset, width);
+    return field.substr(0, std::min(field.find('\0'), width));
+}
+
+/// Octal number field, or GNU base-256 when the high bit of the first byte is set.
+[[nodiscard]] std::optional<std::uint64_t>
+get_number(const TarHeader& header, std::size_t offset, std::size_t width)
+{
+    const std::string_view field(header.data() + offset, width);
+    std::uint64_t value = 0;
+    if ((static_cast<unsigned char>(field.front()) & 0x80U) != 0) {
+        for (std::size_t i = 1; i < width; ++i) {
+            if (value > (std::numeric_limits<std::uint64_t>::max() >> 8U)) {
+                return std::nullopt;
+            }
+            value = (value << 8U) | static_cast<unsigned char>(field[i]);
+        }
+        return value;
+    }
+    bool seen_digit = false;
+    for (const char c : field) {
+        if (c == ' ' && !seen_digit) {
+            continue;
+        }
+        if (c < '0' || c > '7') {
+            break;
+        }
+        seen_digit = true;
+        value = (value << 3U) | static_cast<std::uint64_t>(c - '0');
+    }
+    return seen_digit ? std::optional(value) : std::nullopt;
+}
+
+[[nodiscard]] bool checksum_matches(const TarHeader& header)
+{
+    auto stored = get_number(header, 148, 8);
+    if (!stored) {
+        return false;
+    }
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i < header.size(); ++i) {
+        sum += (i >= 148 && i < 156) ? static_cast<unsigned char>(' ')
+                                     : static_cast<unsigned char>(header.at(i));
+    }
+    return sum == *stored;
+}
+
+/// "path" value of a pax extended header, if present.
+[[nodiscard]] std::optional<std::string> pax_path(std::string_view records)
+{
+    std::optional<std::string> path;
+    while (!records.empty()) {
+        const auto space = records.find(' ');
+        if (space == std::string_view::npos) {
+            break;
+        }
+        std::size_t length = 0;
+        for (const char c : records.substr(0, space)) {
+            if (c < '0' || c > '9') {
+                return path;
+            }
+            length = (length * 10) + static_cast<std::size_t>(c - '0');
+        }
+        if (length <= space + 1 || length > records.size()) {
+            break;
+        }
+        const auto record = records.substr(space + 1, length - space - 2);  // drop '\n'
+        if (record.starts_with("path=")) {
+            path = std::string(record.substr(5));
+        }
+        records.remove_prefix(length);
+    }
+    return path;
+}
+
+[[nodiscard]] std::string normalize_name(std::string name)
+{
+    while (name.starts_with("./")) {
+        name.erase(0, 2);
+    }
+    return name;
+}
+
+[[nodiscard]] std::uint64_t padded_size(std::uint64_t size)
+{
+    return (size + kTarBlockSize - 1) / kTarBlockSize * kTarBlockSize;
+}
+
+/// Incremental tar parser fed with the uncompressed stream in order.
+class TarScanner
+{
+public:
+    explicit TarScanner(const fs::path& path)
+        : m_path(&path)
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_header()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_members()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_extended()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_long_name()
+    {}
+
+    TarScanner(const TarScanner&) = delete;
+    TarScanner& operator=(const TarScanner&) = delete;
+    TarScanner(TarScanner&&) = delete;
+    TarScanner& operator=(TarScanner&&) = delete;
+    ~TarScanner() = default;
+
+    [[nodiscard]] VoidResult feed(std::string_view bytes)
+    {
+        while (!bytes.empty() && !m_finished) {
+            if (m_skip > 0) {
+                const auto take = static_cast<std::size_t>(
+                    std::min<std::uint64_t>(m_skip, bytes.size()));
+                if (m_capture > 0) {
+                    const auto keep = static_cast<std::size_t>(
+                        std::min<std::uint64_t>(m_capture, take));
+                    m_extended.append(bytes.substr(0, keep));
+                    m_capture -= keep;
+                }
+                m_skip -= take;
+                m_offset += take;
+                bytes.remove_prefix(take);
+                if (m_skip == 0 && m_capture_kind != '\0') {
+                    finish_extended();
+                }
+                continue;
+            }
+            const auto take = std::min(bytes.size(), kTarBlockSize - m_header_fill);
+            std::ranges::copy(bytes.substr(0, take),
+                              m_header.begin() + static_cast<std::ptrdiff_t>(m_header_fill));
+            m_header_fill += take;
+            m_offset += take;
+            bytes.remove_prefix(take);
+            if (m_header_fill == kTarBlockSize) {
+                m_header_fill = 0;
+                if (auto parsed = parse_header(); !parsed) {
+                    return parsed;
+                }
+            }
+        }
+        return {};
+    }
+
+    /// The archive ended cleanly: on an end-of-archive block or a member boundary.
+    [[nodiscard]] bool complete() const noexcept
+    {
+        return m_finished || (m_skip == 0 && m_header_fill == 0);
+    }
+
+    [[nodiscard]] std::vector<PackMember> take_members() { return std::move(m_members); }
+
+private:
+    [[nodiscard]] VoidResult parse_header()
+    {
+        if (std::ranges::all_of(m_header, [](char c) noexcept { return c == '\0'; })) {
+            m_finished = true;
+            return {};
+        }
+        if (!checksum_matches(m_header)) {
+            return std::unexpected(invalid_pack(*m_path, "Corrupt tar header"));
+        }
+        auto size = get_number(m_header, 124, 12);
+        if (!size) {
+            return std::unexpected(invalid_pack(*m_path, "Corrupt tar member size"));
+        }
+        const char type = m_header.at(156);
+        m_skip = padded_size(*size);
+
+        if (type == 'L' || type == 'x') {
+            m_capture_kind = type;
+            m_capture = *size;
+            m_extended.clear();
+            if (m_skip == 0) {
+                finish_extended();
+            }
+            return {};
+        }
+        if (type == 'g' || (type != '0' && type != '\0' && type != '7')) {
+            m_long_name.reset();
+            return {};
+        }
+
+        std::string name;
+        if (m_long_name) {
+            name = std::move(*m_long_name);
+            m_long_name.reset();
+        } else {
+            const auto prefix = get_field(m_header, 345, 155);
+            const auto magic = get_field(m_header, 257, 6);
+            if (magic == "ustar" && !prefix.empty()) {
+                name = std::string(prefix) + "/";
+            }
+            name += get_field(m_header, 0, 100);
+        }
+        m_members.push_back(
+            PackMember{.name = normalize_name(std::move(name)), .offset = m_offset, .size = *size});
+        return {};
+    }
+
+    void finish_extended()
+    {
+        if (m_capture_kind == 'L') {
+            m_long_name = m_extended.substr(0, m_extended.find('\0'));
+        } else if (auto path = pax_path(m_extended)) {
+            m_long_name = std::move(*path);
+        }
+        m_capture_kind = '\0';
+        m_extended.clear();
+    }
+
+    const fs::path* m_path;
+    TarHeader m_header;
+    std::size_t m_header_fill = 0;
+    std::uint64_t m_offset = 0;
+    std::uint64_t m_skip = 0;
+    std::uint64_t m_capture = 0;
+    char m_capture_kind = '\0';
+    bool m_finished = false;
+    std::vector<PackMember> m_members;
+    std::string m_extended;
+    std::optional<std::string> m_long_name;
+};
+
+// --- inflation -------------------------------------------------------------
+
+/// Raw inflate stream resumed at an access point; not movable (zlib keeps &m_stream).
+class InflateCursor
+{
+public:
+    InflateCursor(std::string_view compressed, const fs::path& path)
+        : m_compressed(compressed)
+        , m_path(&path)
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_scratch()
+    {}
+
+    InflateCursor(const InflateCursor&) = delete;
+    InflateCursor& operator=(const InflateCursor&) = delete;
+    InflateCursor(InflateCursor&&) = delete;
+    InflateCursor& operator=(InflateCursor&&) = delete;
+
+    ~InflateCursor()
+    {
+        if (m_initialized) {
+            inflateEnd(&m_stream);
+        }
+    }
+
+    [[nodiscard]] VoidResult start(const PackReader::AccessPoint& point)
+    {
+        if (inflateInit2(&m_stream, -MAX_WBITS) != Z_OK) {
+            return std::unexpected(Error::make("IOError", "Failed to initialize inflate"));
+        }
+        m_initialized = true;
+        if (point.in > m_compressed.size() || (point.bits > 0 && point.in == 0)) {
+            return std::unexpected(invalid_pack(*m_path, "Access point outside the archive"));
+        }
+        m_position = static_cast<std::size_t>(point.in);
+        if (point.bits > 0) {
+            const auto byte = static_cast<unsigned char>(m_compressed[m_position - 1]);
+            inflatePrime(&m_stream, point.bits, byte >> static_cast<unsigned>(8 - point.bits));
+        }
+        if (!point.window.empty()
+            && inflateSetDictionary(&m_stream,
+                                    as_bytes(point.window.data()),
+                                    static_cast<uInt>(point.window.size()))
+                   != Z_OK) {
+            return std::unexpected(invalid_pack(*m_path, "Failed to restore deflate window"));
+        }
+        return {};
+    }
+
+    [[nodiscard]] VoidResult skip(std::uint64_t count)
+    {
+        m_scratch.resize(kWindowSize);
+        while (count > 0) {
+            const auto take = static_cast<std::size_t>(std::min<std::uint64_t>(count, kWindowSize));
+            if (auto produced = inflate_into(m_scratch.data(), take); !produced) {
+                return produced;
+            }
+            count -= take;
+        }
+        return {};
+    }
+
+    [[nodiscard]] VoidResult read(std::uint64_t count, std::string& out)
+    {
+        if (count > out.max_size()) {
+            return std::unexpected(invalid_pack(*m_path, "Member too large"));
+        }
+        out.resize(count);
+        return read(std::span(out));
+    }
+
+    /// Inflate exactly dest.size() bytes into @p dest.
+    [[nodiscard]] VoidResult read(std::span<char> dest)
+    {
+        std::size_t filled = 0;
+        while (filled < dest.size()) {
+            const auto take = std::min(dest.size() - filled, std::size_t{UINT_MAX});
+            if (auto produced = inflate_into(dest.data() + filled, take); !produced) {
+                return produced;
+            }
+            filled += take;
+        }
+        return {};
+    }
+
+private:
+    /// Inflate exactly @p count bytes into @p dest.
+    [[nodiscard]] VoidResult inflate_into(char* dest, std::size_t count)
+    {
+        m_stream.next_out = as_bytes(dest);
+        m_stream.avail_out = static_cast<uInt>(count);
+        while (m_stream.avail_out > 0) {
+            if (m_stream.avail_in == 0) {
+                const auto remaining = m_compressed.size() - m_position;
+                if (remaining == 0) {
+                    return std::unexpected(invalid_pack(*m_path, "Truncated gzip data"));
+                }
+                const auto take = std::min(remaining, kMaxInflateInput);
+                m_stream.next_in = as_bytes(m_compressed.data() + m_position);
+                m_stream.avail_in = static_cast<uInt>(take);
+                m_position += take;
+            }
+            const int ret = inflate(&m_stream, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END && m_stream.avail_out > 0) {
+                return std::unexpected(invalid_pack(*m_path, "Truncated tar data"));
+            }
+            if (ret != Z_OK && ret != Z_STREAM_END) {
+                return std::unexpected(invalid_pack(*m_path, "Corrupt gzip data"));
+            }
+        }
+        return {};
+    }
+
+    std::string_view m_compressed;
+    const fs::path* m_path;
+    z_stream m_stream{};
+    bool m_initialized = false;
+    std::size_t m_position = 0;
+    std::string m_scratch;
+};
+
+/// Cursor positioned at the first byte of @p member.
+[[nodiscard]] Result<std::unique_ptr<InflateCursor>>
+open_cursor(std::string_view compressed,
+            const fs::path& path,
+            const std::vector<PackReader::AccessPoint>& points,
+            const PackMember& member)
+{
+    auto point = std::ranges::upper_bound(points, member.offset, {}, &PackReader::AccessPoint::out);
+    --point;  // the first access point sits at offset 0
+    auto cursor = std::make_unique<InflateCursor>(compressed, path);
+    if (auto started = cursor->start(*point); !started) {
+        return std::unexpected(started.error());
+    }
+    if (auto skipped = cursor->skip(member.offset - point->out); !skipped) {
+        return std::unexpected(skipped.error());
+    }
+    return cursor;
+}
+
+/// Access point for the deflate block boundary inflate just stopped at.
+[[nodiscard]] PackReader::AccessPoint make_access_point(const z_stream& stream,
+                                                       std::uint64_t in,
+                                                       std::uint64_t out,
+                                                       std::span<const char> window)
+{
+    // The circular window is filled up to kWindowSize - avail_out; older data follows it.
+    const std::size_t split = window.size() - stream.avail_out;
+    std::string history;
+    history.reserve(window.size());
+    history.append(window.data() + split, window.size() - split);
+    history.append(window.data(), split);
+    const auto kept = static_cast<std::size_t>(std::min<std::uint64_t>(out, window.size()));
+    return PackReader::AccessPoint{.out = out,
+                                   .in = in,
+                                   .bits = stream.data_type & 7,
+                                   .window = history.substr(history.size() - kept)};
+}
+
+/// Decompress @p compressed once, recording tar members and access points.
+[[nodiscard]] Result<PackIndex> build_index(std::string_view compressed, const fs::path& path)
+{
+    z_stream stream{};
+    if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+        return std::unexpected(Error::make("IOError", "Failed to initialize inflate"));
+    }
+    struct StreamGuard
+    {
+        explicit StreamGuard(z_stream* s)
+            : stream(s)
+        {}
+        StreamGuard(const StreamGuard&) = delete;
+        StreamGuard& operator=(const StreamGuard&) = delete;
+        StreamGuard(StreamGuard&&) = delete;
+        StreamGuard& operator=(StreamGuard&&) = delete;
+        ~StreamGuard() { inflateEnd(stream); }
+        z_stream* stream;
+    } guard(&stream);
+
+    PackIndex index;
+    TarScanner scanner(path);
+    std::array<char, kWindowSize> window{};
+    std::size_t position = 0;
+    std::uint64_t total_in = 0;
+    std::uint64_t total_out = 0;
+    std::uint64_t last_point = 0;
+    int ret = Z_OK;
+    while (ret != Z_STREAM_END) {
+        if (stream.avail_out == 0) {
+            stream.next_out = as_bytes(window.data());
+            stream.avail_out = static_cast<uInt>(window.size());
+        }
+        if (stream.avail_in == 0) {
+            const auto take = std::min(compressed.size() - position, kMaxInflateInput);
+            if (take == 0) {
+                return std::unexpected(invalid_pack(path, "Truncated gzip data"));
+            }
+            stream.next_in = as_bytes(compressed.data() + position);
+            stream.avail_in = static_cast<uInt>(take);
+            position += take;
+        }
+        const auto in_before = stream.avail_in;
+        const auto out_before = stream.avail_out;
+        const auto* produced_at = stream.next_out;
+        ret = inflate(&stream, Z_BLOCK);
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            return std::unexpected(invalid_pack(path, "Corrupt gzip data"));
+        }
+        total_in += in_before - stream.avail_in;
+        const auto produced = out_before - stream.avail_out;
+        total_out += produced;
+        const std::string_view bytes(
+            static_cast<const char*>(static_cast<const void*>(produced_at)), produced);
+        if (auto fed = scanner.feed(bytes); !fed) {
+            return std::unexpected(fed.error());
+        }
+
+        // The first boundary is the end of the gzip header, at uncompressed offset 0.
+        const bool block_boundary = (stream.data_type & 128) != 0 && (stream.data_type & 64) == 0;
+        if (ret != Z_STREAM_END && block_boundary
+            && (index.points.empty() ? total_out == 0 : total_out - last_point > kAccessSpan)) {
+            index.points.push_back(make_access_point(stream, total_in, total_out, window));
+            last_point = total_out;
+        }
+    }
+    if (!scanner.complete()) {
+        return std::unexpected(invalid_pack(path, "Truncated tar data"));
+    }
+    if (index.points.empty()) {
+        return std::unexpected(invalid_pack(path, "Empty gzip stream"));
+    }
+
+    index.members = scanner.take_members();
+    // Later members replace earlier ones with the same name, as on extraction.
+    std::ranges::stable_sort(index.members, {}, &PackMember::name);
+    auto last = std::unique(index.members.rbegin(),
+                            index.members.rend(),
+                            [](const PackMember& a, const PackMember& b) {
+                                return a.name == b.name;
+                            });
+    index.members.erase(index.members.begin(), last.base());
+    return index;
+}
+
+/// The sidecar index of @p path, unless it is missing, older than the archive or stale.
+[[nodiscard]] std::optional<PackIndex> load_index(const fs::path& path, std::string_view compressed)
+{
+    const auto index_path = pack_index_path(path);
+    std::error_code ec;
+    const auto archive_time = fs::last_write_time(path, ec);
+    const auto index_time = ec ? archive_time : fs::last_write_time(index_path, ec);
+    if (ec || index_time < archive_time) {
+        return std::nullopt;
+    }
+    auto bytes = common::MappedFile::open(index_path);
+    if (!bytes) {
+        return std::nullopt;
+    }
+    auto index = parse_pack_index(bytes->view(), compressed);
+    if (!index) {
+        return std::nullopt;
+    }
+    return std::move(*index);
+}
+
+}  // namespace
+
+bool is_pack_archive(const fs::path& path)
+{
+    const auto name = path.filename().string();
+    return name.ends_with(".tar.gz") || name.ends_with(".tgz");
+}
+
+fs::path pack_index_path(const fs::path& archive)
+{
+    auto path = archive;
+    path += ".idx";
+    return path;
+}
+
+PackReader::PackReader(fs::path path, common::MappedFile archive)
+    : m_path(std::move(path))
+    , m_archive(std::move(archive))
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    , m_members()
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    , m_points()
+{}
+
+Result<PackReader> PackReader::open(const fs::path& archive)
+{
+    auto mapped = common::MappedFile::open(archive);
+    if (!mapped) {
+        return std::unexpected(mapped.error());
+    }
+    PackReader reader(archive, std::move(*mapped));
+    if (auto loaded = load_index(reader.m_path, reader.m_archive.view())) {
+        reader.m_members = std::move(loaded->members);
+        reader.m_points = std::move(loaded->points);
+        return reader;
+    }
+    auto index = build_index(reader.m_archive.view(), reader.m_path);
+    if (!index) {
+        return std::unexpected(index.error());
+    }
+    reader.m_members = std::move(index->members);
+    reader.m_points = std::move(index->points);
+    return reader;
+}
+
+const PackMember* PackReader::find(std::string_view name) const
+{
+    auto it = std::ranges::lower_bound(m_members, name, {}, &PackMember::name);
+    if (it == m_members.end() || it->name != name) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+Result<std::string> PackReader::read(std::string_view name) const
+{
+    const auto* member = find(name);
+    if (member == nullptr) {
+        return std::unexpected(Error::make(
+            "IOError", "Pack member not found: " + m_path.string() + ":" + std::string(name)));
+    }
+    return read_member(*member);
+}
+
+Result<std::string> PackReader::read_member(const PackMember& member) const
+{
+    auto cursor = open_cursor(m_archive.view(), m_path, m_points, member);
+    if (!cursor) {
+        return std::unexpected(cursor.error());
+    }
+    std::string contents;
+    if (auto read = (*cursor)->read(member.size, contents); !read) {
+        return std::unexpected(read.error());
+    }
+    return contents;
+}
+
+struct PackReader::MemberStream::State
+{
+    const PackReader* reader = nullptr;
+    const PackMember* member = nullptr;
+    std::uint64_t position = 0;
+    std::unique_ptr<InflateCursor> cursor = nullptr;
+};
+
+PackReader::MemberStream::MemberStream(std::unique_ptr<State> state)
+    : m_state(std::move(state))
+{}
+
+PackReader::MemberStream::MemberStream(MemberStream&&) noexcept = default;
+PackReader::MemberStream& PackReader::MemberStream::operator=(MemberStream&&) noexcept = default;
+PackReader::MemberStream::~MemberStream() = default;
+
+Result<std::size_t> PackReader::MemberStream::read(std::span<char> dest)
+{
+    auto& state = *m_state;
+    if (!state.cursor) {
+        auto cursor = open_cursor(state.reader->m_archive.view(),
+                                  state.reader->m_path,
+                                  state.reader->m_points,
+                                  *state.member);
+        if (!cursor) {
+            return std::unexpected(cursor.error());
+        }
+        state.cursor = std::move(*cursor);
+    }
+    const auto take = static_cast<std::size_t>(
+        std::min<std::uint64_t>(dest.size(), state.member->size - state.position));
+    if (auto read = state.cursor->read(dest.first(take)); !read) {
+        return std::unexpected(read.error());
+    }
+    state.position += take;
+    return take;
+}
+
+VoidResult PackReader::MemberStream::rewind()
+{
+    // The cursor is reopened at the member by the next read.
+    m_state->cursor.reset();
+    m_state->position = 0;
+    return {};
+}
+
+Result<PackReader::MemberStream> PackReader::open_member(std::string_view name) const
+{
+    const auto* member = find(name);
+    if (member == nullptr) {
+        return std::unexpected(Error::make(
+            "IOError", "Pack member not found: " + m_path.string() + ":" + std::string(name)));
+    }
+    return MemberStream(std::make_unique<MemberStream::State>(
+        MemberStream::State{.reader = this, .member = member, .position = 0, .cursor = nullptr}));
+}
+
+VoidResult
+PackReader::read_each(const std::function<bool(const PackMember&)>& wanted,
+                      const std::function<VoidResult(const PackMember&, std::string)>& sink) const
+{
+    std::vector<const PackMember*> selected;
+    for (const auto& member : m_members) {
+        if (wanted(member)) {
+            selected.push_back(&member);
+        }
+    }
+    if (selected.empty()) {
+        return {};
+    }
+    std::ranges::sort(selected, {}, &PackMember::offset);
+
+    InflateCursor cursor(m_archive.view(), m_path);
+    if (auto started = cursor.start(m_points.front()); !started) {
+        return started;
+    }
+    std::uint64_t position = m_points.front().out;
+    for (const auto* member : selected) {
+        if (auto skipped = cursor.skip(member->offset - position); !skipped) {
+            return skipped;
+        }
+        std::string contents;
+        if (auto read = cursor.read(member->size, contents); !read) {
+            return read;
+        }
+        position = member->offset + member->size;
+        if (auto sunk = sink(*member, std::move(contents)); !sunk) {
+            return sunk;
+        }
+    }
+    return {};
+}
+
+}  // namespace sappp::pack
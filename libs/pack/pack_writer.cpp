@@ -0,0 +1,549 @@
+/**
+ * @file pack_writer.cpp
+ * @brief Deterministic ustar + parallel block gzip writer for reproducibility packs
+ */
+
+#include "pack_index.hpp"
+
+#include "sappp/mapped_file.hpp"
+#include "sappp/pack.hpp"
+#include "sappp/parallel.hpp"
+#include "sappp/trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <set>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#define ZLIB_CONST
+#include <zlib.h>
+
+namespace sappp::pack {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr std::size_t kTarBlockSize = 512;
+constexpr std::uint64_t kMaxMemberSize = 077777777777;  // 11 octal digits in the size field
+// Uncompressed bytes per deflate block; fixed so the output is independent of --jobs.
+constexpr std::size_t kCompressBlockSize = std::size_t{128} * 1024;
+constexpr std::size_t kDictionarySize = std::size_t{32} * 1024;
+constexpr std::size_t kBlocksPerWorker = 4;
+// Every second block starts without a dictionary, giving PackReader an access point that
+// needs no stored window every 256 KiB of the tar stream.
+constexpr std::size_t kBlocksPerAccessPoint = 2;
+// Deflate, no flags, zero mtime, no extra flags, OS = Unix (as written by `gzip -n`).
+constexpr std::string_view kGzipHeader{"\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\x03", 10};
+
+[[nodiscard]] Error io_error(const fs::path& path, std::string_view what)
+{
+    return Error::make("IOError", std::string(what) + ": " + path.string());
+}
+
+[[nodiscard]] Error invalid_entry(std::string_view name, std::string_view what)
+{
+    return Error::make("InvalidPackEntry", std::string(what) + ": " + std::string(name));
+}
+
+[[nodiscard]] bool is_valid_name(std::string_view name)
+{
+    if (name.empty() || name.front() == '/' || name.contains('\0')) {
+        return false;
+    }
+    std::size_t start = 0;
+    while (start <= name.size()) {
+        const auto end = std::min(name.find('/', start), name.size());
+        const auto component = name.substr(start, end - start);
+        if (component.empty() || component == "." || component == "..") {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+// --- ustar headers ---------------------------------------------------------
+
+using TarHeader = std::array<char, kTarBlockSize>;
+
+void put_field(TarHeader& header, std::size_t offset, std::size_t width, std::string_view value)
+{
+    std::ranges::copy(value.substr(0, width), header.begin() + static_cast<std::ptrdiff_t>(offset));
+}
+
+/// Zero-padded octal filling all but the last byte of the field, which stays NUL.
+void put_octal(TarHeader& header, std::size_t offset, std::size_t width, std::uint64_t value)
+{
+    for (std::size_t i = width - 1; i > 0; --i) {
+        header.at(offset + i - 1) = static_cast<char>('0' + (value & 7U));
+        value >>= 3U;
+    }
+}
+
+/// Split @p name into ustar (prefix, name) fields, keeping the name field as short as possible.
+[[nodiscard]] std::optional<std::pair<std::string_view, std::string_view>>
+split_ustar_name(std::string_view name)
+{
+    constexpr std::size_t kNameWidth = 100;
+    constexpr std::size_t kPrefixWidth = 155;
+    if (name.size() <= kNameWidth) {
+        return std::pair{std::string_view{}, name};
+    }
+    // Directory names carry a trailing '/', which must stay in the name field.
+    auto slash = name.rfind('/', name.size() - 2);
+    while (slash != std::string_view::npos && slash > kPrefixWidth) {
+        slash = slash == 0 ? std::string_view::npos : name.rfind('/', slash - 1);
+    }
+    if (slash == std::string_view::npos || name.size() - slash - 1 > kNameWidth) {
+        return std::nullopt;
+    }
+    return std::pair{name.substr(0, slash), name.substr(slash + 1)};
+}
+
+[[nodiscard]] Result<TarHeader>
+make_header(std::string_view tar_name, std::uint64_t size, bool is_dir)
+{
+    auto fields = split_ustar_name(tar_name);
+    if (!fields) {
+        return std::unexpected(invalid_entry(tar_name, "Name does not fit a ustar header"));
+    }
+    if (size > kMaxMemberSize) {
+        return std::unexpected(invalid_entry(tar_name, "File too large for a ustar member"));
+    }
+    TarHeader header{};
+    put_field(header, 0, 100, fields->second);
+    put_octal(header, 100, 8, is_dir ? 0755U : 0644U);
+    put_octal(header, 108, 8, 0);   // uid
+    put_octal(header, 116, 8, 0);   // gid
+    put_octal(header, 124, 12, size);
+    put_octal(header, 136, 12, 0);  // mtime
+    header.at(156) = is_dir ? '5' : '0';
+    put_field(header, 257, 6, std::string_view("ustar\0", 6));
+    put_field(header, 263, 2, "00");
+    put_octal(header, 329, 8, 0);  // devmajor
+    put_octal(header, 337, 8, 0);  // devminor
+    put_field(header, 345, 155, fields->first);
+
+    // The checksum is computed with its own field filled with spaces.
+    std::ranges::fill(std::span(header).subspan(148, 8), ' ');
+    std::uint64_t checksum = 0;
+    for (const char c : header) {
+        checksum += static_cast<unsigned char>(c);
+    }
+    put_octal(header, 148, 7, checksum);
+    return header;
+}
+
+// --- parallel block gzip ---------------------------------------------------
+
+struct CompressedBlock
+{
+    std::string data = {};
+    uLong crc = 0;
+};
+
+[[nodiscard]] Result<CompressedBlock>
+deflate_block(std::string_view input, std::string_view dictionary, int level, bool last)
+{
+    z_stream stream{};
+    if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return std::unexpected(Error::make("IOError", "Failed to initialize deflate"));
+    }
+    const auto* dictionary_bytes =
+        static_cast<const Bytef*>(static_cast<const void*>(dictionary.data()));
+    if (!dictionary.empty()
+        && deflateSetDictionary(&stream, dictionary_bytes, static_cast<uInt>(dictionary.size()))
+               != Z_OK) {
+        deflateEnd(&stream);
+        return std::unexpected(Error::make("IOError", "Failed to prime deflate dictionary"));
+    }
+
+    CompressedBlock block;
+    const auto* input_bytes = static_cast<const Bytef*>(static_cast<const void*>(input.data()));
+    block.crc = crc32(0, input_bytes, static_cast<uInt>(input.size()));
+    stream.next_in = input_bytes;
+    stream.avail_in = static_cast<uInt>(input.size());
+    // Non-final blocks end byte-aligned with a sync marker so they can be concatenated.
+    const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    std::array<char, std::size_t{64} * 1024> chunk{};
+    do {
+        stream.next_out = static_cast<Bytef*>(static_cast<void*>(chunk.data()));
+        stream.avail_out = static_cast<uInt>(chunk.size());
+        if (deflate(&stream, flush) == Z_STREAM_ERROR) {
+            deflateEnd(&stream);
+            return std::unexpected(Error::make("IOError", "Failed to deflate pack data"));
+        }
+        block.data.append(chunk.data(), chunk.size() - stream.avail_out);
+    } while (stream.avail_out == 0);
+    deflateEnd(&stream);
+    return block;
+}
+
+/// Buffers the tar stream into fixed-size blocks and writes one gzip member.
+class GzipBlockWriter
+{
+public:
+    GzipBlockWriter(std::ofstream& out, fs::path path, std::size_t jobs, int level)
+        : m_out(&out)
+        , m_path(std::move(path))
+        , m_workers(jobs == 0 ? std::max(1U, std::thread::hardware_concurrency()) : jobs)
+        , m_level(level)
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_pending()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_current()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_dictionary()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_points()
+    {
+        m_current.reserve(kCompressBlockSize);
+        write_raw(kGzipHeader);
+    }
+
+    GzipBlockWriter(const GzipBlockWriter&) = delete;
+    GzipBlockWriter& operator=(const GzipBlockWriter&) = delete;
+    GzipBlockWriter(GzipBlockWriter&&) = delete;
+    GzipBlockWriter& operator=(GzipBlockWriter&&) = delete;
+    ~GzipBlockWriter() = default;
+
+    /// Uncompressed bytes accepted so far (the tar offset of the next write).
+    [[nodiscard]] std::uint64_t offset() const noexcept { return m_offset; }
+
+    [[nodiscard]] VoidResult write(std::string_view bytes)
+    {
+        m_offset += bytes.size();
+        while (!bytes.empty()) {
+            const auto take = std::min(bytes.size(), kCompressBlockSize - m_current.size());
+            m_current.append(bytes.substr(0, take));
+            bytes.remove_prefix(take);
+            if (m_current.size() == kCompressBlockSize) {
+                m_pending.push_back(std::exchange(m_current, std::string{}));
+                m_current.reserve(kCompressBlockSize);
+                if (m_pending.size() >= m_workers * kBlocksPerWorker) {
+                    if (auto flushed = flush_pending(false); !flushed) {
+                        return flushed;
+                    }
+                }
+            }
+        }
+        return {};
+    }
+
+    [[nodiscard]] VoidResult write_zeros(std::size_t count)
+    {
+        static constexpr std::array<char, kTarBlockSize * 2> kZeros{};
+        while (count > 0) {
+            const auto take = std::min(count, kZeros.size());
+            if (auto written = write(std::string_view(kZeros.data(), take)); !written) {
+                return written;
+            }
+            count -= take;
+        }
+        return {};
+    }
+
+    /// Compress the remaining input as the final block and append the gzip trailer.
+    [[nodiscard]] VoidResult finish()
+    {
+        m_pending.push_back(std::move(m_current));
+        if (auto flushed = flush_pending(true); !flushed) {
+            return flushed;
+        }
+        std::array<char, 8> trailer{};
+        for (std::size_t i = 0; i < 4; ++i) {
+            trailer.at(i) = static_cast<char>((m_crc >> (8 * i)) & 0xffU);
+            trailer.at(4 + i) = static_cast<char>((m_total >> (8 * i)) & 0xffU);
+        }
+        write_raw(std::string_view(trailer.data(), trailer.size()));
+        m_compressed += trailer.size();
+        m_out->flush();
+        if (!*m_out) {
+            return std::unexpected(io_error(m_path, "Failed to write file"));
+        }
+        return {};
+    }
+
+    /// Archive-level fields and access points of the finished stream.
+    [[nodiscard]] PackIndex take_index()
+    {
+        return PackIndex{.archive_size = m_compressed,
+                         .stream_size = m_total,
+                         .crc = m_crc,
+                         .members = {},
+                         .points = std::move(m_points)};
+    }
+
+private:
+    [[nodiscard]] bool is_access_point(std::size_t pending_index) const noexcept
+    {
+        return (m_blocks + pending_index) % kBlocksPerAccessPoint == 0;
+    }
+
+    void write_raw(std::string_view bytes)
+    {
+        m_out->write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    // NOLINTNEXTLINE(readability-function-size) - compress, then join in block order.
+    [[nodiscard]] VoidResult flush_pending(bool last)
+    {
+        // Each block is primed with the tail of the block before it, so the dictionaries
+        // (and therefore the output) depend only on the input, not on the batching.
+        std::vector<std::string_view> dictionaries(m_pending.size());
+        std::string_view previous = m_dictionary;
+        for (std::size_t i = 0; i < m_pending.size(); ++i) {
+            dictionaries[i] = is_access_point(i) ? std::string_view{} : previous;
+            previous = std::string_view(m_pending[i]);
+            if (previous.size() > kDictionarySize) {
+                previous = previous.substr(previous.size() - kDictionarySize);
+            }
+        }
+
+        std::vector<CompressedBlock> blocks(m_pending.size());
+        auto compressed = common::parallel_for_each_index(
+            m_pending.size(),
+            m_workers,
+            [&](std::size_t i) -> VoidResult {
+                const common::trace::Span span("pack", "deflate_block");
+                const bool final_block = last && i + 1 == m_pending.size();
+                auto block = deflate_block(m_pending[i], dictionaries[i], m_level, final_block);
+                if (!block) {
+                    return std::unexpected(block.error());
+                }
+                blocks[i] = std::move(*block);
+                return {};
+            });
+        if (!compressed) {
+            return std::unexpected(compressed.error());
+        }
+
+        for (std::size_t i = 0; i < m_pending.size(); ++i) {
+            // Blocks end byte-aligned, so the inflater needs neither bits nor a window here.
+            if (is_access_point(i) && !m_pending[i].empty()) {
+                m_points.push_back(PackReader::AccessPoint{.out = m_total,
+                                                           .in = m_compressed,
+                                                           .bits = 0,
+                                                           .window = {}});
+            }
+            write_raw(blocks[i].data);
+            m_compressed += blocks[i].data.size();
+            m_crc = crc32_combine(m_crc, blocks[i].crc, static_cast<z_off_t>(m_pending[i].size()));
+            m_total += m_pending[i].size();
+        }
+        if (!*m_out) {
+            return std::unexpected(io_error(m_path, "Failed to write file"));
+        }
+        m_dictionary.assign(previous);
+        m_blocks += m_pending.size();
+        m_pending.clear();
+        return {};
+    }
+
+    std::ofstream* m_out;
+    fs::path m_path;
+    std::size_t m_workers;
+    int m_level;
+    std::vector<std::string> m_pending;
+    std::string m_current;
+    std::string m_dictionary;
+    uLong m_crc = 0;
+    std::uint64_t m_total = 0;
+    std::uint64_t m_offset = 0;
+    std::uint64_t m_compressed = kGzipHeader.size();
+    std::size_t m_blocks = 0;
+    std::vector<PackReader::AccessPoint> m_points;
+};
+
+struct TarMember
+{
+    std::string tar_name;
+    const PackEntry* entry = nullptr;  // nullptr for directories
+};
+
+[[nodiscard]] Result<std::vector<TarMember>> plan_members(const std::vector<PackEntry>& entries)
+{
+    std::set<std::string_view> files;
+    std::set<std::string> directories;
+    for (const auto& entry : entries) {
+        if (!is_valid_name(entry.name)) {
+            return std::unexpected(invalid_entry(entry.name, "Invalid archive path"));
+        }
+        if (!files.insert(entry.name).second) {
+            return std::unexpected(invalid_entry(entry.name, "Duplicate archive path"));
+        }
+        for (auto slash = entry.name.find('/'); slash != std::string::npos;
+             slash = entry.name.find('/', slash + 1)) {
+            directories.insert(entry.name.substr(0, slash));
+        }
+    }
+
+    std::vector<TarMember> members;
+    members.reserve(entries.size() + directories.size());
+    for (const auto& directory : directories) {
+        if (files.contains(directory)) {
+            return std::unexpected(invalid_entry(directory, "Archive path is also a directory"));
+        }
+        members.push_back(TarMember{.tar_name = directory + "/", .entry = nullptr});
+    }
+    for (const auto& entry : entries) {
+        members.push_back(TarMember{.tar_name = entry.name, .entry = &entry});
+    }
+    std::ranges::sort(members, [](const TarMember& a, const TarMember& b) noexcept {
+        return a.tar_name < b.tar_name;
+    });
+    return members;
+}
+
+/// Write @p member, recording regular files in @p indexed.
+[[nodiscard]] VoidResult
+write_member(GzipBlockWriter& gzip, const TarMember& member, std::vector<PackMember>& indexed)
+{
+    const common::trace::Span span("pack", "member", member.tar_name);
+    if (member.entry == nullptr) {
+        auto header = make_header(member.tar_name, 0, true);
+        if (!header) {
+            return std::unexpected(header.error());
+        }
+        return gzip.write(std::string_view(header->data(), header->size()));
+    }
+
+    std::optional<common::MappedFile> mapped;
+    std::string_view contents;
+    if (member.entry->contents) {
+        contents = *member.entry->contents;
+    } else {
+        auto opened = common::MappedFile::open(member.entry->source);
+        if (!opened) {
+            return std::unexpected(opened.error());
+        }
+        mapped.emplace(std::move(*opened));
+        contents = mapped->view();
+    }
+    const auto& expected = member.entry->expected;
+    const auto changed = [&member](std::string_view what) {
+        return Error::make("IOError",
+                           "File changed while packing (" + std::string(what)
+                               + " differs from the recorded value): "
+                               + member.entry->source.string());
+    };
+    if (expected && expected->size != contents.size()) {
+        return std::unexpected(changed("size"));
+    }
+    auto header = make_header(member.tar_name, contents.size(), false);
+    if (!header) {
+        return std::unexpected(header.error());
+    }
+    if (auto written = gzip.write(std::string_view(header->data(), header->size())); !written) {
+        return written;
+    }
+    indexed.push_back(
+        PackMember{.name = member.tar_name, .offset = gzip.offset(), .size = contents.size()});
+    if (!expected) {
+        if (auto written = gzip.write(contents); !written) {
+            return written;
+        }
+    } else {
+        // Hash each piece right before it is archived, so the digest covers what was written.
+        common::Sha256Hasher hasher;
+        for (std::size_t pos = 0; pos < contents.size(); pos += kCompressBlockSize) {
+            const auto piece = contents.substr(pos, kCompressBlockSize);
+            hasher.update(piece);
+            if (auto written = gzip.write(piece); !written) {
+                return written;
+            }
+        }
+        if ("sha256:" + hasher.finish() != expected->sha256) {
+            return std::unexpected(changed("sha256"));
+        }
+    }
+    const auto remainder = contents.size() % kTarBlockSize;
+    return gzip.write_zeros(remainder == 0 ? 0 : kTarBlockSize - remainder);
+}
+
+}  // namespace
+
+VoidResult write_pack(const fs::path& output,
+                      std::vector<PackEntry> entries,
+                      const PackWriteOptions& options)
+{
+    const common::trace::Span span("pack", "write_pack", [&output] { return output.string(); });
+    auto members = plan_members(entries);
+    if (!members) {
+        return std::unexpected(members.error());
+    }
+
+    std::error_code ec;
+    if (output.has_parent_path()) {
+        fs::create_directories(output.parent_path(), ec);
+        if (ec) {
+            return std::unexpected(io_error(output.parent_path(), "Failed to create directory"));
+        }
+    }
+    fs::path temp_path = output;
+    temp_path += ".tmp";
+    const fs::path index_path = pack_index_path(output);
+    fs::path temp_index_path = index_path;
+    temp_index_path += ".tmp";
+    VoidResult written = {};
+    PackIndex index;
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return std::unexpected(io_error(temp_path, "Failed to write file"));
+        }
+        GzipBlockWriter gzip(out, temp_path, options.jobs, options.level);
+        std::vector<PackMember> indexed;
+        for (const auto& member : *members) {
+            written = write_member(gzip, member, indexed);
+            if (!written) {
+                break;
+            }
+        }
+        if (written) {
+            // End-of-archive marker: two zero blocks.
+            written = gzip.write_zeros(kTarBlockSize * 2);
+        }
+        if (written) {
+            written = gzip.finish();
+        }
+        index = gzip.take_index();
+        index.members = std::move(indexed);
+    }
+    if (written) {
+        // The index is written after the archive, so it is never older than it.
+        std::ofstream out(temp_index_path, std::ios::binary | std::ios::trunc);
+        const std::string bytes = serialize_pack_index(index);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        out.close();
+        if (!out) {
+            written = std::unexpected(io_error(temp_index_path, "Failed to write file"));
+        }
+    }
+    if (!written) {
+        fs::remove(temp_path, ec);
+        fs::remove(temp_index_path, ec);
+        return written;
+    }
+    fs::rename(temp_path, output, ec);
+    if (ec) {
+        fs::remove(temp_path, ec);
+        fs::remove(temp_index_path, ec);
+        return std::unexpected(io_error(output, "Failed to replace file"));
+    }
+    fs::rename(temp_index_path, index_path, ec);
+    if (ec) {
+        fs::remove(temp_index_path, ec);
+        return std::unexpected(io_error(index_path, "Failed to replace file"));
+    }
+    return {};
+}
+
+}  // namespace sappp::pack
@@ -11,13 +11,18 @@
 
 #include "sappp/canonical_json.hpp"
 #include "sappp/common.hpp"
+#include "sappp/file_hash_cache.hpp"
+#include "sappp/parallel.hpp"
+#include "sappp/trace.hpp"
 #include "sappp/version.hpp"
 
 #include <algorithm>
 #include <cctype>
+#include <cstddef>
 #include <filesystem>
-#include <fstream>
 #include <iterator>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <ranges>
 #include <string>
@@ -29,15 +34,63 @@ namespace sappp::po {
 
 namespace {
 
-sappp::Result<std::string> read_file_contents(const std::string& path)
+constexpr std::string_view kFunctionDigestsFormat = "po_function_digests.v1";
+
+/// Source file digests shared by the per-function workers; each path is resolved once
+/// per run through the persistent FileHashCache.
+class SourceHashCache
 {
-    std::ifstream in(path, std::ios::binary);
-    if (!in) {
-        return std::unexpected(
-            Error::make("SourceFileOpenFailed", "Failed to open source file: " + path));
+public:
+    explicit SourceHashCache(common::FileHashCache& files)
+        : m_files(files)
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_mutex()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_entries()
+    {}
+
+    [[nodiscard]] sappp::Result<std::string> digest(const std::string& file_path)
+    {
+        Entry& entry = find_or_create(file_path);
+        std::call_once(entry.once, [&] {
+            if (auto digest = m_files.digest(file_path)) {
+                entry.digest = std::move(*digest);
+                return;
+            }
+            entry.digest = std::unexpected(
+                Error::make("SourceFileOpenFailed", "Failed to open source file: " + file_path));
+        });
+        return entry.digest;
     }
-    return std::string{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
-}
+
+private:
+    struct Entry
+    {
+        std::once_flag once;
+        sappp::Result<std::string> digest;
+
+        Entry()
+            // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+            : once()
+            // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+            , digest()
+        {}
+    };
+
+    [[nodiscard]] Entry& find_or_create(const std::string& file_path)
+    {
+        std::lock_guard lock(m_mutex);
+        auto& slot = m_entries[file_path];
+        if (!slot) {
+            slot = std::make_unique<Entry>();
+        }
+        return *slot;
+    }
+
+    common::FileHashCache& m_files;
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> m_entries;
+};
 
 std::string normalize_kind_token(std::string token)
 {
@@ -150,7 +203,7 @@ std::optional<std::string> resolve_po_kind(const nlohmann::json& inst, std::stri
 // Keep as a single block to mirror schema construction steps.
 sappp::Result<nlohmann::json> build_repo_identity(  // NOLINT(readability-function-size)
     const nlohmann::json& inst,
-    std::unordered_map<std::string, std::string>& file_hashes)
+    SourceHashCache& file_hashes)
 {
     std::string path = "unknown";
     std::string content_hash = common::sha256_prefixed("");
@@ -160,16 +213,11 @@ sappp::Result<nlohmann::json> build_repo_identity(  // NOLINT(readability-functi
         if (src.contains("file") && src.at("file").is_string()) {
             std::string file_path = src.at("file").get<std::string>();
             path = common::normalize_path(file_path);
-            auto it = file_hashes.find(file_path);
-            if (it == file_hashes.end()) {
-                auto contents = read_file_contents(file_path);
-                if (!contents) {
-                    return std::unexpected(contents.error());
-                }
-                std::string digest = common::sha256_prefixed(*contents);
-                it = file_hashes.emplace(file_path, std::move(digest)).first;
+            auto digest = file_hashes.digest(file_path);
+            if (!digest) {
+                return std::unexpected(digest.error());
             }
-            content_hash = it->second;
+            content_hash = std::move(*digest);
         }
     }
 
@@ -284,12 +332,136 @@ build_predicate(const std::string& op,  // NOLINT(bugprone-easily-swappable-para
     };
 }
 
+struct PoVersions
+{
+    std::string semantics_version = {};
+    std::string proof_system_version = {};
+    std::string profile_version = {};
+};
+
+// Per-function PO batch; mirrors the schema mapping step by step.
+// NOLINTNEXTLINE(readability-function-size)
+sappp::Result<std::vector<nlohmann::json>> generate_function_pos(const nlohmann::json& func,
+                                                                 const PoVersions& versions,
+                                                                 SourceHashCache& file_hashes)
+{
+    const std::string& semantics_version = versions.semantics_version;
+    const std::string& proof_system_version = versions.proof_system_version;
+    const std::string& profile_version = versions.profile_version;
+
+    std::vector<nlohmann::json> function_pos;
+    const std::string function_uid = func.at("function_uid").get<std::string>();
+    const std::string mangled_name = func.at("mangled_name").get<std::string>();
+    const auto& blocks = func.at("cfg").at("blocks");
+
+    for (const auto& block : blocks) {
+        const std::string block_id = block.at("id").get<std::string>();
+        const auto& insts = block.at("insts");
+
+        for (const auto& inst : insts) {
+            if (!inst.contains("op") || !inst.at("op").is_string()) {
+                continue;
+            }
+            const std::string op = inst.at("op").get<std::string>();
+            if (op != "ub.check" && op != "sink.marker" && !is_lifetime_op(op)) {
+                continue;
+            }
+            const std::string inst_id = inst.at("id").get<std::string>();
+            auto po_kind = resolve_po_kind(inst, op);
+            if (!po_kind) {
+                continue;
+            }
+            auto repo_identity = build_repo_identity(inst, file_hashes);
+            if (!repo_identity) {
+                return std::unexpected(repo_identity.error());
+            }
+            const nlohmann::json anchor_id = build_anchor_id(block_id, inst_id);
+
+            nlohmann::json po_id_input = {
+                {       "repo_identity",          *repo_identity},
+                {            "function", {{"usr", function_uid}}},
+                {              "anchor",               anchor_id},
+                {             "po_kind",                *po_kind},
+                {   "semantics_version",       semantics_version},
+                {"proof_system_version",    proof_system_version},
+                {     "profile_version",         profile_version}
+            };
+            auto po_id_result = canonical::hash_canonical(po_id_input);
+            if (!po_id_result) {
+                return std::unexpected(po_id_result.error());
+            }
+            const std::string po_id = *po_id_result;
+
+            auto predicate = build_predicate(op, *po_kind, inst);
+            if (!predicate) {
+                return std::unexpected(predicate.error());
+            }
+
+            nlohmann::json po_entry = {
+                {               "po_id",                                              po_id},
+                {             "po_kind",                                           *po_kind},
+                {   "semantics_version",                                  semantics_version},
+                {"proof_system_version",                               proof_system_version},
+                {     "profile_version",                                    profile_version},
+                {       "repo_identity",                                     *repo_identity},
+                {            "function", {{"usr", function_uid}, {"mangled", mangled_name}}},
+                {              "anchor",                                          anchor_id},
+                {           "predicate",                                         *predicate}
+            };
+            function_pos.push_back(std::move(po_entry));
+        }
+    }
+
+    return function_pos;
+}
+
+/// Digest of everything a function's PO entries derive from: the function NIR, the
+/// version triple and the contents of the source files its instructions reference.
+[[nodiscard]] std::optional<std::string> function_digest(const nlohmann::json& func,
+                                                         const PoVersions& versions,
+                                                         SourceHashCache& file_hashes)
+{
+    nlohmann::json sources = nlohmann::json::object();
+    for (const auto& block : func.at("cfg").at("blocks")) {
+        for (const auto& inst : block.at("insts")) {
+            if (!inst.contains("src") || !inst.at("src").is_object()) {
+                continue;
+            }
+            const auto& src = inst.at("src");
+            if (!src.contains("file") || !src.at("file").is_string()) {
+                continue;
+            }
+            std::string file_path = src.at("file").get<std::string>();
+            if (sources.contains(file_path)) {
+                continue;
+            }
+            auto digest = file_hashes.digest(file_path);
+            sources[file_path] = digest ? nlohmann::json(*digest) : nlohmann::json(nullptr);
+        }
+    }
+    const nlohmann::json input = {
+        {            "function",                            func},
+        {             "sources",                         sources},
+        {   "semantics_version",    versions.semantics_version},
+        {"proof_system_version", versions.proof_system_version},
+        {     "profile_version",      versions.profile_version}
+    };
+    auto digest = canonical::hash_canonical(input);
+    if (!digest) {
+        return std::nullopt;
+    }
+    return *digest;
+}
+
 }  // namespace
 
-// Keep as instance method for future state; structure follows schema mapping.
-// NOLINTNEXTLINE(readability-convert-member-functions-to-static, readability-function-size)
-sappp::Result<nlohmann::json> PoGenerator::generate(const nlohmann::json& nir_json) const
+// Structure follows schema mapping; per-function batches are built on m_jobs workers.
+// NOLINTNEXTLINE(readability-function-size)
+sappp::Result<PoGeneration> PoGenerator::run(const nlohmann::json& nir_json,
+                                             const nlohmann::json* previous_po_list,
+                                             const FunctionDigests* previous_digests) const
 {
+    const common::trace::Span generation_span("po", "po_generation");
     const std::string semantics_version = nir_json.at("semantics_version").get<std::string>();
     const std::string proof_system_version = nir_json.at("proof_system_version").get<std::string>();
     const std::string profile_version = nir_json.at("profile_version").get<std::string>();
@@ -310,71 +482,94 @@ sappp::Result<nlohmann::json> PoGenerator::generate(const nlohmann::json& nir_js
         output["input_digest"] = nir_json.at("input_digest");
     }
 
-    std::vector<nlohmann::json> pos;
-    std::unordered_map<std::string, std::string> file_hashes;
-
     const auto& functions = nir_json.at("functions");
-    for (const auto& func : functions) {
-        const std::string function_uid = func.at("function_uid").get<std::string>();
-        const std::string mangled_name = func.at("mangled_name").get<std::string>();
-        const auto& blocks = func.at("cfg").at("blocks");
-
-        for (const auto& block : blocks) {
-            const std::string block_id = block.at("id").get<std::string>();
-            const auto& insts = block.at("insts");
-
-            for (const auto& inst : insts) {
-                if (!inst.contains("op") || !inst.at("op").is_string()) {
-                    continue;
-                }
-                const std::string op = inst.at("op").get<std::string>();
-                if (op != "ub.check" && op != "sink.marker" && !is_lifetime_op(op)) {
-                    continue;
-                }
-                const std::string inst_id = inst.at("id").get<std::string>();
-                auto po_kind = resolve_po_kind(inst, op);
-                if (!po_kind) {
-                    continue;
-                }
-                auto repo_identity = build_repo_identity(inst, file_hashes);
-                if (!repo_identity) {
-                    return std::unexpected(repo_identity.error());
-                }
-                const nlohmann::json anchor_id = build_anchor_id(block_id, inst_id);
-
-                nlohmann::json po_id_input = {
-                    {       "repo_identity",          *repo_identity},
-                    {            "function", {{"usr", function_uid}}},
-                    {              "anchor",               anchor_id},
-                    {             "po_kind",                *po_kind},
-                    {   "semantics_version",       semantics_version},
-                    {"proof_system_version",    proof_system_version},
-                    {     "profile_version",         profile_version}
-                };
-                auto po_id_result = canonical::hash_canonical(po_id_input);
-                if (!po_id_result) {
-                    return std::unexpected(po_id_result.error());
-                }
-                const std::string po_id = *po_id_result;
+    const PoVersions versions{.semantics_version = semantics_version,
+                              .proof_system_version = proof_system_version,
+                              .profile_version = profile_version};
+    common::FileHashCache local_files;
+    SourceHashCache file_hashes(m_file_hashes != nullptr ? *m_file_hashes : local_files);
+
+    // Incremental mode: previous entries grouped by function, reusable only for function
+    // uids that are unique in this NIR (entries are attributed by function.usr).
+    const bool incremental = previous_digests != nullptr;
+    std::unordered_map<std::string, std::size_t> uid_counts;
+    std::unordered_map<std::string, std::vector<const nlohmann::json*>> previous_by_function;
+    if (incremental) {
+        for (const auto& func : functions) {
+            ++uid_counts[func.at("function_uid").get<std::string>()];
+        }
+        if (previous_po_list != nullptr && previous_po_list->contains("pos")) {
+            for (const auto& po : previous_po_list->at("pos")) {
+                previous_by_function[po.at("function").at("usr").get<std::string>()].push_back(
+                    &po);
+            }
+        }
+    }
+
+    struct FunctionBatch
+    {
+        sappp::Result<std::vector<nlohmann::json>> pos = {};
+        std::optional<std::string> digest = std::nullopt;
+        bool reused = false;
+    };
 
-                auto predicate = build_predicate(op, *po_kind, inst);
-                if (!predicate) {
-                    return std::unexpected(predicate.error());
+    auto build_batch = [&](std::size_t index, FunctionBatch& batch) {
+        const auto& func = functions.at(index);
+        const common::trace::Span span("po", "function", [&func] {
+            return func.at("function_uid").get_ref<const std::string&>();
+        });
+        if (incremental) {
+            const std::string uid = func.at("function_uid").get<std::string>();
+            batch.digest = function_digest(func, versions, file_hashes);
+            auto previous = previous_digests->find(uid);
+            if (batch.digest && uid_counts.at(uid) == 1 && previous != previous_digests->end()
+                && previous->second == *batch.digest) {
+                std::vector<nlohmann::json> reused;
+                if (auto it = previous_by_function.find(uid); it != previous_by_function.end()) {
+                    reused.reserve(it->second.size());
+                    for (const nlohmann::json* po : it->second) {
+                        reused.push_back(*po);
+                    }
                 }
+                batch.pos = std::move(reused);
+                batch.reused = true;
+                return;
+            }
+        }
+        batch.pos = generate_function_pos(func, versions, file_hashes);
+    };
 
-                nlohmann::json po_entry = {
-                    {               "po_id",                                              po_id},
-                    {             "po_kind",                                           *po_kind},
-                    {   "semantics_version",                                  semantics_version},
-                    {"proof_system_version",                               proof_system_version},
-                    {     "profile_version",                                    profile_version},
-                    {       "repo_identity",                                     *repo_identity},
-                    {            "function", {{"usr", function_uid}, {"mangled", mangled_name}}},
-                    {              "anchor",                                          anchor_id},
-                    {           "predicate",                                         *predicate}
-                };
-                pos.push_back(std::move(po_entry));
+    // Functions are independent: build their batches in parallel, then merge in
+    // function order so the stable sort below sees the same sequence as a serial run.
+    // Malformed NIR throws from json::at(); the helper carries it back to this thread.
+    std::vector<FunctionBatch> batches(functions.size());
+    auto built = common::parallel_for_each_index(
+        functions.size(),
+        m_jobs,
+        [&](std::size_t i) -> sappp::VoidResult {
+            build_batch(i, batches[i]);
+            if (!batches[i].pos) {
+                return std::unexpected(batches[i].pos.error());
             }
+            return {};
+        });
+    if (!built) {
+        return std::unexpected(built.error());
+    }
+
+    PoGeneration generation;
+    std::vector<nlohmann::json> pos;
+    for (auto [index, batch] : std::views::enumerate(batches)) {
+        std::ranges::move(*batch.pos, std::back_inserter(pos));
+        if (!incremental) {
+            continue;
+        }
+        ++(batch.reused ? generation.reused_functions : generation.regenerated_functions);
+        const std::string uid = functions.at(static_cast<std::size_t>(index))
+                                    .at("function_uid")
+                                    .get<std::string>();
+        if (batch.digest && uid_counts.at(uid) == 1) {
+            generation.function_digests.emplace(uid, std::move(*batch.digest));
         }
     }
 
@@ -383,7 +578,59 @@ sappp::Result<nlohmann::json> PoGenerator::generate(const nlohmann::json& nir_js
     });
 
     output["pos"] = std::move(pos);
-    return output;
+    generation.po_list = std::move(output);
+    return generation;
+}
+
+sappp::Result<nlohmann::json> PoGenerator::generate(const nlohmann::json& nir_json) const
+{
+    auto generation = run(nir_json, nullptr, nullptr);
+    if (!generation) {
+        return std::unexpected(generation.error());
+    }
+    return std::move(generation->po_list);
+}
+
+sappp::Result<PoGeneration>
+PoGenerator::generate_incremental(const nlohmann::json& nir_json,
+                                  const nlohmann::json& previous_po_list,
+                                  const FunctionDigests& previous_digests) const
+{
+    return run(nir_json, &previous_po_list, &previous_digests);
+}
+
+nlohmann::json function_digests_to_json(const FunctionDigests& digests,
+                                        const nlohmann::json& po_list)
+{
+    auto po_list_hash = canonical::hash_canonical(po_list);
+    return nlohmann::json{
+        {        "format",                                   kFunctionDigestsFormat},
+        {"po_list_sha256", po_list_hash ? nlohmann::json(*po_list_hash) : nullptr},
+        {     "functions",                                                 digests}
+    };
+}
+
+std::optional<FunctionDigests> function_digests_from_json(const nlohmann::json& sidecar,
+                                                          const nlohmann::json& po_list)
+{
+    if (!sidecar.is_object() || sidecar.value("format", "") != kFunctionDigestsFormat
+        || !sidecar.contains("po_list_sha256") || !sidecar.at("po_list_sha256").is_string()
+        || !sidecar.contains("functions") || !sidecar.at("functions").is_object()) {
+        return std::nullopt;
+    }
+    // Digests only describe the po_list they were recorded with.
+    auto po_list_hash = canonical::hash_canonical(po_list);
+    if (!po_list_hash || *po_list_hash != sidecar.at("po_list_sha256").get<std::string>()) {
+        return std::nullopt;
+    }
+    FunctionDigests digests;
+    for (const auto& [uid, digest] : sidecar.at("functions").items()) {
+        if (!digest.is_string()) {
+            return std::nullopt;
+        }
+        digests.emplace(uid, digest.get<std::string>());
+    }
+    return digests;
 }
 
 }  // namespace sappp::po
@@ -6,17 +6,71 @@
  */
 
 #include "sappp/common.hpp"
+#include "sappp/file_hash_cache.hpp"
+
+#include <cstddef>
+#include <map>
+#include <optional>
+#include <string>
 
 #include <nlohmann/json.hpp>
 
 namespace sappp::po {
 
+/// Per-function NIR digests (function_uid -> "sha256:<hex>") recorded alongside a po_list.
+using FunctionDigests = std::map<std::string, std::string>;
+
+struct PoGeneration
+{
+    nlohmann::json po_list = {};
+    FunctionDigests function_digests = {};
+    std::size_t reused_functions = 0;
+    std::size_t regenerated_functions = 0;
+};
+
 class PoGenerator
 {
 public:
     PoGenerator() = default;
 
+    /// @param jobs Worker threads for per-function PO generation (0 = hardware concurrency).
+    explicit PoGenerator(std::size_t jobs) noexcept
+        : m_jobs(jobs)
+    {}
+
+    /// Share a persistent source digest cache (not owned); nullptr hashes per call.
+    void set_file_hash_cache(common::FileHashCache* cache) noexcept { m_file_hashes = cache; }
+
+    /// Functions are processed in parallel; the result is identical to a serial run.
     [[nodiscard]] sappp::Result<nlohmann::json> generate(const nlohmann::json& nir_json) const;
+
+    /**
+     * @brief Regenerate only functions whose digest changed since @p previous_po_list
+     *
+     * Entries of unchanged functions are copied verbatim from @p previous_po_list; the
+     * resulting po_list is byte-identical to generate(). The returned digests seed the
+     * next incremental run.
+     */
+    [[nodiscard]] sappp::Result<PoGeneration>
+    generate_incremental(const nlohmann::json& nir_json,
+                         const nlohmann::json& previous_po_list,
+                         const FunctionDigests& previous_digests) const;
+
+private:
+    [[nodiscard]] sappp::Result<PoGeneration> run(const nlohmann::json& nir_json,
+                                                  const nlohmann::json* previous_po_list,
+                                                  const FunctionDigests* previous_digests) const;
+
+    std::size_t m_jobs = 0;
+    common::FileHashCache* m_file_hashes = nullptr;
 };
 
+/// Sidecar document binding @p digests to the po_list they were recorded with.
+[[nodiscard]] nlohmann::json function_digests_to_json(const FunctionDigests& digests,
+                                                      const nlohmann::json& po_list);
+
+/// Digests from a sidecar, or std::nullopt when it is malformed or describes another po_list.
+[[nodiscard]] std::optional<FunctionDigests>
+function_digests_from_json(const nlohmann::json& sidecar, const nlohmann::json& po_list);
+
 }  // namespace sappp::po
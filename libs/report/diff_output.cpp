@@ -0,0 +1,206 @@
+/**
+ * @file diff_output.cpp
+ * @brief Streaming validated_results scans and diff.json output
+ */
+
+#include "sappp/canonical_json.hpp"
+#include "sappp/report.hpp"
+#include "sappp/schema_validate.hpp"
+
+#include <format>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace sappp::report {
+
+sappp::VoidResult
+write_canonical_with_array(const nlohmann::json& header,
+                           std::string_view array_key,
+                           const ChunkSink& out,
+                           const std::function<sappp::VoidResult()>& write_elements)
+{
+    bool first = true;
+    bool array_written = false;
+    auto write_key = [&out, &first](std::string_view key) -> sappp::VoidResult {
+        auto canonical_key = sappp::canonical::canonicalize(nlohmann::json(key));
+        if (!canonical_key) {
+            return std::unexpected(canonical_key.error());
+        }
+        out(first ? "{" : ",");
+        out(*canonical_key);
+        out(":");
+        first = false;
+        return {};
+    };
+    auto write_array = [&]() -> sappp::VoidResult {
+        if (auto key = write_key(array_key); !key) {
+            return key;
+        }
+        out("[");
+        if (auto elements = write_elements(); !elements) {
+            return elements;
+        }
+        out("]");
+        array_written = true;
+        return {};
+    };
+
+    for (const auto& [key, value] : header.items()) {
+        if (!array_written && key > array_key) {
+            if (auto written = write_array(); !written) {
+                return written;
+            }
+        }
+        auto canonical_value = sappp::canonical::canonicalize(value);
+        if (!canonical_value) {
+            return std::unexpected(canonical_value.error());
+        }
+        if (auto written = write_key(key); !written) {
+            return written;
+        }
+        out(*canonical_value);
+    }
+    if (!array_written) {
+        if (auto written = write_array(); !written) {
+            return written;
+        }
+    }
+    out("}");
+    return {};
+}
+
+sappp::Result<DiffResultsScan> scan_diff_results(ResultsReader& reader,
+                                                 const sappp::common::SchemaValidator& schema,
+                                                 std::string_view schema_name)
+{
+    auto schema_error = [schema_name](std::string_view where, const sappp::Error& error) {
+        return sappp::Error::make("SchemaInvalid",
+                                  std::format("{}: {}{}", schema_name, where, error.message));
+    };
+    nlohmann::json wrapper = reader.header();
+    if (!reader.has_results()) {
+        if (auto checked = schema.validate(wrapper); !checked) {
+            return std::unexpected(schema_error("", checked.error()));
+        }
+    }
+    wrapper["results"] = nlohmann::json::array({nullptr});
+
+    DiffResultsScan scan{.digest = {}, .sorted = true};
+    std::string previous_po_id;
+    std::size_t count = 0;
+    sappp::common::Sha256Hasher hasher;
+    auto hashed = write_canonical_with_array(
+        reader.header(),
+        "results",
+        [&hasher](std::string_view chunk) { hasher.update(chunk); },
+        [&]() -> sappp::VoidResult {
+            reader.rewind();
+            while (true) {
+                auto item = reader.next();
+                if (!item) {
+                    return std::unexpected(item.error());
+                }
+                if (!item->has_value()) {
+                    break;
+                }
+                nlohmann::json& slot = wrapper["results"][0];
+                slot = std::move(**item);
+                if (auto checked = schema.validate(wrapper); !checked) {
+                    return std::unexpected(
+                        schema_error(std::format("results[{}]: ", count), checked.error()));
+                }
+                if (auto po_id = slot.find("po_id"); po_id != slot.end() && po_id->is_string()) {
+                    const auto& id = po_id->get_ref<const std::string&>();
+                    scan.sorted = scan.sorted && previous_po_id <= id;
+                    previous_po_id = id;
+                }
+                auto canonical = sappp::canonical::canonicalize(slot);
+                if (!canonical) {
+                    return std::unexpected(canonical.error());
+                }
+                hasher.update(count == 0 ? "" : ",");
+                hasher.update(*canonical);
+                ++count;
+            }
+            return {};
+        });
+    if (!hashed) {
+        return std::unexpected(hashed.error());
+    }
+    if (reader.has_results() && count == 0) {
+        wrapper["results"] = nlohmann::json::array();
+        if (auto checked = schema.validate(wrapper); !checked) {
+            return std::unexpected(schema_error("", checked.error()));
+        }
+    }
+    scan.digest = "sha256:" + hasher.finish();
+    return scan;
+}
+
+sappp::VoidResult write_diff_json(const std::filesystem::path& path,
+                                  const nlohmann::json& header,
+                                  const sappp::common::SchemaValidator& schema,
+                                  const DiffChangeSource& changes)
+{
+    nlohmann::json wrapper = header;
+    wrapper["changes"] = nlohmann::json::array();
+    if (auto checked = schema.validate(wrapper); !checked) {
+        return std::unexpected(checked.error());
+    }
+    wrapper["changes"].push_back(nullptr);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return std::unexpected(
+            sappp::Error::make("IOError", "Failed to open output file: " + path.string()));
+    }
+    auto written = [&]() -> sappp::VoidResult {
+        bool first = true;
+        auto body = write_canonical_with_array(
+            header,
+            "changes",
+            [&out](std::string_view chunk) {
+                out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            },
+            [&]() -> sappp::VoidResult {
+                return changes([&](nlohmann::json change) -> sappp::VoidResult {
+                    nlohmann::json& slot = wrapper["changes"][0];
+                    slot = std::move(change);
+                    if (auto checked = schema.validate(wrapper); !checked) {
+                        return checked;
+                    }
+                    auto canonical = sappp::canonical::canonicalize(slot);
+                    if (!canonical) {
+                        return std::unexpected(canonical.error());
+                    }
+                    if (!first) {
+                        out << ',';
+                    }
+                    out << *canonical;
+                    first = false;
+                    return {};
+                });
+            });
+        if (!body) {
+            return body;
+        }
+        out << "\n";
+        out.close();
+        if (!out) {
+            return std::unexpected(
+                sappp::Error::make("IOError", "Failed to write output file: " + path.string()));
+        }
+        return {};
+    }();
+    if (!written) {
+        out.close();
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+    return written;
+}
+
+
+}  // namespace sappp::report
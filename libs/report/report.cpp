@@ -6,10 +6,11 @@
 #include "sappp/report.hpp"
 
 #include <algorithm>
-#include <map>
+#include <format>
 #include <ranges>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace sappp::report {
@@ -69,84 +70,557 @@ namespace {
     return "Reclassified";
 }
 
-[[nodiscard]] std::map<std::string, nlohmann::json>
-index_results_by_po_id(const nlohmann::json& results)
+[[nodiscard]] nlohmann::json make_change(const std::string& po_id,
+                                         const nlohmann::json* before,
+                                         const nlohmann::json* after,
+                                         std::string_view reason)
 {
-    std::map<std::string, nlohmann::json> index;
+    nlohmann::json from = {
+        {"category", "UNKNOWN"}
+    };
+    nlohmann::json to = {
+        {"category", "UNKNOWN"}
+    };
+    std::string before_category = "UNKNOWN";
+    std::string after_category = "UNKNOWN";
+
+    if (before != nullptr) {
+        from = side_result_of(*before);
+        before_category = category_of(*before);
+    }
+    if (after != nullptr) {
+        to = side_result_of(*after);
+        after_category = category_of(*after);
+    }
+
+    nlohmann::json change = {
+        {"po_id", po_id},
+        {"from", from},
+        {"to", to},
+        {"change_kind",
+         classify_change(before_category, after_category, before != nullptr, after != nullptr)}
+    };
+    if (!reason.empty()) {
+        change["reason"] = std::string(reason);
+    }
+    return change;
+}
+
+/// Entries with a po_id in po_id order; duplicates keep their input order.
+[[nodiscard]] std::vector<const nlohmann::json*> sorted_results_of(const nlohmann::json& results)
+{
+    std::vector<const nlohmann::json*> items;
     if (!results.contains("results")) {
-        return index;
+        return items;
     }
     for (const auto& item : results.at("results")) {
-        if (!item.contains("po_id")) {
-            continue;
+        if (item.contains("po_id")) {
+            items.push_back(&item);
+        }
+    }
+    auto by_po_id = [](const nlohmann::json* lhs, const nlohmann::json* rhs) {
+        return lhs->at("po_id").get_ref<const std::string&>()
+               < rhs->at("po_id").get_ref<const std::string&>();
+    };
+    // The validator writes results sorted by po_id, so this is usually a single scan.
+    if (!std::ranges::is_sorted(items, by_po_id)) {
+        std::ranges::stable_sort(items, by_po_id);
+    }
+    return items;
+}
+
+/// One input of the merge-join:the current entry, with duplicates and order checked.
+class MergeSide
+{
+public:
+    MergeSide(const ResultCursor& cursor, std::string_view label)
+        : m_cursor(&cursor)
+        , m_label(label)
+    {}
+
+    MergeSide(const MergeSide&) = delete;
+    MergeSide& operator=(const MergeSide&) = delete;
+    MergeSide(MergeSide&&) = delete;
+    MergeSide& operator=(MergeSide&&) = delete;
+    ~MergeSide() = default;
+
+    /// Current entry, or nullptr once the cursor is exhausted.
+    [[nodiscard]] const nlohmann::json* current() const
+    {
+        return m_current ? &*m_current : nullptr;
+    }
+
+    [[nodiscard]] const std::string& po_id() const { return m_po_id; }
+
+    [[nodiscard]] sappp::VoidResult advance()
+    {
+        while (true) {
+            auto item = (*m_cursor)();
+            if (!item) {
+                return std::unexpected(item.error());
+            }
+            if (!item->has_value()) {
+                m_current.reset();
+                return {};
+            }
+            if (!(*item)->contains("po_id")) {
+                continue;
+            }
+            auto po_id = (*item)->at("po_id").get<std::string>();
+            if (m_seen && po_id <= m_po_id) {
+                if (po_id == m_po_id) {
+                    continue;
+                }
+                return std::unexpected(
+                    Error::make("UnsortedResults",
+                                std::format("{} results are not sorted by po_id: {} follows {}",
+                                            m_label,
+                                            po_id,
+                                            m_po_id)));
+            }
+            m_seen = true;
+            m_po_id = std::move(po_id);
+            m_current = std::move(**item);
+            return {};
+        }
+    }
+
+private:
+    const ResultCursor* m_cursor;
+    std::string_view m_label;
+    std::optional<nlohmann::json> m_current = std::nullopt;
+    std::string m_po_id = {};
+    bool m_seen = false;
+};
+
+// Streamed documents are read at least this many bytes at a time.
+constexpr std::size_t kStreamChunkSize = std::size_t{64} * 1024;
+
+[[nodiscard]] bool is_json_whitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// Scanner error for input that ends too early; becomes "ParseError" in ResultsReader::scan().
+constexpr std::string_view kTruncatedCode = "TruncatedJson";
+
+[[nodiscard]] Error scan_error(std::size_t pos, std::string_view what)
+{
+    return Error::make("ParseError", std::format("Invalid JSON at byte {}: {}", pos, what));
+}
+
+[[nodiscard]] Error truncated_error(std::size_t pos, std::string_view what)
+{
+    return Error::make(std::string(kTruncatedCode),
+                       std::format("Invalid JSON at byte {}: {}", pos, what));
+}
+
+// The scanners below see the document bytes [base, base + text.size()) and take and return
+// document offsets. ResultsReader::scan() retries a scan that runs into the end of @p text
+// once more of a stream is buffered.
+
+[[nodiscard]] sappp::Result<std::size_t>
+skip_whitespace(std::string_view text, std::size_t base, std::size_t pos)
+{
+    while (pos - base < text.size() && is_json_whitespace(text[pos - base])) {
+        ++pos;
+    }
+    return pos;
+}
+
+/// Offset just past the string whose opening quote is at @p pos.
+[[nodiscard]] sappp::Result<std::size_t>
+skip_string(std::string_view text, std::size_t base, std::size_t pos)
+{
+    for (std::size_t i = pos + 1; i - base < text.size(); ++i) {
+        if (text[i - base] == '\\') {
+            ++i;
+        } else if (text[i - base] == '"') {
+            return i + 1;
+        }
+    }
+    return std::unexpected(truncated_error(pos, "unterminated string"));
+}
+
+/**
+ * Offset just past the value starting at @p pos.
+ *
+ * Only strings and bracket nesting are followed; the value itself is checked
+ * when it is parsed.
+ */
+[[nodiscard]] sappp::Result<std::size_t>
+skip_value(std::string_view text, std::size_t base, std::size_t pos)
+{
+    if (pos - base >= text.size()) {
+        return std::unexpected(truncated_error(pos, "unexpected end of input"));
+    }
+    const char first = text[pos - base];
+    if (first == '"') {
+        return skip_string(text, base, pos);
+    }
+    if (first != '{' && first != '[') {
+        std::size_t end = pos;
+        while (end - base < text.size() && !is_json_whitespace(text[end - base])
+               && text[end - base] != ',' && text[end - base] != '}' && text[end - base] != ']') {
+            ++end;
+        }
+        if (end == pos) {
+            return std::unexpected(scan_error(pos, "expected a value"));
+        }
+        return end;
+    }
+    std::size_t depth = 0;
+    for (std::size_t i = pos; i - base < text.size(); ++i) {
+        const char c = text[i - base];
+        if (c == '"') {
+            auto end = skip_string(text, base, i);
+            if (!end) {
+                return std::unexpected(end.error());
+            }
+            i = *end - 1;
+        } else if (c == '{' || c == '[') {
+            ++depth;
+        } else if (c == '}' || c == ']') {
+            --depth;
+            if (depth == 0) {
+                return i + 1;
+            }
         }
-        index.emplace(item.at("po_id").get<std::string>(), item);
     }
-    return index;
+    return std::unexpected(truncated_error(pos, "unterminated value"));
+}
+
+[[nodiscard]] sappp::Result<nlohmann::json> parse_fragment(std::string_view fragment,
+                                                           std::size_t pos)
+{
+    try {
+        return nlohmann::json::parse(fragment);
+    } catch (const std::exception& ex) {
+        return std::unexpected(scan_error(pos, ex.what()));
+    }
 }
 
 }  // namespace
 
-sappp::Result<nlohmann::json> build_diff_changes(const nlohmann::json& before_results,
-                                                 const nlohmann::json& after_results,
-                                                 std::string_view reason)
+ResultsReader::ResultsReader(std::string_view document, std::optional<DocumentStream> stream)
+    : m_document(document)
+    , m_stream(std::move(stream))
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    , m_buffer()
+    , m_header(nlohmann::json::object())
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    , m_results_begin()
+{}
+
+sappp::Result<ResultsReader> ResultsReader::open(std::string_view document,
+                                                 std::string_view array_key)
 {
-    auto before_index = index_results_by_po_id(before_results);
-    auto after_index = index_results_by_po_id(after_results);
+    ResultsReader reader(document, std::nullopt);
+    if (auto parsed = reader.parse_header(array_key); !parsed) {
+        return std::unexpected(parsed.error());
+    }
+    reader.rewind();
+    return reader;
+}
 
-    std::set<std::string> po_ids;
-    for (const auto& [po_id, _] : before_index) {
-        po_ids.insert(po_id);
+sappp::Result<ResultsReader> ResultsReader::open(DocumentStream stream,
+                                                 std::string_view array_key)
+{
+    ResultsReader reader(std::string_view{}, std::move(stream));
+    if (auto parsed = reader.parse_header(array_key); !parsed) {
+        return std::unexpected(parsed.error());
     }
-    for (const auto& [po_id, _] : after_index) {
-        po_ids.insert(po_id);
+    reader.rewind();
+    return reader;
+}
+
+// NOLINTNEXTLINE(readability-function-size) - one pass over the top-level object.
+sappp::VoidResult ResultsReader::parse_header(std::string_view array_key)
+{
+    auto pos = scan(0, skip_whitespace);
+    if (!pos) {
+        return std::unexpected(pos.error());
     }
+    if (byte_at(*pos) != '{') {
+        return std::unexpected(scan_error(*pos, "expected an object"));
+    }
+    pos = scan(*pos + 1, skip_whitespace);
+    if (!pos) {
+        return std::unexpected(pos.error());
+    }
+    bool closed = byte_at(*pos) == '}';
+    while (!closed) {
+        if (byte_at(*pos) != '"') {
+            return std::unexpected(scan_error(*pos, "expected an object key"));
+        }
+        auto key_end = scan(*pos, skip_string);
+        if (!key_end) {
+            return std::unexpected(key_end.error());
+        }
+        auto key = parse_fragment(bytes(*pos, *key_end), *pos);
+        if (!key) {
+            return std::unexpected(key.error());
+        }
+        pos = scan(*key_end, skip_whitespace);
+        if (!pos) {
+            return std::unexpected(pos.error());
+        }
+        if (byte_at(*pos) != ':') {
+            return std::unexpected(scan_error(*pos, "expected ':'"));
+        }
+        pos = scan(*pos + 1, skip_whitespace);
+        if (!pos) {
+            return std::unexpected(pos.error());
+        }
+        std::size_t value_end = 0;
+        if (*key == array_key && byte_at(*pos) == '[') {
+            // Walk the entries one at a time, so a stream never buffers the whole array.
+            m_results_begin = *pos + 1;
+            m_pos = *m_results_begin;
+            while (true) {
+                auto entry = next_bytes();
+                if (!entry) {
+                    return std::unexpected(entry.error());
+                }
+                if (!entry->has_value()) {
+                    break;
+                }
+            }
+            auto close = scan(m_pos, skip_whitespace);
+            if (!close) {
+                return std::unexpected(close.error());
+            }
+            if (byte_at(*close) != ']') {
+                return std::unexpected(scan_error(*close, "expected ',' or ']'"));
+            }
+            value_end = *close + 1;
+        } else {
+            auto end = scan(*pos, skip_value);
+            if (!end) {
+                return std::unexpected(end.error());
+            }
+            auto value = parse_fragment(bytes(*pos, *end), *pos);
+            if (!value) {
+                return std::unexpected(value.error());
+            }
+            m_header[key->get<std::string>()] = std::move(*value);
+            value_end = *end;
+        }
+        pos = scan(value_end, skip_whitespace);
+        if (!pos) {
+            return std::unexpected(pos.error());
+        }
+        const auto separator = byte_at(*pos);
+        if (separator == '}') {
+            closed = true;
+        } else if (separator != ',') {
+            return std::unexpected(scan_error(*pos, "expected ',' or '}'"));
+        } else {
+            pos = scan(*pos + 1, skip_whitespace);
+            if (!pos) {
+                return std::unexpected(pos.error());
+            }
+        }
+    }
+    auto trailing = scan(*pos + 1, skip_whitespace);
+    if (!trailing) {
+        return std::unexpected(trailing.error());
+    }
+    if (byte_at(*trailing).has_value()) {
+        return std::unexpected(scan_error(*pos + 1, "trailing bytes after value"));
+    }
+    return {};
+}
+
+sappp::Result<std::size_t> ResultsReader::scan(std::size_t pos, ScanFn scan_fn)
+{
+    while (true) {
+        const std::string_view text = m_stream ? std::string_view(m_buffer) : m_document;
+        const std::size_t base = m_stream ? m_buffer_begin : 0;
+        auto end = scan_fn(text, base, pos);
+        // A scan that reaches the end of the buffer may continue in the next chunk.
+        const bool complete = !m_stream || m_stream_ended;
+        if (end && (complete || *end - base < text.size())) {
+            return end;
+        }
+        if (!end && (complete || end.error().code != kTruncatedCode)) {
+            return std::unexpected(Error::make("ParseError", end.error().message));
+        }
+        if (auto filled = refill(pos); !filled) {
+            return std::unexpected(filled.error());
+        }
+    }
+}
 
-    std::vector<nlohmann::json> changes;
-    changes.reserve(po_ids.size());
+std::optional<char> ResultsReader::byte_at(std::size_t pos) const
+{
+    const std::string_view text = m_stream ? std::string_view(m_buffer) : m_document;
+    const std::size_t base = m_stream ? m_buffer_begin : 0;
+    if (pos < base || pos - base >= text.size()) {
+        return std::nullopt;
+    }
+    return text[pos - base];
+}
 
-    for (const auto& po_id : po_ids) {
-        const bool before_present = before_index.contains(po_id);
-        const bool after_present = after_index.contains(po_id);
+std::string_view ResultsReader::bytes(std::size_t begin, std::size_t end) const
+{
+    if (!m_stream) {
+        return m_document.substr(begin, end - begin);
+    }
+    return std::string_view(m_buffer).substr(begin - m_buffer_begin, end - begin);
+}
 
-        nlohmann::json from = {
-            {"category", "UNKNOWN"}
-        };
-        nlohmann::json to = {
-            {"category", "UNKNOWN"}
-        };
-        std::string before_category = "UNKNOWN";
-        std::string after_category = "UNKNOWN";
+sappp::VoidResult ResultsReader::refill(std::size_t keep_from)
+{
+    const std::size_t drop = std::min(keep_from - m_buffer_begin, m_buffer.size());
+    m_buffer.erase(0, drop);
+    m_buffer_begin += drop;
+    // Growing with the kept bytes bounds the rescans of a long entry to O(log n).
+    const std::size_t kept = m_buffer.size();
+    m_buffer.resize(kept + std::max(kStreamChunkSize, kept));
+    auto count = m_stream->read(std::span(m_buffer).subspan(kept));
+    if (!count) {
+        m_buffer.resize(kept);
+        return std::unexpected(count.error());
+    }
+    m_buffer.resize(kept + *count);
+    m_stream_ended = *count == 0;
+    return {};
+}
 
-        if (before_present) {
-            const auto& item = before_index.at(po_id);
-            from = side_result_of(item);
-            before_category = category_of(item);
+sappp::Result<std::optional<nlohmann::json>> ResultsReader::next()
+{
+    auto entry = next_bytes();
+    if (!entry) {
+        return std::unexpected(entry.error());
+    }
+    if (!entry->has_value()) {
+        return std::nullopt;
+    }
+    auto item = parse_fragment(**entry, m_pos - (*entry)->size());
+    if (!item) {
+        return std::unexpected(item.error());
+    }
+    return std::optional<nlohmann::json>(std::move(*item));
+}
+
+sappp::Result<std::optional<std::string_view>> ResultsReader::next_bytes()
+{
+    if (!m_results_begin) {
+        return std::nullopt;
+    }
+    if (m_restart_pending) {
+        m_restart_pending = false;
+        if (auto restarted = m_stream->rewind(); !restarted) {
+            return std::unexpected(restarted.error());
         }
-        if (after_present) {
-            const auto& item = after_index.at(po_id);
-            to = side_result_of(item);
-            after_category = category_of(item);
+        m_buffer.clear();
+        m_buffer_begin = 0;
+        m_stream_ended = false;
+    }
+    auto pos = scan(m_pos, skip_whitespace);
+    if (!pos) {
+        return std::unexpected(pos.error());
+    }
+    if (byte_at(*pos) == ']') {
+        return std::nullopt;
+    }
+    if (m_pos != *m_results_begin) {
+        if (byte_at(*pos) != ',') {
+            return std::unexpected(scan_error(*pos, "expected ',' or ']'"));
+        }
+        pos = scan(*pos + 1, skip_whitespace);
+        if (!pos) {
+            return std::unexpected(pos.error());
         }
+    }
+    auto end = scan(*pos, skip_value);
+    if (!end) {
+        return std::unexpected(end.error());
+    }
+    m_pos = *end;
+    return std::optional<std::string_view>(bytes(*pos, *end));
+}
 
-        nlohmann::json change = {
-            {"po_id", po_id},
-            {"from", from},
-            {"to", to},
-            {"change_kind",
-             classify_change(before_category, after_category, before_present, after_present)}
-        };
-        if (!reason.empty()) {
-            change["reason"] = std::string(reason);
+void ResultsReader::rewind()
+{
+    m_pos = m_results_begin.value_or(0);
+    m_restart_pending = m_stream.has_value();
+}
+
+sappp::VoidResult merge_diff_changes(const ResultCursor& before,
+                                     const ResultCursor& after,
+                                     std::string_view reason,
+                                     const ChangeSink& sink)
+{
+    MergeSide before_side(before, "before");
+    MergeSide after_side(after, "after");
+    if (auto advanced = before_side.advance(); !advanced) {
+        return advanced;
+    }
+    if (auto advanced = after_side.advance(); !advanced) {
+        return advanced;
+    }
+
+    while (before_side.current() != nullptr || after_side.current() != nullptr) {
+        const bool take_before =
+            before_side.current() != nullptr
+            && (after_side.current() == nullptr || before_side.po_id() <= after_side.po_id());
+        const bool take_after =
+            after_side.current() != nullptr
+            && (before_side.current() == nullptr || after_side.po_id() <= before_side.po_id());
+
+        const std::string& po_id = take_before ? before_side.po_id() : after_side.po_id();
+        auto change = make_change(po_id,
+                                  take_before ? before_side.current() : nullptr,
+                                  take_after ? after_side.current() : nullptr,
+                                  reason);
+        if (auto sunk = sink(std::move(change)); !sunk) {
+            return sunk;
+        }
+        if (take_before) {
+            if (auto advanced = before_side.advance(); !advanced) {
+                return advanced;
+            }
+        }
+        if (take_after) {
+            if (auto advanced = after_side.advance(); !advanced) {
+                return advanced;
+            }
         }
-        changes.push_back(std::move(change));
     }
+    return {};
+}
 
-    std::ranges::stable_sort(changes, [](const nlohmann::json& lhs, const nlohmann::json& rhs) {
-        return lhs.at("po_id").get<std::string>() < rhs.at("po_id").get<std::string>();
-    });
+sappp::Result<nlohmann::json> build_diff_changes(const nlohmann::json& before_results,
+                                                 const nlohmann::json& after_results,
+                                                 std::string_view reason)
+{
+    auto before = sorted_results_of(before_results);
+    auto after = sorted_results_of(after_results);
+    auto cursor_over = [](const std::vector<const nlohmann::json*>& items) {
+        return ResultCursor(
+            [&items, index = std::size_t{0}]() mutable
+            -> sappp::Result<std::optional<nlohmann::json>> {
+                if (index == items.size()) {
+                    return std::nullopt;
+                }
+                return std::optional<nlohmann::json>(*items[index++]);
+            });
+    };
 
-    return nlohmann::json(changes);
+    nlohmann::json changes = nlohmann::json::array();
+    auto merged = merge_diff_changes(cursor_over(before),
+                                     cursor_over(after),
+                                     reason,
+                                     [&changes](nlohmann::json change) -> sappp::VoidResult {
+                                         changes.push_back(std::move(change));
+                                         return {};
+                                     });
+    if (!merged) {
+        return std::unexpected(merged.error());
+    }
+    return changes;
 }
 
 // NOLINTBEGIN(readability-function-size) - Keeps filtering logic co-located.
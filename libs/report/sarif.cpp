@@ -0,0 +1,488 @@
+/**
+ * @file sarif.cpp
+ * @brief Streaming SARIF 2.1.0 writer for analysis outputs
+ */
+
+#include "sappp/report.hpp"
+
+#include <algorithm>
+#include <compare>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sappp::report {
+
+namespace {
+
+constexpr std::string_view kSarifSchemaUri = "https://json.schemastore.org/sarif-2.1.0.json";
+constexpr std::string_view kSarifVersion = "2.1.0";
+constexpr std::string_view kFallbackRuleId = "sappp.unclassified";
+
+struct SourceSite
+{
+    std::string file;
+    std::int64_t line = 0;
+    std::int64_t col = 0;
+};
+
+struct UnknownNote
+{
+    std::string stable_id;
+    std::string code;
+    std::string lemma;
+    std::string plan;
+};
+
+/// Insertion-ordered string table; SARIF rules and artifacts are referenced by index.
+class InternTable
+{
+public:
+    [[nodiscard]] std::size_t intern(const std::string& key)
+    {
+        auto [it, inserted] = m_index.try_emplace(key, m_keys.size());
+        if (inserted) {
+            m_keys.push_back(key);
+        }
+        return it->second;
+    }
+
+    [[nodiscard]] const std::vector<std::string>& keys() const { return m_keys; }
+
+private:
+    std::unordered_map<std::string, std::size_t> m_index = {};
+    std::vector<std::string> m_keys = {};
+};
+
+/// IR position of a source_map entry; source_map is sorted by it.
+struct SiteKey
+{
+    std::string function_uid = {};
+    std::string block_id = {};
+    std::string inst_id = {};
+
+    auto operator<=>(const SiteKey&) const = default;
+};
+
+[[nodiscard]] std::string string_at(const nlohmann::json& object, std::string_view key)
+{
+    auto it = object.find(key);
+    return it != object.end() && it->is_string() ? it->get<std::string>() : std::string{};
+}
+
+/// Visit the entries of @p array_key in @p document one at a time; stops at the first error.
+template <typename Visitor>
+[[nodiscard]] sappp::VoidResult
+for_each_entry(std::string_view document, std::string_view array_key, Visitor&& visit)
+{
+    auto reader = ResultsReader::open(document, array_key);
+    if (!reader) {
+        return std::unexpected(reader.error());
+    }
+    while (true) {
+        auto entry = reader->next();
+        if (!entry) {
+            return std::unexpected(entry.error());
+        }
+        if (!entry->has_value()) {
+            return {};
+        }
+        if (auto visited = visit(**entry); !visited) {
+            return visited;
+        }
+    }
+}
+
+[[nodiscard]] SiteKey site_key_of(const nlohmann::json& entry)
+{
+    auto ir_ref = entry.find("ir_ref");
+    if (ir_ref == entry.end() || !ir_ref->is_object()) {
+        return {};
+    }
+    return SiteKey{.function_uid = string_at(*ir_ref, "function_uid"),
+                   .block_id = string_at(*ir_ref, "block_id"),
+                   .inst_id = string_at(*ir_ref, "inst_id")};
+}
+
+[[nodiscard]] nlohmann::json parse_entry(std::string_view bytes)
+{
+    auto entry = nlohmann::json::parse(bytes, nullptr, false);
+    return entry.is_object() ? entry : nlohmann::json::object();
+}
+
+/// Byte ranges of the source_map entries; a lookup parses only the entries it probes.
+class SourceSites
+{
+public:
+    /// Collect the entries of @p source_map, which must be sorted by IR position.
+    [[nodiscard]] static sappp::Result<SourceSites> open(std::string_view source_map)
+    {
+        SourceSites sites;
+        if (source_map.empty()) {
+            return sites;
+        }
+        auto reader = ResultsReader::open(source_map, "entries");
+        if (!reader) {
+            return std::unexpected(reader.error());
+        }
+        SiteKey previous;
+        while (true) {
+            auto bytes = reader->next_bytes();
+            if (!bytes) {
+                return std::unexpected(bytes.error());
+            }
+            if (!bytes->has_value()) {
+                return sites;
+            }
+            auto key = site_key_of(parse_entry(**bytes));
+            if (key < previous) {
+                return std::unexpected(Error::make(
+                    "UnsortedResults",
+                    std::format("source_map is not sorted by IR position at {}",
+                                key.function_uid)));
+            }
+            previous = std::move(key);
+            sites.m_entries.push_back(**bytes);
+        }
+    }
+
+    /// Expansion location of the first entry at @p key that has one.
+    [[nodiscard]] std::optional<SourceSite> find(const SiteKey& key) const
+    {
+        auto it = std::ranges::partition_point(m_entries, [&key](std::string_view bytes) {
+            return site_key_of(parse_entry(bytes)) < key;
+        });
+        for (; it != m_entries.end(); ++it) {
+            const auto entry = parse_entry(*it);
+            if (site_key_of(entry) != key) {
+                break;
+            }
+            if (auto loc = entry.find("expansion_loc"); loc != entry.end() && loc->is_object()) {
+                return SourceSite{.file = string_at(*loc, "file"),
+                                  .line = loc->value("line", std::int64_t{0}),
+                                  .col = loc->value("col", std::int64_t{0})};
+            }
+        }
+        return std::nullopt;
+    }
+
+private:
+    std::vector<std::string_view> m_entries = {};
+};
+
+/// Index of the unknown ledger: the one given in @p inputs, or one built into @p storage.
+[[nodiscard]] sappp::Result<UnknownIndexView> open_unknown_index(const SarifInputs& inputs,
+                                                                 std::string& storage)
+{
+    if (inputs.unknown_index) {
+        return *inputs.unknown_index;
+    }
+    auto built = build_unknown_index(inputs.unknown_ledger);
+    if (!built) {
+        return std::unexpected(built.error());
+    }
+    storage = std::move(*built);
+    return UnknownIndexView::open(inputs.unknown_ledger, storage);
+}
+
+/// First unknown ledger entry of @p po_id, reduced to what a SARIF message shows.
+[[nodiscard]] sappp::Result<std::optional<UnknownNote>>
+find_unknown_note(const UnknownIndexView& index, const std::string& po_id)
+{
+    if (po_id.empty()) {
+        return std::nullopt;
+    }
+    auto entries = index.entries_by_po_id(po_id);
+    if (!entries) {
+        return std::unexpected(entries.error());
+    }
+    if (entries->empty()) {
+        return std::nullopt;
+    }
+    const auto& entry = entries->front();
+    UnknownNote note{.stable_id = string_at(entry, "unknown_stable_id"),
+                     .code = string_at(entry, "unknown_code"),
+                     .lemma = {},
+                     .plan = {}};
+    if (auto lemma = entry.find("missing_lemma"); lemma != entry.end()) {
+        note.lemma = string_at(*lemma, "pretty");
+    }
+    if (auto plan = entry.find("refinement_plan"); plan != entry.end()) {
+        note.plan = string_at(*plan, "message");
+    }
+    return note;
+}
+
+[[nodiscard]] Error unsorted(std::string_view label, std::string_view po_id)
+{
+    return Error::make("UnsortedResults",
+                       std::format("{} is not sorted by po_id at {}", label, po_id));
+}
+
+/// po_list entries in po_id order, walked forward alongside the results.
+class PoCursor
+{
+public:
+    explicit PoCursor(ResultsReader reader)
+        : m_reader(std::move(reader))
+    {}
+
+    /// The po_list entry for @p po_id, or nullptr when po_list has none.
+    [[nodiscard]] sappp::Result<const nlohmann::json*> seek(const std::string& po_id)
+    {
+        while (!m_done && (!m_current || m_po_id < po_id)) {
+            auto entry = m_reader.next();
+            if (!entry) {
+                return std::unexpected(entry.error());
+            }
+            if (!entry->has_value()) {
+                m_done = true;
+                m_current.reset();
+                break;
+            }
+            auto next_po_id = string_at(**entry, "po_id");
+            if (m_current && next_po_id < m_po_id) {
+                return std::unexpected(unsorted("po_list", next_po_id));
+            }
+            m_po_id = std::move(next_po_id);
+            m_current = std::move(**entry);
+        }
+        return m_current && m_po_id == po_id ? &*m_current : nullptr;
+    }
+
+private:
+    ResultsReader m_reader;
+    std::optional<nlohmann::json> m_current = std::nullopt;
+    std::string m_po_id = {};
+    bool m_done = false;
+};
+
+/// SARIF artifact URI: repository-relative paths stay relative, absolute ones become file URIs.
+[[nodiscard]] std::string artifact_uri(std::string_view path)
+{
+    std::string uri = path.starts_with('/') ? "file://" : "";
+    for (const char c : path) {
+        const auto byte = static_cast<unsigned char>(c);
+        const bool unreserved = (byte >= 'A' && byte <= 'Z') || (byte >= 'a' && byte <= 'z')
+                                || (byte >= '0' && byte <= '9') || c == '-' || c == '.'
+                                || c == '_' || c == '~' || c == '/';
+        if (unreserved) {
+            uri.push_back(c);
+        } else {
+            uri += std::format("%{:02X}", byte);
+        }
+    }
+    return uri;
+}
+
+[[nodiscard]] std::string message_for(std::string_view category,
+                                      const nlohmann::json* po,
+                                      const UnknownNote* note)
+{
+    std::string predicate;
+    if (po != nullptr && po->contains("predicate")) {
+        predicate = string_at(po->at("predicate"), "pretty");
+    }
+    if (category == "BUG") {
+        return predicate.empty() ? std::string("BUG") : std::format("BUG: {}", predicate);
+    }
+    if (note == nullptr) {
+        return predicate.empty() ? std::string("UNKNOWN")
+                                 : std::format("UNKNOWN: {} is not proven", predicate);
+    }
+    std::string text = std::format("UNKNOWN ({})", note->code);
+    if (!note->lemma.empty()) {
+        text += std::format(": missing {}", note->lemma);
+    }
+    if (!note->plan.empty()) {
+        text += std::format(". {}", note->plan);
+    }
+    return text;
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE(readability-function-size) - Keeps the single-pass join together.
+sappp::Result<std::size_t> write_sarif(const SarifInputs& inputs, std::ostream& out)
+{
+    auto sites = SourceSites::open(inputs.source_map);
+    if (!sites) {
+        return std::unexpected(sites.error());
+    }
+    std::string built_index;
+    auto unknowns = open_unknown_index(inputs, built_index);
+    if (!unknowns) {
+        return std::unexpected(unknowns.error());
+    }
+    auto po_reader = ResultsReader::open(inputs.po_list, "pos");
+    if (!po_reader) {
+        return std::unexpected(po_reader.error());
+    }
+
+    InternTable rules;
+    InternTable artifacts;
+    std::size_t written = 0;
+    auto emit = [&](const std::string& po_id,
+                    std::string_view category,
+                    const nlohmann::json* result,
+                    const nlohmann::json* po,
+                    const UnknownNote* note) {
+        std::string rule_id = po != nullptr ? string_at(*po, "po_kind") : std::string{};
+        if (rule_id.empty()) {
+            rule_id = kFallbackRuleId;
+        }
+
+        nlohmann::json properties = {
+            {   "po_id",    po_id},
+            {"category", category}
+        };
+        if (result != nullptr) {
+            for (const auto* key :
+                 {"certificate_root", "validator_status", "downgrade_reason_code"}) {
+                if (result->contains(key)) {
+                    properties[key] = result->at(key);
+                }
+            }
+        }
+        if (note != nullptr && category == "UNKNOWN") {
+            properties["unknown_code"] = note->code;
+            properties["unknown_stable_id"] = note->stable_id;
+        }
+
+        nlohmann::json sarif_result = {
+            {"ruleId", rule_id},
+            {"ruleIndex", rules.intern(rule_id)},
+            {"level", category == "BUG" ? "error" : "warning"},
+            {"message", {{"text", message_for(category, po, note)}}},
+            {"partialFingerprints", {{"sapppPoId/v1", po_id}}},
+            {"properties", std::move(properties)}
+        };
+
+        // Prefer the mapped source position; fall back to the PO's file without a region.
+        nlohmann::json physical;
+        if (po != nullptr && po->contains("function") && po->contains("anchor")) {
+            const auto& anchor = po->at("anchor");
+            auto site = sites->find({.function_uid = string_at(po->at("function"), "usr"),
+                                     .block_id = string_at(anchor, "block_id"),
+                                     .inst_id = string_at(anchor, "inst_id")});
+            if (site && !site->file.empty()) {
+                physical["artifactLocation"] = {
+                    {  "uri", artifact_uri(site->file)},
+                    {"index", artifacts.intern(site->file)}
+                };
+                if (site->line > 0) {
+                    physical["region"] = {
+                        {"startLine", site->line}
+                    };
+                    if (site->col > 0) {
+                        physical["region"]["startColumn"] = site->col;
+                    }
+                }
+            }
+        }
+        if (physical.is_null() && po != nullptr && po->contains("repo_identity")) {
+            auto path = string_at(po->at("repo_identity"), "path");
+            if (!path.empty()) {
+                physical["artifactLocation"] = {
+                    {  "uri",  artifact_uri(path)},
+                    {"index", artifacts.intern(path)}
+                };
+            }
+        }
+        if (!physical.is_null()) {
+            sarif_result["locations"] = nlohmann::json::array({
+                {{"physicalLocation", std::move(physical)}}
+            });
+        }
+
+        out << (written == 0 ? "" : ",") << sarif_result.dump();
+        ++written;
+    };
+
+    out << std::format(R"({{"$schema":"{}","runs":[{{"results":[)", kSarifSchemaUri);
+
+    PoCursor po_cursor(std::move(*po_reader));
+    if (!inputs.validated_results.empty()) {
+        std::string previous_po_id;
+        auto reader = ResultsReader::open(inputs.validated_results, "results");
+        if (!reader) {
+            return std::unexpected(reader.error());
+        }
+        while (true) {
+            auto result = reader->next();
+            if (!result) {
+                return std::unexpected(result.error());
+            }
+            if (!result->has_value()) {
+                break;
+            }
+            const auto& item = **result;
+            auto po_id = string_at(item, "po_id");
+            if (po_id < previous_po_id) {
+                return std::unexpected(unsorted("validated results", po_id));
+            }
+            previous_po_id = po_id;
+            const auto category = string_at(item, "category");
+            if (category != "BUG" && category != "UNKNOWN") {
+                continue;
+            }
+            auto po = po_cursor.seek(po_id);
+            if (!po) {
+                return std::unexpected(po.error());
+            }
+            std::optional<UnknownNote> note;
+            if (category == "UNKNOWN") {
+                auto found = find_unknown_note(*unknowns, po_id);
+                if (!found) {
+                    return std::unexpected(found.error());
+                }
+                note = std::move(*found);
+            }
+            emit(po_id, category, &item, *po, note ? &*note : nullptr);
+        }
+    } else {
+        // Before validation only the POs recorded in the unknown ledger are known results.
+        auto walked = for_each_entry(
+            inputs.po_list, "pos", [&](const nlohmann::json& po) -> sappp::VoidResult {
+                auto po_id = string_at(po, "po_id");
+                auto note = find_unknown_note(*unknowns, po_id);
+                if (!note) {
+                    return std::unexpected(note.error());
+                }
+                if (note->has_value()) {
+                    emit(po_id, "UNKNOWN", nullptr, &po, &**note);
+                }
+                return {};
+            });
+        if (!walked) {
+            return std::unexpected(walked.error());
+        }
+    }
+
+    nlohmann::json rule_table = nlohmann::json::array();
+    for (const auto& rule_id : rules.keys()) {
+        rule_table.push_back({
+            {"id", rule_id}
+        });
+    }
+    nlohmann::json artifact_table = nlohmann::json::array();
+    for (const auto& path : artifacts.keys()) {
+        artifact_table.push_back({
+            {"location", {{"uri", artifact_uri(path)}}}
+        });
+    }
+    nlohmann::json driver = {
+        {   "name", inputs.tool.value("name", "sappp")},
+        {"version",    inputs.tool.value("version", "")},
+        {  "rules",             std::move(rule_table)}
+    };
+    out << R"(],"tool":{"driver":)" << driver.dump() << R"(},"artifacts":)" << artifact_table.dump()
+        << std::format(R"(}}],"version":"{}"}})", kSarifVersion) << '\n';
+    return written;
+}
+
+}  // namespace sappp::report
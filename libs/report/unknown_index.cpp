@@ -0,0 +1,316 @@
+/**
+ * @file unknown_index.cpp
+ * @brief Sidecar lookup index for unknown_ledger.json
+ */
+
+#include "sappp/canonical_json.hpp"
+#include "sappp/report.hpp"
+
+#include <algorithm>
+#include <format>
+#include <ranges>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace sappp::report {
+
+namespace {
+
+constexpr std::string_view kIndexMagic = "SAPPPUX1";
+constexpr std::size_t kFieldSize = 8;
+
+// Header fields following the magic.
+constexpr std::size_t kLedgerSizeField = 0;
+constexpr std::size_t kPoIdCountField = 1;
+constexpr std::size_t kUnknownIdCountField = 2;
+constexpr std::size_t kHeaderOffsetField = 3;
+constexpr std::size_t kHeaderSizeField = 4;
+constexpr std::size_t kHeaderFieldCount = 5;
+constexpr std::size_t kIndexHeaderSize = kIndexMagic.size() + (kHeaderFieldCount * kFieldSize);
+
+// Record fields and tables.
+constexpr std::size_t kKeyOffsetField = 0;
+constexpr std::size_t kKeySizeField = 1;
+constexpr std::size_t kEntryOffsetField = 2;
+constexpr std::size_t kEntrySizeField = 3;
+constexpr std::size_t kRecordSize = 4 * kFieldSize;
+constexpr std::size_t kPoIdTable = 0;
+constexpr std::size_t kUnknownIdTable = 1;
+
+struct IndexRecord
+{
+    std::string key;
+    std::uint64_t entry_offset = 0;
+    std::uint64_t entry_size = 0;
+};
+
+void put_u64(std::string& out, std::uint64_t value)
+{
+    for (std::size_t i = 0; i < kFieldSize; ++i) {
+        out.push_back(static_cast<char>((value >> (i * 8U)) & 0xFFU));
+    }
+}
+
+[[nodiscard]] std::uint64_t get_u64(std::string_view bytes, std::size_t offset)
+{
+    std::uint64_t value = 0;
+    for (std::size_t i = 0; i < kFieldSize; ++i) {
+        value |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[offset + i]))
+                 << (i * 8U);
+    }
+    return value;
+}
+
+[[nodiscard]] std::uint64_t header_field(std::string_view index, std::size_t field)
+{
+    return get_u64(index, kIndexMagic.size() + (field * kFieldSize));
+}
+
+/// Bytes [offset, offset + size) of @p bytes, or std::nullopt when out of range.
+[[nodiscard]] std::optional<std::string_view>
+slice(std::string_view bytes, std::uint64_t offset, std::uint64_t size)
+{
+    if (offset > bytes.size() || size > bytes.size() - offset) {
+        return std::nullopt;
+    }
+    return bytes.substr(offset, size);
+}
+
+[[nodiscard]] Error stale_index(std::string_view what)
+{
+    return Error::make("StaleIndex", std::format("Unknown ledger index is stale: {}", what));
+}
+
+}  // namespace
+
+std::filesystem::path unknown_index_path(const std::filesystem::path& ledger_path)
+{
+    auto path = ledger_path;
+    path.replace_extension(".idx");
+    return path;
+}
+
+sappp::Result<std::string> build_unknown_index(std::string_view ledger)
+{
+    auto reader = ResultsReader::open(ledger, "unknowns");
+    if (!reader) {
+        return std::unexpected(reader.error());
+    }
+
+    std::vector<IndexRecord> by_po_id;
+    std::vector<IndexRecord> by_unknown_id;
+    while (true) {
+        auto bytes = reader->next_bytes();
+        if (!bytes) {
+            return std::unexpected(bytes.error());
+        }
+        if (!bytes->has_value()) {
+            break;
+        }
+        nlohmann::json entry;
+        try {
+            entry = nlohmann::json::parse(**bytes);
+        } catch (const std::exception& ex) {
+            return std::unexpected(Error::make(
+                "ParseError", std::format("Failed to parse unknown ledger entry: {}", ex.what())));
+        }
+        const auto offset = static_cast<std::uint64_t>((*bytes)->data() - ledger.data());
+        const std::uint64_t size = (*bytes)->size();
+        if (auto po_id = entry.find("po_id"); po_id != entry.end() && po_id->is_string()) {
+            by_po_id.push_back(IndexRecord{.key = po_id->get<std::string>(),
+                                           .entry_offset = offset,
+                                           .entry_size = size});
+        }
+        if (auto unknown_id = entry.find("unknown_stable_id");
+            unknown_id != entry.end() && unknown_id->is_string()) {
+            by_unknown_id.push_back(IndexRecord{.key = unknown_id->get<std::string>(),
+                                                .entry_offset = offset,
+                                                .entry_size = size});
+        }
+    }
+    // Records were collected in ledger order, which the stable sort keeps for equal keys.
+    std::ranges::stable_sort(by_po_id, {}, &IndexRecord::key);
+    std::ranges::stable_sort(by_unknown_id, {}, &IndexRecord::key);
+
+    auto header = sappp::canonical::canonicalize(reader->header());
+    if (!header) {
+        return std::unexpected(header.error());
+    }
+
+    const std::size_t pool_begin =
+        kIndexHeaderSize + ((by_po_id.size() + by_unknown_id.size()) * kRecordSize);
+    std::string pool = *header;
+    std::string index(kIndexMagic);
+    put_u64(index, ledger.size());
+    put_u64(index, by_po_id.size());
+    put_u64(index, by_unknown_id.size());
+    put_u64(index, pool_begin);
+    put_u64(index, header->size());
+    for (const auto* table : {&by_po_id, &by_unknown_id}) {
+        for (const auto& record : *table) {
+            put_u64(index, pool_begin + pool.size());
+            put_u64(index, record.key.size());
+            put_u64(index, record.entry_offset);
+            put_u64(index, record.entry_size);
+            pool += record.key;
+        }
+    }
+    index += pool;
+    return index;
+}
+
+UnknownIndexView::UnknownIndexView(std::string_view ledger, std::string_view index)
+    : m_ledger(ledger)
+    , m_index(index)
+{}
+
+sappp::Result<UnknownIndexView> UnknownIndexView::open(std::string_view ledger,
+                                                       std::string_view index)
+{
+    if (index.size() < kIndexHeaderSize || !index.starts_with(kIndexMagic)) {
+        return std::unexpected(stale_index("unrecognized format"));
+    }
+    if (header_field(index, kLedgerSizeField) != ledger.size()) {
+        return std::unexpected(stale_index("ledger size differs"));
+    }
+    const std::uint64_t max_records = (index.size() - kIndexHeaderSize) / kRecordSize;
+    const std::uint64_t po_count = header_field(index, kPoIdCountField);
+    const std::uint64_t id_count = header_field(index, kUnknownIdCountField);
+    if (po_count > max_records || id_count > max_records - po_count
+        || !slice(index,
+                  header_field(index, kHeaderOffsetField),
+                  header_field(index, kHeaderSizeField))) {
+        return std::unexpected(stale_index("truncated"));
+    }
+    return UnknownIndexView(ledger, index);
+}
+
+sappp::Result<nlohmann::json> UnknownIndexView::find_by_po_id(std::string_view po_id) const
+{
+    return find(kPoIdTable, po_id, "po_id");
+}
+
+sappp::Result<nlohmann::json>
+UnknownIndexView::find_by_unknown_id(std::string_view unknown_id) const
+{
+    return find(kUnknownIdTable, unknown_id, "unknown_stable_id");
+}
+
+sappp::Result<nlohmann::json> UnknownIndexView::entries_by_po_id(std::string_view po_id) const
+{
+    return entries(kPoIdTable, po_id, "po_id");
+}
+
+sappp::Result<nlohmann::json>
+UnknownIndexView::entries(std::size_t table, std::string_view key, std::string_view field) const
+{
+    const std::uint64_t po_count = header_field(m_index, kPoIdCountField);
+    const std::uint64_t count =
+        table == kPoIdTable ? po_count : header_field(m_index, kUnknownIdCountField);
+    const std::size_t table_begin =
+        kIndexHeaderSize + (table == kPoIdTable ? 0 : po_count * kRecordSize);
+    auto record_field = [&](std::uint64_t record, std::size_t record_field_index) {
+        return get_u64(m_index,
+                       table_begin + (record * kRecordSize) + (record_field_index * kFieldSize));
+    };
+    // Out-of-range keys compare as empty; the entry check below rejects such records.
+    auto key_at = [&](std::uint64_t record) {
+        return slice(m_index,
+                     record_field(record, kKeyOffsetField),
+                     record_field(record, kKeySizeField))
+            .value_or(std::string_view{});
+    };
+
+    const auto records = std::views::iota(std::uint64_t{0}, count);
+    const auto first = std::ranges::partition_point(
+        records, [&](std::uint64_t record) { return key_at(record) < key; });
+
+    nlohmann::json entries = nlohmann::json::array();
+    for (auto it = first; it != records.end() && key_at(*it) == key; ++it) {
+        auto entry_bytes = slice(m_ledger,
+                                 record_field(*it, kEntryOffsetField),
+                                 record_field(*it, kEntrySizeField));
+        if (!entry_bytes) {
+            return std::unexpected(stale_index("entry outside the ledger"));
+        }
+        nlohmann::json entry = nlohmann::json::parse(*entry_bytes, nullptr, false);
+        auto value = entry.is_object() ? entry.find(field) : entry.end();
+        if (value == entry.end() || !value->is_string()
+            || value->get_ref<const std::string&>() != key) {
+            return std::unexpected(stale_index("entry does not match its key"));
+        }
+        entries.push_back(std::move(entry));
+    }
+    return entries;
+}
+
+sappp::Result<nlohmann::json>
+UnknownIndexView::find(std::size_t table, std::string_view key, std::string_view field) const
+{
+    auto found = entries(table, key, field);
+    if (!found) {
+        return std::unexpected(found.error());
+    }
+    auto header_bytes = slice(m_index,
+                              header_field(m_index, kHeaderOffsetField),
+                              header_field(m_index, kHeaderSizeField));
+    nlohmann::json document = nlohmann::json::parse(*header_bytes, nullptr, false);
+    if (!document.is_object()) {
+        return std::unexpected(stale_index("unreadable ledger header"));
+    }
+    document["unknowns"] = std::move(*found);
+    return document;
+}
+
+UnknownIndex::UnknownIndex(sappp::common::MappedFile ledger, sappp::common::MappedFile index)
+    : m_ledger(std::move(ledger))
+    , m_index(std::move(index))
+{}
+
+sappp::Result<UnknownIndex> UnknownIndex::open(const std::filesystem::path& ledger_path)
+{
+    const auto index_path = unknown_index_path(ledger_path);
+    auto ledger = sappp::common::MappedFile::open(ledger_path);
+    if (!ledger) {
+        return std::unexpected(ledger.error());
+    }
+    auto index = sappp::common::MappedFile::open(index_path);
+    if (!index) {
+        return std::unexpected(index.error());
+    }
+
+    std::error_code ec;
+    const auto ledger_time = std::filesystem::last_write_time(ledger_path, ec);
+    const auto index_time = ec ? ledger_time : std::filesystem::last_write_time(index_path, ec);
+    if (ec) {
+        return std::unexpected(
+            Error::make("IOError", "Failed to stat " + index_path.string() + ": " + ec.message()));
+    }
+    if (index_time < ledger_time) {
+        return std::unexpected(stale_index("older than " + ledger_path.string()));
+    }
+    if (auto checked = UnknownIndexView::open(ledger->view(), index->view()); !checked) {
+        return std::unexpected(checked.error());
+    }
+    return UnknownIndex(std::move(*ledger), std::move(*index));
+}
+
+sappp::Result<nlohmann::json> UnknownIndex::find_by_po_id(std::string_view po_id) const
+{
+    return view().find_by_po_id(po_id);
+}
+
+sappp::Result<nlohmann::json> UnknownIndex::find_by_unknown_id(std::string_view unknown_id) const
+{
+    return view().find_by_unknown_id(unknown_id);
+}
+
+UnknownIndexView UnknownIndex::view() const
+{
+    // The mapped views are only taken here, so they follow a moved UnknownIndex.
+    return UnknownIndexView(m_ledger.view(), m_index.view());
+}
+
+}  // namespace sappp::report
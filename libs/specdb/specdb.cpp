@@ -6,14 +6,20 @@
 #include "sappp/specdb.hpp"
 
 #include "sappp/canonical_json.hpp"
+#include "sappp/mapped_file.hpp"
+#include "sappp/parallel.hpp"
 #include "sappp/schema_validate.hpp"
+#include "sappp/version.hpp"
 
 #include <algorithm>
 #include <cctype>
+#include <cstddef>
+#include <cstring>
 #include <exception>
 #include <filesystem>
 #include <fstream>
 #include <iterator>
+#include <optional>
 #include <ranges>
 #include <string>
 #include <string_view>
@@ -218,46 +224,94 @@ normalize_contract_document(const nlohmann::json& input,
     return std::vector<nlohmann::json>{std::move(*normalized)};
 }
 
+/// Offset of the first "//@sappp" at or after @p from, or npos.
+[[nodiscard]] std::size_t find_annotation_prefix(std::string_view text, std::size_t from)
+{
+    // '@' is rare in C/C++ sources: anchor on it with memchr (vectorized by libc) and
+    // compare the full prefix only at candidate positions.
+    constexpr std::size_t kAnchor = 2;
+    static_assert(kAnnotationPrefix[kAnchor] == '@');
+    std::size_t pos = from + kAnchor;
+    while (pos < text.size()) {
+        const void* hit = std::memchr(text.data() + pos, '@', text.size() - pos);
+        if (hit == nullptr) {
+            break;
+        }
+        const auto anchor = static_cast<std::size_t>(static_cast<const char*>(hit) - text.data());
+        if (text.substr(anchor - kAnchor).starts_with(kAnnotationPrefix)) {
+            return anchor - kAnchor;
+        }
+        pos = anchor + 1;
+    }
+    return std::string_view::npos;
+}
+
+/// Contract of one annotation line, given the text after the prefix (nullopt if not one).
+[[nodiscard]] sappp::Result<std::optional<nlohmann::json>>
+parse_annotation(std::string_view tail, const AnnotationFileSpec& spec, std::size_t line_no)
+{
+    std::string trimmed = trim_left(tail);
+    if (!trimmed.starts_with(kAnnotationContract)) {
+        return std::nullopt;
+    }
+    trimmed = trim_left(std::string_view(trimmed).substr(kAnnotationContract.size()));
+    std::string payload_text = trim(trimmed);
+    if (payload_text.empty()) {
+        return std::unexpected(sappp::Error::make("InvalidContract",
+                                                  "Empty contract annotation in "
+                                                      + spec.path.string() + ":"
+                                                      + std::to_string(line_no)));
+    }
+    auto parsed = parse_inline_contract({.text = payload_text, .source = spec.path.string()});
+    if (!parsed) {
+        return std::unexpected(parsed.error());
+    }
+    auto normalized = normalize_contract_ir(*parsed, spec.schema_dir);
+    if (!normalized) {
+        return std::unexpected(normalized.error());
+    }
+    return std::move(*normalized);
+}
+
+/**
+ * @brief Contracts annotated in one source file, in line order
+ *
+ * The file is scanned through a read-only mapping; line numbers are only counted up to
+ * each hit. As with line-wise reading, only the first prefix on a line is considered.
+ */
 [[nodiscard]] sappp::Result<std::vector<nlohmann::json>>
 parse_annotations_in_file(const AnnotationFileSpec& spec)
 {
-    std::ifstream in(spec.path);
-    if (!in) {
+    auto file = sappp::common::MappedFile::open(spec.path);
+    if (!file) {
         return std::unexpected(
             sappp::Error::make("IOError", "Failed to open source file: " + spec.path.string()));
     }
+    const std::string_view text = file->view();
     std::vector<nlohmann::json> contracts;
-    std::string line;
-    std::size_t line_no = 0;
-    while (std::getline(in, line)) {
-        ++line_no;
-        auto pos = line.find(kAnnotationPrefix);
-        if (pos == std::string::npos) {
-            continue;
-        }
-        std::string_view tail(line);
-        tail.remove_prefix(pos + kAnnotationPrefix.size());
-        std::string trimmed = trim_left(tail);
-        if (!trimmed.starts_with(kAnnotationContract)) {
-            continue;
+    std::size_t line_no = 1;
+    std::size_t counted = 0;
+    for (std::size_t pos = find_annotation_prefix(text, 0); pos != std::string_view::npos;
+         pos = find_annotation_prefix(text, pos)) {
+        line_no += static_cast<std::size_t>(
+            std::count(text.begin() + static_cast<std::ptrdiff_t>(counted),
+                       text.begin() + static_cast<std::ptrdiff_t>(pos),
+                       '\n'));
+        counted = pos;
+        std::size_t line_end = text.find('\n', pos);
+        if (line_end == std::string_view::npos) {
+            line_end = text.size();
         }
-        trimmed = trim_left(std::string_view(trimmed).substr(kAnnotationContract.size()));
-        std::string payload_text = trim(trimmed);
-        if (payload_text.empty()) {
-            return std::unexpected(sappp::Error::make("InvalidContract",
-                                                      "Empty contract annotation in "
-                                                          + spec.path.string() + ":"
-                                                          + std::to_string(line_no)));
-        }
-        auto parsed = parse_inline_contract({.text = payload_text, .source = spec.path.string()});
-        if (!parsed) {
-            return std::unexpected(parsed.error());
+        const std::size_t tail_begin = pos + kAnnotationPrefix.size();
+        auto contract =
+            parse_annotation(text.substr(tail_begin, line_end - tail_begin), spec, line_no);
+        if (!contract) {
+            return std::unexpected(contract.error());
         }
-        auto normalized = normalize_contract_ir(*parsed, spec.schema_dir);
-        if (!normalized) {
-            return std::unexpected(normalized.error());
+        if (*contract) {
+            contracts.push_back(std::move(**contract));
         }
-        contracts.push_back(std::move(*normalized));
+        pos = line_end;
     }
     return contracts;
 }
@@ -358,29 +412,257 @@ list_sidecar_files(const std::filesystem::path& spec_path)
     return json_files;
 }
 
+enum class SpecInputKind {
+    kSidecar,
+    kAnnotation,
+};
+
+/// A file contributing contracts: a sidecar JSON document or an annotated source.
+struct SpecInput
+{
+    std::filesystem::path path;
+    SpecInputKind kind = SpecInputKind::kSidecar;
+};
+
+/// Sidecars (path order) followed by annotation sources (path order).
+[[nodiscard]] sappp::Result<std::vector<SpecInput>> collect_spec_inputs(const BuildOptions& options)
+{
+    std::vector<SpecInput> inputs;
+    if (std::filesystem::is_regular_file(options.spec_path)) {
+        inputs.push_back({.path = options.spec_path, .kind = SpecInputKind::kSidecar});
+    } else if (!options.spec_path.empty()) {
+        auto json_files = list_sidecar_files(options.spec_path);
+        if (!json_files) {
+            return std::unexpected(json_files.error());
+        }
+        for (auto& path : *json_files) {
+            inputs.push_back({.path = std::move(path), .kind = SpecInputKind::kSidecar});
+        }
+    }
+    auto sources = collect_annotation_sources(options.build_snapshot);
+    if (!sources) {
+        return std::unexpected(sources.error());
+    }
+    for (auto& path : *sources) {
+        inputs.push_back({.path = std::move(path), .kind = SpecInputKind::kAnnotation});
+    }
+    return inputs;
+}
+
 [[nodiscard]] sappp::Result<std::vector<nlohmann::json>>
-load_sidecar_contracts(const std::filesystem::path& spec_path,
-                       const std::filesystem::path& schema_dir)
+load_spec_input(const SpecInput& input, const std::filesystem::path& schema_dir)
 {
-    std::vector<nlohmann::json> contracts;
-    if (spec_path.empty()) {
+    if (input.kind == SpecInputKind::kSidecar) {
+        return load_contracts_from_path(input.path, schema_dir);
+    }
+    return parse_annotations_in_file({.path = input.path, .schema_dir = schema_dir});
+}
+
+/**
+ * @brief Normalized contracts of each spec input, persisted across runs
+ *
+ * Stored as <cache_dir>/contracts.json. Entries are keyed by input kind and path and are
+ * valid for one content digest; the file header binds the tool build and the schemas, so
+ * any change there discards every entry. Entries are revalidated on lookup, and an entry
+ * that fails is a miss. A digest over all inputs also records the resulting
+ * specdb_digest, letting an unchanged run skip revalidation of the merged snapshot.
+ * Unreadable caches are misses and write failures are ignored, so the cache can never
+ * turn a SpecDB build into an error.
+ */
+class ContractCache
+{
+public:
+    ContractCache(const std::filesystem::path& cache_dir,
+                  std::string context,
+                  std::filesystem::path schema_dir)
+        : m_path(cache_dir / "contracts.json")
+        , m_context(std::move(context))
+        , m_schema_dir(std::move(schema_dir))
+        , m_previous(nlohmann::json::object())
+        , m_next(nlohmann::json::object())
+        , m_snapshot(nlohmann::json::object())
+    {
+        std::ifstream in(m_path, std::ios::binary);
+        if (!in) {
+            return;
+        }
+        nlohmann::json document = nlohmann::json::parse(in, nullptr, false);
+        if (document.is_discarded() || !document.is_object()
+            || document.value("format", "") != kFormat
+            || document.value("context", "") != m_context) {
+            return;
+        }
+        if (document.contains("files") && document.at("files").is_object()) {
+            m_previous = std::move(document.at("files"));
+        }
+        if (document.contains("snapshot") && document.at("snapshot").is_object()) {
+            m_snapshot = std::move(document.at("snapshot"));
+        }
+    }
+
+    [[nodiscard]] static std::string key(const SpecInput& input)
+    {
+        return std::string(input.kind == SpecInputKind::kSidecar ? "sidecar:" : "annotation:")
+               + input.path.generic_string();
+    }
+
+    [[nodiscard]] std::optional<std::vector<nlohmann::json>> lookup(const std::string& key,
+                                                                     const std::string& digest)
+    {
+        auto it = m_previous.find(key);
+        if (it == m_previous.end() || !it->is_object() || it->value("sha256", "") != digest
+            || !it->contains("contracts") || !it->at("contracts").is_array()) {
+            return std::nullopt;
+        }
+        // The cache file is not trusted: each contract must still pass the schema and be
+        // a fixed point of normalization, otherwise the input is loaded again.
+        auto contracts = it->at("contracts").get<std::vector<nlohmann::json>>();
+        for (const auto& contract : contracts) {
+            auto normalized = normalize_contract_ir(contract, m_schema_dir);
+            if (!normalized || *normalized != contract) {
+                return std::nullopt;
+            }
+        }
+        m_next[key] = *it;
         return contracts;
     }
-    if (std::filesystem::is_regular_file(spec_path)) {
-        return load_contracts_from_path(spec_path, schema_dir);
+
+    void store(const std::string& key,
+               const std::string& digest,
+               const std::vector<nlohmann::json>& contracts)
+    {
+        m_next[key] = {
+            {   "sha256",    digest},
+            {"contracts", contracts}
+        };
     }
-    auto json_files = list_sidecar_files(spec_path);
-    if (!json_files) {
-        return std::unexpected(json_files.error());
+
+    /// specdb_digest recorded for the same set of input digests, if any.
+    [[nodiscard]] std::optional<std::string> specdb_digest(const std::string& inputs_digest) const
+    {
+        if (m_snapshot.value("inputs", "") != inputs_digest
+            || !m_snapshot.contains("specdb_digest")
+            || !m_snapshot.at("specdb_digest").is_string()) {
+            return std::nullopt;
+        }
+        return m_snapshot.at("specdb_digest").get<std::string>();
+    }
+
+    void set_specdb_digest(const std::string& inputs_digest, const std::string& specdb_digest)
+    {
+        m_snapshot = {
+            {       "inputs",  inputs_digest},
+            {"specdb_digest", specdb_digest}
+        };
+    }
+
+    /// Best-effort write of the entries used by this run (stale entries are dropped).
+    void save() const
+    {
+        const nlohmann::json document = {
+            {  "format",    kFormat},
+            { "context",  m_context},
+            {   "files",     m_next},
+            {"snapshot", m_snapshot}
+        };
+        std::error_code ec;
+        std::filesystem::create_directories(m_path.parent_path(), ec);
+        std::filesystem::path temp_path = m_path;
+        temp_path += ".tmp";
+        {
+            std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                return;
+            }
+            out << document.dump();
+            if (!out) {
+                return;
+            }
+        }
+        std::filesystem::rename(temp_path, m_path, ec);
+        if (ec) {
+            std::filesystem::remove(temp_path, ec);
+        }
     }
-    for (const auto& path : *json_files) {
-        auto loaded = load_contracts_from_path(path, schema_dir);
-        if (!loaded) {
-            return std::unexpected(loaded.error());
+
+private:
+    static constexpr std::string_view kFormat = "specdb_contract_cache.v1";
+
+    std::filesystem::path m_path;
+    std::string m_context;
+    std::filesystem::path m_schema_dir;
+    nlohmann::json m_previous;
+    nlohmann::json m_next;
+    nlohmann::json m_snapshot;
+};
+
+/// Cache context: the tool build plus the schemas contracts and snapshots are checked against.
+[[nodiscard]] std::optional<std::string> contract_cache_context(const BuildOptions& options,
+                                                                common::FileHashCache& hashes)
+{
+    std::string context = std::string(sappp::kVersion) + "\n" + std::string(sappp::kBuildId);
+    for (const auto* name : {"contract_ir.v1.schema.json", "specdb_snapshot.v1.schema.json"}) {
+        auto digest = hashes.digest(options.schema_dir / name);
+        if (!digest) {
+            return std::nullopt;
+        }
+        context += "\n" + *digest;
+    }
+    return common::sha256_prefixed(context);
+}
+
+/**
+ * @brief Contracts of every spec input, concatenated in input order
+ *
+ * Inputs with a digest and a @p cache entry are reused; the others are loaded on up to
+ * @p jobs workers and stored back into @p cache. The first failing input in order wins,
+ * independent of scheduling.
+ */
+[[nodiscard]] sappp::Result<std::vector<nlohmann::json>>
+collect_spec_contracts(const std::vector<SpecInput>& inputs,
+                       const std::vector<std::optional<std::string>>& digests,
+                       ContractCache* cache,
+                       const std::filesystem::path& schema_dir,
+                       std::size_t jobs)
+{
+    std::vector<std::vector<nlohmann::json>> loaded(inputs.size());
+    std::vector<bool> cached(inputs.size(), false);
+    for (std::size_t i = 0; cache != nullptr && i < inputs.size(); ++i) {
+        if (!digests[i]) {
+            continue;
+        }
+        if (auto contracts = cache->lookup(ContractCache::key(inputs[i]), *digests[i])) {
+            loaded[i] = std::move(*contracts);
+            cached[i] = true;
+        }
+    }
+    // Unreadable inputs are never cached; loading them reports the usual error.
+    auto scanned = common::parallel_for_each_index(
+        inputs.size(),
+        jobs,
+        [&](std::size_t i) -> sappp::VoidResult {
+            if (cached[i]) {
+                return {};
+            }
+            auto contracts = load_spec_input(inputs[i], schema_dir);
+            if (!contracts) {
+                return std::unexpected(contracts.error());
+            }
+            loaded[i] = std::move(*contracts);
+            return {};
+        });
+    if (!scanned) {
+        return std::unexpected(scanned.error());
+    }
+
+    std::vector<nlohmann::json> contracts;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        if (cache != nullptr && digests[i] && !cached[i]) {
+            cache->store(ContractCache::key(inputs[i]), *digests[i], loaded[i]);
         }
         contracts.insert(contracts.end(),
-                         std::make_move_iterator(loaded->begin()),
-                         std::make_move_iterator(loaded->end()));
+                         std::make_move_iterator(loaded[i].begin()),
+                         std::make_move_iterator(loaded[i].end()));
     }
     return contracts;
 }
@@ -428,27 +710,6 @@ struct ContractSortKey
                            .contract_id = std::move(contract_id)};
 }
 
-[[nodiscard]] sappp::Result<std::vector<nlohmann::json>>
-collect_annotation_contracts(const nlohmann::json& build_snapshot,
-                             const std::filesystem::path& schema_dir)
-{
-    auto sources = collect_annotation_sources(build_snapshot);
-    if (!sources) {
-        return std::unexpected(sources.error());
-    }
-    std::vector<nlohmann::json> contracts;
-    for (const auto& path : *sources) {
-        auto annotations = parse_annotations_in_file({.path = path, .schema_dir = schema_dir});
-        if (!annotations) {
-            return std::unexpected(annotations.error());
-        }
-        contracts.insert(contracts.end(),
-                         std::make_move_iterator(annotations->begin()),
-                         std::make_move_iterator(annotations->end()));
-    }
-    return contracts;
-}
-
 [[nodiscard]] std::vector<nlohmann::json> dedupe_contracts(std::vector<nlohmann::json> contracts)
 {
     std::unordered_set<std::string> seen_contracts;
@@ -531,27 +792,52 @@ sappp::Result<nlohmann::json> normalize_contract_ir(const nlohmann::json& input,
     return contract;
 }
 
+// NOLINTNEXTLINE(readability-function-size) - load, merge and cache stay together.
 sappp::Result<nlohmann::json> build_snapshot(const BuildOptions& options)
 {
-    std::vector<nlohmann::json> contracts;
-    auto sidecar_contracts = load_sidecar_contracts(options.spec_path, options.schema_dir);
-    if (!sidecar_contracts) {
-        return std::unexpected(sidecar_contracts.error());
+    auto inputs = collect_spec_inputs(options);
+    if (!inputs) {
+        return std::unexpected(inputs.error());
+    }
+
+    common::FileHashCache local_hashes;
+    common::FileHashCache& hashes =
+        options.file_hashes != nullptr ? *options.file_hashes : local_hashes;
+    std::optional<ContractCache> cache;
+    std::vector<std::optional<std::string>> digests(inputs->size());
+    if (!options.cache_dir.empty()) {
+        if (auto context = contract_cache_context(options, hashes)) {
+            cache.emplace(options.cache_dir, std::move(*context), options.schema_dir);
+            std::vector<std::filesystem::path> paths;
+            paths.reserve(inputs->size());
+            for (const auto& input : *inputs) {
+                paths.push_back(input.path);
+            }
+            auto hashed = hashes.digest_all(paths, options.jobs);
+            for (std::size_t i = 0; i < hashed.size(); ++i) {
+                if (hashed[i]) {
+                    digests[i] = std::move(*hashed[i]);
+                }
+            }
+        }
     }
-    contracts.insert(contracts.end(),
-                     std::make_move_iterator(sidecar_contracts->begin()),
-                     std::make_move_iterator(sidecar_contracts->end()));
 
-    auto annotation_contracts =
-        collect_annotation_contracts(options.build_snapshot, options.schema_dir);
-    if (!annotation_contracts) {
-        return std::unexpected(annotation_contracts.error());
+    std::string inputs_key;
+    for (std::size_t i = 0; i < inputs->size(); ++i) {
+        if (digests[i]) {
+            inputs_key += ContractCache::key((*inputs)[i]) + "\n" + *digests[i] + "\n";
+        }
+    }
+    auto contracts = collect_spec_contracts(*inputs,
+                                            digests,
+                                            cache ? &*cache : nullptr,
+                                            options.schema_dir,
+                                            options.jobs);
+    if (!contracts) {
+        return std::unexpected(contracts.error());
     }
-    contracts.insert(contracts.end(),
-                     std::make_move_iterator(annotation_contracts->begin()),
-                     std::make_move_iterator(annotation_contracts->end()));
 
-    auto unique_contracts = dedupe_contracts(std::move(contracts));
+    auto unique_contracts = dedupe_contracts(std::move(*contracts));
     sort_contracts(unique_contracts);
 
     nlohmann::json snapshot = {
@@ -567,11 +853,36 @@ sappp::Result<nlohmann::json> build_snapshot(const BuildOptions& options)
     }
     snapshot["specdb_digest"] = *digest;
 
+    // Every contract was validated when it was loaded or taken from the cache, so a
+    // snapshot whose digest was already validated for the same input set is not
+    // revalidated. The recorded digest is only compared, never trusted.
+    const bool all_inputs_keyed =
+        cache && std::ranges::all_of(digests, [](const auto& input) noexcept {
+            return input.has_value();
+        });
+    const std::string inputs_digest =
+        all_inputs_keyed ? common::sha256_prefixed(inputs_key) : std::string{};
+    const auto save_cache = [&options, &cache]() {
+        if (!options.may_save_cache || options.may_save_cache()) {
+            cache->save();
+        }
+    };
+    if (all_inputs_keyed && cache->specdb_digest(inputs_digest) == *digest) {
+        save_cache();
+        return snapshot;
+    }
+
     const auto schema_path = (options.schema_dir / "specdb_snapshot.v1.schema.json").string();
     if (auto validation = sappp::common::validate_json(snapshot, schema_path); !validation) {
         return std::unexpected(validation.error());
     }
 
+    if (cache) {
+        if (all_inputs_keyed) {
+            cache->set_specdb_digest(inputs_digest, *digest);
+        }
+        save_cache();
+    }
     return snapshot;
 }
 
@@ -7,7 +7,10 @@
 
 #include "sappp/canonical_json.hpp"
 #include "sappp/common.hpp"
+#include "sappp/pack.hpp"
+#include "sappp/run_stats.hpp"
 #include "sappp/schema_validate.hpp"
+#include "sappp/trace.hpp"
 #include "sappp/version.hpp"
 
 #include <algorithm>
@@ -18,9 +21,12 @@
 #include <iomanip>
 #include <iterator>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <ranges>
 #include <string_view>
+#include <tuple>
 #include <unordered_map>
 #include <vector>
 
@@ -37,6 +43,11 @@ struct ValidationError
     std::string message;
 };
 
+/// Dense id of an interned NIR function, block or edge kind.
+using NirId = std::uint32_t;
+
+constexpr NirId kUnknownNirId = std::numeric_limits<NirId>::max();
+
 struct NirInstruction
 {
     std::string op;
@@ -45,44 +56,56 @@ struct NirInstruction
 
 struct NirBlock
 {
-    std::unordered_map<std::string, NirInstruction> insts;
+    std::unordered_map<std::string, std::size_t> inst_ids;
+    std::vector<NirInstruction> insts;
 
     NirBlock()
         // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
-        : insts()
+        : inst_ids()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , insts()
     {}
 };
 
 struct NirEdge
 {
-    std::string to;
-    std::string kind;
+    NirId to;
+    NirId kind;
 };
 
+/// CFG of one function; blocks are interned in NIR order and successor lists are sorted.
 struct NirFunction
 {
-    std::unordered_map<std::string, NirBlock> blocks;
-    std::unordered_map<std::string, std::vector<NirEdge>> edges;
-    std::string entry_block;
+    std::unordered_map<std::string, NirId> block_ids;
+    std::vector<NirBlock> blocks;
+    std::vector<std::vector<NirEdge>> successors;
+    NirId entry_block;
 
     NirFunction()
         // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
-        : blocks()
+        : block_ids()
         // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
-        , edges()
+        , blocks()
         // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
-        , entry_block()
+        , successors()
+        , entry_block(kUnknownNirId)
     {}
 };
 
 struct NirIndex
 {
-    std::unordered_map<std::string, NirFunction> functions;
+    std::unordered_map<std::string, NirId> function_ids;
+    std::vector<NirFunction> functions;
+    std::unordered_map<std::string, NirId> edge_kinds;
     std::string tu_id;
 
     NirIndex()
         // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
-        : functions()
+        : function_ids()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , functions()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , edge_kinds()
         // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
         , tu_id()
     {}
@@ -101,11 +124,17 @@ struct NirContext
     {}
 };
 
+class InputTree;
+class CertObjectCache;
+class ValidationResultCache;
+
 struct ValidationContext
 {
-    const fs::path* input_dir;
+    const InputTree* input;
     const std::string* schema_dir;
     const NirContext* nir_context;
+    CertObjectCache* cert_cache;
+    const ValidationResultCache* result_cache;
     bool strict;
 };
 
@@ -157,8 +186,8 @@ constexpr std::string_view kDeterministicGeneratedAt = "1970-01-01T00:00:00Z";
     return (fs::path(schema_dir) / "nir.v1.schema.json").string();
 }
 
-[[nodiscard]] sappp::Result<std::string> object_path_for_hash(const fs::path& base_dir,
-                                                              const std::string& hash)
+/// Location of a certificate object relative to the input root.
+[[nodiscard]] sappp::Result<std::string> object_name_for_hash(const std::string& hash)
 {
     constexpr std::string_view kPrefix = "sha256:";
     std::size_t digest_start = hash.starts_with(kPrefix) ? kPrefix.size() : 0;
@@ -166,48 +195,158 @@ constexpr std::string_view kDeterministicGeneratedAt = "1970-01-01T00:00:00Z";
         return std::unexpected(Error::make("InvalidHash", "Hash is too short: " + hash));
     }
     std::string shard = hash.substr(digest_start, 2);
-    fs::path object_path = base_dir / "certstore" / "objects" / shard / (hash + ".json");
-    return object_path.string();
+    return "certstore/objects/" + shard + "/" + hash + ".json";
 }
 
-[[nodiscard]] sappp::Result<nlohmann::json> read_json_file(const std::string& path)
+[[nodiscard]] sappp::Result<std::string> read_file_contents(const std::string& path)
 {
     std::ifstream in(path, std::ios::binary);
     if (!in.is_open()) {
         return std::unexpected(Error::make("IOError", "Failed to open file for read: " + path));
     }
-    std::string content{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    return std::string{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
+[[nodiscard]] sappp::Result<nlohmann::json> read_json_file(const std::string& path)
+{
+    auto content = read_file_contents(path);
+    if (!content) {
+        return std::unexpected(content.error());
+    }
     try {
-        return nlohmann::json::parse(content);
+        return nlohmann::json::parse(*content);
     } catch (const std::exception& ex) {
         return std::unexpected(
             Error::make("ParseError", "Failed to parse JSON from " + path + ": " + ex.what()));
     }
 }
 
-[[nodiscard]] std::optional<std::string> read_generated_at_from(const fs::path& path)
-{
-    auto json = read_json_file(path.string());
-    if (!json) {
-        return std::nullopt;
+constexpr std::string_view kNirName = "frontend/nir.json";
+constexpr std::string_view kIndexDirName = "certstore/index";
+// The last entry is where a pack stores the build snapshot.
+constexpr std::array<std::string_view, 5> kGeneratedAtSources{
+    {"config/analysis_config.json",
+     kNirName, "po/po_list.json",
+     "build_snapshot.json", "inputs/build_snapshot.json"}
+};
+
+/**
+ * @brief Analysis outputs, read from a directory or from a pack archive.
+ *
+ * Members are addressed by '/'-separated names relative to the output root. A pack is
+ * never extracted: each member is inflated on demand from the nearest access point of the
+ * pack index, so only the member being validated is held in memory.
+ */
+class InputTree
+{
+public:
+    [[nodiscard]] static sappp::Result<InputTree> open(const fs::path& input)
+    {
+        InputTree tree(input);
+        if (!sappp::pack::is_pack_archive(input)) {
+            return tree;
+        }
+        auto reader = sappp::pack::PackReader::open(input);
+        if (!reader) {
+            return std::unexpected(reader.error());
+        }
+        tree.m_pack.emplace(std::move(*reader));
+        return tree;
     }
-    if (!json->contains("generated_at") || !(*json)["generated_at"].is_string()) {
-        return std::nullopt;
+
+    /// False for pack archives.
+    [[nodiscard]] bool is_directory() const noexcept { return !m_pack.has_value(); }
+
+    [[nodiscard]] const fs::path& root() const noexcept { return m_root; }
+
+    /// Human-readable location of @p name for messages.
+    [[nodiscard]] std::string display(std::string_view name) const
+    {
+        if (m_pack) {
+            return m_root.string() + ":" + member_name(name);
+        }
+        return (m_root / name).string();
     }
-    return (*json)["generated_at"].get<std::string>();
-}
 
-[[nodiscard]] std::string pick_generated_at(const fs::path& input_dir)
+    [[nodiscard]] sappp::Result<bool> exists(std::string_view name) const
+    {
+        if (m_pack) {
+            return m_pack->find(member_name(name)) != nullptr;
+        }
+        std::error_code ec;
+        const bool found = fs::exists(m_root / name, ec);
+        if (ec) {
+            return std::unexpected(Error::make(
+                "IOError", "Failed to stat " + display(name) + ": " + ec.message()));
+        }
+        return found;
+    }
+
+    [[nodiscard]] sappp::Result<std::string> read(std::string_view name) const
+    {
+        if (!m_pack) {
+            return read_file_contents(display(name));
+        }
+        const auto* member = m_pack->find(member_name(name));
+        if (member == nullptr) {
+            return std::unexpected(
+                Error::make("IOError", "Failed to open file for read: " + display(name)));
+        }
+        return m_pack->read(member->name);
+    }
+
+    [[nodiscard]] sappp::Result<nlohmann::json> read_json(std::string_view name) const
+    {
+        auto content = read(name);
+        if (!content) {
+            return std::unexpected(content.error());
+        }
+        try {
+            return nlohmann::json::parse(*content);
+        } catch (const std::exception& ex) {
+            return std::unexpected(Error::make(
+                "ParseError", "Failed to parse JSON from " + display(name) + ": " + ex.what()));
+        }
+    }
+
+    /// Names of the regular *.json files directly inside the pack's @p dir, sorted.
+    [[nodiscard]] std::vector<std::string> pack_json_files(std::string_view dir) const
+    {
+        std::vector<std::string> names;
+        const std::string prefix = member_name(dir) + "/";
+        const auto& members = m_pack->members();
+        auto it = std::ranges::lower_bound(members, prefix, {}, &sappp::pack::PackMember::name);
+        for (; it != members.end() && it->name.starts_with(prefix); ++it) {
+            const std::string_view rest = std::string_view(it->name).substr(prefix.size());
+            if (!rest.contains('/') && rest.ends_with(".json")) {
+                names.push_back(it->name.substr(sappp::pack::kPackRootPrefix.size()));
+            }
+        }
+        return names;
+    }
+
+private:
+    explicit InputTree(fs::path root)
+        : m_root(std::move(root))
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_pack()
+    {}
+
+    [[nodiscard]] static std::string member_name(std::string_view name)
+    {
+        return std::string(sappp::pack::kPackRootPrefix) + std::string(name);
+    }
+
+    fs::path m_root;
+    std::optional<sappp::pack::PackReader> m_pack;
+};
+
+[[nodiscard]] std::string pick_generated_at(const InputTree& input)
 {
-    const std::vector<fs::path> candidates = {
-        input_dir / "config" / "analysis_config.json",
-        input_dir / "frontend" / "nir.json",
-        input_dir / "po" / "po_list.json",
-        input_dir / "build_snapshot.json",
-    };
-    for (const auto& path : candidates) {
-        if (auto generated_at = read_generated_at_from(path); generated_at) {
-            return *generated_at;
+    for (const auto name : kGeneratedAtSources) {
+        auto json = input.read_json(name);
+        if (json && json->contains("generated_at") && (*json)["generated_at"].is_string()) {
+            return (*json)["generated_at"].get<std::string>();
         }
     }
     return std::string(kDeterministicGeneratedAt);
@@ -241,6 +380,7 @@ constexpr std::string_view kDeterministicGeneratedAt = "1970-01-01T00:00:00Z";
         return std::unexpected(
             Error::make("IOError", "Failed to write file: " + out_path.string()));
     }
+    sappp::common::stats::add(sappp::common::stats::Counter::kBytesWritten, canonical->size());
     return {};
 }
 
@@ -289,47 +429,323 @@ constexpr std::string_view kDeterministicGeneratedAt = "1970-01-01T00:00:00Z";
 [[nodiscard]] bool is_supported_safety_domain(std::string_view domain);
 
 [[nodiscard]] sappp::Result<nlohmann::json>
-load_cert_object(const fs::path& input_dir, std::string_view schema_dir, const std::string& hash)
+load_cert_object(const InputTree& input, std::string_view schema_dir, const std::string& hash)
 {
-    auto path = object_path_for_hash(input_dir, hash);
-    if (!path) {
-        return std::unexpected(path.error());
+    auto name = object_name_for_hash(hash);
+    if (!name) {
+        return std::unexpected(name.error());
     }
 
-    std::error_code ec;
-    if (!fs::exists(*path, ec)) {
-        if (ec) {
-            return std::unexpected(
-                Error::make("IOError",
-                            "Failed to stat certificate: " + *path + ": " + ec.message()));
-        }
+    auto found = input.exists(*name);
+    if (!found) {
+        return std::unexpected(found.error());
+    }
+    if (!*found) {
         return std::unexpected(Error::make("MissingDependency", "Missing certificate: " + hash));
     }
 
-    auto cert_result = read_json_file(*path);
-    if (!cert_result) {
-        return std::unexpected(cert_result.error());
+    auto content = input.read(*name);
+    if (!content) {
+        return std::unexpected(content.error());
+    }
+
+    // Objects are stored in canonical form, so the raw bytes hash to the object name.
+    auto document = sappp::canonical::parse_canonical(*content);
+    if (!document) {
+        if (document.error().code == "NonCanonicalJson") {
+            return std::unexpected(
+                Error::make("HashMismatch",
+                            "Certificate is not canonical JSON: " + document.error().message));
+        }
+        return std::unexpected(Error::make(document.error().code,
+                                           "Failed to parse JSON from " + input.display(*name)
+                                               + ": " + document.error().message));
     }
 
-    if (auto result = sappp::common::validate_json(*cert_result, cert_schema_path(schema_dir));
+    if (auto result = sappp::common::validate_json(document->value, cert_schema_path(schema_dir));
         !result) {
         return std::unexpected(
             Error::make("SchemaInvalid", "Certificate schema invalid: " + result.error().message));
     }
 
-    auto computed_hash = sappp::canonical::hash_canonical(*cert_result);
-    if (!computed_hash) {
-        return std::unexpected(computed_hash.error());
-    }
-    if (*computed_hash != hash) {
+    if (document->hash != hash) {
         return std::unexpected(
             Error::make("HashMismatch",
-                        "Certificate hash mismatch: expected " + hash + ", got " + *computed_hash));
+                        "Certificate hash mismatch: expected " + hash + ", got " + document->hash));
     }
 
-    return *cert_result;
+    return std::move(document->value);
 }
 
+[[nodiscard]] std::optional<ValidationError> check_contract_cert(const nlohmann::json& contract_cert)
+{
+    if (contract_cert.at("kind").get<std::string>() != "ContractRef") {
+        return rule_violation_error("Contract reference is not ContractRef");
+    }
+
+    std::string tier = contract_cert.at("tier").get<std::string>();
+    if (tier == "Tier2" || tier == "Disabled") {
+        return proof_failed_error("Contract tier not allowed for SAFE: " + tier);
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief Per-run cache of verified certificate objects keyed by hash.
+ *
+ * Roots share ContractRef/IrRef/PoDef objects, so each object is read,
+ * schema-validated and re-hashed once per validation run; load failures are
+ * cached too so every referencing root sees the same downgrade. ProofRoot and
+ * evidence objects belong to a single PO and are loaded through
+ * load_cert_object() instead, so the cache never holds one per PO. Derived
+ * verdicts (contract tier checks) are memoized alongside. Each entry is
+ * computed under its own once_flag, so lookups are safe from multiple threads.
+ */
+class CertObjectCache
+{
+public:
+    CertObjectCache(const InputTree& input, std::string_view schema_dir)
+        : m_input(&input)
+        , m_schema_dir(schema_dir)
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_mutex()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_objects()
+        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+        , m_contract_verdicts()
+    {}
+
+    CertObjectCache(const CertObjectCache&) = delete;
+    CertObjectCache& operator=(const CertObjectCache&) = delete;
+    CertObjectCache(CertObjectCache&&) = delete;
+    CertObjectCache& operator=(CertObjectCache&&) = delete;
+    ~CertObjectCache() = default;
+
+    /// Verified certificate for @p hash; the pointer stays valid for the cache lifetime.
+    [[nodiscard]] sappp::Result<const nlohmann::json*> load(const std::string& hash)
+    {
+        ObjectEntry& entry = find_or_create(m_objects, hash);
+        std::call_once(entry.once, [&] {
+            entry.cert = load_cert_object(*m_input, m_schema_dir, hash);
+        });
+        if (!entry.cert) {
+            return std::unexpected(entry.cert.error());
+        }
+        return &*entry.cert;
+    }
+
+    /// Verdict of the ContractRef checks for @p hash (std::nullopt when usable for SAFE).
+    [[nodiscard]] std::optional<ValidationError> contract_verdict(const std::string& hash)
+    {
+        VerdictEntry& entry = find_or_create(m_contract_verdicts, hash);
+        std::call_once(entry.once, [&] {
+            auto contract_cert = load(hash);
+            entry.verdict = contract_cert ? check_contract_cert(**contract_cert)
+                                          : make_error_from_result(contract_cert.error());
+        });
+        return entry.verdict;
+    }
+
+private:
+    struct ObjectEntry
+    {
+        std::once_flag once;
+        sappp::Result<nlohmann::json> cert;
+
+        ObjectEntry()
+            // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+            : once()
+            // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+            , cert()
+        {}
+    };
+
+    struct VerdictEntry
+    {
+        std::once_flag once;
+        std::optional<ValidationError> verdict;
+
+        VerdictEntry()
+            // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+            : once()
+            // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+            , verdict()
+        {}
+    };
+
+    template <typename Entry>
+    [[nodiscard]] Entry& find_or_create(
+        std::unordered_map<std::string, std::unique_ptr<Entry>>& entries,
+        const std::string& hash)
+    {
+        std::lock_guard lock(m_mutex);
+        auto& slot = entries[hash];
+        if (!slot) {
+            slot = std::make_unique<Entry>();
+        }
+        return *slot;
+    }
+
+    const InputTree* m_input;
+    std::string m_schema_dir;
+    std::mutex m_mutex;
+    std::unordered_map<std::string, std::unique_ptr<ObjectEntry>> m_objects;
+    std::unordered_map<std::string, std::unique_ptr<VerdictEntry>> m_contract_verdicts;
+};
+
+struct CachedResult
+{
+    nlohmann::json result;
+    std::string tu_id;
+};
+
+/**
+ * @brief Persistent cache of per-entry validation results (REQ-OPS-002).
+ *
+ * The cache is opt-in and lives in a caller-chosen directory outside the
+ * input tree, since whoever writes the analyzer output must not be able to
+ * plant verdicts. An entry is keyed by po_id, the proof root hash and a run
+ * digest covering the tool build, VersionTriple, strict flag, the contents of
+ * the schemas and the NIR; any change there selects a different key. Each
+ * entry lists the content hashes of every certificate object the result
+ * depended on, and a hit requires each object in the input to still hash to
+ * its recorded value and the stored result to name the same po_id and root.
+ * Unreadable entries are treated as misses and write failures are ignored,
+ * so the cache can never turn a validation into an error.
+ */
+class ValidationResultCache
+{
+public:
+    ValidationResultCache(const InputTree& input,
+                          fs::path cache_dir,
+                          std::string run_digest) noexcept
+        : m_input(&input)
+        , m_cache_dir(std::move(cache_dir))
+        , m_run_digest(std::move(run_digest))
+    {}
+
+    ValidationResultCache(const ValidationResultCache&) = delete;
+    ValidationResultCache& operator=(const ValidationResultCache&) = delete;
+    ValidationResultCache(ValidationResultCache&&) = delete;
+    ValidationResultCache& operator=(ValidationResultCache&&) = delete;
+    ~ValidationResultCache() = default;
+
+    [[nodiscard]] std::optional<CachedResult> lookup(const std::string& po_id,
+                                                     const std::string& root_hash) const
+    {
+        const std::string key = entry_key(po_id, root_hash);
+        auto entry = read_json_file(entry_path(key).string());
+        if (!entry || !entry->is_object()) {
+            return std::nullopt;
+        }
+        if (entry->value("format", "") != kFormat || entry->value("key", "") != key
+            || entry->value("po_id", "") != po_id || entry->value("root", "") != root_hash) {
+            return std::nullopt;
+        }
+        if (!entry->contains("objects") || !entry->at("objects").is_array()
+            || !entry->contains("result") || !entry->at("result").is_object()
+            || !entry->contains("tu_id") || !entry->at("tu_id").is_string()) {
+            return std::nullopt;
+        }
+        const auto& objects = entry->at("objects");
+        if (std::ranges::find(objects, nlohmann::json(root_hash)) == objects.end()) {
+            return std::nullopt;
+        }
+        for (const auto& recorded : objects) {
+            if (!recorded.is_string() || !object_matches(recorded.get<std::string>())) {
+                return std::nullopt;
+            }
+        }
+        const nlohmann::json& result = entry->at("result");
+        if (!result_matches(result, po_id, root_hash)) {
+            return std::nullopt;
+        }
+        return CachedResult{.result = result, .tu_id = entry->at("tu_id").get<std::string>()};
+    }
+
+    /// Best-effort store; results caused by missing or unreadable inputs are not cached.
+    void store(const std::string& po_id,
+               const std::string& root_hash,
+               const std::string& tu_id,
+               const std::vector<std::string>& object_hashes,
+               const nlohmann::json& result) const
+    {
+        const std::string status = result.value("validator_status", "");
+        if (status == "IOError" || status == "MissingDependency") {
+            return;
+        }
+
+        const std::string key = entry_key(po_id, root_hash);
+        nlohmann::json entry = {
+            { "format",       kFormat},
+            {    "key",           key},
+            {  "po_id",         po_id},
+            {   "root",     root_hash},
+            {  "tu_id",         tu_id},
+            {"objects", object_hashes},
+            { "result",        result}
+        };
+
+        const fs::path path = entry_path(key);
+        fs::path temp_path = path;
+        temp_path += ".tmp";
+        if (!write_json_file(temp_path.string(), entry)) {
+            return;
+        }
+        std::error_code ec;
+        fs::rename(temp_path, path, ec);
+        if (ec) {
+            fs::remove(temp_path, ec);
+        }
+    }
+
+private:
+    static constexpr std::string_view kFormat = "validation_cache.v2";
+
+    [[nodiscard]] std::string entry_key(const std::string& po_id,
+                                        const std::string& root_hash) const
+    {
+        return sappp::common::sha256_prefixed(m_run_digest + "\n" + po_id + "\n" + root_hash);
+    }
+
+    [[nodiscard]] fs::path entry_path(const std::string& key) const
+    {
+        constexpr std::string_view kPrefix = "sha256:";
+        return m_cache_dir / key.substr(kPrefix.size(), 2) / (key + ".json");
+    }
+
+    /// Objects are stored canonically, so their raw bytes must hash to their name.
+    [[nodiscard]] bool object_matches(const std::string& hash) const
+    {
+        auto name = object_name_for_hash(hash);
+        if (!name) {
+            return false;
+        }
+        auto content = m_input->read(*name);
+        return content && sappp::common::sha256_prefixed(*content) == hash;
+    }
+
+    /// A cached verdict must describe this PO, and a confirmed one this root.
+    [[nodiscard]] static bool result_matches(const nlohmann::json& result,
+                                             const std::string& po_id,
+                                             const std::string& root_hash)
+    {
+        if (result.value("po_id", "") != po_id) {
+            return false;
+        }
+        const std::string category = result.value("category", "");
+        if (category == "UNKNOWN") {
+            return !result.contains("certificate_root");
+        }
+        return result.value("validator_status", "") == "Validated"
+               && result.value("certificate_root", "") == root_hash;
+    }
+
+    const InputTree* m_input;
+    fs::path m_cache_dir;
+    std::string m_run_digest;
+};
+
 [[nodiscard]] sappp::Result<nlohmann::json> finish_or_unknown(const std::string& po_id,
                                                               const ValidationError& error,
                                                               const ValidationContext& context)
@@ -340,10 +756,11 @@ load_cert_object(const fs::path& input_dir, std::string_view schema_dir, const s
     return make_unknown_result(po_id, error);
 }
 
-[[nodiscard]] sappp::Result<nlohmann::json> load_index_json(const fs::path& index_path,
+[[nodiscard]] sappp::Result<nlohmann::json> load_index_json(const InputTree& input,
+                                                            std::string_view index_name,
                                                             std::string_view schema_dir)
 {
-    auto index_json_result = read_json_file(index_path.string());
+    auto index_json_result = input.read_json(index_name);
     if (!index_json_result) {
         return std::unexpected(index_json_result.error());
     }
@@ -358,72 +775,101 @@ load_cert_object(const fs::path& input_dir, std::string_view schema_dir, const s
     return *index_json_result;
 }
 
+[[nodiscard]] NirId intern_nir_id(std::unordered_map<std::string, NirId>& ids, std::string key)
+{
+    auto next_id = static_cast<NirId>(ids.size());
+    return ids.try_emplace(std::move(key), next_id).first->second;
+}
+
 [[nodiscard]] sappp::Result<std::pair<std::string, NirBlock>>
 build_nir_block_entry(const nlohmann::json& block_json)
 {
     std::string block_id = block_json.at("id").get<std::string>();
     NirBlock block_index;
-    std::size_t inst_index = 0;
+    block_index.insts.reserve(block_json.at("insts").size());
     for (const auto& inst_json : block_json.at("insts")) {
         std::string inst_id = inst_json.at("id").get<std::string>();
         std::string op = inst_json.at("op").get<std::string>();
-        if (block_index.insts.contains(inst_id)) {
+        const std::size_t inst_index = block_index.insts.size();
+        if (!block_index.inst_ids.try_emplace(inst_id, inst_index).second) {
             return std::unexpected(
                 Error::make("NirInvalid", "Duplicate inst_id in NIR: " + inst_id));
         }
-        block_index.insts.emplace(std::move(inst_id),
-                                  NirInstruction{.op = std::move(op), .index = inst_index});
-        ++inst_index;
+        block_index.insts.push_back(NirInstruction{.op = std::move(op), .index = inst_index});
     }
     return std::make_pair(std::move(block_id), std::move(block_index));
 }
 
+[[nodiscard]] std::optional<NirId> find_block_id(const NirFunction& function,
+                                                 const std::string& block_id)
+{
+    auto it = function.block_ids.find(block_id);
+    if (it == function.block_ids.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
 [[nodiscard]] sappp::VoidResult add_nir_edges(const nlohmann::json& cfg,
-                                              NirFunction& function_index)
+                                              NirFunction& function_index,
+                                              std::unordered_map<std::string, NirId>& edge_kinds)
 {
+    function_index.successors.resize(function_index.blocks.size());
     for (const auto& edge_json : cfg.at("edges")) {
-        std::string from = edge_json.at("from").get<std::string>();
-        std::string to = edge_json.at("to").get<std::string>();
-        std::string kind = edge_json.at("kind").get<std::string>();
-        if (!function_index.blocks.contains(from) || !function_index.blocks.contains(to)) {
+        const auto& from = edge_json.at("from").get_ref<const std::string&>();
+        const auto& to = edge_json.at("to").get_ref<const std::string&>();
+        auto from_id = find_block_id(function_index, from);
+        auto to_id = find_block_id(function_index, to);
+        if (!from_id || !to_id) {
             std::string message = "NIR edge references missing block: ";
             message += from;
             message += " -> ";
             message += to;
             return std::unexpected(Error::make("NirInvalid", message));
         }
-        function_index.edges[from].push_back(NirEdge{.to = std::move(to), .kind = std::move(kind)});
+        NirId kind = intern_nir_id(edge_kinds, edge_json.at("kind").get<std::string>());
+        function_index.successors[*from_id].push_back(NirEdge{.to = *to_id, .kind = kind});
+    }
+    for (auto& successors : function_index.successors) {
+        std::ranges::sort(successors, [](const NirEdge& a, const NirEdge& b) noexcept {
+            return std::tie(a.to, a.kind) < std::tie(b.to, b.kind);
+        });
     }
     return {};
 }
 
-[[nodiscard]] sappp::Result<NirFunction> build_nir_function(const nlohmann::json& function_json)
+[[nodiscard]] sappp::Result<NirFunction>
+build_nir_function(const nlohmann::json& function_json,
+                   std::unordered_map<std::string, NirId>& edge_kinds)
 {
     NirFunction function_index;
     const auto& cfg = function_json.at("cfg");
     if (!cfg.contains("entry") || !cfg.at("entry").is_string()) {
         return std::unexpected(Error::make("NirInvalid", "Missing cfg.entry in NIR"));
     }
-    function_index.entry_block = cfg.at("entry").get<std::string>();
     const auto& blocks = cfg.at("blocks");
+    function_index.blocks.reserve(blocks.size());
     for (const auto& block_json : blocks) {
         auto block_entry = build_nir_block_entry(block_json);
         if (!block_entry) {
             return std::unexpected(block_entry.error());
         }
         auto [block_id, block_index] = std::move(*block_entry);
-        if (function_index.blocks.contains(block_id)) {
+        auto next_id = static_cast<NirId>(function_index.blocks.size());
+        if (!function_index.block_ids.try_emplace(block_id, next_id).second) {
             return std::unexpected(
                 Error::make("NirInvalid", "Duplicate block_id in NIR: " + block_id));
         }
-        function_index.blocks.emplace(std::move(block_id), std::move(block_index));
+        function_index.blocks.push_back(std::move(block_index));
     }
-    if (!function_index.blocks.contains(function_index.entry_block)) {
+    auto entry_block = find_block_id(function_index, cfg.at("entry").get<std::string>());
+    if (!entry_block) {
         return std::unexpected(
             Error::make("NirInvalid", "cfg.entry does not match any block in NIR"));
     }
+    function_index.entry_block = *entry_block;
 
-    if (auto edge_result = add_nir_edges(cfg, function_index); !edge_result) {
+    if (auto edge_result = add_nir_edges(cfg, function_index, edge_kinds); !edge_result) {
         return std::unexpected(edge_result.error());
     }
 
@@ -440,38 +886,37 @@ build_nir_block_entry(const nlohmann::json& block_json)
         return std::unexpected(Error::make("NirInvalid", "NIR functions field missing or invalid"));
     }
 
+    index.functions.reserve(functions.size());
     for (const auto& function_json : functions) {
         std::string function_uid = function_json.at("function_uid").get<std::string>();
-        if (index.functions.contains(function_uid)) {
+        auto next_id = static_cast<NirId>(index.functions.size());
+        if (!index.function_ids.try_emplace(function_uid, next_id).second) {
             return std::unexpected(
                 Error::make("NirInvalid", "Duplicate function_uid in NIR: " + function_uid));
         }
-        auto function_index = build_nir_function(function_json);
+        auto function_index = build_nir_function(function_json, index.edge_kinds);
         if (!function_index) {
             return std::unexpected(function_index.error());
         }
-        index.functions.emplace(std::move(function_uid), std::move(*function_index));
+        index.functions.push_back(std::move(*function_index));
     }
 
     return index;
 }
 
-[[nodiscard]] sappp::Result<NirIndex> load_nir_index(const fs::path& input_dir,
+[[nodiscard]] sappp::Result<NirIndex> load_nir_index(const InputTree& input,
                                                      std::string_view schema_dir)
 {
-    fs::path nir_path = input_dir / "frontend" / "nir.json";
-    std::error_code ec;
-    if (!fs::exists(nir_path, ec)) {
-        if (ec) {
-            return std::unexpected(
-                Error::make("IOError",
-                            "Failed to stat NIR file: " + nir_path.string() + ": " + ec.message()));
-        }
+    auto found = input.exists(kNirName);
+    if (!found) {
+        return std::unexpected(found.error());
+    }
+    if (!*found) {
         return std::unexpected(
-            Error::make("MissingDependency", "NIR file not found: " + nir_path.string()));
+            Error::make("MissingDependency", "NIR file not found: " + input.display(kNirName)));
     }
 
-    auto nir_json_result = read_json_file(nir_path.string());
+    auto nir_json_result = input.read_json(kNirName);
     if (!nir_json_result) {
         return std::unexpected(nir_json_result.error());
     }
@@ -485,55 +930,42 @@ build_nir_block_entry(const nlohmann::json& block_json)
     return build_nir_index(*nir_json_result);
 }
 
-[[nodiscard]] const NirFunction* find_function(const NirIndex& index,
-                                               const std::string& function_uid)
+[[nodiscard]] std::optional<NirId> find_function_id(const NirIndex& index,
+                                                    const std::string& function_uid)
 {
-    auto it = index.functions.find(function_uid);
-    if (it == index.functions.end()) {
-        return nullptr;
-    }
-    return &it->second;
-}
-
-[[nodiscard]] const NirBlock* find_block(const NirFunction& function, const std::string& block_id)
-{
-    auto it = function.blocks.find(block_id);
-    if (it == function.blocks.end()) {
-        return nullptr;
+    auto it = index.function_ids.find(function_uid);
+    if (it == index.function_ids.end()) {
+        return std::nullopt;
     }
-    return &it->second;
+    return it->second;
 }
 
 [[nodiscard]] const NirInstruction* find_instruction(const NirBlock& block,
                                                      const std::string& inst_id)
 {
-    auto it = block.insts.find(inst_id);
-    if (it == block.insts.end()) {
+    auto it = block.inst_ids.find(inst_id);
+    if (it == block.inst_ids.end()) {
         return nullptr;
     }
-    return &it->second;
+    return &block.insts[it->second];
 }
 
 struct EdgeLookup
 {
-    std::string from;
-    std::string to;
+    NirId from;
+    NirId to;
 };
 
 [[nodiscard]] bool has_cfg_edge(const NirFunction& function,
                                 const EdgeLookup& lookup,
-                                const std::optional<std::string>& edge_kind)
+                                const std::optional<NirId>& edge_kind)
 {
-    auto it = function.edges.find(lookup.from);
-    if (it == function.edges.end()) {
-        return false;
+    const auto& successors = function.successors[lookup.from];
+    auto targets = std::ranges::equal_range(successors, lookup.to, {}, &NirEdge::to);
+    if (!edge_kind) {
+        return !targets.empty();
     }
-    return std::ranges::any_of(it->second, [&](const NirEdge& edge) noexcept {
-        if (edge.to != lookup.to) {
-            return false;
-        }
-        return !edge_kind || edge.kind == *edge_kind;
-    });
+    return std::ranges::binary_search(targets, *edge_kind, {}, &NirEdge::kind);
 }
 
 [[nodiscard]] std::optional<ValidationError> validate_root_header(const nlohmann::json& root)
@@ -577,40 +1009,13 @@ struct EdgeLookup
 
 struct TraceStepInfo
 {
-    const NirFunction*
-        function;  // NOLINT(cppcoreguidelines-use-default-member-init,modernize-use-default-member-init)
-                   // - required for -Weffc++.
-    std::string function_uid;
-    std::string block_id;
-    std::string inst_id;
-    std::string inst_op;
-    std::size_t
-        inst_index;  // NOLINT(cppcoreguidelines-use-default-member-init,modernize-use-default-member-init)
-                     // - required for -Weffc++.
-    std::optional<std::string> edge_kind;
+    const NirFunction* function = nullptr;
+    NirId function_id = kUnknownNirId;
+    NirId block_id = kUnknownNirId;
+    std::size_t inst_index = 0;
+    std::string_view inst_op = {};
+    std::optional<NirId> edge_kind = std::nullopt;
     bool is_entry_block = false;
-
-    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
-    TraceStepInfo()
-        : function(nullptr)
-        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
-        , function_uid()
-        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
-        , block_id()
-        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
-        , inst_id()
-        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
-        , inst_op()
-        , inst_index(0)
-        // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
-        , edge_kind()
-    {}
-
-    TraceStepInfo(const TraceStepInfo&) = default;
-    TraceStepInfo& operator=(const TraceStepInfo&) = default;
-    TraceStepInfo(TraceStepInfo&&) = default;
-    TraceStepInfo& operator=(TraceStepInfo&&) = default;
-    ~TraceStepInfo() = default;
 };
 
 struct TraceExpectations
@@ -620,8 +1025,8 @@ struct TraceExpectations
 
 struct CallFrame
 {
-    std::string function_uid;
-    std::string block_id;
+    NirId function_id;
+    NirId block_id;
     std::size_t inst_index;
 };
 
@@ -663,24 +1068,22 @@ build_trace_step_info(const NirIndex& nir_index,
                       TraceStepInfo& info)
 {
     const nlohmann::json& ir = step.at("ir");
-    std::string tu_id = ir.at("tu_id").get<std::string>();
-    if (tu_id != expected.tu_id) {
+    if (ir.at("tu_id").get_ref<const std::string&>() != expected.tu_id) {
         return rule_violation_error("BugTrace tu_id mismatch");
     }
-    std::string function_uid = ir.at("function_uid").get<std::string>();
-
-    std::string block_id = ir.at("block_id").get<std::string>();
-    std::string inst_id = ir.at("inst_id").get<std::string>();
 
-    const NirFunction* function = find_function(nir_index, function_uid);
-    if (function == nullptr) {
+    auto function_id =
+        find_function_id(nir_index, ir.at("function_uid").get_ref<const std::string&>());
+    if (!function_id) {
         return rule_violation_error("BugTrace function not found in NIR");
     }
-    const NirBlock* block = find_block(*function, block_id);
-    if (block == nullptr) {
+    const NirFunction& function = nir_index.functions[*function_id];
+    auto block_id = find_block_id(function, ir.at("block_id").get_ref<const std::string&>());
+    if (!block_id) {
         return rule_violation_error("BugTrace block not found in NIR");
     }
-    const NirInstruction* inst = find_instruction(*block, inst_id);
+    const NirInstruction* inst = find_instruction(function.blocks[*block_id],
+                                                  ir.at("inst_id").get_ref<const std::string&>());
     if (inst == nullptr) {
         return rule_violation_error("BugTrace instruction not found in NIR");
     }
@@ -688,19 +1091,20 @@ build_trace_step_info(const NirIndex& nir_index,
         return unsupported_error("BugTrace op not supported: " + inst->op);
     }
 
-    std::optional<std::string> edge_kind;
+    std::optional<NirId> edge_kind = std::nullopt;
     if (step.contains("edge_kind")) {
-        edge_kind = step.at("edge_kind").get<std::string>();
+        // Kinds absent from the NIR cannot match any edge.
+        auto it = nir_index.edge_kinds.find(step.at("edge_kind").get_ref<const std::string&>());
+        edge_kind = it == nir_index.edge_kinds.end() ? kUnknownNirId : it->second;
     }
 
-    info.function = function;
-    info.function_uid = std::move(function_uid);
-    info.block_id = std::move(block_id);
-    info.inst_id = std::move(inst_id);
-    info.inst_op = inst->op;
+    info.function = &function;
+    info.function_id = *function_id;
+    info.block_id = *block_id;
     info.inst_index = inst->index;
-    info.edge_kind = std::move(edge_kind);
-    info.is_entry_block = info.block_id == function->entry_block;
+    info.inst_op = inst->op;
+    info.edge_kind = edge_kind;
+    info.is_entry_block = *block_id == function.entry_block;
     return std::nullopt;
 }
 
@@ -710,7 +1114,7 @@ validate_trace_transition(const TraceStepInfo& previous,
                           const TraceStepInfo& current,
                           std::vector<CallFrame>& call_stack)
 {
-    if (current.function_uid == previous.function_uid) {
+    if (current.function_id == previous.function_id) {
         if (current.block_id == previous.block_id) {
             if (current.inst_index < previous.inst_index) {
                 return proof_failed_error("BugTrace instruction order is not monotonic");
@@ -728,7 +1132,7 @@ validate_trace_transition(const TraceStepInfo& previous,
         if (!current.is_entry_block) {
             return proof_failed_error("BugTrace call enters non-entry block");
         }
-        call_stack.push_back(CallFrame{.function_uid = previous.function_uid,
+        call_stack.push_back(CallFrame{.function_id = previous.function_id,
                                        .block_id = previous.block_id,
                                        .inst_index = previous.inst_index});
         return std::nullopt;
@@ -739,7 +1143,7 @@ validate_trace_transition(const TraceStepInfo& previous,
             return proof_failed_error("BugTrace return without call frame");
         }
         const CallFrame& frame = call_stack.back();
-        if (frame.function_uid != current.function_uid) {
+        if (frame.function_id != current.function_id) {
             return proof_failed_error("BugTrace return target mismatch");
         }
         if (current.block_id == frame.block_id && current.inst_index < frame.inst_index) {
@@ -756,12 +1160,12 @@ validate_trace_transition(const TraceStepInfo& previous,
         auto reversed_call_stack = call_stack | std::views::reverse;
         auto match_it =
             std::ranges::find_if(reversed_call_stack, [&](const CallFrame& frame) noexcept {
-                return frame.function_uid == current.function_uid;
+                return frame.function_id == current.function_id;
             });
         if (match_it == std::ranges::end(reversed_call_stack)) {
             return proof_failed_error("BugTrace unwind target mismatch");
         }
-        while (!call_stack.empty() && call_stack.back().function_uid != current.function_uid) {
+        while (!call_stack.empty() && call_stack.back().function_id != current.function_id) {
             call_stack.pop_back();
         }
         if (call_stack.empty()) {
@@ -856,18 +1260,8 @@ validate_bug_trace_path(const ValidationContext& context,
     const auto& contracts = depends.at("contracts");
     for (const auto& contract_ref : contracts) {
         std::string contract_hash = contract_ref.at("ref").get<std::string>();
-        auto contract_cert =
-            load_cert_object(*context.input_dir, *context.schema_dir, contract_hash);
-        if (!contract_cert) {
-            return make_error_from_result(contract_cert.error());
-        }
-        if (contract_cert->at("kind").get<std::string>() != "ContractRef") {
-            return rule_violation_error("Contract reference is not ContractRef");
-        }
-
-        std::string tier = contract_cert->at("tier").get<std::string>();
-        if (tier == "Tier2" || tier == "Disabled") {
-            return proof_failed_error("Contract tier not allowed for SAFE: " + tier);
+        if (auto error = context.cert_cache->contract_verdict(contract_hash)) {
+            return error;
         }
     }
 
@@ -1238,6 +1632,18 @@ struct RootRefs
                     .result_kind = root.at("result").get<std::string>()};
 }
 
+[[nodiscard]] std::vector<std::string> referenced_object_hashes(const std::string& root_hash,
+                                                               const RootRefs& refs)
+{
+    std::vector<std::string> hashes = {root_hash, refs.po_ref, refs.ir_ref, refs.evidence_ref};
+    if (refs.depends->contains("contracts")) {
+        for (const auto& contract_ref : refs.depends->at("contracts")) {
+            hashes.push_back(contract_ref.at("ref").get<std::string>());
+        }
+    }
+    return hashes;
+}
+
 struct ResultValidationInputs
 {
     const ValidationContext* context = nullptr;
@@ -1277,8 +1683,19 @@ validate_result_kind(const ResultValidationInputs& inputs)
                              *inputs.context);
 }
 
-[[nodiscard]] sappp::Result<std::vector<fs::path>> collect_index_files(const fs::path& index_dir)
+[[nodiscard]] sappp::Result<std::vector<std::string>> collect_index_files(const InputTree& input)
 {
+    if (!input.is_directory()) {
+        auto names = input.pack_json_files(kIndexDirName);
+        if (names.empty()) {
+            return std::unexpected(Error::make("MissingDependency",
+                                               "certstore index directory not found: "
+                                                   + input.display(kIndexDirName)));
+        }
+        return names;
+    }
+
+    const fs::path index_dir = input.root() / kIndexDirName;
     std::error_code ec;
     if (!fs::exists(index_dir, ec)) {
         if (ec) {
@@ -1291,7 +1708,7 @@ validate_result_kind(const ResultValidationInputs& inputs)
                         "certstore index directory not found: " + index_dir.string()));
     }
 
-    std::vector<fs::path> index_files;
+    std::vector<std::string> index_files;
     for (fs::directory_iterator it(index_dir, ec); it != fs::directory_iterator();
          it.increment(ec)) {
         if (ec) {
@@ -1312,7 +1729,8 @@ validate_result_kind(const ResultValidationInputs& inputs)
             continue;
         }
         if (entry.path().extension() == ".json") {
-            index_files.push_back(entry.path());
+            index_files.push_back(std::string(kIndexDirName) + "/"
+                                  + entry.path().filename().string());
         }
     }
     if (ec) {
@@ -1346,13 +1764,13 @@ check_tu_id_consistency(std::string_view entry_tu_id,
 
 [[nodiscard]] sappp::Result<nlohmann::json>
 validate_index_entry(const ValidationContext& context,
-                     const fs::path& index_path,
+                     const std::string& index_name,
                      std::optional<std::string>& tu_id,
                      const std::optional<std::string>& expected_tu_id)
 {
-    auto index_json = load_index_json(index_path, *context.schema_dir);
+    auto index_json = load_index_json(*context.input, index_name, *context.schema_dir);
     if (!index_json) {
-        std::string fallback_po_id = derive_po_id_from_path(index_path);
+        std::string fallback_po_id = derive_po_id_from_path(fs::path(index_name));
         return finish_or_unknown(fallback_po_id,
                                  make_error_from_result(index_json.error()),
                                  context);
@@ -1361,7 +1779,16 @@ validate_index_entry(const ValidationContext& context,
     std::string po_id = index_json->at("po_id").get<std::string>();
     std::string root_hash = index_json->at("root").get<std::string>();
 
-    auto root_cert = load_cert_object(*context.input_dir, *context.schema_dir, root_hash);
+    if (context.result_cache != nullptr) {
+        if (auto cached = context.result_cache->lookup(po_id, root_hash)) {
+            if (auto error = check_tu_id_consistency(cached->tu_id, tu_id, expected_tu_id)) {
+                return finish_or_unknown(po_id, *error, context);
+            }
+            return std::move(cached->result);
+        }
+    }
+
+    auto root_cert = load_cert_object(*context.input, *context.schema_dir, root_hash);
     if (!root_cert) {
         return finish_or_unknown(po_id, make_error_from_result(root_cert.error()), context);
     }
@@ -1373,28 +1800,28 @@ validate_index_entry(const ValidationContext& context,
 
     auto root_refs = extract_root_refs(root);
 
-    auto po_cert = load_cert_object(*context.input_dir, *context.schema_dir, root_refs.po_ref);
+    auto po_cert = context.cert_cache->load(root_refs.po_ref);
     if (!po_cert) {
         return finish_or_unknown(po_id, make_error_from_result(po_cert.error()), context);
     }
-    if (auto error = validate_po_header(*po_cert, po_id)) {
+    if (auto error = validate_po_header(**po_cert, po_id)) {
         return finish_or_unknown(po_id, *error, context);
     }
 
-    auto ir_cert = load_cert_object(*context.input_dir, *context.schema_dir, root_refs.ir_ref);
+    auto ir_cert = context.cert_cache->load(root_refs.ir_ref);
     if (!ir_cert) {
         return finish_or_unknown(po_id, make_error_from_result(ir_cert.error()), context);
     }
-    if (auto error = validate_ir_header(*ir_cert)) {
+    if (auto error = validate_ir_header(**ir_cert)) {
         return finish_or_unknown(po_id, *error, context);
     }
-    std::string entry_tu_id = ir_cert->at("tu_id").get<std::string>();
+    std::string entry_tu_id = (*ir_cert)->at("tu_id").get<std::string>();
     if (auto error = check_tu_id_consistency(entry_tu_id, tu_id, expected_tu_id)) {
         return finish_or_unknown(po_id, *error, context);
     }
 
     auto evidence_cert =
-        load_cert_object(*context.input_dir, *context.schema_dir, root_refs.evidence_ref);
+        load_cert_object(*context.input, *context.schema_dir, root_refs.evidence_ref);
     if (!evidence_cert) {
         return finish_or_unknown(po_id, make_error_from_result(evidence_cert.error()), context);
     }
@@ -1404,10 +1831,59 @@ validate_index_entry(const ValidationContext& context,
                                                 .root_hash = &root_hash,
                                                 .result_kind = &root_refs.result_kind,
                                                 .depends = root_refs.depends,
-                                                .po_cert = &(*po_cert),
-                                                .ir_cert = &(*ir_cert),
-                                                .evidence_cert = &(*evidence_cert)};
-    return validate_result_kind(result_inputs);
+                                                .po_cert = *po_cert,
+                                                .ir_cert = *ir_cert,
+                                                .evidence_cert = &*evidence_cert};
+    auto result = validate_result_kind(result_inputs);
+    if (result && context.result_cache != nullptr) {
+        context.result_cache->store(po_id,
+                                    root_hash,
+                                    entry_tu_id,
+                                    referenced_object_hashes(root_hash, root_refs),
+                                    *result);
+    }
+    return result;
+}
+
+[[nodiscard]] std::string content_digest_or_absent(const sappp::Result<std::string>& content)
+{
+    return content ? sappp::common::sha256_prefixed(*content) : std::string("absent");
+}
+
+[[nodiscard]] std::string result_cache_run_digest(const InputTree& input,
+                                                  std::string_view schema_dir,
+                                                  const sappp::VersionTriple& versions,
+                                                  bool strict)
+{
+    // Schemas are keyed by content: the same path may hold a different schema next run.
+    nlohmann::json schemas = nlohmann::json::object();
+    for (const auto& path : {cert_schema_path(schema_dir),
+                             cert_index_schema_path(schema_dir),
+                             nir_schema_path(schema_dir),
+                             validated_results_schema_path(schema_dir)}) {
+        schemas[fs::path(path).filename().string()] =
+            content_digest_or_absent(read_file_contents(path));
+    }
+    nlohmann::json inputs = {
+        {        "tool_version",                                sappp::kVersion},
+        {            "build_id",                                sappp::kBuildId},
+        {   "semantics_version",                             versions.semantics},
+        {"proof_system_version",                          versions.proof_system},
+        {     "profile_version",                               versions.profile},
+        {              "strict",                                         strict},
+        {             "schemas",                                        schemas},
+        {          "nir_digest", content_digest_or_absent(input.read(kNirName))}
+    };
+    return sappp::common::sha256_prefixed(inputs.dump());
+}
+
+[[nodiscard]] bool is_within(const fs::path& path, const fs::path& root)
+{
+    std::error_code ec;
+    const auto canonical_path = fs::weakly_canonical(fs::absolute(path, ec), ec);
+    const auto canonical_root = fs::weakly_canonical(fs::absolute(root, ec), ec);
+    const auto [root_end, path_it] = std::ranges::mismatch(canonical_root, canonical_path);
+    return root_end == canonical_root.end();
 }
 
 ValidationError version_mismatch_error(const std::string& message)
@@ -1457,28 +1933,56 @@ Validator::Validator(std::string input_dir, std::string schema_dir, sappp::Versi
     : m_input_dir(std::move(input_dir))
     , m_schema_dir(std::move(schema_dir))
     , m_versions(std::move(versions))
+    // NOLINTNEXTLINE(readability-redundant-member-init) - required for -Weffc++.
+    , m_result_cache_dir()
 {}
 
+void Validator::set_result_cache_dir(std::string cache_dir)
+{
+    m_result_cache_dir = std::move(cache_dir);
+}
+
 sappp::Result<nlohmann::json> Validator::validate(bool strict)
 {
-    fs::path index_dir = fs::path(m_input_dir) / "certstore" / "index";
-    auto index_files = collect_index_files(index_dir);
+    const sappp::common::trace::Span validate_span("validate", "validate");
+    auto input = InputTree::open(fs::path(m_input_dir));
+    if (!input) {
+        return std::unexpected(input.error());
+    }
+    auto index_files = collect_index_files(*input);
     if (!index_files) {
         return std::unexpected(index_files.error());
     }
 
-    fs::path input_dir(m_input_dir);
     NirContext nir_context;
-    auto nir_index = load_nir_index(input_dir, m_schema_dir);
+    auto nir_index = [&] {
+        const sappp::common::trace::Span span("validate", "load_nir_index");
+        return load_nir_index(*input, m_schema_dir);
+    }();
     if (nir_index) {
         nir_context.index = std::move(*nir_index);
     } else {
         nir_context.error = make_error_from_result(nir_index.error());
     }
 
-    ValidationContext context{.input_dir = &input_dir,
+    CertObjectCache cert_cache(*input, m_schema_dir);
+    std::optional<ValidationResultCache> result_cache;
+    if (!m_result_cache_dir.empty()) {
+        if (is_within(m_result_cache_dir, input->root())) {
+            return std::unexpected(
+                Error::make("InvalidArgument",
+                            "Result cache directory must be outside the input: "
+                                + m_result_cache_dir));
+        }
+        result_cache.emplace(*input,
+                             fs::path(m_result_cache_dir),
+                             result_cache_run_digest(*input, m_schema_dir, m_versions, strict));
+    }
+    ValidationContext context{.input = &*input,
                               .schema_dir = &m_schema_dir,
                               .nir_context = &nir_context,
+                              .cert_cache = &cert_cache,
+                              .result_cache = result_cache ? &*result_cache : nullptr,
                               .strict = strict};
     std::vector<nlohmann::json> results;
     results.reserve(index_files->size());
@@ -1489,8 +1993,9 @@ sappp::Result<nlohmann::json> Validator::validate(bool strict)
         tu_id = expected_tu_id;
     }
 
-    for (const auto& index_path : *index_files) {
-        auto result = validate_index_entry(context, index_path, tu_id, expected_tu_id);
+    for (const auto& index_name : *index_files) {
+        const sappp::common::trace::Span span("validate", "index_entry", index_name);
+        auto result = validate_index_entry(context, index_name, tu_id, expected_tu_id);
         if (!result) {
             return std::unexpected(result.error());
         }
@@ -1511,7 +2016,7 @@ sappp::Result<nlohmann::json> Validator::validate(bool strict)
             Error::make("RuleViolation", "Failed to determine tu_id from IR references"));
     }
 
-    const std::string generated_at = pick_generated_at(input_dir);
+    const std::string generated_at = pick_generated_at(*input);
     nlohmann::json output = {
         {      "schema_version",                                                           "validated_results.v1"},
         {                "tool", {{"name", "sappp"}, {"version", sappp::kVersion}, {"build_id", sappp::kBuildId}}},
@@ -1537,6 +2042,7 @@ sappp::Result<nlohmann::json> Validator::validate(bool strict)
 sappp::VoidResult Validator::write_results(const nlohmann::json& results,
                                            const std::string& output_path) const
 {
+    const sappp::common::trace::Span span("validate", "write_results", output_path);
     if (auto result =
             sappp::common::validate_json(results, validated_results_schema_path(m_schema_dir));
         !result) {
@@ -141,6 +141,41 @@ TEST(AnalyzerBudgetTest, BudgetExceededProducesUnknown)
     EXPECT_EQ(unknowns.at(0).at("unknown_code"), "BudgetExceeded");
     const auto& action = unknowns.at(0).at("refinement_plan").at("actions").at(0).at("action");
     EXPECT_EQ(action, "increase-budget");
+    EXPECT_EQ(output->stats.budget_exceeded, "max_iterations");
+}
+
+TEST(AnalyzerBudgetTest, ReportsProgramSizeAndDomainWork)
+{
+    auto temp_dir = ensure_temp_dir("sappp_analyzer_budget_stats");
+    auto cert_dir = temp_dir / "certstore";
+
+    Analyzer analyzer({
+        .schema_dir = SAPPP_SCHEMA_DIR,
+        .certstore_dir = cert_dir.string(),
+        .versions = {.semantics = "sem.v1",
+                     .proof_system = "proof.v1",
+                     .profile = "safety.core.v1"},
+        .budget = {},
+        .memory_domain = ""
+    });
+
+    auto nir = make_nir_with_two_blocks();
+    auto po_list = make_po_list();
+    auto specdb_snapshot = make_contract_snapshot();
+
+    auto output = analyzer.analyze(nir, po_list, &specdb_snapshot);
+    ASSERT_TRUE(output);
+
+    const auto& stats = output->stats;
+    EXPECT_EQ(stats.functions, 1U);
+    EXPECT_EQ(stats.blocks, 2U);
+    EXPECT_EQ(stats.instructions, 2U);
+    EXPECT_EQ(stats.pos, 1U);
+    EXPECT_EQ(stats.unknowns, output->unknown_ledger.at("unknowns").size());
+    EXPECT_FALSE(stats.budget_exceeded.has_value());
+    ASSERT_EQ(stats.domains.size(), 4U);
+    EXPECT_GT(stats.domains.at("lifetime").iterations, 0U);
+    EXPECT_GT(stats.domains.at("init").iterations, 0U);
 }
 
 }  // namespace sappp::analyzer::test
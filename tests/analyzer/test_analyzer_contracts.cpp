@@ -1227,6 +1227,58 @@ TEST(AnalyzerContractTest, MatchContractsConflictProducesUnknown)
     ASSERT_EQ(matched_contracts.size(), 2U);
 }
 
+TEST(AnalyzerContractTest, MatchContractsRepeatedCalleeMatchesEveryPo)
+{
+    auto temp_dir = ensure_temp_dir("sappp_analyzer_contract_match_repeated");
+    auto cert_dir = temp_dir / "certstore";
+
+    Analyzer analyzer({
+        .schema_dir = SAPPP_SCHEMA_DIR,
+        .certstore_dir = cert_dir.string(),
+        .versions = {.semantics = "sem.v1",
+                     .proof_system = "proof.v1",
+                     .profile = "safety.core.v1"},
+        .budget = AnalyzerConfig::AnalysisBudget{},
+        .memory_domain = ""
+    });
+
+    nlohmann::json contracts = nlohmann::json::array();
+    contracts.push_back(
+        make_contract_entry(make_sha256('f'), "usr::foo", "x86_64", "1.0.0", {}, 0));
+    contracts.push_back(
+        make_contract_entry(make_sha256('e'), "usr::foo", "x86_64", "1.0.0", {"COND_A"}, 0));
+    contracts.push_back(
+        make_contract_entry(make_sha256('d'), "usr::foo", "arm64", "1.0.0", {}, 0));
+
+    nlohmann::json specdb_snapshot = {
+        {"schema_version",                                    "specdb_snapshot.v1"},
+        {          "tool", nlohmann::json{{"name", "sappp"}, {"version", "0.1.0"}}},
+        {  "generated_at",                                  "1970-01-01T00:00:00Z"},
+        {     "contracts",                                               contracts}
+    };
+
+    // Every PO resolves the same callee; each must carry the same selected contract.
+    auto po_list = make_po_list("UB.DivZero");
+    auto& pos = po_list.at("pos");
+    for (char fill : {'1', '2', '3'}) {
+        nlohmann::json po = pos.at(0);
+        po["po_id"] = make_sha256(fill);
+        pos.push_back(std::move(po));
+    }
+
+    auto nir = make_nir();
+    auto output = analyzer.analyze(nir, po_list, &specdb_snapshot, make_match_context({"COND_A"}));
+    ASSERT_TRUE(output);
+
+    const auto& unknowns = output->unknown_ledger.at("unknowns");
+    ASSERT_EQ(unknowns.size(), 4U);
+    for (const auto& unknown : unknowns) {
+        const auto& matched_contracts = unknown.at("depends_on").at("contracts");
+        ASSERT_EQ(matched_contracts.size(), 1U);
+        EXPECT_EQ(matched_contracts.at(0).get<std::string>(), make_sha256('e'));
+    }
+}
+
 TEST(AnalyzerContractTest, VCallMissingContractProducesUnknownCode)
 {
     auto temp_dir = ensure_temp_dir("sappp_analyzer_vcall_unknown");
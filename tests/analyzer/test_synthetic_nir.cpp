@@ -0,0 +1,81 @@
+#include "analyzer.hpp"
+#include "synthetic_nir.hpp"
+
+#include "sappp/schema_validate.hpp"
+
+#include <string>
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+namespace sappp::analyzer::test {
+
+TEST(SyntheticNirTest, SameOptionsProduceIdenticalDocuments)
+{
+    SyntheticNirOptions options;
+    options.seed = 7;
+    const auto first = make_synthetic_nir(options);
+    const auto second = make_synthetic_nir(options);
+    EXPECT_EQ(first.dump(), second.dump());
+
+    options.seed = 8;
+    const auto reseeded = make_synthetic_nir(options);
+    EXPECT_NE(first.dump(), reseeded.dump());
+    EXPECT_NE(first.at("tu_id"), reseeded.at("tu_id"));
+}
+
+TEST(SyntheticNirTest, ShapeFollowsOptions)
+{
+    SyntheticNirOptions options;
+    options.functions = 3;
+    options.blocks_per_function = 6;
+    options.loop_depth = 2;
+    options.exception_edges = 1;
+    options.vcall_percent = 100;
+
+    const auto nir = make_synthetic_nir(options);
+    auto valid =
+        common::validate_json(nir, std::string(SAPPP_SCHEMA_DIR) + "/nir.v1.schema.json");
+    EXPECT_TRUE(valid) << valid.error().message;
+
+    const auto& functions = nir.at("functions");
+    ASSERT_EQ(functions.size(), 3U);
+    for (const auto& func : functions) {
+        const auto& cfg = func.at("cfg");
+        // Six blocks plus the landing pad of the exception edge.
+        EXPECT_EQ(cfg.at("blocks").size(), 7U);
+        int back_edges = 0;
+        int exception_edges = 0;
+        for (const auto& edge : cfg.at("edges")) {
+            back_edges += edge.at("kind") == "succ1" ? 1 : 0;
+            exception_edges += edge.at("kind") == "exception" ? 1 : 0;
+        }
+        EXPECT_EQ(back_edges, 2);
+        EXPECT_EQ(exception_edges, 1);
+        EXPECT_EQ(func.at("tables").at("vcall_candidates").size(), 3U);
+    }
+}
+
+TEST(SyntheticNirTest, EveryFixpointDoesWork)
+{
+    const auto nir = make_synthetic_nir(SyntheticNirOptions{});
+    for (const auto domain : {FixpointDomain::kLifetime,
+                              FixpointDomain::kHeapLifetime,
+                              FixpointDomain::kInit,
+                              FixpointDomain::kPointsTo}) {
+        auto stats = run_fixpoint(domain, nir);
+        ASSERT_TRUE(stats);
+        EXPECT_GT(stats->iterations, 0U);
+        EXPECT_GT(stats->states, 0U);
+    }
+}
+
+TEST(SyntheticNirTest, UnknownFixpointDomainIsAnError)
+{
+    const auto nir = make_synthetic_nir(SyntheticNirOptions{});
+    auto stats = run_fixpoint(static_cast<FixpointDomain>(0xFF), nir);
+    ASSERT_FALSE(stats);
+    EXPECT_EQ(stats.error().code, "InvalidArgument");
+}
+
+}  // namespace sappp::analyzer::test
@@ -0,0 +1,211 @@
+// bench_analyzer.cpp - Analyzer のベンチマーク
+//
+// 合成 NIR（make_synthetic_nir）に対して Analyzer::analyze 全体と
+// 各抽象ドメインの不動点計算を個別に測定します。
+// 引数の範囲を変えてスケーリング曲線を取り、性能回帰を検出します。
+
+#include "analyzer.hpp"
+#include "po_generator.hpp"
+#include "synthetic_nir.hpp"
+
+#include <sappp/version.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <system_error>
+
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+
+namespace {
+
+using sappp::analyzer::FixpointDomain;
+using sappp::analyzer::SyntheticNirOptions;
+
+// ===========================================================================
+// テストデータ生成
+// ===========================================================================
+
+// Args: {関数数, 関数あたりのブロック数, ループのネスト深さ}
+SyntheticNirOptions options_from(const benchmark::State& state)
+{
+    SyntheticNirOptions options;
+    options.functions = static_cast<std::uint32_t>(state.range(0));
+    options.blocks_per_function = static_cast<std::uint32_t>(state.range(1));
+    options.loop_depth = static_cast<std::uint32_t>(state.range(2));
+    return options;
+}
+
+// Args: {例外エッジ数, 変数数, vcall 密度 (%), 確保密度 (%)}（関数 32 x ブロック 16）
+SyntheticNirOptions shape_options_from(const benchmark::State& state)
+{
+    SyntheticNirOptions options;
+    options.functions = 32;
+    options.blocks_per_function = 16;
+    options.exception_edges = static_cast<std::uint32_t>(state.range(0));
+    options.variables = static_cast<std::uint32_t>(state.range(1));
+    options.vcall_percent = static_cast<std::uint32_t>(state.range(2));
+    options.alloc_percent = static_cast<std::uint32_t>(state.range(3));
+    return options;
+}
+
+void set_program_counters(benchmark::State& state, const SyntheticNirOptions& options)
+{
+    const auto blocks = static_cast<std::int64_t>(options.functions)
+                        * static_cast<std::int64_t>(options.blocks_per_function);
+    state.SetItemsProcessed(state.iterations() * blocks);
+    state.counters["functions"] = options.functions;
+    state.counters["blocks"] = static_cast<double>(blocks);
+}
+
+// ===========================================================================
+// 不動点ベンチマーク（ドメインごと）
+// ===========================================================================
+
+void run_fixpoint_benchmark(benchmark::State& state,
+                            FixpointDomain domain,
+                            const SyntheticNirOptions& options)
+{
+    const auto nir = sappp::analyzer::make_synthetic_nir(options);
+    sappp::analyzer::DomainStats stats;
+    for (auto _ : state) {
+        auto result = sappp::analyzer::run_fixpoint(domain, nir);
+        if (!result) {
+            state.SkipWithError(result.error().message.c_str());
+            return;
+        }
+        stats = *result;
+        benchmark::DoNotOptimize(stats);
+    }
+    set_program_counters(state, options);
+    state.counters["fixpoint_iterations"] = static_cast<double>(stats.iterations);
+    state.counters["states"] = static_cast<double>(stats.states);
+}
+
+void apply_scaling_args(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgNames({"functions", "blocks", "loop_depth"});
+    for (const std::int64_t functions : {8, 64, 256}) {
+        bench->Args({functions, 16, 1});
+    }
+    for (const std::int64_t blocks : {4, 32, 128}) {
+        bench->Args({32, blocks, 1});
+    }
+    for (const std::int64_t depth : {0, 2, 4}) {
+        bench->Args({32, 16, depth});
+    }
+    bench->Unit(benchmark::kMicrosecond);
+}
+
+void apply_shape_args(benchmark::internal::Benchmark* bench)
+{
+    bench->ArgNames({"exception_edges", "variables", "vcall_pct", "alloc_pct"});
+    bench->Args({0, 4, 10, 20});
+    bench->Args({4, 4, 10, 20});
+    bench->Args({1, 16, 10, 20});
+    bench->Args({1, 4, 50, 20});
+    bench->Args({1, 4, 10, 80});
+    bench->Unit(benchmark::kMicrosecond);
+}
+
+static void BM_Fixpoint_Lifetime(benchmark::State& state)
+{
+    run_fixpoint_benchmark(state, FixpointDomain::kLifetime, options_from(state));
+}
+BENCHMARK(BM_Fixpoint_Lifetime)->Apply(apply_scaling_args);
+
+static void BM_Fixpoint_HeapLifetime(benchmark::State& state)
+{
+    run_fixpoint_benchmark(state, FixpointDomain::kHeapLifetime, options_from(state));
+}
+BENCHMARK(BM_Fixpoint_HeapLifetime)->Apply(apply_scaling_args);
+
+static void BM_Fixpoint_Init(benchmark::State& state)
+{
+    run_fixpoint_benchmark(state, FixpointDomain::kInit, options_from(state));
+}
+BENCHMARK(BM_Fixpoint_Init)->Apply(apply_scaling_args);
+
+static void BM_Fixpoint_PointsTo(benchmark::State& state)
+{
+    run_fixpoint_benchmark(state, FixpointDomain::kPointsTo, options_from(state));
+}
+BENCHMARK(BM_Fixpoint_PointsTo)->Apply(apply_scaling_args);
+
+static void BM_Fixpoint_Lifetime_Shape(benchmark::State& state)
+{
+    run_fixpoint_benchmark(state, FixpointDomain::kLifetime, shape_options_from(state));
+}
+BENCHMARK(BM_Fixpoint_Lifetime_Shape)->Apply(apply_shape_args);
+
+static void BM_Fixpoint_PointsTo_Shape(benchmark::State& state)
+{
+    run_fixpoint_benchmark(state, FixpointDomain::kPointsTo, shape_options_from(state));
+}
+BENCHMARK(BM_Fixpoint_PointsTo_Shape)->Apply(apply_shape_args);
+
+// ===========================================================================
+// Analyzer::analyze ベンチマーク（PO 判定と証明書書き込みを含む）
+// ===========================================================================
+
+void run_analyze_benchmark(benchmark::State& state, const SyntheticNirOptions& options)
+{
+    const auto nir = sappp::analyzer::make_synthetic_nir(options);
+    auto po_list = sappp::po::PoGenerator().generate(nir);
+    if (!po_list) {
+        state.SkipWithError(po_list.error().message.c_str());
+        return;
+    }
+    const auto cert_dir = std::filesystem::temp_directory_path() / "sappp_bench_analyzer";
+    std::error_code ec;
+    std::filesystem::remove_all(cert_dir, ec);
+
+    // 証明書ストアは実行間で共有されるため、2 回目以降は重複排除の経路を測定します。
+    const sappp::analyzer::Analyzer analyzer({
+        .schema_dir = SAPPP_SCHEMA_DIR,
+        .certstore_dir = cert_dir.string(),
+        .versions = sappp::default_version_triple(),
+        .budget = {},
+        .memory_domain = std::nullopt,
+    });
+    const nlohmann::json specdb_snapshot = {
+        {"schema_version",                                    "specdb_snapshot.v1"},
+        {          "tool", nlohmann::json{{"name", "sappp"}, {"version", "0.1.0"}}},
+        {  "generated_at",                                  "1970-01-01T00:00:00Z"},
+        {     "contracts",                               nlohmann::json::array()}
+    };
+
+    std::uint64_t unknowns = 0;
+    for (auto _ : state) {
+        auto output = analyzer.analyze(nir, *po_list, &specdb_snapshot);
+        if (!output) {
+            state.SkipWithError(output.error().message.c_str());
+            break;
+        }
+        unknowns = output->stats.unknowns;
+        benchmark::DoNotOptimize(output);
+    }
+    std::filesystem::remove_all(cert_dir, ec);
+
+    const auto pos = static_cast<std::int64_t>(po_list->at("pos").size());
+    set_program_counters(state, options);
+    state.counters["pos"] = static_cast<double>(pos);
+    state.counters["unknowns"] = static_cast<double>(unknowns);
+    state.counters["pos_per_second"] = benchmark::Counter(
+        static_cast<double>(state.iterations() * pos), benchmark::Counter::kIsRate);
+}
+
+static void BM_Analyze(benchmark::State& state)
+{
+    run_analyze_benchmark(state, options_from(state));
+}
+BENCHMARK(BM_Analyze)
+    ->ArgNames({"functions", "blocks", "loop_depth"})
+    ->Args({8, 16, 1})
+    ->Args({32, 16, 1})
+    ->Args({16, 64, 2})
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -240,4 +240,31 @@ static void BM_CanonicalHash_Large(benchmark::State& state)
 }
 BENCHMARK(BM_CanonicalHash_Large);
 
+// ===========================================================================
+// 格納済みオブジェクトの検証（parse + 再カノニカル化 vs parse_canonical）
+// ===========================================================================
+
+static void BM_VerifyReserialize_Large(benchmark::State& state)
+{
+    auto bytes = sappp::canonical::canonicalize(create_large_json());
+    for (auto _ : state) {
+        auto json = nlohmann::json::parse(*bytes);
+        auto hash = sappp::canonical::hash_canonical(json);
+        benchmark::DoNotOptimize(hash);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes->size()));
+}
+BENCHMARK(BM_VerifyReserialize_Large);
+
+static void BM_VerifyParseCanonical_Large(benchmark::State& state)
+{
+    auto bytes = sappp::canonical::canonicalize(create_large_json());
+    for (auto _ : state) {
+        auto document = sappp::canonical::parse_canonical(*bytes);
+        benchmark::DoNotOptimize(document);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(bytes->size()));
+}
+BENCHMARK(BM_VerifyParseCanonical_Large);
+
 }  // namespace
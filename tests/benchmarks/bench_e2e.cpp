@@ -0,0 +1,413 @@
+// bench_e2e.cpp - capture → analyze → validate → pack のエンドツーエンド・ベンチマーク
+//
+// tests/end_to_end の litmus プログラムを N 個の TU に複製した合成プロジェクトと
+// compile_commands.json を作成し、各サブコマンドを子プロセスとして実行して
+// 所要時間とピーク RSS を測定します。結果（TUs/s, POs/s, certs/s）は JSON で出力します。
+//
+// frontend_clang なしでビルドした場合、analyze 以降（frontend が必要）は skipped になります。
+// --work-dir は実行前に空にします。bench_e2e が作成したもの（目印 .sappp_bench_e2e がある）
+// 以外の非空ディレクトリは削除せずにエラー終了します。
+//
+// 使い方:
+//   ./build/bin/bench_e2e --tus 64 --jobs 8 --out e2e.json
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <nlohmann/json.hpp>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// ベンチマークが作成した作業ディレクトリの目印。これがない非空のディレクトリは削除しません。
+constexpr std::string_view kWorkDirMarker = ".sappp_bench_e2e";
+
+struct Options
+{
+    std::size_t tus = 16;
+    std::size_t jobs = 0;
+    fs::path work_dir = fs::temp_directory_path() / "sappp_bench_e2e";
+    std::optional<fs::path> out;
+    bool keep = false;
+};
+
+struct StageRun
+{
+    int exit_code = -1;
+    std::chrono::microseconds wall_time{0};
+    std::uint64_t peak_rss_bytes = 0;
+};
+
+// ===========================================================================
+// 子プロセス実行（wait4 で子プロセスごとの ru_maxrss を取得）
+// ===========================================================================
+
+StageRun run_stage(const std::vector<std::string>& args)
+{
+    StageRun run;
+    // posix_spawn は char* を要求するため、引数ごとに NUL 終端のバッファを持ちます。
+    std::vector<std::vector<char>> buffers;
+    buffers.reserve(args.size());
+    std::vector<char*> argv;
+    argv.reserve(args.size() + 1);
+    for (const auto& arg : args) {
+        auto& buffer = buffers.emplace_back(arg.begin(), arg.end());
+        buffer.push_back('\0');
+        argv.push_back(buffer.data());
+    }
+    argv.push_back(nullptr);
+
+    // サブコマンドの進捗出力がレポート（stdout）に混ざらないよう破棄します。
+    posix_spawn_file_actions_t actions;
+    if (const int rc = posix_spawn_file_actions_init(&actions); rc != 0) {
+        std::cerr << "posix_spawn_file_actions_init failed: " << std::strerror(rc) << "\n";
+        return run;
+    }
+    if (const int rc = posix_spawn_file_actions_addopen(
+            &actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+        rc != 0) {
+        std::cerr << "posix_spawn_file_actions_addopen failed: " << std::strerror(rc) << "\n";
+        posix_spawn_file_actions_destroy(&actions);
+        return run;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    pid_t pid = 0;
+    const int spawned =
+        posix_spawn(&pid, argv.front(), &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (spawned != 0) {
+        std::cerr << "Failed to spawn " << args.front() << ": " << std::strerror(spawned)
+                  << "\n";
+        return run;
+    }
+    int status = 0;
+    rusage usage{};
+    if (wait4(pid, &status, 0, &usage) != pid) {
+        return run;
+    }
+    run.wall_time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    run.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#if defined(__APPLE__)
+    run.peak_rss_bytes = static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+    // Linux は ru_maxrss を KB 単位で返します。
+    run.peak_rss_bytes = static_cast<std::uint64_t>(usage.ru_maxrss) * 1024U;
+#endif
+    return run;
+}
+
+double per_second(std::uint64_t count, std::chrono::microseconds wall_time)
+{
+    if (wall_time.count() <= 0) {
+        return 0.0;
+    }
+    return static_cast<double>(count) * 1'000'000.0 / static_cast<double>(wall_time.count());
+}
+
+[[maybe_unused]] nlohmann::json load_json_or_null(const fs::path& path)
+{
+    std::ifstream in(path);
+    if (!in) {
+        return nullptr;
+    }
+    return nlohmann::json::parse(in, nullptr, /*allow_exceptions=*/false);
+}
+
+[[maybe_unused]] std::uint64_t array_size_or_zero(const nlohmann::json& document,
+                                                  std::string_view key)
+{
+    if (!document.is_object() || !document.contains(key) || !document.at(key).is_array()) {
+        return 0;
+    }
+    return document.at(key).size();
+}
+
+// ===========================================================================
+// 合成プロジェクト生成
+// ===========================================================================
+
+std::vector<fs::path> find_litmus_sources(const fs::path& litmus_dir)
+{
+    std::vector<fs::path> sources;
+    for (const auto& entry : fs::directory_iterator(litmus_dir)) {
+        const auto& path = entry.path();
+        const auto extension = path.extension().string();
+        if (entry.is_regular_file() && path.filename().string().starts_with("litmus_")
+            && (extension == ".c" || extension == ".cpp")) {
+            sources.push_back(path);
+        }
+    }
+    std::ranges::sort(sources);
+    return sources;
+}
+
+/// Clears @p work_dir for a run; refuses a non-empty directory the benchmark did not create.
+bool prepare_work_dir(const fs::path& work_dir)
+{
+    const fs::path marker = work_dir / kWorkDirMarker;
+    std::error_code ec;
+    if (fs::exists(work_dir, ec)) {
+        const bool ours = fs::is_directory(work_dir, ec)
+                          && (fs::is_empty(work_dir, ec) || fs::exists(marker, ec));
+        if (!ours) {
+            std::cerr << "Refusing to clear " << work_dir
+                      << ": it is not empty and was not created by bench_e2e\n";
+            return false;
+        }
+        fs::remove_all(work_dir, ec);
+        if (ec) {
+            std::cerr << "Failed to clear " << work_dir << ": " << ec.message() << "\n";
+            return false;
+        }
+    }
+    fs::create_directories(work_dir, ec);
+    std::ofstream out(marker);
+    if (ec || !out) {
+        std::cerr << "Failed to create " << work_dir << "\n";
+        return false;
+    }
+    return true;
+}
+
+/// Copies the litmus sources round-robin into @p tus translation units.
+bool write_project(const Options& options, const std::vector<fs::path>& sources)
+{
+    const fs::path src_dir = options.work_dir / "src";
+    fs::create_directories(src_dir);
+
+    nlohmann::json compile_db = nlohmann::json::array();
+    for (std::size_t index = 0; index < options.tus; ++index) {
+        const auto& source = sources[index % sources.size()];
+        const bool is_c = source.extension() == ".c";
+        const fs::path target = src_dir
+                                / ("tu" + std::to_string(index) + "_"
+                                   + source.filename().string());
+        std::error_code ec;
+        fs::copy_file(source, target, fs::copy_options::overwrite_existing, ec);
+        if (ec) {
+            std::cerr << "Failed to copy " << source << ": " << ec.message() << "\n";
+            return false;
+        }
+        compile_db.push_back({
+            {"directory",                                                options.work_dir.string()},
+            {     "file",                                                          target.string()},
+            {"arguments",
+             {is_c ? "clang" : "clang++", is_c ? "-std=c11" : "-std=c++23", "-c", target.string()}}
+        });
+    }
+
+    std::ofstream out(options.work_dir / "compile_commands.json");
+    out << compile_db.dump(2) << "\n";
+    return static_cast<bool>(out);
+}
+
+std::optional<Options> parse_options(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        const bool has_value = i + 1 < argc;
+        if (arg == "--tus" && has_value) {
+            options.tus = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--jobs" && has_value) {
+            options.jobs = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--work-dir" && has_value) {
+            options.work_dir = argv[++i];
+        } else if (arg == "--out" && has_value) {
+            options.out = fs::path(argv[++i]);
+        } else if (arg == "--keep") {
+            options.keep = true;
+        } else {
+            std::cerr << "Usage: bench_e2e [--tus N] [--jobs N] [--work-dir DIR] [--out FILE]"
+                         " [--keep]\n";
+            return std::nullopt;
+        }
+    }
+    if (options.tus == 0) {
+        std::cerr << "--tus must be positive\n";
+        return std::nullopt;
+    }
+    return options;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    auto options = parse_options(argc, argv);
+    if (!options) {
+        return 1;
+    }
+
+    const fs::path repo_root = SAPPP_REPO_ROOT;
+    const std::string sappp_bin = (fs::path(SAPPP_BIN_DIR) / "sappp").string();
+    const std::string schema_dir = (repo_root / "schemas").string();
+    const auto sources = find_litmus_sources(repo_root / "tests" / "end_to_end");
+    if (sources.empty()) {
+        std::cerr << "No litmus sources under tests/end_to_end\n";
+        return 1;
+    }
+
+    if (!prepare_work_dir(options->work_dir) || !write_project(*options, sources)) {
+        return 1;
+    }
+
+    const fs::path out_dir = options->work_dir / "out";
+    const std::string build_snapshot = (out_dir / "build_snapshot.json").string();
+    const std::string pack_path = (options->work_dir / "pack.tar.gz").string();
+    std::vector<std::string> jobs_args;
+    if (options->jobs > 0) {
+        jobs_args = {"--jobs", std::to_string(options->jobs)};
+    }
+    const auto with_jobs = [&](std::vector<std::string> args) {
+        args.insert(args.end(), jobs_args.begin(), jobs_args.end());
+        return args;
+    };
+
+    nlohmann::json stages = nlohmann::json::array();
+    nlohmann::json skipped = nlohmann::json::array();
+    std::chrono::microseconds total_time{0};
+    bool failed = false;
+    const auto record = [&](std::string_view name, const std::vector<std::string>& args) {
+        if (failed) {
+            skipped.push_back({
+                {  "stage", std::string(name)},
+                { "reason", "previous stage failed"}
+            });
+            return std::optional<StageRun>();
+        }
+        const auto run = run_stage(args);
+        total_time += run.wall_time;
+        stages.push_back({
+            {         "stage",                                      std::string(name)},
+            {     "exit_code",                                          run.exit_code},
+            {       "wall_us",                                 run.wall_time.count()},
+            {"peak_rss_bytes",                                     run.peak_rss_bytes},
+            {"tus_per_second", per_second(options->tus, run.wall_time)}
+        });
+        if (run.exit_code != 0) {
+            std::cerr << "Stage " << name << " failed with exit code " << run.exit_code << "\n";
+            failed = true;
+            return std::optional<StageRun>();
+        }
+        return std::optional<StageRun>(run);
+    };
+
+    fs::create_directories(out_dir);
+    (void)record("capture",
+                 with_jobs({sappp_bin,
+                            "capture",
+                            "--compile-commands",
+                            (options->work_dir / "compile_commands.json").string(),
+                            "--out",
+                            build_snapshot,
+                            "--repo-root",
+                            options->work_dir.string(),
+                            "--schema-dir",
+                            schema_dir}));
+
+    std::uint64_t pos = 0;
+    std::uint64_t certs = 0;
+#if defined(SAPPP_HAS_CLANG_FRONTEND)
+    const auto analyze = record("analyze",
+                                with_jobs({sappp_bin,
+                                           "analyze",
+                                           "--build",
+                                           build_snapshot,
+                                           "--out",
+                                           out_dir.string(),
+                                           "--schema-dir",
+                                           schema_dir}));
+    if (analyze) {
+        pos = array_size_or_zero(load_json_or_null(out_dir / "po" / "po_list.json"), "pos");
+        const auto analyze_stats = load_json_or_null(out_dir / "stats.json");
+        if (analyze_stats.is_object()) {
+            certs = analyze_stats.at("counters").value("certs_written", std::uint64_t{0});
+        }
+        stages.back()["pos_per_second"] = per_second(pos, analyze->wall_time);
+        stages.back()["certs_per_second"] = per_second(certs, analyze->wall_time);
+    }
+
+    const auto validate = record(
+        "validate",
+        {sappp_bin, "validate", "--in", out_dir.string(), "--schema-dir", schema_dir});
+    if (validate) {
+        const auto results = array_size_or_zero(
+            load_json_or_null(out_dir / "results" / "validated_results.json"), "results");
+        stages.back()["pos_per_second"] = per_second(results, validate->wall_time);
+        stages.back()["certs_per_second"] = per_second(certs, validate->wall_time);
+    }
+
+    (void)record("pack",
+                 with_jobs({sappp_bin,
+                            "pack",
+                            "--in",
+                            out_dir.string(),
+                            "--out",
+                            pack_path,
+                            "--manifest",
+                            (options->work_dir / "manifest.json").string(),
+                            "--schema-dir",
+                            schema_dir}));
+#else
+    for (const std::string_view stage : {"analyze", "validate", "pack"}) {
+        skipped.push_back({
+            { "stage",                                std::string(stage)},
+            {"reason", "frontend_clang is not built (SAPPP_BUILD_CLANG_FRONTEND=OFF)"}
+        });
+    }
+#endif
+
+    std::uint64_t peak_rss_bytes = 0;
+    for (const auto& stage : stages) {
+        peak_rss_bytes = std::max(peak_rss_bytes, stage.at("peak_rss_bytes").get<std::uint64_t>());
+    }
+    const nlohmann::json report = {
+        {      "benchmark",                                  "e2e"},
+        {            "tus",                           options->tus},
+        {"litmus_sources",                         sources.size()},
+        {           "jobs",                          options->jobs},
+        {            "pos",                                    pos},
+        {          "certs",                                  certs},
+        {        "wall_us",                     total_time.count()},
+        { "tus_per_second",       per_second(options->tus, total_time)},
+        { "pos_per_second",                per_second(pos, total_time)},
+        {"certs_per_second",             per_second(certs, total_time)},
+        { "peak_rss_bytes",                         peak_rss_bytes},
+        {         "stages",                                 stages},
+        {        "skipped",                                skipped}
+    };
+
+    if (options->out) {
+        std::ofstream out(*options->out);
+        out << report.dump(2) << "\n";
+    } else {
+        std::cout << report.dump(2) << "\n";
+    }
+    if (!options->keep) {
+        std::error_code ec;
+        fs::remove_all(options->work_dir, ec);
+    }
+    return failed ? 1 : 0;
+}
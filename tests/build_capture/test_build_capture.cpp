@@ -5,11 +5,16 @@
 
 #include "sappp/build_capture.hpp"
 #include "sappp/canonical_json.hpp"
+#include "sappp/file_hash_cache.hpp"
 #include "sappp/schema_validate.hpp"
 
 #include <filesystem>
 #include <fstream>
+#include <limits>
 #include <ranges>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -43,6 +48,56 @@ std::filesystem::path write_compile_commands(const std::filesystem::path& repo_r
     return compile_commands;
 }
 
+std::filesystem::path write_large_compile_commands(const std::filesystem::path& repo_root,
+                                                   std::size_t count,
+                                                   std::size_t invalid_from)
+{
+    std::filesystem::path build_dir = repo_root / "build";
+    std::filesystem::create_directories(build_dir);
+
+    nlohmann::json compile_db = nlohmann::json::array();
+    for (std::size_t i = 0; i < count; ++i) {
+        std::string file = (repo_root / "src" / ("unit" + std::to_string(i) + ".cpp")).string();
+        nlohmann::json entry = {
+            {"directory", build_dir.string()},
+            {     "file",               file}
+        };
+        if (i % 2 == 0) {
+            entry["arguments"] = {"clang++", "-std=c++20", "-DUNIT=" + std::to_string(i), file};
+        } else {
+            entry["command"] = "clang++ -std=c++17 -DUNIT=" + std::to_string(i) + " " + file;
+        }
+        if (i >= invalid_from) {
+            entry.erase("file");
+        }
+        compile_db.push_back(std::move(entry));
+    }
+
+    std::filesystem::path compile_commands = build_dir / "compile_commands.json";
+    std::ofstream out(compile_commands);
+    out << compile_db.dump();
+    return compile_commands;
+}
+
+void write_text(const std::filesystem::path& path, std::string_view contents)
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << contents;
+}
+
+[[nodiscard]] std::string tu_id_with_define(const BuildSnapshot& snapshot, std::string_view define)
+{
+    for (const auto& unit : snapshot.json().at("compile_units")) {
+        for (const auto& arg : unit.at("argv")) {
+            if (arg == define) {
+                return unit.at("tu_id").get<std::string>();
+            }
+        }
+    }
+    return {};
+}
+
 }  // namespace
 
 TEST(BuildCaptureTest, GeneratesSnapshotFromCompileCommands)
@@ -116,4 +171,176 @@ TEST(BuildCaptureTest, GeneratesSnapshotFromCompileCommands)
     EXPECT_TRUE(schema_result) << (schema_result ? "" : schema_result.error().message);
 }
 
+TEST(BuildCaptureTest, ParallelCaptureMatchesSerial)
+{
+    std::filesystem::path repo_root =
+        std::filesystem::temp_directory_path() / "sappp_build_capture_parallel" / "repo";
+    std::filesystem::remove_all(repo_root);
+    std::filesystem::path compile_commands =
+        write_large_compile_commands(repo_root, 1000, std::numeric_limits<std::size_t>::max());
+
+    auto serial = BuildCapture(repo_root.string(), SAPPP_SCHEMA_DIR, 1).capture(compile_commands);
+    auto parallel =
+        BuildCapture(repo_root.string(), SAPPP_SCHEMA_DIR, 8).capture(compile_commands);
+    ASSERT_TRUE(serial) << serial.error().message;
+    ASSERT_TRUE(parallel) << parallel.error().message;
+
+    const auto& units = parallel->json().at("compile_units");
+    ASSERT_EQ(units.size(), 1000U);
+    EXPECT_EQ(units, serial->json().at("compile_units"));
+    EXPECT_EQ(parallel->json().at("input_digest"), serial->json().at("input_digest"));
+}
+
+TEST(BuildCaptureTest, ReportsFirstInvalidEntry)
+{
+    std::filesystem::path repo_root =
+        std::filesystem::temp_directory_path() / "sappp_build_capture_invalid" / "repo";
+    std::filesystem::remove_all(repo_root);
+    std::filesystem::path compile_commands = write_large_compile_commands(repo_root, 900, 700);
+
+    auto result = BuildCapture(repo_root.string(), SAPPP_SCHEMA_DIR, 4).capture(compile_commands);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, "CompileCommandsEntryInvalid");
+    EXPECT_TRUE(result.error().message.contains("entry 700 ")) << result.error().message;
+}
+
+TEST(BuildCaptureTest, RejectsNonArrayDatabase)
+{
+    std::filesystem::path temp_root =
+        std::filesystem::temp_directory_path() / "sappp_build_capture_non_array";
+    std::filesystem::create_directories(temp_root);
+    std::filesystem::path compile_commands = temp_root / "compile_commands.json";
+    {
+        std::ofstream out(compile_commands);
+        out << R"({"directory": "/tmp", "file": "a.cpp", "arguments": ["clang++"]})";
+    }
+
+    auto result = BuildCapture(temp_root.string(), SAPPP_SCHEMA_DIR).capture(compile_commands);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, "CompileCommandsInvalid");
+}
+
+
+TEST(BuildCaptureTest, DeltaCaptureReusesUnchangedUnits)
+{
+    std::filesystem::path repo_root =
+        std::filesystem::temp_directory_path() / "sappp_build_capture_delta" / "repo";
+    std::filesystem::remove_all(repo_root);
+    std::filesystem::path base_commands =
+        write_large_compile_commands(repo_root, 50, std::numeric_limits<std::size_t>::max());
+
+    BuildCapture capture(repo_root.string(), SAPPP_SCHEMA_DIR, 4);
+    auto base = capture.capture(base_commands);
+    ASSERT_TRUE(base) << base.error().message;
+
+    // Recompile unit3 with different flags, drop unit10 and add a new source.
+    nlohmann::json compile_db;
+    {
+        std::ifstream in(base_commands);
+        compile_db = nlohmann::json::parse(in);
+    }
+    compile_db[3]["command"] = compile_db[3]["command"].get<std::string>() + " -O2";
+    compile_db.erase(10);
+    std::string added_file = (repo_root / "src" / "added.cpp").string();
+    compile_db.push_back({
+        {"directory",         (repo_root / "build").string()},
+        {     "file",                               added_file},
+        {"arguments", {"clang++", "-DUNIT=added", added_file}}
+    });
+    std::filesystem::path next_commands = repo_root / "build" / "compile_commands_next.json";
+    {
+        std::ofstream out(next_commands);
+        out << compile_db.dump();
+    }
+
+    auto delta = capture.capture_delta(next_commands.string(), *base);
+    ASSERT_TRUE(delta) << delta.error().message;
+    auto full = capture.capture(next_commands.string());
+    ASSERT_TRUE(full) << full.error().message;
+    EXPECT_EQ(delta->snapshot.json().at("compile_units"), full->json().at("compile_units"));
+
+    const auto& change_set = delta->change_set;
+    EXPECT_EQ(change_set.at("schema_version"), "build_change_set.v1");
+    EXPECT_EQ(change_set.at("base_input_digest"), base->json().at("input_digest"));
+    EXPECT_EQ(change_set.at("input_digest"), full->json().at("input_digest"));
+    EXPECT_EQ(change_set.at("unchanged"), 48);
+    EXPECT_EQ(change_set.at("added"),
+              nlohmann::json::array({tu_id_with_define(*full, "-DUNIT=added")}));
+    EXPECT_EQ(change_set.at("removed"),
+              nlohmann::json::array({tu_id_with_define(*base, "-DUNIT=10")}));
+    ASSERT_EQ(change_set.at("modified").size(), 1U);
+    EXPECT_EQ(change_set.at("modified")[0].at("base_tu_id"), tu_id_with_define(*base, "-DUNIT=3"));
+    EXPECT_EQ(change_set.at("modified")[0].at("tu_id"), tu_id_with_define(*full, "-DUNIT=3"));
+}
+
+TEST(BuildCaptureTest, HeaderEditInvalidatesOnlyIncludingUnits)
+{
+    std::filesystem::path repo_root =
+        std::filesystem::temp_directory_path() / "sappp_build_capture_deps" / "repo";
+    std::filesystem::remove_all(repo_root);
+    std::filesystem::path compile_commands = write_compile_commands(repo_root);
+    write_text(repo_root / "src" / "main.c", "#include \"shared.h\"\n");
+    write_text(repo_root / "src" / "app.cpp", "#include \"app.h\"\n");
+    write_text(repo_root / "include" / "shared.h", "int shared;\n");
+    write_text(repo_root / "include" / "app.h", "int app;\n");
+
+    auto snapshot = BuildCapture(repo_root.string(), SAPPP_SCHEMA_DIR).capture(compile_commands);
+    ASSERT_TRUE(snapshot) << snapshot.error().message;
+
+    // Record the closure the dependency scanner would produce for each unit.
+    common::FileHashCache recording;
+    nlohmann::json recorded = nlohmann::json::array();
+    std::string app_tu_id;
+    for (const auto& unit : snapshot->json().at("compile_units")) {
+        const bool is_app = unit.at("lang") == "c++";
+        std::vector<std::string> files = {"include/shared.h", "src/main.c"};
+        if (is_app) {
+            files = {"include/app.h", "src/app.cpp"};
+        }
+        nlohmann::json files_json = nlohmann::json::array();
+        for (const auto& file : files) {
+            auto digest = recording.digest(repo_root / file);
+            ASSERT_TRUE(digest) << digest.error().message;
+            files_json.push_back({
+                {  "path",    file},
+                {"sha256", *digest}
+            });
+        }
+        recorded.push_back({
+            {"tu_id", unit.at("tu_id")},
+            {"files",       files_json}
+        });
+        if (is_app) {
+            app_tu_id = unit.at("tu_id").get<std::string>();
+        }
+    }
+    snapshot->json()["dependencies"] = {
+        {"schema_version", "build_deps.v1"},
+        {         "units",        recorded}
+    };
+    ASSERT_TRUE(common::validate_json(snapshot->json(),
+                                      std::string(SAPPP_SCHEMA_DIR)
+                                          + "/build_snapshot.v1.schema.json"));
+
+    common::FileHashCache unchanged;
+    EXPECT_TRUE(invalidated_units(*snapshot, unchanged, repo_root.string()).empty());
+
+    write_text(repo_root / "include" / "app.h", "int app_renamed;\n");
+    common::FileHashCache edited;
+    EXPECT_EQ(invalidated_units(*snapshot, edited, repo_root.string()),
+              std::vector<std::string>{app_tu_id});
+
+    // A delta capture against the scanned snapshot reports the same unit.
+    BuildCapture capture(repo_root.string(), SAPPP_SCHEMA_DIR);
+    auto delta = capture.capture_delta(compile_commands, *snapshot);
+    ASSERT_TRUE(delta) << delta.error().message;
+    EXPECT_EQ(delta->change_set.at("unchanged"), 2);
+    EXPECT_EQ(delta->change_set.at("dependency_changed"), nlohmann::json::array({app_tu_id}));
+
+    // Without a recorded closure every unit has to be rebuilt.
+    snapshot->json().erase("dependencies");
+    common::FileHashCache missing;
+    EXPECT_EQ(invalidated_units(*snapshot, missing, repo_root.string()).size(), 2U);
+}
+
 }  // namespace sappp::build_capture::tests
@@ -0,0 +1,117 @@
+/**
+ * @file test_bench_cli.cpp
+ * @brief Smoke test for the sappp bench subcommand
+ */
+
+#include "sappp/schema_validate.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+namespace sappp::determinism::tests {
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr std::string_view kSapppBinary = SAPPP_TEST_SAPPP_BIN;
+constexpr std::string_view kSchemaDir = SAPPP_SCHEMA_DIR;
+
+TEST(BenchCliTest, ReportsEveryWorkloadAndCleansUp)
+{
+    const fs::path dir = fs::temp_directory_path() / "sappp_bench_cli";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+    const fs::path report_path = dir / "bench.json";
+
+    const auto command =
+        std::format("\"{}\" bench --iterations 3 --dir \"{}\" --out \"{}\" --schema-dir \"{}\"",
+                    kSapppBinary,
+                    dir.string(),
+                    report_path.string(),
+                    kSchemaDir);
+    ASSERT_EQ(std::system(command.c_str()), 0);
+
+    std::ifstream in(report_path);
+    const auto report = nlohmann::json::parse(in);
+    auto valid = common::validate_json(report, std::string(kSchemaDir) + "/bench.v1.schema.json");
+    EXPECT_TRUE(valid) << valid.error().message;
+
+    const auto& workloads = report.at("workloads");
+    EXPECT_EQ(workloads.size(), 9U);
+    for (const auto& workload : workloads) {
+        EXPECT_EQ(workload.at("ops"), 3);
+        const auto name = workload.at("name").get<std::string>();
+        if (name.starts_with("certstore_get")) {
+            EXPECT_TRUE(workload.contains("cache")) << name;
+        }
+        if (name.starts_with("certstore_")) {
+            EXPECT_GT(workload.at("bytes").get<std::uint64_t>(), 0U) << name;
+        }
+        const auto& latency = workload.at("latency_ns");
+        EXPECT_LE(latency.at("min").get<std::uint64_t>(), latency.at("p50").get<std::uint64_t>());
+        EXPECT_LE(latency.at("p50").get<std::uint64_t>(), latency.at("max").get<std::uint64_t>());
+    }
+    EXPECT_FALSE(fs::exists(dir / ".sappp-bench"));
+    fs::remove_all(dir, ec);
+}
+
+TEST(BenchCliTest, RepeatedWorkloadRunsOnce)
+{
+    const fs::path dir = fs::temp_directory_path() / "sappp_bench_cli_repeat";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir);
+    const fs::path report_path = dir / "bench.json";
+
+    const auto command = std::format(
+        "\"{}\" bench --iterations 2 --workload certstore_put --workload certstore_get"
+        " --workload certstore_put --dir \"{}\" --out \"{}\" --schema-dir \"{}\"",
+        kSapppBinary,
+        dir.string(),
+        report_path.string(),
+        kSchemaDir);
+    ASSERT_EQ(std::system(command.c_str()), 0);
+
+    std::ifstream in(report_path);
+    const auto workloads = nlohmann::json::parse(in).at("workloads");
+    ASSERT_EQ(workloads.size(), 2U);
+    EXPECT_EQ(workloads[0].at("name"), "certstore_put");
+    EXPECT_EQ(workloads[1].at("name"), "certstore_get");
+    EXPECT_EQ(workloads[1].at("cache"), "warm");
+    fs::remove_all(dir, ec);
+}
+
+TEST(BenchCliTest, ForeignWorkDirIsNotCleared)
+{
+    const fs::path dir = fs::temp_directory_path() / "sappp_bench_cli_foreign";
+    std::error_code ec;
+    fs::remove_all(dir, ec);
+    fs::create_directories(dir / ".sappp-bench");
+    const fs::path kept = dir / ".sappp-bench" / "keep.txt";
+    std::ofstream(kept) << "not ours\n";
+
+    const auto command = std::format(
+        "\"{}\" bench --iterations 1 --workload certstore_put --dir \"{}\" --out \"{}\""
+        " --schema-dir \"{}\"",
+        kSapppBinary,
+        dir.string(),
+        (dir / "bench.json").string(),
+        kSchemaDir);
+    EXPECT_NE(std::system(command.c_str()), 0);
+    EXPECT_TRUE(fs::exists(kept));
+    EXPECT_FALSE(fs::exists(dir / "bench.json"));
+    fs::remove_all(dir, ec);
+}
+
+}  // namespace
+}  // namespace sappp::determinism::tests
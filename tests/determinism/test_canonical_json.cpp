@@ -6,6 +6,9 @@
 #include "sappp/canonical_json.hpp"
 #include "sappp/common.hpp"
 
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include <nlohmann/json.hpp>
 
@@ -145,3 +148,55 @@ TEST(CanonicalJSON, ValidateForCanonical)
         {"arr", {1, 2, 3}}
     }));
 }
+
+TEST(CanonicalJSON, ParseCanonicalMatchesHashCanonical)
+{
+    Json j = {
+        {   "z",                                    -5},
+        {   "a", {{"nested", "tab\there \"q\" \x01"}}},
+        { "arr",           {1, 18446744073709551615ULL}},
+        {"utf8",                     "\xE3\x81\x82/\x7F"}
+    };
+    auto canonical = canonicalize(j);
+    ASSERT_TRUE(canonical);
+
+    auto document = parse_canonical(*canonical);
+    ASSERT_TRUE(document) << document.error().message;
+    EXPECT_EQ(document->value, j);
+
+    auto hash = hash_canonical(j);
+    ASSERT_TRUE(hash);
+    EXPECT_EQ(document->hash, *hash);
+}
+
+TEST(CanonicalJSON, ParseCanonicalRejectsNonCanonicalBytes)
+{
+    const std::vector<std::string> non_canonical = {
+        R"({"b":1,"a":2})",
+        R"({"a":1,"a":2})",
+        R"({"a": 1})",
+        R"({"a":1})"
+        "\n",
+        R"({"a":1.5})",
+        R"({"a":1e3})",
+        R"({"a":-0})",
+        R"({"a":"\/"})",
+        R"({"a":"\u0041"})",
+        R"({"a":"\u000A"})",
+        R"({"a":"\u001F"})",
+        R"({"a":99999999999999999999})",
+    };
+    for (const auto& bytes : non_canonical) {
+        auto document = parse_canonical(bytes);
+        ASSERT_FALSE(document) << bytes;
+        EXPECT_EQ(document.error().code, "NonCanonicalJson") << bytes;
+    }
+
+    auto truncated = parse_canonical(R"({"a":)");
+    ASSERT_FALSE(truncated);
+    EXPECT_EQ(truncated.error().code, "ParseError");
+
+    auto escaped_control = parse_canonical(R"({"a":"\u001f"})");
+    ASSERT_TRUE(escaped_control);
+    EXPECT_EQ(escaped_control->value.at("a"), "\x1f");
+}
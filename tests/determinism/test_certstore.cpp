@@ -8,13 +8,20 @@
 
 #include "sappp/certstore.hpp"
 
+#include "sappp/run_stats.hpp"
+
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 using sappp::certstore::CertStore;
 using Json = nlohmann::json;
+using sappp::common::stats::Counter;
 
 namespace {
 
@@ -106,3 +113,139 @@ TEST(CertStore, PutGetDeterminism)
     EXPECT_EQ(index.at("po_id"), po_id);
     EXPECT_EQ(index.at("root"), hash1);
 }
+
+TEST(CertStore, GetRejectsNonCanonicalObject)
+{
+    TempDir temp_dir("sappp_certstore_non_canonical_test");
+
+    CertStore store(temp_dir.path().string(), SAPPP_SCHEMA_DIR);
+    auto hash = store.put(make_ir_ref_cert());
+    ASSERT_TRUE(hash.has_value()) << "put() failed: " << hash.error().message;
+
+    // Same content and hash after re-canonicalization, but not the stored canonical bytes.
+    constexpr std::string_view kPrefix = "sha256:";
+    std::filesystem::path object_path = temp_dir.path() / "objects"
+                                        / hash->substr(kPrefix.size(), 2) / (*hash + ".json");
+    {
+        std::ofstream out(object_path, std::ios::binary | std::ios::trunc);
+        out << make_ir_ref_cert().dump(2);
+    }
+
+    auto fetched = store.get(*hash);
+    ASSERT_FALSE(fetched.has_value());
+    EXPECT_EQ(fetched.error().code, "NonCanonicalJson");
+}
+
+TEST(CertStore, AsyncWritesMatchSynchronousLayout)
+{
+    TempDir sync_dir("sappp_certstore_sync_test");
+    TempDir async_dir("sappp_certstore_async_test");
+
+    CertStore sync_store(sync_dir.path().string(), SAPPP_SCHEMA_DIR);
+    CertStore async_store(async_dir.path().string(), SAPPP_SCHEMA_DIR);
+    async_store.enable_async_writes(4);
+
+    const auto written_before = sappp::common::stats::value(Counter::kCertsWritten);
+    const auto deduplicated_before = sappp::common::stats::value(Counter::kCertsDeduplicated);
+    std::vector<std::string> hashes;
+    for (int i = 0; i < 32; ++i) {
+        Json cert = make_ir_ref_cert();
+        cert["inst_id"] = "I" + std::to_string(i % 8);  // Repeats exercise de-duplication.
+        auto sync_hash = sync_store.put(cert);
+        auto async_hash = async_store.put(cert);
+        ASSERT_TRUE(sync_hash.has_value()) << sync_hash.error().message;
+        ASSERT_TRUE(async_hash.has_value()) << async_hash.error().message;
+        EXPECT_EQ(*sync_hash, *async_hash);
+        hashes.push_back(*async_hash);
+    }
+
+    // Rebinding the same PO must keep the last submitted root.
+    std::string po_id = "sha256:bbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbbb";
+    for (const auto& hash : hashes) {
+        ASSERT_TRUE(sync_store.bind_po(po_id, hash).has_value());
+        ASSERT_TRUE(async_store.bind_po(po_id, hash).has_value());
+    }
+    ASSERT_TRUE(async_store.flush().has_value());
+    // Both stores write 8 distinct objects and skip 24 repeats.
+    EXPECT_EQ(sappp::common::stats::value(Counter::kCertsWritten) - written_before, 16U);
+    EXPECT_EQ(sappp::common::stats::value(Counter::kCertsDeduplicated) - deduplicated_before,
+              48U);
+
+    auto read_tree = [](const std::filesystem::path& root) {
+        std::map<std::string, std::string> files;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(root)) {
+            if (!entry.is_regular_file()) {
+                continue;
+            }
+            std::ifstream in(entry.path(), std::ios::binary);
+            files.emplace(std::filesystem::relative(entry.path(), root).generic_string(),
+                          std::string{std::istreambuf_iterator<char>{in},
+                                      std::istreambuf_iterator<char>{}});
+        }
+        return files;
+    };
+    EXPECT_EQ(read_tree(sync_dir.path()), read_tree(async_dir.path()));
+
+    auto fetched = async_store.get(hashes.back());
+    ASSERT_TRUE(fetched.has_value()) << fetched.error().message;
+}
+
+TEST(CertStore, AsyncWriteErrorsAreReportedOnFlush)
+{
+    TempDir temp_dir("sappp_certstore_async_error_test");
+
+    // A regular file where the objects directory should be makes every object write fail.
+    {
+        std::ofstream blocker(temp_dir.path() / "objects");
+    }
+
+    CertStore store(temp_dir.path().string(), SAPPP_SCHEMA_DIR);
+    store.enable_async_writes(2);
+    Json first = make_ir_ref_cert();
+    Json second = make_ir_ref_cert();
+    second["inst_id"] = "I2";
+    const auto written_before = sappp::common::stats::value(Counter::kCertsWritten);
+    ASSERT_TRUE(store.put(first).has_value());
+    ASSERT_TRUE(store.put(second).has_value());
+
+    auto flushed = store.flush();
+    ASSERT_FALSE(flushed.has_value());
+    EXPECT_EQ(flushed.error().code, "IOError");
+    EXPECT_TRUE(flushed.error().message.starts_with("2 certificate write(s) failed"))
+        << flushed.error().message;
+    EXPECT_TRUE(store.flush().has_value());
+    EXPECT_EQ(sappp::common::stats::value(Counter::kCertsWritten), written_before);
+
+    // A failed object write is forgotten, so putting the same certificate retries it.
+    std::filesystem::remove(temp_dir.path() / "objects");
+    auto retried = store.put(first);
+    ASSERT_TRUE(retried.has_value());
+    ASSERT_TRUE(store.flush().has_value());
+    EXPECT_EQ(sappp::common::stats::value(Counter::kCertsWritten) - written_before, 1U);
+    auto fetched = store.get(*retried);
+    ASSERT_TRUE(fetched.has_value()) << fetched.error().message;
+    EXPECT_EQ(*fetched, first);
+}
+
+TEST(CertStore, AsyncRewritesOfOnePathKeepSubmissionOrder)
+{
+    TempDir temp_dir("sappp_certstore_async_order_test");
+    CertStore store(temp_dir.path().string(), SAPPP_SCHEMA_DIR);
+    store.enable_async_writes(4);
+
+    std::string po_id = "sha256:cccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccccc";
+    std::string last_hash;
+    for (int i = 0; i < 64; ++i) {
+        Json cert = make_ir_ref_cert();
+        cert["inst_id"] = "I" + std::to_string(i);
+        auto hash = store.put(cert);
+        ASSERT_TRUE(hash.has_value());
+        ASSERT_TRUE(store.bind_po(po_id, *hash).has_value());
+        last_hash = *hash;
+    }
+    ASSERT_TRUE(store.flush().has_value());
+
+    std::ifstream in(temp_dir.path() / "index" / (po_id + ".json"));
+    const auto index = Json::parse(in);
+    EXPECT_EQ(index.at("root"), last_hash);
+}
@@ -0,0 +1,201 @@
+/**
+ * @file test_file_hash_cache.cpp
+ * @brief Persistent file content-hash cache tests
+ */
+
+#include "sappp/common.hpp"
+#include "sappp/file_hash_cache.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+using namespace sappp::common;
+
+namespace {
+
+class FileHashCacheTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_root = std::filesystem::temp_directory_path() / "sappp_file_hash_cache_test";
+        std::filesystem::remove_all(m_root);
+        std::filesystem::create_directories(m_root);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(m_root); }
+
+    /// Write @p contents and backdate the mtime so the digest is eligible for persistence.
+    [[nodiscard]] std::filesystem::path
+    write_file(const std::string& name, const std::string& contents, std::chrono::hours age)
+    {
+        const auto path = m_root / name;
+        {
+            std::ofstream out(path, std::ios::binary | std::ios::trunc);
+            out << contents;
+        }
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - age);
+        return path;
+    }
+
+    [[nodiscard]] std::filesystem::path cache_file() const { return m_root / "file_hashes.json"; }
+
+    std::filesystem::path m_root = {};
+};
+
+}  // namespace
+
+TEST_F(FileHashCacheTest, DigestMatchesSha256)
+{
+    const auto path = write_file("a.txt", "hello", std::chrono::hours{1});
+    FileHashCache cache;
+    auto digest = cache.digest(path);
+    ASSERT_TRUE(digest) << digest.error().message;
+    EXPECT_EQ(*digest, sha256_prefixed("hello"));
+
+    const auto empty = write_file("empty.txt", "", std::chrono::hours{1});
+    auto empty_digest = cache.digest(empty);
+    ASSERT_TRUE(empty_digest) << empty_digest.error().message;
+    EXPECT_EQ(*empty_digest, sha256_prefixed(""));
+
+    auto missing = cache.digest(m_root / "missing.txt");
+    ASSERT_FALSE(missing);
+    EXPECT_EQ(missing.error().code, "IOError");
+}
+
+TEST_F(FileHashCacheTest, RerunRehashesOnlyChangedFile)
+{
+    std::vector<std::filesystem::path> paths;
+    for (int i = 0; i < 8; ++i) {
+        paths.push_back(write_file("f" + std::to_string(i) + ".txt",
+                                   "contents " + std::to_string(i),
+                                   std::chrono::hours{1}));
+    }
+
+    {
+        FileHashCache cache(cache_file());
+        auto digests = cache.digest_all(paths, 4);
+        ASSERT_EQ(digests.size(), paths.size());
+        for (std::size_t i = 0; i < digests.size(); ++i) {
+            ASSERT_TRUE(digests[i]);
+            EXPECT_EQ(*digests[i], sha256_prefixed("contents " + std::to_string(i)));
+        }
+        EXPECT_EQ(cache.misses(), paths.size());
+        ASSERT_TRUE(cache.save());
+    }
+
+    paths[3] = write_file("f3.txt", "changed", std::chrono::hours{2});
+
+    FileHashCache cache(cache_file());
+    auto digests = cache.digest_all(paths, 4);
+    ASSERT_TRUE(digests[3]);
+    EXPECT_EQ(*digests[3], sha256_prefixed("changed"));
+    EXPECT_EQ(cache.misses(), 1U);
+    EXPECT_EQ(cache.hits(), paths.size() - 1);
+}
+
+TEST_F(FileHashCacheTest, RecentlyModifiedFilesAreNotPersisted)
+{
+    const auto path = write_file("fresh.txt", "fresh", std::chrono::hours{0});
+    {
+        FileHashCache cache(cache_file());
+        ASSERT_TRUE(cache.digest(path));
+        ASSERT_TRUE(cache.digest(path));
+        EXPECT_EQ(cache.hits(), 1U);
+        ASSERT_TRUE(cache.save());
+    }
+
+    FileHashCache cache(cache_file());
+    ASSERT_TRUE(cache.digest(path));
+    EXPECT_EQ(cache.misses(), 1U);
+}
+
+TEST_F(FileHashCacheTest, SaveKeepsTheMostRecentlyUsedEntries)
+{
+    std::vector<std::filesystem::path> paths;
+    for (int i = 0; i < 4; ++i) {
+        paths.push_back(write_file("f" + std::to_string(i) + ".txt",
+                                   "contents " + std::to_string(i),
+                                   std::chrono::hours{1}));
+    }
+    {
+        FileHashCache cache(cache_file());
+        ASSERT_TRUE(cache.digest(paths[0]));
+        ASSERT_TRUE(cache.digest(paths[1]));
+        ASSERT_TRUE(cache.save());
+    }
+    {
+        // A later run uses two other files; the two entries from the first run go.
+        std::this_thread::sleep_for(std::chrono::milliseconds{2});
+        FileHashCache cache(cache_file(), 2);
+        ASSERT_TRUE(cache.digest(paths[2]));
+        ASSERT_TRUE(cache.digest(paths[3]));
+        ASSERT_TRUE(cache.save());
+    }
+
+    FileHashCache cache(cache_file());
+    for (const auto& path : paths) {
+        ASSERT_TRUE(cache.digest(path));
+    }
+    EXPECT_EQ(cache.hits(), 2U);
+    EXPECT_EQ(cache.misses(), 2U);
+}
+
+TEST_F(FileHashCacheTest, SaveDropsEntriesUnusedForTooLong)
+{
+    const auto path = write_file("old.txt", "old", std::chrono::hours{1});
+    {
+        FileHashCache cache(cache_file());
+        ASSERT_TRUE(cache.digest(path));
+        ASSERT_TRUE(cache.save());
+    }
+    // Backdate the recorded last use past the age limit.
+    nlohmann::json document;
+    {
+        std::ifstream in(cache_file());
+        document = nlohmann::json::parse(in);
+    }
+    const auto expired = std::chrono::system_clock::now() - FileHashCache::kMaxEntryAge
+                         - std::chrono::hours{1};
+    for (auto& entry : document.at("entries")) {
+        entry["used_ns"] = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               expired.time_since_epoch())
+                               .count();
+    }
+    {
+        std::ofstream out(cache_file(), std::ios::trunc);
+        out << document.dump();
+    }
+
+    // A run that hashes something else rewrites the cache without the stale entry.
+    const auto other = write_file("other.txt", "other", std::chrono::hours{1});
+    {
+        FileHashCache cache(cache_file());
+        ASSERT_TRUE(cache.digest(other));
+        ASSERT_TRUE(cache.save());
+    }
+    FileHashCache cache(cache_file());
+    ASSERT_TRUE(cache.digest(path));
+    ASSERT_TRUE(cache.digest(other));
+    EXPECT_EQ(cache.misses(), 1U);
+    EXPECT_EQ(cache.hits(), 1U);
+}
+
+TEST_F(FileHashCacheTest, DefaultPathIsOptIn)
+{
+    ASSERT_EQ(::setenv("SAPPP_CACHE_DIR", "", 1), 0);
+    EXPECT_FALSE(FileHashCache::default_path());
+    ASSERT_EQ(::unsetenv("SAPPP_CACHE_DIR"), 0);
+    EXPECT_FALSE(FileHashCache::default_path());
+    ASSERT_EQ(::setenv("SAPPP_CACHE_DIR", m_root.c_str(), 1), 0);
+    EXPECT_EQ(FileHashCache::default_path(), m_root / "file_hashes.json");
+    ASSERT_EQ(::unsetenv("SAPPP_CACHE_DIR"), 0);
+}
@@ -0,0 +1,68 @@
+/**
+ * @file test_parallel.cpp
+ * @brief parallel_for_each_index tests
+ */
+
+#include "sappp/parallel.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using sappp::common::parallel_for_each_index;
+
+TEST(ParallelForEachIndexTest, VisitsEveryIndexOnce)
+{
+    for (std::size_t jobs : {1U, 4U}) {
+        std::vector<std::atomic<int>> visits(1000);
+        auto result = parallel_for_each_index(visits.size(),
+                                              jobs,
+                                              [&](std::size_t i) -> sappp::VoidResult {
+                                                  ++visits[i];
+                                                  return {};
+                                              });
+        ASSERT_TRUE(result);
+        for (const auto& count : visits) {
+            EXPECT_EQ(count.load(), 1);
+        }
+    }
+}
+
+TEST(ParallelForEachIndexTest, ReportsTheLowestFailingIndex)
+{
+    // Index 3 fails with an error and index 7 throws: a serial run stops at 3.
+    const auto fn = [](std::size_t i) -> sappp::VoidResult {
+        if (i == 7) {
+            throw std::runtime_error("seven");
+        }
+        if (i == 3 || i == 40) {
+            return std::unexpected(sappp::Error::make("Failed", std::to_string(i)));
+        }
+        return {};
+    };
+    for (std::size_t jobs : {1U, 8U}) {
+        auto result = parallel_for_each_index(64, jobs, fn);
+        ASSERT_FALSE(result);
+        EXPECT_EQ(result.error().message, "3");
+    }
+}
+
+TEST(ParallelForEachIndexTest, RethrowsAnEarlierExceptionBeforeALaterError)
+{
+    const auto fn = [](std::size_t i) -> sappp::VoidResult {
+        if (i == 2) {
+            throw std::runtime_error("two");
+        }
+        if (i == 5) {
+            return std::unexpected(sappp::Error::make("Failed", "five"));
+        }
+        return {};
+    };
+    for (std::size_t jobs : {1U, 8U}) {
+        EXPECT_THROW((void)parallel_for_each_index(16, jobs, fn), std::runtime_error);
+    }
+}
@@ -0,0 +1,50 @@
+/**
+ * @file test_run_stats.cpp
+ * @brief Run statistics (stats.json) tests
+ */
+
+#include "sappp/run_stats.hpp"
+
+#include <cstdint>
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+namespace stats = sappp::common::stats;
+
+TEST(RunStatsTest, ReportsPhasesAndCounterDeltas)
+{
+    stats::add(stats::Counter::kBytesWritten, 100);
+    stats::RunStats run_stats("validate");
+    run_stats.begin_phase("load");
+    stats::add(stats::Counter::kBytesWritten, 7);
+    stats::add(stats::Counter::kCertsWritten);
+    run_stats.begin_phase("write");
+    stats::add(stats::Counter::kCertsDeduplicated, 2);
+
+    const auto document = run_stats.to_json();
+    EXPECT_EQ(document.at("schema_version"), "stats.v1");
+    EXPECT_EQ(document.at("command"), "validate");
+    const auto& phases = document.at("phases");
+    ASSERT_EQ(phases.size(), 2U);
+    EXPECT_EQ(phases[0].at("name"), "load");
+    EXPECT_EQ(phases[1].at("name"), "write");
+    EXPECT_LE(phases[0].at("wall_us").get<std::int64_t>(),
+              document.at("wall_us").get<std::int64_t>());
+
+    // Only activity after construction is attributed to the run.
+    const auto& counters = document.at("counters");
+    EXPECT_EQ(counters.at("bytes_written"), 7);
+    EXPECT_EQ(counters.at("certs_written"), 1);
+    EXPECT_EQ(counters.at("certs_deduplicated"), 2);
+    EXPECT_EQ(counters.at("schema_validations"), 0);
+}
+
+TEST(RunStatsTest, ReportsResourceUsage)
+{
+    const auto usage = stats::resource_usage();
+#if !defined(_WIN32)
+    EXPECT_GT(usage.peak_rss_bytes, 0U);
+#endif
+    EXPECT_GE(usage.cpu_time.count(), 0);
+}
@@ -0,0 +1,100 @@
+/**
+ * @file test_trace.cpp
+ * @brief Chrome trace-event recorder tests
+ */
+
+#include "sappp/trace.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+namespace trace = sappp::common::trace;
+
+namespace {
+
+class TraceTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_path = std::filesystem::temp_directory_path() / "sappp_trace_test.json";
+        std::filesystem::remove(m_path);
+    }
+
+    void TearDown() override { std::filesystem::remove(m_path); }
+
+    [[nodiscard]] nlohmann::json read_trace() const
+    {
+        std::ifstream in(m_path, std::ios::binary);
+        return nlohmann::json::parse(in);
+    }
+
+    std::filesystem::path m_path = {};
+};
+
+}  // namespace
+
+TEST_F(TraceTest, RecordsCompleteEventsPerThread)
+{
+    trace::start();
+    ASSERT_TRUE(trace::enabled());
+    {
+        const trace::Span outer("test", "outer", "main.cpp");
+        std::jthread worker([] { const trace::Span inner("test", "inner"); });
+    }
+    ASSERT_TRUE(trace::write(m_path));
+    EXPECT_FALSE(trace::enabled());
+
+    const auto document = read_trace();
+    const auto& events = document.at("traceEvents");
+    ASSERT_EQ(events.size(), 2U);
+    // The worker span ends first, so it is recorded first.
+    EXPECT_EQ(events[0].at("name"), "inner");
+    EXPECT_FALSE(events[0].contains("args"));
+    EXPECT_EQ(events[1].at("name"), "outer");
+    EXPECT_EQ(events[1].at("cat"), "test");
+    EXPECT_EQ(events[1].at("ph"), "X");
+    EXPECT_EQ(events[1].at("args").at("detail"), "main.cpp");
+    EXPECT_NE(events[0].at("tid"), events[1].at("tid"));
+    EXPECT_LE(events[1].at("ts").get<double>(), events[0].at("ts").get<double>());
+    EXPECT_GE(events[1].at("dur").get<double>(), events[0].at("dur").get<double>());
+}
+
+TEST_F(TraceTest, SpansAreIgnoredWhenStopped)
+{
+    trace::start();
+    ASSERT_TRUE(trace::write(m_path));
+    bool detail_built = false;
+    {
+        const trace::Span ignored("test", "ignored");
+        const trace::Span lazy("test", "lazy", [&detail_built] {
+            detail_built = true;
+            return std::string("unused");
+        });
+    }
+    ASSERT_TRUE(trace::write(m_path));
+    EXPECT_FALSE(detail_built);
+
+    const auto document = read_trace();
+    EXPECT_EQ(document.at("displayTimeUnit"), "ms");
+    EXPECT_TRUE(document.at("traceEvents").empty());
+}
+
+TEST_F(TraceTest, LazyDetailIsBuiltWhileRecording)
+{
+    trace::start();
+    {
+        const std::filesystem::path path("dir/file.json");
+        const trace::Span span("test", "lazy", [&path] { return path.string(); });
+    }
+    ASSERT_TRUE(trace::write(m_path));
+
+    const auto events = read_trace().at("traceEvents");
+    ASSERT_EQ(events.size(), 1U);
+    EXPECT_EQ(events[0].at("args").at("detail"), "dir/file.json");
+}
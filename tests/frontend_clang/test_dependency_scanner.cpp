@@ -0,0 +1,88 @@
+#include "frontend_clang/dependency_scanner.hpp"
+#include "sappp/common.hpp"
+#include "sappp/schema_validate.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+namespace sappp::frontend_clang::test {
+
+namespace {
+
+void write_text(const std::filesystem::path& path, std::string_view contents)
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << contents;
+}
+
+nlohmann::json make_compile_unit(std::string_view tu, std::string_view source)
+{
+    return {
+        {         "tu_id",                   sappp::common::sha256_prefixed(tu)},
+        {           "cwd",                                                  "."},
+        {          "argv", {"clang++", "-std=c++23", "-c", std::string(source)}},
+        {     "env_delta",                             nlohmann::json::object()},
+        {"response_files",                              nlohmann::json::array()},
+        {          "lang",                                                "c++"},
+        {           "std",                                              "c++23"},
+        {        "target",
+         {{"triple", "x86_64-unknown-linux-gnu"},
+         {"abi", "sysv"},
+         {"data_layout", {{"ptr_bits", 64}, {"long_bits", 64}, {"align", {{"max", 16}}}}}}},
+        {      "frontend",             {{"kind", "clang"}, {"version", "test"}}}
+    };
+}
+
+}  // namespace
+
+TEST(DependencyScannerTest, RecordsHeaderClosureWithDigests)
+{
+    const auto root = std::filesystem::temp_directory_path() / "sappp_dependency_scanner";
+    std::filesystem::remove_all(root);
+    write_text(root / "include" / "shared.h", "#pragma once\nint shared();\n");
+    write_text(root / "include" / "only_a.h", "#pragma once\n#include \"shared.h\"\n");
+    write_text(root / "a.cpp", "#include \"include/only_a.h\"\nint a() { return shared(); }\n");
+    write_text(root / "b.cpp", "int b() { return 0; }\n");
+
+    nlohmann::json snapshot = {
+        {"schema_version",                       "build_snapshot.v1"},
+        {          "tool", {{"name", "sappp"}, {"version", "0.1.0"}}},
+        {  "generated_at",                    "2024-01-01T00:00:00Z"},
+        {          "host",     {{"os", "linux"}, {"arch", "x86_64"}}},
+        { "compile_units",
+         nlohmann::json::array({make_compile_unit("a", "a.cpp"), make_compile_unit("b", "b.cpp")})}
+    };
+
+    auto dependencies = DependencyScanner(root.string(), 2).scan(snapshot);
+    ASSERT_TRUE(dependencies) << dependencies.error().message;
+    snapshot["dependencies"] = *dependencies;
+    ASSERT_TRUE(sappp::common::validate_json(
+        snapshot,
+        std::string(SAPPP_SCHEMA_DIR) + "/build_snapshot.v1.schema.json"));
+
+    const auto& units = dependencies->at("units");
+    ASSERT_EQ(units.size(), 2U);
+    for (const auto& unit : units) {
+        std::vector<std::string> paths;
+        for (const auto& file : unit.at("files")) {
+            paths.push_back(file.at("path").get<std::string>());
+        }
+        if (unit.at("tu_id") == sappp::common::sha256_prefixed("a")) {
+            EXPECT_EQ(paths,
+                      (std::vector<std::string>{"a.cpp", "include/only_a.h", "include/shared.h"}));
+            EXPECT_EQ(unit.at("files")[2].at("sha256"),
+                      sappp::common::sha256_prefixed("#pragma once\nint shared();\n"));
+        } else {
+            EXPECT_EQ(paths, std::vector<std::string>{"b.cpp"});
+        }
+    }
+}
+
+}  // namespace sappp::frontend_clang::test
@@ -0,0 +1,219 @@
+/**
+ * @file test_pack_reader.cpp
+ * @brief Random-access pack archive reader tests
+ */
+
+#include "sappp/pack.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace sappp::pack;
+
+namespace {
+
+class PackReaderTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_root = std::filesystem::temp_directory_path() / "sappp_pack_reader_test";
+        std::filesystem::remove_all(m_root);
+        std::filesystem::create_directories(m_root);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(m_root); }
+
+    std::filesystem::path m_root = {};
+};
+
+/// Poorly compressible bytes, so the archive spans several access points.
+[[nodiscard]] std::string make_payload(std::size_t size, std::uint32_t seed)
+{
+    std::string payload;
+    payload.reserve(size);
+    std::uint32_t state = seed;
+    while (payload.size() < size) {
+        state = (state * 1103515245U) + 12345U;
+        payload.push_back(static_cast<char>((state >> 16U) & 0xffU));
+    }
+    return payload;
+}
+
+void write_file(const std::filesystem::path& path, const std::string& contents)
+{
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << contents;
+}
+
+[[nodiscard]] std::string read_file(const std::filesystem::path& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
+}  // namespace
+
+TEST_F(PackReaderTest, ReadsMembersOfWrittenPack)
+{
+    const std::map<std::string, std::string> files = {
+        {           "pack/a.txt",                       "alpha\n"},
+        {       "pack/big/1.bin", make_payload(std::size_t{3} * 1024 * 1024, 1)},
+        {       "pack/big/2.bin",         make_payload(std::size_t{700} * 1024, 2)},
+        {"pack/certstore/x.json",                      "{\"x\":1}\n"},
+        {          "pack/empty",                               ""},
+        {   "pack/manifest.json",                           "{}\n"},
+    };
+    std::vector<PackEntry> entries;
+    for (const auto& [name, contents] : files) {
+        entries.push_back(PackEntry{.name = name, .source = {}, .contents = contents});
+    }
+    const auto archive = m_root / "pack.tar.gz";
+    ASSERT_TRUE(write_pack(archive, std::move(entries), PackWriteOptions{.jobs = 2}));
+
+    auto reader = PackReader::open(archive);
+    ASSERT_TRUE(reader) << reader.error().message;
+    std::vector<std::string> names;
+    for (const auto& member : reader->members()) {
+        names.push_back(member.name);
+    }
+    EXPECT_EQ(names,
+              (std::vector<std::string>{"pack/a.txt",
+                                        "pack/big/1.bin",
+                                        "pack/big/2.bin",
+                                        "pack/certstore/x.json",
+                                        "pack/empty",
+                                        "pack/manifest.json"}));
+
+    // Members after the first MiB are reached through later access points.
+    for (const auto& [name, contents] : files) {
+        auto read = reader->read(name);
+        ASSERT_TRUE(read) << name << ": " << read.error().message;
+        EXPECT_EQ(*read, contents) << name;
+    }
+
+    std::map<std::string, std::string> streamed;
+    auto each = reader->read_each(
+        [](const PackMember& member) noexcept { return !member.name.starts_with("pack/big/"); },
+        [&streamed](const PackMember& member, std::string contents) -> sappp::VoidResult {
+            streamed.emplace(member.name, std::move(contents));
+            return {};
+        });
+    ASSERT_TRUE(each) << each.error().message;
+    EXPECT_EQ(streamed.size(), 4U);
+    EXPECT_EQ(streamed.at("pack/certstore/x.json"), "{\"x\":1}\n");
+    EXPECT_EQ(streamed.at("pack/manifest.json"), "{}\n");
+
+    auto missing = reader->read("pack/missing.json");
+    ASSERT_FALSE(missing);
+    EXPECT_EQ(missing.error().code, "IOError");
+}
+
+TEST_F(PackReaderTest, ReadsArchivesCreatedByTar)
+{
+    // GNU tar stores the long path through a 'L' extension header and prefixes "./".
+    const std::string long_name = "pack/" + std::string(120, 'd') + "/leaf.txt";
+    write_file(m_root / "tree" / long_name, "long\n");
+    write_file(m_root / "tree" / "pack" / "results" / "validated_results.json", "{\"r\":1}\n");
+    const std::string payload = make_payload(std::size_t{2} * 1024 * 1024, 3);
+    write_file(m_root / "tree" / "pack" / "data.bin", payload);
+
+    const auto archive = m_root / "tar.tar.gz";
+    const auto command = std::format(R"(tar -czf "{}" -C "{}" .)",
+                                     archive.string(),
+                                     (m_root / "tree").string());
+    ASSERT_EQ(std::system(command.c_str()), 0) << command;
+
+    auto reader = PackReader::open(archive);
+    ASSERT_TRUE(reader) << reader.error().message;
+    EXPECT_EQ(reader->members().size(), 3U);
+    ASSERT_NE(reader->find(long_name), nullptr);
+    EXPECT_EQ(reader->read(long_name).value_or(""), "long\n");
+    EXPECT_EQ(reader->read("pack/results/validated_results.json").value_or(""), "{\"r\":1}\n");
+    EXPECT_EQ(reader->read("pack/data.bin").value_or(""), payload);
+}
+
+TEST_F(PackReaderTest, RejectsCorruptArchives)
+{
+    const auto archive = m_root / "pack.tar.gz";
+    ASSERT_TRUE(write_pack(archive,
+                           {PackEntry{.name = "pack/data.bin",
+                                      .source = {},
+                                      .contents = make_payload(std::size_t{256} * 1024, 4)}}));
+    const std::string bytes = read_file(archive);
+
+    const auto truncated = m_root / "truncated.tar.gz";
+    write_file(truncated, bytes.substr(0, bytes.size() / 2));
+    auto reader = PackReader::open(truncated);
+    ASSERT_FALSE(reader);
+    EXPECT_EQ(reader.error().code, "InvalidPack");
+
+    const auto garbage = m_root / "garbage.tar.gz";
+    write_file(garbage, "not a gzip stream");
+    reader = PackReader::open(garbage);
+    ASSERT_FALSE(reader);
+    EXPECT_EQ(reader.error().code, "InvalidPack");
+
+    reader = PackReader::open(m_root / "absent.tar.gz");
+    ASSERT_FALSE(reader);
+    EXPECT_EQ(reader.error().code, "IOError");
+}
+
+TEST_F(PackReaderTest, OpensThroughTheSidecarIndex)
+{
+    const std::string payload = make_payload(std::size_t{1536} * 1024, 5);
+    const auto archive = m_root / "pack.tgz";
+    ASSERT_TRUE(is_pack_archive(archive));
+    ASSERT_TRUE(write_pack(archive,
+                           {PackEntry{.name = "pack/data.bin", .source = {}, .contents = payload},
+                            PackEntry{.name = "pack/z.json", .source = {}, .contents = "{}\n"}}));
+    ASSERT_TRUE(std::filesystem::exists(pack_index_path(archive)));
+
+    // Break the gzip magic: only a reader that skips the full decompression can open it.
+    std::string bytes = read_file(archive);
+    bytes[0] = '\0';
+    write_file(archive, bytes);
+    std::filesystem::last_write_time(archive,
+                                     std::filesystem::last_write_time(pack_index_path(archive)));
+
+    auto reader = PackReader::open(archive);
+    ASSERT_TRUE(reader) << reader.error().message;
+    EXPECT_EQ(reader->members().size(), 2U);
+    EXPECT_EQ(reader->read("pack/data.bin").value_or(""), payload);
+    EXPECT_EQ(reader->read("pack/z.json").value_or(""), "{}\n");
+
+    std::filesystem::remove(pack_index_path(archive));
+    reader = PackReader::open(archive);
+    ASSERT_FALSE(reader);
+    EXPECT_EQ(reader.error().code, "InvalidPack");
+}
+
+TEST_F(PackReaderTest, IgnoresAStaleSidecarIndex)
+{
+    const auto archive = m_root / "pack.tar.gz";
+    const auto saved_index = m_root / "old.idx";
+    ASSERT_TRUE(write_pack(archive,
+                           {PackEntry{.name = "pack/a.json", .source = {}, .contents = "{}\n"}}));
+    std::filesystem::copy_file(pack_index_path(archive), saved_index);
+    ASSERT_TRUE(
+        write_pack(archive,
+                   {PackEntry{.name = "pack/b.json", .source = {}, .contents = "{\"b\":1}\n"}}));
+
+    // A newer index that describes another archive must not be trusted.
+    write_file(pack_index_path(archive), read_file(saved_index));
+    auto reader = PackReader::open(archive);
+    ASSERT_TRUE(reader) << reader.error().message;
+    ASSERT_EQ(reader->members().size(), 1U);
+    EXPECT_EQ(reader->members().front().name, "pack/b.json");
+    EXPECT_EQ(reader->read("pack/b.json").value_or(""), "{\"b\":1}\n");
+}
@@ -0,0 +1,202 @@
+/**
+ * @file test_pack_writer.cpp
+ * @brief Deterministic pack archive writer tests
+ */
+
+#include "sappp/common.hpp"
+#include "sappp/pack.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace sappp::pack;
+
+namespace {
+
+class PackWriterTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_root = std::filesystem::temp_directory_path() / "sappp_pack_writer_test";
+        std::filesystem::remove_all(m_root);
+        std::filesystem::create_directories(m_root / "src" / "dir");
+    }
+
+    void TearDown() override { std::filesystem::remove_all(m_root); }
+
+    [[nodiscard]] std::filesystem::path write_file(const std::string& name,
+                                                   const std::string& contents) const
+    {
+        const auto path = m_root / "src" / name;
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << contents;
+        return path;
+    }
+
+    /// Entries spanning several compression blocks, plus an inline member.
+    [[nodiscard]] std::vector<PackEntry> make_entries() const
+    {
+        return {
+            PackEntry{.name = "pack/dir/b.bin",
+                      .source = m_root / "src" / "dir" / "b.bin",
+                      .contents = std::nullopt},
+            PackEntry{.name = "pack/a.txt",
+                      .source = m_root / "src" / "a.txt",
+                      .contents = std::nullopt},
+            PackEntry{.name = "pack/manifest.json", .source = {}, .contents = "{}\n"},
+            // Longer than the 100-byte ustar name field; stored through the prefix field.
+            PackEntry{.name = long_name(), .source = {}, .contents = "long\n"},
+        };
+    }
+
+    [[nodiscard]] static std::string long_dir() { return "pack/" + std::string(60, 'd'); }
+
+    [[nodiscard]] static std::string long_name()
+    {
+        return long_dir() + "/" + std::string(60, 'e') + "/leaf.txt";
+    }
+
+    std::filesystem::path m_root = {};
+};
+
+/// Mildly compressible bytes so blocks neither vanish nor stay incompressible.
+[[nodiscard]] std::string make_payload(std::size_t size)
+{
+    std::string payload;
+    payload.reserve(size);
+    std::uint32_t state = 12345;
+    while (payload.size() < size) {
+        state = (state * 1103515245U) + 12345U;
+        payload += std::format("line {} value {}\n", payload.size() % 97, (state >> 16U) % 1000);
+    }
+    payload.resize(size);
+    return payload;
+}
+
+[[nodiscard]] std::string read_file(const std::filesystem::path& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+}
+
+}  // namespace
+
+TEST_F(PackWriterTest, ArchiveExtractsWithSortedMembers)
+{
+    const std::string payload = make_payload(std::size_t{700} * 1024);
+    (void)write_file("a.txt", "alpha\n");
+    (void)write_file("dir/b.bin", payload);
+
+    const auto archive = m_root / "pack.tar.gz";
+    auto written = write_pack(archive, make_entries(), PackWriteOptions{.jobs = 4});
+    ASSERT_TRUE(written) << written.error().message;
+    EXPECT_FALSE(std::filesystem::exists(m_root / "pack.tar.gz.tmp"));
+    EXPECT_TRUE(std::filesystem::exists(pack_index_path(archive)));
+    EXPECT_FALSE(std::filesystem::exists(m_root / "pack.tar.gz.idx.tmp"));
+
+    const auto listing = m_root / "listing.txt";
+    const auto list_command =
+        std::format(R"(tar -tzf "{}" > "{}")", archive.string(), listing.string());
+    ASSERT_EQ(std::system(list_command.c_str()), 0) << list_command;
+    const std::string expected_listing = "pack/\npack/a.txt\n" + long_dir() + "/\n" + long_dir()
+                                         + "/" + std::string(60, 'e') + "/\n" + long_name()
+                                         + "\npack/dir/\npack/dir/b.bin\npack/manifest.json\n";
+    EXPECT_EQ(read_file(listing), expected_listing);
+
+    const auto extracted = m_root / "extracted";
+    std::filesystem::create_directories(extracted);
+    const auto extract_command =
+        std::format(R"(tar -xzf "{}" -C "{}")", archive.string(), extracted.string());
+    ASSERT_EQ(std::system(extract_command.c_str()), 0) << extract_command;
+    EXPECT_EQ(read_file(extracted / "pack" / "a.txt"), "alpha\n");
+    EXPECT_EQ(read_file(extracted / "pack" / "dir" / "b.bin"), payload);
+    EXPECT_EQ(read_file(extracted / "pack" / "manifest.json"), "{}\n");
+    EXPECT_EQ(read_file(extracted / long_name()), "long\n");
+}
+
+TEST_F(PackWriterTest, OutputIsIdenticalForAnyJobCount)
+{
+    (void)write_file("a.txt", "alpha\n");
+    (void)write_file("dir/b.bin", make_payload(std::size_t{1} * 1024 * 1024 + 123));
+
+    const auto serial = m_root / "serial.tar.gz";
+    const auto parallel = m_root / "parallel.tar.gz";
+    ASSERT_TRUE(write_pack(serial, make_entries(), PackWriteOptions{.jobs = 1}));
+    ASSERT_TRUE(write_pack(parallel, make_entries(), PackWriteOptions{.jobs = 8}));
+
+    const auto serial_bytes = read_file(serial);
+    ASSERT_FALSE(serial_bytes.empty());
+    EXPECT_EQ(serial_bytes, read_file(parallel));
+
+    EXPECT_EQ(read_file(pack_index_path(serial)), read_file(pack_index_path(parallel)));
+
+    ASSERT_TRUE(write_pack(parallel, make_entries(), PackWriteOptions{.jobs = 3}));
+    EXPECT_EQ(serial_bytes, read_file(parallel));
+}
+
+TEST_F(PackWriterTest, RejectsInvalidMemberNames)
+{
+    (void)write_file("a.txt", "alpha\n");
+    const auto archive = m_root / "invalid.tar.gz";
+    const auto source = m_root / "src" / "a.txt";
+    const std::vector<std::vector<std::string>> cases = {
+        {"pack/a.txt", "pack/a.txt"},
+        {"pack/../a.txt"},
+        {"/pack/a.txt"},
+        {"pack/a.txt", "pack/a.txt/b"},
+        {"pack/" + std::string(200, 'x')},
+    };
+    for (const auto& names : cases) {
+        std::vector<PackEntry> entries;
+        for (const auto& name : names) {
+            entries.push_back(PackEntry{.name = name, .source = source, .contents = std::nullopt});
+        }
+        auto written = write_pack(archive, std::move(entries));
+        ASSERT_FALSE(written) << names.front();
+        EXPECT_EQ(written.error().code, "InvalidPackEntry");
+        EXPECT_FALSE(std::filesystem::exists(archive));
+        EXPECT_FALSE(std::filesystem::exists(pack_index_path(archive)));
+    }
+}
+
+TEST_F(PackWriterTest, RejectsSourcesThatNoLongerMatchTheirDigest)
+{
+    const std::string payload = make_payload(std::size_t{300} * 1024);
+    const auto source = write_file("a.txt", payload);
+    const auto archive = m_root / "checked.tar.gz";
+    const auto entry_with = [&source](std::string sha256, std::uint64_t size) {
+        return std::vector<PackEntry>{
+            PackEntry{.name = "pack/a.txt",
+                      .source = source,
+                      .contents = std::nullopt,
+                      .expected = PackEntryDigest{.sha256 = std::move(sha256), .size = size}}
+        };
+    };
+    const auto digest = sappp::common::sha256_prefixed(payload);
+    ASSERT_TRUE(write_pack(archive, entry_with(digest, payload.size())));
+
+    // Recorded values of a source that was edited afterwards, in place or resized.
+    std::string edited = payload;
+    edited.back() = edited.back() == '\n' ? ' ' : '\n';
+    const std::vector<std::vector<PackEntry>> cases = {
+        entry_with(sappp::common::sha256_prefixed(edited), payload.size()),
+        entry_with(digest, payload.size() + 1),
+    };
+    for (const auto& entries : cases) {
+        std::filesystem::remove(archive);
+        auto written = write_pack(archive, entries);
+        ASSERT_FALSE(written);
+        EXPECT_EQ(written.error().code, "IOError");
+        EXPECT_FALSE(std::filesystem::exists(archive));
+        EXPECT_FALSE(std::filesystem::exists(m_root / "checked.tar.gz.tmp"));
+    }
+}
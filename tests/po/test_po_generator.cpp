@@ -324,4 +324,116 @@ TEST(PoGeneratorTest, LifetimeOpWithoutKindIsIgnored)
     EXPECT_TRUE(po_list.at("pos").empty());
 }
 
+
+TEST(PoGeneratorTest, ParallelGenerationMatchesSerial)
+{
+    std::filesystem::path source_path = write_temp_source("parallel");
+    nlohmann::json nir = build_minimal_nir(source_path);
+    const nlohmann::json function_template = nir.at("functions").at(0);
+    nlohmann::json functions = nlohmann::json::array();
+    for (int i = 0; i < 64; ++i) {
+        nlohmann::json func = function_template;
+        func["function_uid"] = "f" + std::to_string(i);
+        functions.push_back(std::move(func));
+    }
+    nir["functions"] = std::move(functions);
+
+    auto serial = PoGenerator(1).generate(nir);
+    auto parallel = PoGenerator(8).generate(nir);
+    ASSERT_TRUE(serial) << serial.error().message;
+    ASSERT_TRUE(parallel) << parallel.error().message;
+    ASSERT_EQ(parallel->at("pos").size(), 64U);
+
+    auto serial_bytes = canonical::canonicalize(*serial);
+    auto parallel_bytes = canonical::canonicalize(*parallel);
+    ASSERT_TRUE(serial_bytes);
+    ASSERT_TRUE(parallel_bytes);
+    EXPECT_EQ(*parallel_bytes, *serial_bytes);
+}
+
+TEST(PoGeneratorTest, ParallelGenerationReportsMissingSource)
+{
+    std::filesystem::path missing =
+        std::filesystem::temp_directory_path() / "sappp_po_generator_test" / "missing.cpp";
+    std::filesystem::remove(missing);
+    nlohmann::json nir = build_minimal_nir(missing);
+    nir["functions"].push_back(nir.at("functions").at(0));
+
+    auto result = PoGenerator(2).generate(nir);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, "SourceFileOpenFailed");
+}
+
+
+TEST(PoGeneratorTest, IncrementalRegenerationMatchesFullRun)
+{
+    std::filesystem::path source_path = write_temp_source("incremental");
+    nlohmann::json nir = build_minimal_nir(source_path);
+    const nlohmann::json function_template = nir.at("functions").at(0);
+    nlohmann::json functions = nlohmann::json::array();
+    for (int i = 0; i < 16; ++i) {
+        nlohmann::json func = function_template;
+        func["function_uid"] = "f" + std::to_string(i);
+        functions.push_back(std::move(func));
+    }
+    nir["functions"] = std::move(functions);
+
+    PoGenerator generator(4);
+    auto first = generator.generate_incremental(nir, nlohmann::json::object(), {});
+    ASSERT_TRUE(first) << first.error().message;
+    EXPECT_EQ(first->regenerated_functions, 16U);
+    EXPECT_EQ(first->function_digests.size(), 16U);
+
+    nir["functions"][5]["cfg"]["blocks"][0]["insts"][0]["args"] =
+        nlohmann::json::array({"null", true});
+    auto second = generator.generate_incremental(nir, first->po_list, first->function_digests);
+    ASSERT_TRUE(second) << second.error().message;
+    EXPECT_EQ(second->reused_functions, 15U);
+    EXPECT_EQ(second->regenerated_functions, 1U);
+
+    auto full = generator.generate(nir);
+    ASSERT_TRUE(full) << full.error().message;
+    auto full_bytes = canonical::canonicalize(*full);
+    auto incremental_bytes = canonical::canonicalize(second->po_list);
+    ASSERT_TRUE(full_bytes);
+    ASSERT_TRUE(incremental_bytes);
+    EXPECT_EQ(*incremental_bytes, *full_bytes);
+
+    // Editing the source changes repo_identity, so every function is regenerated.
+    {
+        std::ofstream out(source_path);
+        out << "int main() { return 1; }\n";
+    }
+    auto third = generator.generate_incremental(nir, second->po_list, second->function_digests);
+    ASSERT_TRUE(third) << third.error().message;
+    EXPECT_EQ(third->reused_functions, 0U);
+    auto refreshed = generator.generate(nir);
+    ASSERT_TRUE(refreshed);
+    auto third_bytes = canonical::canonicalize(third->po_list);
+    auto refreshed_bytes = canonical::canonicalize(*refreshed);
+    ASSERT_TRUE(third_bytes);
+    ASSERT_TRUE(refreshed_bytes);
+    EXPECT_EQ(*third_bytes, *refreshed_bytes);
+}
+
+TEST(PoGeneratorTest, FunctionDigestsAreBoundToTheirPoList)
+{
+    std::filesystem::path source_path = write_temp_source("digests");
+    nlohmann::json nir = build_minimal_nir(source_path);
+
+    PoGenerator generator;
+    auto generation = generator.generate_incremental(nir, nlohmann::json::object(), {});
+    ASSERT_TRUE(generation) << generation.error().message;
+
+    nlohmann::json sidecar =
+        function_digests_to_json(generation->function_digests, generation->po_list);
+    auto restored = function_digests_from_json(sidecar, generation->po_list);
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_EQ(*restored, generation->function_digests);
+
+    nlohmann::json edited = generation->po_list;
+    edited["pos"] = nlohmann::json::array();
+    EXPECT_FALSE(function_digests_from_json(sidecar, edited).has_value());
+}
+
 }  // namespace sappp::po::tests
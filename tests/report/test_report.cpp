@@ -5,10 +5,37 @@
 
 #include "sappp/report.hpp"
 
+#include "sappp/canonical_json.hpp"
+#include "sappp/schema_validate.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <gtest/gtest.h>
 
 namespace {
 
+[[nodiscard]] sappp::report::ResultCursor cursor_over(const std::vector<nlohmann::json>& items)
+{
+    return [&items, index = std::size_t{0}]() mutable
+           -> sappp::Result<std::optional<nlohmann::json>> {
+        if (index == items.size()) {
+            return std::nullopt;
+        }
+        return std::optional<nlohmann::json>(items[index++]);
+    };
+}
+
 TEST(ReportDiff, ClassifiesChangesAndSorts)
 {
     nlohmann::json before = {
@@ -37,6 +64,265 @@ TEST(ReportDiff, ClassifiesChangesAndSorts)
     EXPECT_EQ(changes->at(2).at("change_kind"), "Resolved");
 }
 
+TEST(ReportDiff, MergeJoinStreamsChangesInOrder)
+{
+    const std::vector<nlohmann::json> before = {
+        {{"po_id", "sha256:aaaa"}, {"category", "SAFE"}},
+        {{"po_id", "sha256:bbbb"}, {"category", "BUG"}},
+        {{"po_id", "sha256:bbbb"}, {"category", "SAFE"}},
+        {{"category", "SAFE"}},
+        {{"po_id", "sha256:dddd"}, {"category", "UNKNOWN"}}
+    };
+    const std::vector<nlohmann::json> after = {
+        {{"po_id", "sha256:bbbb"}, {"category", "UNKNOWN"}},
+        {{"po_id", "sha256:cccc"}, {"category", "SAFE"}},
+        {{"po_id", "sha256:dddd"}, {"category", "BUG"}, {"certificate_root", "sha256:eeee"}}
+    };
+
+    std::vector<nlohmann::json> changes;
+    auto merged = sappp::report::merge_diff_changes(
+        cursor_over(before),
+        cursor_over(after),
+        "",
+        [&changes](nlohmann::json change) -> sappp::VoidResult {
+            changes.push_back(std::move(change));
+            return {};
+        });
+    ASSERT_TRUE(merged.has_value()) << merged.error().message;
+    ASSERT_EQ(changes.size(), 4U);
+
+    EXPECT_EQ(changes.at(0).at("change_kind"), "Resolved");
+    // Of duplicated po_ids only the first entry counts.
+    EXPECT_EQ(changes.at(1).at("from").at("category"), "BUG");
+    EXPECT_EQ(changes.at(1).at("change_kind"), "Regressed");
+    EXPECT_EQ(changes.at(2).at("po_id"), "sha256:cccc");
+    EXPECT_EQ(changes.at(2).at("change_kind"), "New");
+    EXPECT_EQ(changes.at(3).at("to").at("certificate_root"), "sha256:eeee");
+    EXPECT_EQ(changes.at(3).at("change_kind"), "Resolved");
+    EXPECT_FALSE(changes.at(3).contains("reason"));
+
+    const std::vector<nlohmann::json> unsorted = {
+        {{"po_id", "sha256:bbbb"}, {"category", "SAFE"}},
+        {{"po_id", "sha256:aaaa"}, {"category", "SAFE"}}
+    };
+    merged = sappp::report::merge_diff_changes(
+        cursor_over(before),
+        cursor_over(unsorted),
+        "",
+        [](const nlohmann::json&) noexcept -> sappp::VoidResult { return {}; });
+    ASSERT_FALSE(merged.has_value());
+    EXPECT_EQ(merged.error().code, "UnsortedResults");
+}
+
+TEST(ReportDiff, ResultsReaderParsesEntriesLazily)
+{
+    const std::string document = R"( {"schema_version": "validated_results.v1",
+        "results": [ {"po_id": "sha256:aaaa", "note": "a ] \" [ b"} ,
+                     {"po_id": "sha256:bbbb", "nested": {"x": [1, 2]}} ],
+        "tool": {"name": "sappp"}} )";
+    auto reader = sappp::report::ResultsReader::open(document);
+    ASSERT_TRUE(reader.has_value()) << reader.error().message;
+    EXPECT_TRUE(reader->has_results());
+    EXPECT_EQ(reader->header(),
+              (nlohmann::json{
+                  {"schema_version", "validated_results.v1"},
+                  {          "tool",   {{"name", "sappp"}}}
+    }));
+
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<std::string> po_ids;
+        while (true) {
+            auto item = reader->next();
+            ASSERT_TRUE(item.has_value()) << item.error().message;
+            if (!item->has_value()) {
+                break;
+            }
+            po_ids.push_back((*item)->at("po_id").get<std::string>());
+        }
+        EXPECT_EQ(po_ids, (std::vector<std::string>{"sha256:aaaa", "sha256:bbbb"}));
+        reader->rewind();
+    }
+
+    auto empty = sappp::report::ResultsReader::open(R"({"results":[]})");
+    ASSERT_TRUE(empty.has_value());
+    EXPECT_FALSE(empty->next().value().has_value());
+
+    auto truncated = sappp::report::ResultsReader::open(R"({"results":[{"po_id":"x"})");
+    ASSERT_FALSE(truncated.has_value());
+    EXPECT_EQ(truncated.error().code, "ParseError");
+}
+
+TEST(ReportDiff, ResultsReaderStreamsInSmallChunks)
+{
+    const std::string document = R"({"generated_at": "2024-01-01T00:00:00Z",
+        "results": [{"po_id": "sha256:aaaa", "note": "} ] , \" ["}, {"po_id": "sha256:bbbb",
+                    "n": 12345}], "tool": {"name": "sappp"}})";
+    // Three bytes per read splits keys, strings, numbers and entries across chunks.
+    auto make_stream = [](const std::string& bytes, std::size_t& rewinds) {
+        auto offset = std::make_shared<std::size_t>(0);
+        return sappp::report::DocumentStream{
+            .read = [&bytes, offset](std::span<char> dest) -> sappp::Result<std::size_t> {
+                const std::size_t count = std::min({dest.size(), bytes.size() - *offset, 3UL});
+                std::copy_n(bytes.data() + *offset, count, dest.data());
+                *offset += count;
+                return count;
+            },
+            .rewind = [offset, &rewinds]() noexcept -> sappp::VoidResult {
+                *offset = 0;
+                ++rewinds;
+                return {};
+            }};
+    };
+    std::size_t rewinds = 0;
+    auto streamed = sappp::report::ResultsReader::open(make_stream(document, rewinds));
+    ASSERT_TRUE(streamed.has_value()) << streamed.error().message;
+    auto mapped = sappp::report::ResultsReader::open(document);
+    ASSERT_TRUE(mapped.has_value());
+    EXPECT_EQ(streamed->header(), mapped->header());
+
+    for (int pass = 0; pass < 2; ++pass) {
+        while (true) {
+            auto expected = mapped->next();
+            auto item = streamed->next();
+            ASSERT_TRUE(item.has_value()) << item.error().message;
+            ASSERT_EQ(*item, *expected);
+            if (!item->has_value()) {
+                break;
+            }
+        }
+        streamed->rewind();
+        mapped->rewind();
+    }
+    EXPECT_EQ(rewinds, 2U);
+
+    const std::string truncated = R"({"results":[{"po_id":"x"})";
+    auto failed = sappp::report::ResultsReader::open(make_stream(truncated, rewinds));
+    ASSERT_FALSE(failed.has_value());
+    EXPECT_EQ(failed.error().code, "ParseError");
+}
+
+TEST(ReportDiff, WritesCanonicalJsonWithSplicedArray)
+{
+    const nlohmann::json header = {
+        {"a", 1},
+        {"z", {{"y", true}, {"b", nullptr}}}
+    };
+    for (const auto& [key, expected] :
+         {std::pair{std::string("m"), std::string(R"({"a":1,"m":[1,2],"z":{"b":null,"y":true}})")},
+          std::pair{std::string("zz"),
+                    std::string(R"({"a":1,"z":{"b":null,"y":true},"zz":[1,2]})")}}) {
+        std::string out;
+        auto written = sappp::report::write_canonical_with_array(
+            header,
+            key,
+            [&out](std::string_view chunk) { out += chunk; },
+            [&out]() -> sappp::VoidResult {
+                out += "1,2";
+                return {};
+            });
+        ASSERT_TRUE(written.has_value()) << written.error().message;
+        EXPECT_EQ(out, expected);
+    }
+}
+
+TEST(ReportDiff, ScansResultsAndWritesDiffJson)
+{
+    const std::filesystem::path schema_dir(SAPPP_SCHEMA_DIR);
+    auto results_schema = sappp::common::SchemaValidator::load(
+        (schema_dir / "validated_results.v1.schema.json").string());
+    ASSERT_TRUE(results_schema.has_value()) << results_schema.error().message;
+    auto diff_schema =
+        sappp::common::SchemaValidator::load((schema_dir / "diff.v1.schema.json").string());
+    ASSERT_TRUE(diff_schema.has_value()) << diff_schema.error().message;
+
+    auto sha = [](char c) { return "sha256:" + std::string(64, c); };
+    const nlohmann::json tool = {
+        {   "name", "sappp"},
+        {"version", "0.1.0"}
+    };
+    const nlohmann::json results = {
+        {      "schema_version", "validated_results.v1"},
+        {                "tool",                   tool},
+        {        "generated_at", "2024-01-01T00:00:00Z"},
+        {               "tu_id",               sha('0')},
+        {   "semantics_version",               "sem.v1"},
+        {"proof_system_version",             "proof.v1"},
+        {     "profile_version",           "profile.v1"},
+        {"results",
+         nlohmann::json::array({{{"po_id", sha('2')},
+                                 {"category", "BUG"},
+                                 {"certificate_root", sha('c')},
+                                 {"validator_status", "Validated"}},
+                                {{"po_id", sha('1')},
+                                 {"category", "UNKNOWN"},
+                                 {"validator_status", "Validated"}}})}
+    };
+    const std::string bytes = results.dump(2);
+    auto reader = sappp::report::ResultsReader::open(bytes);
+    ASSERT_TRUE(reader.has_value());
+    auto scan = sappp::report::scan_diff_results(
+        *reader, *results_schema, "validated_results.v1.schema.json");
+    ASSERT_TRUE(scan.has_value()) << scan.error().message;
+    EXPECT_EQ(scan->digest, sappp::canonical::hash_canonical(results).value());
+    EXPECT_FALSE(scan->sorted);
+
+    const nlohmann::json side = {
+        {        "input_digest",   sha('a')},
+        {   "semantics_version",   "sem.v1"},
+        {"proof_system_version", "proof.v1"},
+        {     "profile_version", "profile.v1"},
+        {      "results_digest",   sha('b')}
+    };
+    const nlohmann::json header = {
+        {"schema_version",              "diff.v1"},
+        {          "tool",                   tool},
+        {  "generated_at", "2024-01-01T00:00:00Z"},
+        {        "before",                   side},
+        {         "after",                   side}
+    };
+    const nlohmann::json changes = nlohmann::json::array({
+        {{"po_id", sha('1')},
+         {"from", {{"category", "UNKNOWN"}}},
+         {"to", {{"category", "SAFE"}}},
+         {"change_kind", "Resolved"}},
+        {{"po_id", sha('2')},
+         {"from", {{"category", "UNKNOWN"}}},
+         {"to", {{"category", "BUG"}}},
+         {"change_kind", "New"}}
+    });
+    const auto path = std::filesystem::temp_directory_path() / "sappp_report_diff_test.json";
+    auto written = sappp::report::write_diff_json(
+        path,
+        header,
+        *diff_schema,
+        [&changes](const sappp::report::ChangeSink& sink) -> sappp::VoidResult {
+            for (const auto& change : changes) {
+                if (auto sunk = sink(change); !sunk) {
+                    return sunk;
+                }
+            }
+            return {};
+        });
+    ASSERT_TRUE(written.has_value()) << written.error().message;
+    nlohmann::json document = header;
+    document["changes"] = changes;
+    std::ifstream in(path, std::ios::binary);
+    const std::string text{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    EXPECT_EQ(text, sappp::canonical::canonicalize(document).value() + "\n");
+
+    // A failing change source leaves no partial file behind.
+    written = sappp::report::write_diff_json(
+        path,
+        header,
+        *diff_schema,
+        [](const sappp::report::ChangeSink&) -> sappp::VoidResult {
+            return std::unexpected(sappp::Error::make("Failed", "source"));
+        });
+    ASSERT_FALSE(written.has_value());
+    EXPECT_EQ(written.error().code, "Failed");
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
 TEST(ReportExplain, FiltersUnknowns)
 {
     nlohmann::json unknown_ledger = {
@@ -75,4 +361,194 @@ TEST(ReportExplain, FiltersUnknowns)
     EXPECT_EQ(filtered->at(0).at("po_id"), "sha256:po1");
 }
 
+TEST(ReportExplain, UnknownIndexFindsEntriesByKey)
+{
+    auto make_entry = [](const std::string& unknown_id, const std::string& po_id) {
+        return nlohmann::json{
+            {"unknown_stable_id", unknown_id},
+            {            "po_id",      po_id},
+            {     "unknown_code",   "Budget"}
+        };
+    };
+    const nlohmann::json ledger = {
+        {"schema_version", "unknown.v1"},
+        {"unknowns",
+         nlohmann::json::array({make_entry("sha256:u3", "sha256:p2"),
+                                make_entry("sha256:u1", "sha256:p1"),
+                                make_entry("sha256:u2", "sha256:p2")})}
+    };
+    const std::string bytes = ledger.dump() + "\n";
+    auto index = sappp::report::build_unknown_index(bytes);
+    ASSERT_TRUE(index.has_value()) << index.error().message;
+
+    const auto dir = std::filesystem::temp_directory_path() / "sappp_unknown_index_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const auto ledger_path = dir / "unknown_ledger.json";
+    std::ofstream(ledger_path, std::ios::binary) << bytes;
+    EXPECT_EQ(sappp::report::unknown_index_path(ledger_path), dir / "unknown_ledger.idx");
+    std::ofstream(sappp::report::unknown_index_path(ledger_path), std::ios::binary) << *index;
+
+    auto opened = sappp::report::UnknownIndex::open(ledger_path);
+    ASSERT_TRUE(opened.has_value()) << opened.error().message;
+    auto by_po = opened->find_by_po_id("sha256:p2");
+    ASSERT_TRUE(by_po.has_value()) << by_po.error().message;
+    EXPECT_EQ(by_po->at("schema_version"), "unknown.v1");
+    ASSERT_EQ(by_po->at("unknowns").size(), 2U);
+    // Entries sharing a key keep their ledger order.
+    EXPECT_EQ(by_po->at("unknowns").at(0), make_entry("sha256:u3", "sha256:p2"));
+    EXPECT_EQ(by_po->at("unknowns").at(1), make_entry("sha256:u2", "sha256:p2"));
+
+    auto by_id = opened->find_by_unknown_id("sha256:u1");
+    ASSERT_TRUE(by_id.has_value());
+    ASSERT_EQ(by_id->at("unknowns").size(), 1U);
+    EXPECT_EQ(by_id->at("unknowns").at(0).at("po_id"), "sha256:p1");
+    EXPECT_TRUE(opened->find_by_po_id("sha256:p0")->at("unknowns").empty());
+    EXPECT_TRUE(opened->find_by_unknown_id("sha256:u9")->at("unknowns").empty());
+
+    std::ofstream(ledger_path, std::ios::binary | std::ios::app) << " ";
+    std::filesystem::last_write_time(sappp::report::unknown_index_path(ledger_path),
+                                     std::filesystem::last_write_time(ledger_path));
+    auto stale = sappp::report::UnknownIndex::open(ledger_path);
+    ASSERT_FALSE(stale.has_value());
+    EXPECT_EQ(stale.error().code, "StaleIndex");
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ReportSarif, JoinsResultsAndInternsTables)
+{
+    auto make_po = [](const std::string& po_id, const std::string& kind, const std::string& inst) {
+        return nlohmann::json{
+            {    "po_id",                                           po_id},
+            {  "po_kind",                                            kind},
+            { "function",                              {{"usr", "c:@F@f"}}},
+            {   "anchor",          {{"block_id", "B1"}, {"inst_id", inst}}},
+            {"predicate",                          {{"pretty", "b != 0"}}},
+            {"repo_identity", {{"path", "src/f.cpp"}, {"content_sha256", "x"}}}
+        };
+    };
+    auto make_site = [](const std::string& inst, const std::string& file, int line) {
+        return nlohmann::json{
+            {       "ir_ref", {{"function_uid", "c:@F@f"}, {"block_id", "B1"}, {"inst_id", inst}}},
+            {"expansion_loc",                {{"file", file}, {"line", line}, {"col", 7}}}
+        };
+    };
+    const nlohmann::json po_list = {
+        {"pos",
+         nlohmann::json::array({make_po("sha256:p1", "UB.DivZero", "I1"),
+                                make_po("sha256:p2", "UB.DivZero", "I2"),
+                                make_po("sha256:p3", "UB.NullDeref", "I3")})}
+    };
+    const nlohmann::json source_map = {
+        {"entries",
+         nlohmann::json::array({make_site("I1", "src/f.cpp", 3),
+                                make_site("I2", "src/f.cpp", 4),
+                                make_site("I3", "/abs/g h.cpp", 5)})}
+    };
+    const nlohmann::json ledger = {
+        {"unknowns",
+         nlohmann::json::array({{{"unknown_stable_id", "sha256:u3"},
+                                 {"po_id", "sha256:p3"},
+                                 {"unknown_code", "MissingContract.Pre"},
+                                 {"missing_lemma", {{"pretty", "p != nullptr"}}},
+                                 {"refinement_plan", {{"message", "Add a contract."}}}}})}
+    };
+    const nlohmann::json results = {
+        {"results",
+         nlohmann::json::array({{{"po_id", "sha256:p1"}, {"category", "BUG"}},
+                                {{"po_id", "sha256:p2"}, {"category", "SAFE"}},
+                                {{"po_id", "sha256:p3"}, {"category", "UNKNOWN"}}})}
+    };
+    const std::string po_bytes = po_list.dump();
+    const std::string map_bytes = source_map.dump();
+    const std::string ledger_bytes = ledger.dump();
+    const std::string result_bytes = results.dump();
+
+    std::ostringstream out;
+    auto written = sappp::report::write_sarif({.validated_results = result_bytes,
+                                               .unknown_ledger = ledger_bytes,
+                                               .po_list = po_bytes,
+                                               .source_map = map_bytes,
+                                               .tool = {{"name", "sappp"}, {"version", "0.1.0"}}},
+                                              out);
+    ASSERT_TRUE(written.has_value()) << written.error().message;
+    EXPECT_EQ(*written, 2U);
+
+    const auto sarif = nlohmann::json::parse(out.str());
+    auto valid = sappp::common::validate_json(sarif, SAPPP_SARIF_SCHEMA);
+    EXPECT_TRUE(valid.has_value()) << valid.error().message;
+    EXPECT_EQ(sarif.at("version"), "2.1.0");
+    const auto& run = sarif.at("runs").at(0);
+    // SAFE results are omitted, so UB.DivZero is interned once and src/f.cpp once.
+    ASSERT_EQ(run.at("results").size(), 2U);
+    ASSERT_EQ(run.at("tool").at("driver").at("rules").size(), 2U);
+    EXPECT_EQ(run.at("tool").at("driver").at("rules").at(1).at("id"), "UB.NullDeref");
+    ASSERT_EQ(run.at("artifacts").size(), 2U);
+    EXPECT_EQ(run.at("artifacts").at(1).at("location").at("uri"), "file:///abs/g%20h.cpp");
+
+    const auto& bug = run.at("results").at(0);
+    EXPECT_EQ(bug.at("level"), "error");
+    EXPECT_EQ(bug.at("message").at("text"), "BUG: b != 0");
+    const auto& location = bug.at("locations").at(0).at("physicalLocation");
+    EXPECT_EQ(location.at("artifactLocation").at("index"), 0);
+    EXPECT_EQ(location.at("region").at("startLine"), 3);
+
+    const auto& unknown = run.at("results").at(1);
+    EXPECT_EQ(unknown.at("level"), "warning");
+    EXPECT_EQ(unknown.at("ruleIndex"), 1);
+    EXPECT_EQ(unknown.at("message").at("text"),
+              "UNKNOWN (MissingContract.Pre): missing p != nullptr. Add a contract.");
+    EXPECT_EQ(unknown.at("properties").at("unknown_stable_id"), "sha256:u3");
+
+    // Without validated results the ledger alone is reported.
+    std::ostringstream ledger_only;
+    written = sappp::report::write_sarif({.validated_results = {},
+                                          .unknown_ledger = ledger_bytes,
+                                          .po_list = po_bytes,
+                                          .source_map = {},
+                                          .tool = {{"name", "sappp"}}},
+                                         ledger_only);
+    ASSERT_TRUE(written.has_value()) << written.error().message;
+    EXPECT_EQ(*written, 1U);
+    const auto fallback_log = nlohmann::json::parse(ledger_only.str());
+    valid = sappp::common::validate_json(fallback_log, SAPPP_SARIF_SCHEMA);
+    EXPECT_TRUE(valid.has_value()) << valid.error().message;
+    const auto& fallback = fallback_log.at("runs").at(0);
+    EXPECT_EQ(fallback.at("results").at(0).at("locations").at(0).at("physicalLocation").at(
+                  "artifactLocation").at("uri"),
+              "src/f.cpp");
+
+    // A ledger index supplied by the caller is used instead of building one.
+    auto index_bytes = sappp::report::build_unknown_index(ledger_bytes);
+    ASSERT_TRUE(index_bytes.has_value()) << index_bytes.error().message;
+    auto index = sappp::report::UnknownIndexView::open(ledger_bytes, *index_bytes);
+    ASSERT_TRUE(index.has_value()) << index.error().message;
+    std::ostringstream indexed;
+    written = sappp::report::write_sarif({.validated_results = result_bytes,
+                                          .unknown_ledger = ledger_bytes,
+                                          .po_list = po_bytes,
+                                          .source_map = map_bytes,
+                                          .tool = {{"name", "sappp"}, {"version", "0.1.0"}},
+                                          .unknown_index = *index},
+                                         indexed);
+    ASSERT_TRUE(written.has_value()) << written.error().message;
+    EXPECT_EQ(indexed.str(), out.str());
+
+    // Locations are binary-searched, so an unsorted source map is rejected.
+    const nlohmann::json unsorted_map = {
+        {"entries",
+         nlohmann::json::array({make_site("I2", "src/f.cpp", 4),
+                                make_site("I1", "src/f.cpp", 3)})}
+    };
+    std::ostringstream rejected;
+    written = sappp::report::write_sarif({.validated_results = result_bytes,
+                                          .unknown_ledger = ledger_bytes,
+                                          .po_list = po_bytes,
+                                          .source_map = unsorted_map.dump(),
+                                          .tool = {{"name", "sappp"}}},
+                                         rejected);
+    ASSERT_FALSE(written.has_value());
+    EXPECT_EQ(written.error().code, "UnsortedResults");
+}
+
 }  // namespace
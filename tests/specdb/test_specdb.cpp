@@ -1,8 +1,10 @@
 #include "sappp/specdb.hpp"
 
+#include <cstddef>
 #include <filesystem>
 #include <fstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -43,6 +45,36 @@ void write_text_file(const std::filesystem::path& path, const std::string& conte
     out << content;
 }
 
+nlohmann::json make_build_snapshot(const std::filesystem::path& cwd,
+                                   const std::vector<std::filesystem::path>& sources)
+{
+    nlohmann::json units = nlohmann::json::array();
+    for (const auto& source : sources) {
+        units.push_back({
+            { "cwd",                                                cwd.string()},
+            {"argv", nlohmann::json::array({"clang++", "-c", source.string()})}
+        });
+    }
+    return nlohmann::json{
+        {"schema_version",                       "build_snapshot.v1"},
+        {          "tool", {{"name", "sappp"}, {"version", "0.1.0"}}},
+        {  "generated_at",                    "1970-01-01T00:00:00Z"},
+        { "compile_units",                                      units}
+    };
+}
+
+sappp::specdb::BuildOptions make_build_options(nlohmann::json build_snapshot, std::size_t jobs)
+{
+    return sappp::specdb::BuildOptions{
+        .build_snapshot = std::move(build_snapshot),
+        .spec_path = std::filesystem::path{},
+        .schema_dir = std::filesystem::path(SAPPP_SCHEMA_DIR),
+        .generated_at = "1970-01-01T00:00:00Z",
+        .tool = nlohmann::json{{"name", "sappp"}, {"version", "0.1.0"}},
+        .jobs = jobs
+    };
+}
+
 }  // namespace
 
 TEST(SpecdbTest, NormalizeContractAssignsIdAndSortsConditions)
@@ -106,4 +138,188 @@ TEST(SpecdbTest, BuildSnapshotCollectsSidecarAndAnnotation)
     EXPECT_EQ(contracts.at(1).at("target").at("usr"), "usr::sidecar");
 }
 
+
+TEST(SpecdbTest, ParallelAnnotationScanMatchesSerial)
+{
+    auto temp_dir = ensure_temp_dir("sappp_specdb_parallel_scan");
+    std::vector<std::filesystem::path> sources;
+    for (int i = 0; i < 40; ++i) {
+        const std::string id = std::to_string(i);
+        const auto first = make_contract("usr::first" + id, "x86_64", {}, 0).dump();
+        const auto second = make_contract("usr::second" + id, "arm64", {"C" + id}, i).dump();
+        // Mixed line endings, a non-contract annotation hiding a second prefix on the same
+        // line (ignored) and a final annotation without a trailing newline.
+        std::string content = "int f" + id + "(); // user@example.com\r\n";
+        content += "  //@sappp contract " + first + "\r\n";
+        content += "//@sappp note //@sappp contract {}\n\n";
+        content += "/* @sappp */ int g" + id + "(); //@sappp   contract   " + second;
+        sources.push_back(temp_dir / ("src" + id + ".cpp"));
+        write_text_file(sources.back(), content);
+    }
+    auto build_snapshot = make_build_snapshot(temp_dir, sources);
+
+    auto serial = sappp::specdb::build_snapshot(make_build_options(build_snapshot, 1));
+    auto parallel = sappp::specdb::build_snapshot(make_build_options(build_snapshot, 8));
+    ASSERT_TRUE(serial) << serial.error().message;
+    ASSERT_TRUE(parallel) << parallel.error().message;
+    EXPECT_EQ(serial->at("contracts").size(), 80U);
+    EXPECT_EQ(*parallel, *serial);
+}
+
+TEST(SpecdbTest, AnnotationErrorReportsFirstSourceAndLine)
+{
+    auto temp_dir = ensure_temp_dir("sappp_specdb_annotation_error");
+    std::vector<std::filesystem::path> sources;
+    for (int i = 0; i < 20; ++i) {
+        sources.push_back(temp_dir / (std::string(1, static_cast<char>('a' + i)) + ".cpp"));
+        std::string content = "int x;\n";
+        if (i == 7 || i == 15) {
+            content += "\n\n//@sappp contract\n";
+        }
+        write_text_file(sources.back(), content);
+    }
+
+    auto result = sappp::specdb::build_snapshot(
+        make_build_options(make_build_snapshot(temp_dir, sources), 8));
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, "InvalidContract");
+    EXPECT_EQ(result.error().message,
+              "Empty contract annotation in " + (temp_dir / "h.cpp").string() + ":4");
+}
+
+
+TEST(SpecdbTest, CachedBuildMatchesUncachedAcrossEdits)
+{
+    auto temp_dir = ensure_temp_dir("sappp_specdb_cache");
+    auto spec_dir = temp_dir / "specdb";
+    auto cache_dir = temp_dir / "cache";
+    std::filesystem::create_directories(spec_dir);
+    write_text_file(spec_dir / "sidecar.json",
+                    make_contract("usr::sidecar", "x86_64", {"COND"}, 1).dump());
+    std::vector<std::filesystem::path> sources;
+    for (int i = 0; i < 4; ++i) {
+        const std::string id = std::to_string(i);
+        sources.push_back(temp_dir / ("src" + id + ".cpp"));
+        write_text_file(sources.back(),
+                        "//@sappp contract "
+                            + make_contract("usr::annotation" + id, "arm64", {}, 0).dump() + "\n");
+    }
+    auto build_snapshot = make_build_snapshot(temp_dir, sources);
+
+    const auto build = [&](bool cached) {
+        auto options = make_build_options(build_snapshot, 2);
+        options.spec_path = spec_dir;
+        if (cached) {
+            options.cache_dir = cache_dir;
+        }
+        return sappp::specdb::build_snapshot(options);
+    };
+
+    auto first = build(true);
+    ASSERT_TRUE(first) << first.error().message;
+    EXPECT_TRUE(std::filesystem::exists(cache_dir / "contracts.json"));
+    auto uncached = build(false);
+    ASSERT_TRUE(uncached) << uncached.error().message;
+    EXPECT_EQ(*first, *uncached);
+
+    auto rerun = build(true);
+    ASSERT_TRUE(rerun) << rerun.error().message;
+    EXPECT_EQ(*rerun, *uncached);
+
+    write_text_file(sources[2],
+                    "//@sappp contract "
+                        + make_contract("usr::edited", "arm64", {"EDITED"}, 3).dump() + "\n");
+    write_text_file(spec_dir / "sidecar.json",
+                    make_contract("usr::sidecar", "x86_64", {"OTHER"}, 2).dump());
+    auto edited = build(true);
+    ASSERT_TRUE(edited) << edited.error().message;
+    auto edited_uncached = build(false);
+    ASSERT_TRUE(edited_uncached) << edited_uncached.error().message;
+    EXPECT_EQ(*edited, *edited_uncached);
+    EXPECT_NE(edited->at("specdb_digest"), first->at("specdb_digest"));
+}
+
+TEST(SpecdbTest, CacheEntriesAreReusedForUnchangedInputs)
+{
+    auto temp_dir = ensure_temp_dir("sappp_specdb_cache_reuse");
+    auto cache_dir = temp_dir / "cache";
+    auto source = temp_dir / "sample.cpp";
+    write_text_file(source,
+                    "//@sappp contract " + make_contract("usr::original", "arm64", {}, 0).dump()
+                        + "\n");
+    auto options = make_build_options(make_build_snapshot(temp_dir, {source}), 1);
+    options.cache_dir = cache_dir;
+    ASSERT_TRUE(sappp::specdb::build_snapshot(options));
+
+    // Rewrite the cached contracts: an unchanged source must be served from the cache.
+    nlohmann::json cache;
+    {
+        std::ifstream in(cache_dir / "contracts.json");
+        cache = nlohmann::json::parse(in);
+    }
+    auto& entry = cache.at("files").at("annotation:" + source.generic_string());
+    entry.at("contracts")[0]["target"]["usr"] = "usr::from_cache";
+    cache.erase("snapshot");
+    write_text_file(cache_dir / "contracts.json", cache.dump());
+
+    auto snapshot = sappp::specdb::build_snapshot(options);
+    ASSERT_TRUE(snapshot) << snapshot.error().message;
+    EXPECT_EQ(snapshot->at("contracts").at(0).at("target").at("usr"), "usr::from_cache");
+}
+
+TEST(SpecdbTest, InvalidCacheEntriesAreReloaded)
+{
+    auto temp_dir = ensure_temp_dir("sappp_specdb_cache_invalid");
+    auto cache_dir = temp_dir / "cache";
+    auto source = temp_dir / "sample.cpp";
+    write_text_file(source,
+                    "//@sappp contract " + make_contract("usr::original", "arm64", {}, 0).dump()
+                        + "\n");
+    auto options = make_build_options(make_build_snapshot(temp_dir, {source}), 1);
+    options.cache_dir = cache_dir;
+    auto first = sappp::specdb::build_snapshot(options);
+    ASSERT_TRUE(first) << first.error().message;
+
+    // A cached contract that no longer normalizes is ignored, not merged.
+    nlohmann::json cache;
+    {
+        std::ifstream in(cache_dir / "contracts.json");
+        cache = nlohmann::json::parse(in);
+    }
+    auto& entry = cache.at("files").at("annotation:" + source.generic_string());
+    entry.at("contracts")[0]["version_scope"]["priority"] = "high";
+    write_text_file(cache_dir / "contracts.json", cache.dump());
+
+    auto snapshot = sappp::specdb::build_snapshot(options);
+    ASSERT_TRUE(snapshot) << snapshot.error().message;
+    EXPECT_EQ(*snapshot, *first);
+}
+
+TEST(SpecdbTest, CacheWriteCanBeHeldBack)
+{
+    auto temp_dir = ensure_temp_dir("sappp_specdb_cache_held_back");
+    auto cache_dir = temp_dir / "cache";
+    auto source = temp_dir / "sample.cpp";
+    write_text_file(source,
+                    "//@sappp contract " + make_contract("usr::original", "arm64", {}, 0).dump()
+                        + "\n");
+    auto options = make_build_options(make_build_snapshot(temp_dir, {source}), 1);
+    options.cache_dir = cache_dir;
+    int asked = 0;
+    options.may_save_cache = [&asked]() noexcept {
+        ++asked;
+        return false;
+    };
+    auto held = sappp::specdb::build_snapshot(options);
+    ASSERT_TRUE(held) << held.error().message;
+    EXPECT_EQ(asked, 1);
+    EXPECT_FALSE(std::filesystem::exists(cache_dir));
+
+    options.may_save_cache = []() noexcept { return true; };
+    auto saved = sappp::specdb::build_snapshot(options);
+    ASSERT_TRUE(saved) << saved.error().message;
+    EXPECT_EQ(*saved, *held);
+    EXPECT_TRUE(std::filesystem::exists(cache_dir / "contracts.json"));
+}
+
 }  // namespace sappp::specdb::test
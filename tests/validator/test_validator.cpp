@@ -1,6 +1,7 @@
 #include "sappp/canonical_json.hpp"
 #include "sappp/certstore.hpp"
 #include "sappp/common.hpp"
+#include "sappp/pack.hpp"
 #include "sappp/validator.hpp"
 #include "sappp/version.hpp"
 
@@ -1201,3 +1202,274 @@ TEST(ValidatorTest, DowngradesOnBlockLevelInvariantForInstructionPO)
     EXPECT_EQ(entry.at("validator_status"), "ProofCheckFailed");
     EXPECT_EQ(entry.at("downgrade_reason_code"), "ProofCheckFailed");
 }
+
+TEST(ValidatorTest, SharedCertsYieldConsistentVerdictsAcrossRoots)
+{
+    TempDir temp_dir("sappp_validator_shared_certs");
+    std::string schema_dir = SAPPP_SCHEMA_DIR;
+
+    fs::path certstore_dir = temp_dir.path() / "certstore";
+    sappp::certstore::CertStore store(certstore_dir.string(), schema_dir);
+
+    std::string tu_id = sappp::common::sha256_prefixed("tu-shared");
+    nlohmann::json predicate_expr = {
+        {"op", "neq"}
+    };
+    nlohmann::json state = {
+        {"predicates", nlohmann::json::array({predicate_expr})}
+    };
+
+    // IrRef, SafetyProof and ContractRef objects are shared by every root.
+    std::string ir_hash = put_cert_or_fail(store, make_ir_cert(tu_id), "ir_cert");
+    std::string safety_hash = put_cert_or_fail(store, make_safety_proof(state), "safety_proof");
+    auto make_contract = [](std::string_view tier) {
+        return nlohmann::json{
+            {"schema_version",                   "cert.v1"},
+            {          "kind",               "ContractRef"},
+            {   "contract_id", "contract-" + std::string(tier)},
+            {          "tier",           std::string(tier)},
+            {        "target",   {{"usr", "c:@F@callee"}}}
+        };
+    };
+    std::string tier1_hash = put_cert_or_fail(store, make_contract("Tier1"), "contract_tier1");
+    std::string tier2_hash = put_cert_or_fail(store, make_contract("Tier2"), "contract_tier2");
+
+    struct RootSpec
+    {
+        std::string label;
+        std::string contract_hash;
+    };
+    const std::vector<RootSpec> specs = {
+        {.label = "po-shared-a", .contract_hash = tier2_hash},
+        {.label = "po-shared-b", .contract_hash = tier2_hash},
+        {.label = "po-shared-c", .contract_hash = tier1_hash},
+    };
+    std::vector<std::string> po_ids;
+    for (const auto& spec : specs) {
+        std::string po_id = sappp::common::sha256_prefixed(spec.label);
+        std::string po_hash = put_cert_or_fail(store, make_po_cert(po_id, predicate_expr), spec.label);
+        nlohmann::json proof_root = make_proof_root(po_hash, ir_hash, safety_hash, "SAFE");
+        proof_root["depends"]["contracts"] = nlohmann::json::array({
+            {{"ref", spec.contract_hash}}
+        });
+        std::string root_hash = put_cert_or_fail(store, proof_root, "proof_root");
+        bind_po_or_fail(store, po_id, root_hash);
+        po_ids.push_back(po_id);
+    }
+
+    sappp::validator::Validator validator(temp_dir.path().string(), schema_dir);
+    auto results = validator.validate(false);
+    ASSERT_TRUE(results);
+    ASSERT_EQ(results->at("results").size(), specs.size());
+
+    for (const auto& entry : results->at("results")) {
+        const auto po_id = entry.at("po_id").get<std::string>();
+        if (po_id == po_ids.at(2)) {
+            EXPECT_EQ(entry.at("category"), "SAFE");
+            EXPECT_EQ(entry.at("validator_status"), "Validated");
+            continue;
+        }
+        EXPECT_EQ(entry.at("category"), "UNKNOWN");
+        EXPECT_EQ(entry.at("validator_status"), "ProofCheckFailed");
+        EXPECT_EQ(entry.at("notes"), "Contract tier not allowed for SAFE: Tier2");
+    }
+}
+
+TEST(ValidatorTest, ReusesCachedResultUntilDependencyChanges)
+{
+    TempDir temp_dir("sappp_validator_result_cache");
+    std::string schema_dir = SAPPP_SCHEMA_DIR;
+    const fs::path input_dir = temp_dir.path() / "out";
+    const fs::path cache_dir = temp_dir.path() / "cache";
+
+    CertBundle bundle = build_cert_store(input_dir, schema_dir);
+    auto nir_result = write_nir_file(input_dir,
+                                     bundle.tu_id,
+                                     kTestFunctionUid,
+                                     {
+                                         NirInstSpec{.id = "I1", .op = "ub.check"}
+    });
+    ASSERT_TRUE(nir_result);
+
+    sappp::validator::Validator validator(input_dir.string(), schema_dir);
+    auto uncached = validator.validate(false);
+    ASSERT_TRUE(uncached);
+    EXPECT_FALSE(fs::exists(cache_dir));
+
+    validator.set_result_cache_dir(cache_dir.string());
+    auto first = validator.validate(false);
+    ASSERT_TRUE(first);
+    EXPECT_EQ(*first, *uncached);
+    EXPECT_EQ(first->at("results").at(0).at("validator_status"), "Validated");
+    EXPECT_FALSE(fs::exists(input_dir / "cache"));
+
+    std::vector<fs::path> entries;
+    for (const auto& entry : fs::recursive_directory_iterator(cache_dir)) {
+        if (entry.is_regular_file()) {
+            entries.push_back(entry.path());
+        }
+    }
+    ASSERT_EQ(entries.size(), 1U);
+
+    std::ifstream entry_stream(entries.front());
+    const nlohmann::json cache_entry = nlohmann::json::parse(entry_stream);
+    entry_stream.close();
+
+    // Mark the cached result so that a hit is observable.
+    nlohmann::json marked = cache_entry;
+    marked.at("result")["notes"] = "from-cache";
+    ASSERT_TRUE(write_json_file(entries.front().string(), marked));
+    auto cached = validator.validate(false);
+    ASSERT_TRUE(cached);
+    EXPECT_EQ(cached->at("results").at(0).value("notes", ""), "from-cache");
+
+    // A stored verdict that names another root is rechecked, not trusted.
+    nlohmann::json forged = cache_entry;
+    forged.at("result")["certificate_root"] = bundle.bug_trace_hash;
+    ASSERT_TRUE(write_json_file(entries.front().string(), forged));
+    auto rechecked = validator.validate(false);
+    ASSERT_TRUE(rechecked);
+    EXPECT_EQ(*rechecked, *first);
+
+    auto strict = validator.validate(true);
+    ASSERT_TRUE(strict);
+    EXPECT_FALSE(strict->at("results").at(0).contains("notes"));
+
+    std::string bug_path = object_path_for_hash(input_dir, bundle.bug_trace_hash);
+    std::ifstream bug_stream(bug_path);
+    nlohmann::json bug_trace = nlohmann::json::parse(bug_stream);
+    bug_stream.close();
+    bug_trace.at("steps").at(0).at("ir")["block_id"] = "B2";
+    ASSERT_TRUE(write_json_file(bug_path, bug_trace));
+
+    auto invalidated = validator.validate(false);
+    ASSERT_TRUE(invalidated);
+    const nlohmann::json& entry = invalidated->at("results").at(0);
+    EXPECT_EQ(entry.at("category"), "UNKNOWN");
+    EXPECT_EQ(entry.at("validator_status"), "HashMismatch");
+}
+
+TEST(ValidatorTest, RejectsResultCacheInsideInput)
+{
+    TempDir temp_dir("sappp_validator_result_cache_inside");
+    std::string schema_dir = SAPPP_SCHEMA_DIR;
+
+    CertBundle bundle = build_cert_store(temp_dir.path(), schema_dir);
+    auto nir_result = write_nir_file(temp_dir.path(),
+                                     bundle.tu_id,
+                                     kTestFunctionUid,
+                                     {
+                                         NirInstSpec{.id = "I1", .op = "ub.check"}
+    });
+    ASSERT_TRUE(nir_result);
+
+    sappp::validator::Validator validator(temp_dir.path().string(), schema_dir);
+    validator.set_result_cache_dir((temp_dir.path() / "cache" / "validation").string());
+    auto result = validator.validate(false);
+    ASSERT_FALSE(result);
+    EXPECT_EQ(result.error().code, "InvalidArgument");
+    EXPECT_FALSE(fs::exists(temp_dir.path() / "cache"));
+}
+
+TEST(ValidatorTest, ValidatesPackArchiveInPlace)
+{
+    TempDir temp_dir("sappp_validator_pack");
+    std::string schema_dir = SAPPP_SCHEMA_DIR;
+
+    const fs::path output_dir = temp_dir.path() / "out";
+    CertBundle bundle = build_cert_store(output_dir, schema_dir);
+    auto nir_result = write_nir_file(output_dir,
+                                     bundle.tu_id,
+                                     kTestFunctionUid,
+                                     {
+                                         NirInstSpec{.id = "I1", .op = "ub.check"}
+    });
+    ASSERT_TRUE(nir_result);
+
+    std::vector<sappp::pack::PackEntry> entries;
+    for (const auto& entry : fs::recursive_directory_iterator(output_dir)) {
+        if (entry.is_regular_file()) {
+            entries.push_back(sappp::pack::PackEntry{
+                .name = "pack/" + fs::relative(entry.path(), output_dir).generic_string(),
+                .source = entry.path(),
+                .contents = std::nullopt});
+        }
+    }
+    const fs::path archive = temp_dir.path() / "pack.tar.gz";
+    ASSERT_TRUE(sappp::pack::write_pack(archive, std::move(entries)));
+
+    sappp::validator::Validator pack_validator(archive.string(), schema_dir);
+    auto from_pack = pack_validator.validate(false);
+    ASSERT_TRUE(from_pack) << from_pack.error().message;
+    EXPECT_EQ(from_pack->at("results").at(0).at("validator_status"), "Validated");
+    EXPECT_FALSE(fs::exists(temp_dir.path() / "cache"));
+
+    sappp::validator::Validator dir_validator(output_dir.string(), schema_dir);
+    auto from_dir = dir_validator.validate(false);
+    ASSERT_TRUE(from_dir);
+    EXPECT_EQ(*from_pack, *from_dir);
+}
+
+TEST(ValidatorTest, DowngradesOnBugTraceEdgeKindMismatch)
+{
+    TempDir temp_dir("sappp_validator_bug_edge_kind_mismatch");
+    std::string schema_dir = SAPPP_SCHEMA_DIR;
+
+    fs::path certstore_dir = temp_dir.path() / "certstore";
+    sappp::certstore::CertStore store(certstore_dir.string(), schema_dir);
+
+    std::string po_id = sappp::common::sha256_prefixed("po-bug-edge-kind");
+    std::string tu_id = sappp::common::sha256_prefixed("tu-bug-edge-kind");
+
+    nlohmann::json predicate_expr = {
+        {"op", "neq"}
+    };
+    nlohmann::json po_cert = make_po_cert(po_id, predicate_expr, "I2");
+    nlohmann::json ir_cert = make_ir_cert(tu_id, "I2");
+
+    // B0 reaches B1 only through an exception edge; the normal edge goes to B2.
+    std::vector<nlohmann::json> steps = {
+        make_trace_step(tu_id, kTestFunctionUid, "B0", "I1"),
+        make_trace_step(tu_id, kTestFunctionUid, "B1", "I2", "normal"),
+    };
+    nlohmann::json bug_trace = make_bug_trace(po_id, tu_id, steps);
+
+    std::string po_hash = put_cert_or_fail(store, po_cert, "po_cert");
+    std::string ir_hash = put_cert_or_fail(store, ir_cert, "ir_cert");
+    std::string bug_hash = put_cert_or_fail(store, bug_trace, "bug_trace");
+
+    nlohmann::json proof_root = make_proof_root(po_hash, ir_hash, bug_hash, "BUG");
+    std::string root_hash = put_cert_or_fail(store, proof_root, "proof_root");
+
+    bind_po_or_fail(store, po_id, root_hash);
+
+    nlohmann::json function_json = {
+        {"function_uid",              std::string(kTestFunctionUid)                        },
+        {"mangled_name",                                      std::string(kTestMangledName)},
+        {         "cfg",
+         {{"entry", "B0"},
+         {"blocks",
+         nlohmann::json::array({
+         {{"id", "B0"}, {"insts", nlohmann::json::array({{{"id", "I1"}, {"op", "invoke"}}})}},
+         {{"id", "B1"},
+         {"insts", nlohmann::json::array({{{"id", "I2"}, {"op", "landingpad"}}})}},
+         {{"id", "B2"}, {"insts", nlohmann::json::array({{{"id", "I3"}, {"op", "ret"}}})}},
+         })},
+         {"edges",
+         nlohmann::json::array({{{"from", "B0"}, {"to", "B2"}, {"kind", "normal"}},
+         {{"from", "B0"}, {"to", "B1"}, {"kind", "exception"}}})}}  }
+    };
+    auto nir_result =
+        write_nir_file_custom(temp_dir.path(), tu_id, nlohmann::json::array({function_json}));
+    ASSERT_TRUE(nir_result);
+
+    sappp::validator::Validator validator(temp_dir.path().string(), schema_dir);
+    auto results = validator.validate(false);
+    ASSERT_TRUE(results);
+
+    ASSERT_EQ(results->at("results").size(), 1U);
+    const nlohmann::json& entry = results->at("results").at(0);
+    EXPECT_EQ(entry.at("category"), "UNKNOWN");
+    EXPECT_EQ(entry.at("validator_status"), "ProofCheckFailed");
+    EXPECT_EQ(entry.at("notes"), "BugTrace path is not connected in CFG");
+}
@@ -13,6 +13,7 @@
  *   pack      - Create reproducibility pack
  *   diff      - Compare analysis results
  *   explain   - Explain UNKNOWN entries
+ *   bench     - Measure this host with synthetic workloads
  *   version   - Show version information
  */
 
@@ -21,33 +22,55 @@
 #include "sappp/build_capture.hpp"
 #include "sappp/canonical_json.hpp"
 #include "sappp/common.hpp"
+#include "sappp/file_hash_cache.hpp"
+#include "sappp/mapped_file.hpp"
+#include "sappp/pack.hpp"
 #include "sappp/report.hpp"
+#include "sappp/run_stats.hpp"
 #include "sappp/schema_validate.hpp"
 #include "sappp/specdb.hpp"
+#include "sappp/trace.hpp"
 #include "sappp/validator.hpp"
 #include "sappp/version.hpp"
+#include "synthetic_nir.hpp"
 #if defined(SAPPP_HAS_CLANG_FRONTEND)
+    #include "frontend_clang/dependency_scanner.hpp"
     #include "frontend_clang/frontend.hpp"
 #endif
 #include "sappp/print.hpp"
 
+#include <algorithm>
+#include <array>
 #include <charconv>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <cstdlib>
+#include <deque>
 #include <exception>
 #include <filesystem>
 #include <format>
 #include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <ranges>
 #include <span>
 #include <string>
 #include <string_view>
 #include <system_error>
+#include <thread>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
 namespace {
 
 [[nodiscard]] [[maybe_unused]] std::string current_time_utc()
@@ -96,6 +119,7 @@ Commands:
   pack        Create reproducibility pack (tar.gz + manifest)
   diff        Compare before/after analysis results
   explain     Explain UNKNOWN entries in human-readable form
+  bench       Measure throughput and latency on this host
   version     Show version information
 
 Global Options:
@@ -104,6 +128,7 @@ Global Options:
   -v, --verbose           Verbose logging
   -q, --quiet             Quiet mode (errors only)
   --json-logs PATH        Write JSONL logs to file
+  --trace-out FILE        Write Chrome trace-event JSON for the run
   --jobs N, -j N           Number of parallel jobs (default: auto)
   --schema-dir DIR        Path to schema directory
   --semantics VERSION     Semantics version (default: sem.v1)
@@ -125,10 +150,17 @@ Options:
   --out FILE, -o            Output file (default: build_snapshot.json)
   --repo-root DIR           Repository root for relative paths
   --schema-dir DIR          Path to schema directory (default: ./schemas)
+  --jobs N, -j N            Parallel entry normalization (default: auto)
+  --base FILE               Previous build_snapshot.json; unchanged units are reused
+  --change-set FILE         Change set output with --base
+                            (default: build_change_set.json next to --out)
+  --scan-deps               Record each unit's header closure with digests
+                            (requires frontend_clang)
   --help, -h                Show this help
 
 Output:
   build_snapshot.json
+  build_change_set.json (with --base)
 )");
 }
 
@@ -143,6 +175,7 @@ Options:
   --spec PATH               Path to Spec DB snapshot or directory
   --out DIR, -o             Output directory (required)
   --jobs N, -j N            Number of parallel jobs
+  --pipeline                Overlap SpecDB, frontend, PO generation and output writes
   --schema-dir DIR          Path to schema directory (default: ./schemas)
   --analysis-config FILE    Analysis configuration file
   --emit-sarif FILE         SARIF output path
@@ -154,6 +187,7 @@ Output:
   <output>/frontend/source_map.json
   <output>/po/po_list.json
   <output>/analyzer/unknown_ledger.json
+  <output>/analyzer/unknown_ledger.idx
   <output>/certstore/
   <output>/config/analysis_config.json
   <output>/specdb/snapshot.json
@@ -167,10 +201,14 @@ void print_validate_help()
 Validate certificates and confirm SAFE/BUG results
 
 Options:
-  --input DIR, --in DIR     Input directory containing analysis outputs (required)
-  --out FILE, -o            Output file (default: <input>/results/validated_results.json)
+  --input PATH, --in PATH   Analysis output directory or pack.tar.gz (required)
+  --out FILE, -o            Output file (default: <input>/results/validated_results.json,
+                            or ./validated_results.json for a pack)
   --strict                  Fail on any validation error (no downgrade)
+  --cache-dir DIR           Reuse and update validation results in DIR
+                            (off by default; DIR must be outside the input)
   --schema-dir DIR          Path to schema directory (default: ./schemas)
+  --emit-sarif FILE         Also write BUG/UNKNOWN results as SARIF 2.1.0
   --help, -h                Show this help
 
 Output:
@@ -190,6 +228,7 @@ Options:
   --manifest FILE           Manifest output (default: manifest.json)
   --repro-level LEVEL       Repro asset level (L0/L1/L2/L3)
   --include-analyzer-candidates  Include analyzer cert candidates
+  --jobs N, -j N            Parallel hashing and compression (default: auto)
   --schema-dir DIR          Path to schema directory (default: ./schemas)
   --help, -h                Show this help
 
@@ -224,8 +263,8 @@ void print_explain_help()
 Explain UNKNOWN entries
 
 Options:
-  --unknown FILE           Path to unknown_ledger.json (required)
-  --validated FILE         Path to validated_results.json (optional)
+  --unknown FILE           Path to unknown_ledger.json or pack.tar.gz (required)
+  --validated FILE         Path to validated_results.json or pack.tar.gz (optional)
   --po PO_ID               Filter by PO ID
   --unknown-id UNKNOWN_ID  Filter by unknown stable ID
   --format FORMAT          Output format: text|json (default: text)
@@ -235,6 +274,32 @@ Options:
 )");
 }
 
+void print_bench_help()
+{
+    std::print(R"(Usage: sappp bench [options]
+
+Measure throughput and latency of embedded synthetic workloads on this host
+
+Options:
+  --dir DIR                 Directory for the certstore workloads (default: .)
+                            Objects are written under DIR/.sappp-bench, which
+                            is only cleared if empty or made by sappp bench
+  --iterations N            Operations per workload (default: 200)
+  --workload NAME           Run only NAME (repeatable, each runs once): canonical_hash,
+                            schema_validation, certstore_put, certstore_get,
+                            certstore_get_cold, fixpoint_lifetime,
+                            fixpoint_heap_lifetime, fixpoint_init,
+                            fixpoint_points_to
+  --keep                    Keep DIR/.sappp-bench after the run
+  --out FILE, -o            Write the report to FILE (default: stdout)
+  --schema-dir DIR          Path to schema directory (default: ./schemas)
+  --help, -h                Show this help
+
+Output:
+  bench.v1 JSON: ops/s and latency percentiles (ns) per workload
+)");
+}
+
 struct LoggingOptions
 {
     bool verbose = false;
@@ -248,6 +313,10 @@ struct CaptureOptions
     std::string repo_root;
     std::string output_path;
     std::string schema_dir;
+    int jobs;
+    std::string base;
+    std::string change_set_path;
+    bool scan_deps;
     sappp::VersionTriple versions;
     LoggingOptions logging;
     bool show_help;
@@ -263,6 +332,7 @@ struct AnalyzeOptions
     std::string analysis_config;
     std::string emit_sarif;
     std::string repro_level;
+    bool pipeline;
     sappp::VersionTriple versions;
     LoggingOptions logging;
     bool show_help;
@@ -272,8 +342,10 @@ struct ValidateOptions
 {
     std::string input;
     bool strict;
+    std::string cache_dir;
     std::string output;
     std::string schema_dir;
+    std::string emit_sarif;
     sappp::VersionTriple versions;
     LoggingOptions logging;
     bool show_help;
@@ -287,6 +359,7 @@ struct PackOptions
     std::string schema_dir;
     std::string repro_level;
     bool include_analyzer_candidates;
+    int jobs;
     bool show_help;
 };
 
@@ -311,6 +384,17 @@ struct ExplainOptions
     bool show_help;
 };
 
+struct BenchOptions
+{
+    std::string dir;
+    std::size_t iterations;
+    std::vector<std::string> workloads;
+    bool keep;
+    std::string output;
+    std::string schema_dir;
+    bool show_help;
+};
+
 struct AnalyzePaths
 {
     std::filesystem::path output_dir;
@@ -328,6 +412,7 @@ struct AnalyzePaths
     std::filesystem::path unknown_ledger_path;
     std::filesystem::path analysis_config_path;
     std::filesystem::path specdb_snapshot_path;
+    std::filesystem::path stats_path;
 };
 
 // NOLINTBEGIN(bugprone-easily-swappable-parameters) - CLI signature matches call sites.
@@ -448,6 +533,7 @@ enum class ExitCode { kOk = 0, kCliError = 1, kInputError = 2, kInternalError =
 
 [[nodiscard]] sappp::Result<nlohmann::json> read_json_file(const std::filesystem::path& path)
 {
+    const sappp::common::trace::Span span("io", "read_json", [&path] { return path.string(); });
     std::ifstream in(path);
     if (!in) {
         return std::unexpected(
@@ -467,6 +553,7 @@ enum class ExitCode { kOk = 0, kCliError = 1, kInputError = 2, kInternalError =
 [[nodiscard]] sappp::VoidResult write_canonical_json_file(const std::filesystem::path& path,
                                                           const nlohmann::json& payload)
 {
+    const sappp::common::trace::Span span("io", "write_json", [&path] { return path.string(); });
     std::ofstream out(path);
     if (!out) {
         return std::unexpected(
@@ -481,9 +568,45 @@ enum class ExitCode { kOk = 0, kCliError = 1, kInputError = 2, kInternalError =
         return std::unexpected(
             sappp::Error::make("IOError", "Failed to write output file: " + path.string()));
     }
+    sappp::common::stats::add(sappp::common::stats::Counter::kBytesWritten, canonical->size() + 1);
     return {};
 }
 
+/// Write unknown_ledger.json canonically, followed by its sidecar lookup index for explain.
+[[nodiscard]] [[maybe_unused]] sappp::VoidResult
+write_unknown_ledger(const std::filesystem::path& path, const nlohmann::json& ledger)
+{
+    auto canonical = sappp::canonical::canonicalize(ledger);
+    if (!canonical) {
+        return std::unexpected(canonical.error());
+    }
+    *canonical += "\n";
+    auto index = sappp::report::build_unknown_index(*canonical);
+    if (!index) {
+        return std::unexpected(index.error());
+    }
+    auto write_bytes = [](const std::filesystem::path& target,
+                          std::string_view bytes) -> sappp::VoidResult {
+        std::ofstream out(target, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return std::unexpected(
+                sappp::Error::make("IOError", "Failed to open output file: " + target.string()));
+        }
+        out << bytes;
+        if (!out) {
+            return std::unexpected(
+                sappp::Error::make("IOError", "Failed to write output file: " + target.string()));
+        }
+        sappp::common::stats::add(sappp::common::stats::Counter::kBytesWritten, bytes.size());
+        return {};
+    };
+    // The index is written last so that its mtime is not older than the ledger's.
+    if (auto written = write_bytes(path, *canonical); !written) {
+        return written;
+    }
+    return write_bytes(sappp::report::unknown_index_path(path), *index);
+}
+
 [[nodiscard]] sappp::VoidResult ensure_directory(const std::filesystem::path& dir,
                                                  std::string_view label)
 {
@@ -497,28 +620,95 @@ enum class ExitCode { kOk = 0, kCliError = 1, kInputError = 2, kInternalError =
     return {};
 }
 
-[[nodiscard]] sappp::Result<std::string> read_file_binary(const std::filesystem::path& path)
+/// Content-hash cache shared by every subcommand; persisted only when SAPPP_CACHE_DIR is set.
+[[nodiscard]] std::unique_ptr<sappp::common::FileHashCache> open_file_hash_cache()
 {
-    std::ifstream in(path, std::ios::binary);
-    if (!in) {
-        return std::unexpected(
-            sappp::Error::make("IOError", "Failed to read file: " + path.string()));
+    if (auto path = sappp::common::FileHashCache::default_path()) {
+        return std::make_unique<sappp::common::FileHashCache>(*path);
     }
-    std::string content{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
-    if (!in.good() && !in.eof()) {
-        return std::unexpected(
-            sappp::Error::make("IOError", "Failed to read file: " + path.string()));
+    return std::make_unique<sappp::common::FileHashCache>();
+}
+
+void save_file_hash_cache(const sappp::common::FileHashCache& cache)
+{
+    if (auto saved = cache.save(); !saved) {
+        std::println(stderr, "Warning: failed to update file hash cache: {}", saved.error().message);
+    }
+}
+
+/// Write stats.json with the command-specific @p section. Stats sit outside every digest
+/// and pack, so a failure is reported without failing the command.
+[[nodiscard]] bool write_stats_output(const std::filesystem::path& path,
+                                      sappp::common::stats::RunStats& run_stats,
+                                      std::string_view section_name,
+                                      nlohmann::json section,
+                                      const std::string& schema_dir)
+{
+    nlohmann::json document = run_stats.to_json();
+    document["tool"] = tool_metadata_json();
+    document[std::string(section_name)] = std::move(section);
+    const auto schema_path = std::filesystem::path(schema_dir) / "stats.v1.schema.json";
+    auto written = sappp::common::validate_json(document, schema_path.string());
+    if (written) {
+        written = write_canonical_json_file(path, document);
     }
-    return content;
+    if (!written) {
+        std::println(stderr, "Warning: failed to write stats: {}", written.error().message);
+    }
+    return written.has_value();
 }
 
-[[nodiscard]] sappp::Result<std::string> sha256_for_file(const std::filesystem::path& path)
+using sappp::pack::kPackRootPrefix;
+
+/// Manifest entries for pack members. Digests of on-disk sources come from the persistent
+/// cache (misses are hashed in parallel), so the archive pass is the only full read of
+/// unchanged files. Each source entry records its digest and size as
+/// PackEntry::expected, and the pack writer checks the archived bytes against them.
+[[nodiscard]] sappp::Result<std::vector<nlohmann::json>>
+build_pack_file_entries(sappp::common::FileHashCache& file_hashes,
+                        std::span<sappp::pack::PackEntry> files,
+                        std::size_t jobs)
 {
-    auto content = read_file_binary(path);
-    if (!content) {
-        return std::unexpected(content.error());
+    const sappp::common::trace::Span span("pack", "file_entries");
+    std::vector<std::filesystem::path> sources;
+    for (const auto& file : files) {
+        if (!file.contents) {
+            sources.push_back(file.source);
+        }
+    }
+    auto digests = file_hashes.digest_all(sources, jobs);
+
+    std::vector<nlohmann::json> entries;
+    entries.reserve(files.size());
+    std::size_t next_source = 0;
+    for (auto& file : files) {
+        std::string digest;
+        std::uintmax_t size = 0;
+        if (file.contents) {
+            digest = sappp::common::sha256_prefixed(*file.contents);
+            size = file.contents->size();
+        } else {
+            const auto& source_digest = digests[next_source++];
+            if (!source_digest) {
+                return std::unexpected(source_digest.error());
+            }
+            digest = *source_digest;
+            std::error_code ec;
+            size = std::filesystem::file_size(file.source, ec);
+            if (ec) {
+                return std::unexpected(sappp::Error::make(
+                    "IOError",
+                    "Failed to stat file: " + file.source.string() + ": " + ec.message()));
+            }
+            file.expected = sappp::pack::PackEntryDigest{.sha256 = digest, .size = size};
+        }
+        entries.push_back(nlohmann::json{
+            {"path", file.name.substr(kPackRootPrefix.size())},
+            {"sha256", std::move(digest)},
+            {"size_bytes", static_cast<std::int64_t>(size)}
+        });
     }
-    return sappp::common::sha256_prefixed(*content);
+    return entries;
 }
 
 [[nodiscard]] sappp::Result<std::string>
@@ -530,77 +720,33 @@ input_digest_from_build_snapshot(const nlohmann::json& snapshot)
     return sappp::canonical::hash_canonical(snapshot);
 }
 
-// NOLINTBEGIN(bugprone-easily-swappable-parameters) - Signature groups path + schema.
-[[nodiscard]] sappp::Result<nlohmann::json>
-read_and_validate_json(const std::filesystem::path& path,
-                       const std::filesystem::path& schema_dir,
-                       std::string_view schema_name)
+[[nodiscard]] sappp::VoidResult check_json_schema(const nlohmann::json& json,
+                                                  const std::filesystem::path& schema_dir,
+                                                  std::string_view schema_name)
 {
-    auto json = read_json_file(path);
-    if (!json) {
-        return std::unexpected(json.error());
-    }
     auto schema_path = (schema_dir / schema_name).string();
-    if (auto validation = sappp::common::validate_json(*json, schema_path); !validation) {
+    if (auto validation = sappp::common::validate_json(json, schema_path); !validation) {
         return std::unexpected(
             sappp::Error::make("SchemaInvalid",
                                std::string(schema_name) + ": " + validation.error().message));
     }
-    return *json;
-}
-// NOLINTEND(bugprone-easily-swappable-parameters)
-
-[[nodiscard]] sappp::VoidResult copy_file_checked(const std::filesystem::path& source,
-                                                  const std::filesystem::path& destination)
-{
-    std::error_code ec;
-    std::filesystem::copy_file(source,
-                               destination,
-                               std::filesystem::copy_options::overwrite_existing,
-                               ec);
-    if (ec) {
-        return std::unexpected(sappp::Error::make("IOError",
-                                                  "Failed to copy file: " + source.string() + " -> "
-                                                      + destination.string() + ": "
-                                                      + ec.message()));
-    }
     return {};
 }
 
-[[nodiscard]] sappp::Result<std::filesystem::path>
-prepare_pack_root(const std::filesystem::path& base_dir)
-{
-    std::filesystem::path pack_root = base_dir / "pack";
-    if (auto result = ensure_directory(pack_root, "pack"); !result) {
-        return std::unexpected(result.error());
-    }
-    return pack_root;
-}
-
-// NOLINTBEGIN(bugprone-easily-swappable-parameters) - Label/seed pairing is explicit.
-[[nodiscard]] sappp::Result<std::filesystem::path> prepare_temp_dir(std::string_view label,
-                                                                    std::string_view seed)
+// NOLINTBEGIN(bugprone-easily-swappable-parameters) - Signature groups path + schema.
+[[nodiscard]] sappp::Result<nlohmann::json>
+read_and_validate_json(const std::filesystem::path& path,
+                       const std::filesystem::path& schema_dir,
+                       std::string_view schema_name)
 {
-    const auto hash = sappp::common::sha256_prefixed(seed);
-    const auto suffix_length =
-        hash.size() < static_cast<std::size_t>(12) ? hash.size() : static_cast<std::size_t>(12);
-    const auto suffix = hash.substr(hash.size() - suffix_length);
-    std::filesystem::path temp_dir =
-        std::filesystem::temp_directory_path() / std::format("sappp_{}_{}", label, suffix);
-    std::error_code ec;
-    std::filesystem::remove_all(temp_dir, ec);
-    if (ec) {
-        return std::unexpected(sappp::Error::make("IOError",
-                                                  "Failed to remove existing temp dir '"
-                                                      + temp_dir.string() + "': " + ec.message()));
+    auto json = read_json_file(path);
+    if (!json) {
+        return std::unexpected(json.error());
     }
-    std::filesystem::create_directories(temp_dir, ec);
-    if (ec) {
-        return std::unexpected(sappp::Error::make("IOError",
-                                                  "Failed to create temp dir '" + temp_dir.string()
-                                                      + "': " + ec.message()));
+    if (auto checked = check_json_schema(*json, schema_dir, schema_name); !checked) {
+        return std::unexpected(checked.error());
     }
-    return temp_dir;
+    return *json;
 }
 // NOLINTEND(bugprone-easily-swappable-parameters)
 
@@ -674,28 +820,323 @@ build_pack_manifest(const std::vector<nlohmann::json>& files,
     return {};
 }
 
-[[nodiscard]] sappp::Result<std::filesystem::path>
-extract_pack_if_needed(const std::filesystem::path& input_path)
+/// Analysis outputs: a directory, or a pack archive whose members are read in place.
+struct OutputSource
+{
+    std::filesystem::path root;
+    std::optional<sappp::pack::PackReader> pack;
+};
+
+[[nodiscard]] sappp::Result<OutputSource> open_output_source(const std::filesystem::path& input)
+{
+    if (!sappp::pack::is_pack_archive(input)) {
+        return OutputSource{.root = input, .pack = std::nullopt};
+    }
+    auto reader = sappp::pack::PackReader::open(input);
+    if (!reader) {
+        return std::unexpected(reader.error());
+    }
+    return OutputSource{.root = input, .pack = std::move(*reader)};
+}
+
+/// JSON file @p name ('/'-separated, relative to the output root or the pack directory).
+[[nodiscard]] sappp::Result<nlohmann::json> read_output_json(const OutputSource& source,
+                                                             std::string_view name)
+{
+    if (!source.pack) {
+        return read_json_file(source.root / name);
+    }
+    const std::string member = std::string(kPackRootPrefix) + std::string(name);
+    auto contents = source.pack->read(member);
+    if (!contents) {
+        return std::unexpected(contents.error());
+    }
+    try {
+        return nlohmann::json::parse(*contents);
+    } catch (const std::exception& ex) {
+        return std::unexpected(sappp::Error::make("ParseError",
+                                                  "Failed to parse JSON file: "
+                                                      + source.root.string() + ":" + member + ": "
+                                                      + ex.what()));
+    }
+}
+
+// NOLINTBEGIN(bugprone-easily-swappable-parameters) - Signature groups name + schema.
+[[nodiscard]] sappp::Result<nlohmann::json>
+read_and_validate_output_json(const OutputSource& source,
+                              std::string_view name,
+                              const std::filesystem::path& schema_dir,
+                              std::string_view schema_name)
+{
+    auto json = read_output_json(source, name);
+    if (!json) {
+        return std::unexpected(json.error());
+    }
+    if (auto checked = check_json_schema(*json, schema_dir, schema_name); !checked) {
+        return std::unexpected(checked.error());
+    }
+    return *json;
+}
+// NOLINTEND(bugprone-easily-swappable-parameters)
+
+/// Serialized output file: mapped from disk, or read from a pack member.
+struct OutputBytes
+{
+    std::optional<sappp::common::MappedFile> mapped;
+    std::string contents;
+
+    [[nodiscard]] std::string_view view() const
+    {
+        return mapped ? mapped->view() : std::string_view(contents);
+    }
+};
+
+/// Bytes of output file @p name ('/'-separated, relative to the output root or the pack directory).
+[[nodiscard]] sappp::Result<OutputBytes> read_output_bytes(const OutputSource& source,
+                                                           std::string_view name)
+{
+    if (!source.pack) {
+        auto mapped = sappp::common::MappedFile::open(source.root / name);
+        if (!mapped) {
+            return std::unexpected(mapped.error());
+        }
+        return OutputBytes{.mapped = std::move(*mapped), .contents = {}};
+    }
+    auto contents = source.pack->read(std::string(kPackRootPrefix) + std::string(name));
+    if (!contents) {
+        return std::unexpected(contents.error());
+    }
+    return OutputBytes{.mapped = std::nullopt, .contents = std::move(*contents)};
+}
+
+/**
+ * Write SARIF for the analysis outputs in @p source to @p path.
+ *
+ * With empty @p validated_results only the unknown ledger is reported. A
+ * missing source map leaves results located by their PO's file alone.
+ */
+[[nodiscard]] sappp::Result<std::size_t> emit_sarif(const OutputSource& source,
+                                                    std::string_view validated_results,
+                                                    const std::filesystem::path& path)
 {
-    const auto filename = input_path.filename().string();
-    if (!filename.ends_with(".tar.gz")) {
-        return input_path;
+    auto ledger = read_output_bytes(source, "analyzer/unknown_ledger.json");
+    if (!ledger) {
+        return std::unexpected(ledger.error());
     }
-    auto temp_dir = prepare_temp_dir("pack", input_path.string());
-    if (!temp_dir) {
-        return std::unexpected(temp_dir.error());
+    auto po_list = read_output_bytes(source, "po/po_list.json");
+    if (!po_list) {
+        return std::unexpected(po_list.error());
+    }
+    auto source_map = read_output_bytes(source, "frontend/source_map.json");
+    // Packs carry no ledger index, and a stale sidecar is rebuilt in memory by write_sarif.
+    std::optional<sappp::report::UnknownIndex> ledger_index;
+    if (!source.pack) {
+        if (auto opened =
+                sappp::report::UnknownIndex::open(source.root / "analyzer/unknown_ledger.json")) {
+            ledger_index = std::move(*opened);
+        }
     }
 
-    const auto command =
-        std::format(R"(tar -xzf "{}" -C "{}")", input_path.string(), temp_dir->string());
-    if (std::system(command.c_str()) != 0) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
         return std::unexpected(
-            sappp::Error::make("IOError", "Failed to extract pack: " + input_path.string()));
+            sappp::Error::make("IOError", "Failed to open output file: " + path.string()));
+    }
+    auto written = sappp::report::write_sarif(
+        {.validated_results = validated_results,
+         .unknown_ledger = ledger->view(),
+         .po_list = po_list->view(),
+         .source_map = source_map ? source_map->view() : std::string_view{},
+         .tool = {{"name", "sappp"}, {"version", sappp::kVersion}},
+         .unknown_index = ledger_index ? std::optional(ledger_index->view()) : std::nullopt},
+        out);
+    out.close();
+    if (written && !out) {
+        written = std::unexpected(
+            sappp::Error::make("IOError", "Failed to write output file: " + path.string()));
+    }
+    if (!written) {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+    }
+    return written;
+}
+
+/// SARIF for validated results already written to @p results_path.
+[[nodiscard]] sappp::Result<std::size_t>
+emit_validated_sarif(const std::filesystem::path& input,
+                     const std::filesystem::path& results_path,
+                     const std::filesystem::path& path)
+{
+    auto source = open_output_source(input);
+    if (!source) {
+        return std::unexpected(source.error());
+    }
+    auto results = sappp::common::MappedFile::open(results_path);
+    if (!results) {
+        return std::unexpected(results.error());
+    }
+    return emit_sarif(*source, results->view(), path);
+}
+
+/**
+ * Reader over output file @p name: mapped into @p mapped from disk, or streamed
+ * from the pack member so that it is never held in memory as a whole.
+ */
+[[nodiscard]] sappp::Result<sappp::report::ResultsReader>
+open_output_results(const OutputSource& source,
+                    std::string_view name,
+                    std::optional<sappp::common::MappedFile>& mapped)
+{
+    if (!source.pack) {
+        auto file = sappp::common::MappedFile::open(source.root / name);
+        if (!file) {
+            return std::unexpected(file.error());
+        }
+        return sappp::report::ResultsReader::open(mapped.emplace(std::move(*file)).view());
+    }
+    auto member = source.pack->open_member(std::string(kPackRootPrefix) + std::string(name));
+    if (!member) {
+        return std::unexpected(member.error());
+    }
+    auto stream = std::make_shared<sappp::pack::PackReader::MemberStream>(std::move(*member));
+    return sappp::report::ResultsReader::open(sappp::report::DocumentStream{
+        .read = [stream](std::span<char> dest) { return stream->read(dest); },
+        .rewind = [stream] { return stream->rewind(); }});
+}
+
+/// The whole document behind @p reader, for results that cannot be merge-joined.
+[[nodiscard]] sappp::Result<nlohmann::json> read_whole_results(sappp::report::ResultsReader& reader)
+{
+    nlohmann::json document = reader.header();
+    if (!reader.has_results()) {
+        return document;
+    }
+    document["results"] = nlohmann::json::array();
+    reader.rewind();
+    while (true) {
+        auto item = reader.next();
+        if (!item) {
+            return std::unexpected(item.error());
+        }
+        if (!item->has_value()) {
+            return document;
+        }
+        document["results"].push_back(std::move(**item));
     }
-    return *temp_dir / "pack";
 }
 
 #if defined(SAPPP_HAS_CLANG_FRONTEND)
+/// Serialized artifacts that may wait for the writer in --pipeline mode.
+constexpr std::size_t kArtifactQueueDepth = 2;
+
+/**
+ * @brief One background worker fed through a bounded job queue
+ *
+ * submit() blocks while @c capacity jobs are pending, so a fast stage cannot pile up
+ * work ahead of a slow one. With capacity 0 each job runs inline in submit(). Jobs
+ * after the first failure are skipped; finish() reports that failure.
+ */
+class PipelineStage
+{
+public:
+    using Job = std::function<sappp::VoidResult()>;
+
+    explicit PipelineStage(std::size_t capacity)
+        : m_capacity(capacity)
+    {
+        if (m_capacity > 0) {
+            m_worker = std::jthread([this] { run(); });
+        }
+    }
+
+    ~PipelineStage() { (void)finish(); }
+
+    PipelineStage(const PipelineStage&) = delete;
+    PipelineStage& operator=(const PipelineStage&) = delete;
+    PipelineStage(PipelineStage&&) = delete;
+    PipelineStage& operator=(PipelineStage&&) = delete;
+
+    /// Queue @p job; @p label prefixes the message of its error.
+    void submit(std::string label, Job job)
+    {
+        if (m_capacity == 0) {
+            execute(label, job);
+            return;
+        }
+        {
+            std::unique_lock lock(m_mutex);
+            m_space_cv.wait(lock, [this] { return m_pending.size() < m_capacity; });
+            m_pending.emplace_back(std::move(label), std::move(job));
+        }
+        m_work_cv.notify_one();
+    }
+
+    /// Wait until every submitted job has run.
+    [[nodiscard]] sappp::VoidResult finish()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_closed = true;
+        }
+        m_work_cv.notify_all();
+        if (m_worker.joinable()) {
+            m_worker.join();
+        }
+        if (m_error) {
+            return std::unexpected(*m_error);
+        }
+        return {};
+    }
+
+private:
+    void run()
+    {
+        for (;;) {
+            std::pair<std::string, Job> next;
+            {
+                std::unique_lock lock(m_mutex);
+                m_work_cv.wait(lock, [this] { return m_closed || !m_pending.empty(); });
+                if (m_pending.empty()) {
+                    return;
+                }
+                next = std::move(m_pending.front());
+                m_pending.pop_front();
+            }
+            m_space_cv.notify_one();
+            execute(next.first, next.second);
+        }
+    }
+
+    // Only the worker (or the submitting thread when inline) runs jobs and sets m_error.
+    void execute(const std::string& label, const Job& job)
+    {
+        if (m_error) {
+            return;
+        }
+        sappp::VoidResult done;
+        try {
+            done = job();
+        } catch (const std::exception& ex) {
+            done = std::unexpected(sappp::Error::make("InternalError", ex.what()));
+        }
+        if (!done) {
+            m_error = sappp::Error::make(done.error().code,
+                                         std::format("{}: {}", label, done.error().message));
+        }
+    }
+
+    std::size_t m_capacity;
+    std::mutex m_mutex{};
+    std::condition_variable m_work_cv{};
+    std::condition_variable m_space_cv{};
+    std::deque<std::pair<std::string, Job>> m_pending{};
+    bool m_closed = false;
+    std::optional<sappp::Error> m_error = std::nullopt;
+    // Declared last so the worker is joined before the state it uses is destroyed.
+    std::jthread m_worker{};
+};
+
 [[nodiscard]] sappp::Result<AnalyzePaths> prepare_analyze_paths(std::string_view output)
 {
     auto output_dir = std::filesystem::path(output);
@@ -734,6 +1175,7 @@ extract_pack_if_needed(const std::filesystem::path& input_path)
     auto unknown_ledger_path = analyzer_dir / "unknown_ledger.json";
     auto analysis_config_path = config_dir / "analysis_config.json";
     auto specdb_snapshot_path = specdb_dir / "snapshot.json";
+    auto stats_path = output_dir / "stats.json";
     return AnalyzePaths{output_dir,
                         frontend_dir,
                         po_dir,
@@ -748,7 +1190,8 @@ extract_pack_if_needed(const std::filesystem::path& input_path)
                         po_path,
                         unknown_ledger_path,
                         analysis_config_path,
-                        specdb_snapshot_path};
+                        specdb_snapshot_path,
+                        stats_path};
 }
 
 [[nodiscard]] sappp::Result<nlohmann::json> load_analysis_config(const AnalyzeOptions& options,
@@ -847,15 +1290,23 @@ parse_analysis_budget(const nlohmann::json& analysis_config)
 [[nodiscard]] sappp::Result<nlohmann::json>
 load_specdb_snapshot(const AnalyzeOptions& options,
                      std::string_view generated_at,
-                     const nlohmann::json& build_snapshot)
+                     const nlohmann::json& build_snapshot,
+                     sappp::common::FileHashCache& file_hashes,
+                     std::function<bool()> may_save_cache = {})
 {
     std::string resolved_generated_at =
         generated_at.empty() ? std::string(kDeterministicGeneratedAt) : std::string(generated_at);
-    sappp::specdb::BuildOptions specdb_options{.build_snapshot = build_snapshot,
-                                               .spec_path = options.spec,
-                                               .schema_dir = options.schema_dir,
-                                               .generated_at = resolved_generated_at,
-                                               .tool = tool_metadata_json()};
+    sappp::specdb::BuildOptions specdb_options{
+        .build_snapshot = build_snapshot,
+        .spec_path = options.spec,
+        .schema_dir = options.schema_dir,
+        .generated_at = resolved_generated_at,
+        .tool = tool_metadata_json(),
+        .jobs = options.jobs > 0 ? static_cast<std::size_t>(options.jobs) : std::size_t{0},
+        .cache_dir = std::filesystem::path(options.output) / "cache" / "specdb",
+        .file_hashes = &file_hashes,
+        .may_save_cache = std::move(may_save_cache)};
+    const sappp::common::trace::Span span("specdb", "build_snapshot");
     return sappp::specdb::build_snapshot(specdb_options);
 }
 
@@ -899,12 +1350,14 @@ write_analysis_config_output(const AnalyzePaths& paths,
     return *analysis_config;
 }
 
-[[nodiscard]] sappp::VoidResult write_specdb_snapshot_output(const AnalyzePaths& paths,
-                                                             const AnalyzeOptions& options,
-                                                             std::string_view generated_at,
-                                                             const nlohmann::json& build_snapshot)
+[[nodiscard]] sappp::Result<nlohmann::json>
+write_specdb_snapshot_output(const AnalyzePaths& paths,
+                             const AnalyzeOptions& options,
+                             std::string_view generated_at,
+                             const nlohmann::json& build_snapshot,
+                             sappp::common::FileHashCache& file_hashes)
 {
-    auto specdb_snapshot = load_specdb_snapshot(options, generated_at, build_snapshot);
+    auto specdb_snapshot = load_specdb_snapshot(options, generated_at, build_snapshot, file_hashes);
     if (!specdb_snapshot) {
         return std::unexpected(specdb_snapshot.error());
     }
@@ -912,7 +1365,72 @@ write_analysis_config_output(const AnalyzePaths& paths,
         !write) {
         return std::unexpected(write.error());
     }
-    return {};
+    return *specdb_snapshot;
+}
+
+[[nodiscard]] std::filesystem::path po_function_digests_path(const AnalyzePaths& paths)
+{
+    return paths.output_dir / "cache" / "po" / "function_digests.json";
+}
+
+/// Regenerate the PO list, reusing entries of functions unchanged since the previous run.
+[[nodiscard]] sappp::Result<sappp::po::PoGeneration>
+generate_po_list(const sappp::po::PoGenerator& generator,
+                 const nlohmann::json& nir,
+                 const AnalyzePaths& paths)
+{
+    const std::filesystem::path digests_path = po_function_digests_path(paths);
+    if (std::filesystem::exists(paths.po_path) && std::filesystem::exists(digests_path)) {
+        auto previous_po_list = read_json_file(paths.po_path);
+        auto sidecar = read_json_file(digests_path);
+        if (previous_po_list && sidecar) {
+            if (auto previous_digests =
+                    sappp::po::function_digests_from_json(*sidecar, *previous_po_list)) {
+                return generator.generate_incremental(nir, *previous_po_list, *previous_digests);
+            }
+        }
+    }
+    return generator.generate_incremental(nir, nlohmann::json::object(), {});
+}
+
+[[nodiscard]] nlohmann::json analyze_stats_json(const sappp::analyzer::AnalyzeStats& stats)
+{
+    nlohmann::json domains = nlohmann::json::object();
+    for (const auto& [domain, counts] : stats.domains) {
+        domains[domain] = {
+            {"iterations", counts.iterations},
+            {    "states",     counts.states}
+        };
+    }
+    nlohmann::json section = {
+        {    "functions",     stats.functions},
+        {       "blocks",        stats.blocks},
+        { "instructions",  stats.instructions},
+        {          "pos",           stats.pos},
+        {     "unknowns",      stats.unknowns},
+        {"summary_nodes", stats.summary_nodes},
+        {      "domains",  std::move(domains)}
+    };
+    if (stats.budget_exceeded) {
+        section["budget_exceeded"] = *stats.budget_exceeded;
+    }
+    return section;
+}
+
+/// Record per-function digests for the next run; failures only cost a full regeneration.
+void write_po_function_digests(const AnalyzePaths& paths,
+                               const sappp::po::PoGeneration& generation)
+{
+    const std::filesystem::path digests_path = po_function_digests_path(paths);
+    auto written = ensure_directory(digests_path.parent_path(), "po cache");
+    if (written) {
+        written = write_canonical_json_file(
+            digests_path,
+            sappp::po::function_digests_to_json(generation.function_digests, generation.po_list));
+    }
+    if (!written) {
+        std::println(stderr, "Warning: failed to record PO digests: {}", written.error().message);
+    }
 }
 
 #endif
@@ -962,6 +1480,10 @@ write_analysis_config_output(const AnalyzePaths& paths,
                                                          AnalyzeOptions& options,
                                                          bool& skip_next)
 {
+    if (arg == "--pipeline") {
+        options.pipeline = true;
+        return sappp::Result<bool>{true};
+    }
     if (arg != "--jobs" && arg != "-j") {
         return sappp::Result<bool>{false};
     }
@@ -1085,6 +1607,24 @@ write_analysis_config_output(const AnalyzePaths& paths,
         skip_next = true;
         return sappp::Result<bool>{true};
     }
+    if (arg == "--emit-sarif") {
+        auto value = read_option_value(args, idx, arg);
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+        options.emit_sarif = *value;
+        skip_next = true;
+        return sappp::Result<bool>{true};
+    }
+    if (arg == "--cache-dir") {
+        auto value = read_option_value(args, idx, arg);
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+        options.cache_dir = *value;
+        skip_next = true;
+        return sappp::Result<bool>{true};
+    }
     if (arg == "--strict") {
         options.strict = true;
         return sappp::Result<bool>{true};
@@ -1094,6 +1634,7 @@ write_analysis_config_output(const AnalyzePaths& paths,
 // NOLINTEND(bugprone-easily-swappable-parameters)
 
 // NOLINTBEGIN(bugprone-easily-swappable-parameters) - CLI parsing signature is stable.
+// NOLINTNEXTLINE(readability-function-size) - CLI parsing is kept in one place for clarity.
 [[nodiscard]] sappp::Result<bool> set_capture_option(std::string_view arg,
                                                      std::span<char*> args,
                                                      std::size_t idx,
@@ -1136,24 +1677,59 @@ write_analysis_config_output(const AnalyzePaths& paths,
         skip_next = true;
         return sappp::Result<bool>{true};
     }
-    return sappp::Result<bool>{false};
-}
-// NOLINTEND(bugprone-easily-swappable-parameters)
-
-// NOLINTBEGIN(bugprone-easily-swappable-parameters) - CLI parsing signature is stable.
-// NOLINTNEXTLINE(readability-function-size) - CLI parsing is kept in one place for clarity.
-[[nodiscard]] sappp::Result<bool> set_pack_option(std::string_view arg,
-                                                  std::span<char*> args,
-                                                  std::size_t idx,
-                                                  PackOptions& options,
-                                                  bool& skip_next)
-{
-    if (arg == "--input" || arg == "--in") {
+    if (arg == "--jobs" || arg == "-j") {
         auto value = read_option_value(args, idx, arg);
         if (!value) {
             return std::unexpected(value.error());
         }
-        options.input = *value;
+        auto parsed = parse_jobs_value(*value);
+        if (!parsed) {
+            return std::unexpected(parsed.error());
+        }
+        options.jobs = *parsed;
+        skip_next = true;
+        return sappp::Result<bool>{true};
+    }
+    if (arg == "--scan-deps") {
+        options.scan_deps = true;
+        return sappp::Result<bool>{true};
+    }
+    if (arg == "--base") {
+        auto value = read_option_value(args, idx, arg);
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+        options.base = *value;
+        skip_next = true;
+        return sappp::Result<bool>{true};
+    }
+    if (arg == "--change-set") {
+        auto value = read_option_value(args, idx, arg);
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+        options.change_set_path = *value;
+        skip_next = true;
+        return sappp::Result<bool>{true};
+    }
+    return sappp::Result<bool>{false};
+}
+// NOLINTEND(bugprone-easily-swappable-parameters)
+
+// NOLINTBEGIN(bugprone-easily-swappable-parameters) - CLI parsing signature is stable.
+// NOLINTNEXTLINE(readability-function-size) - CLI parsing is kept in one place for clarity.
+[[nodiscard]] sappp::Result<bool> set_pack_option(std::string_view arg,
+                                                  std::span<char*> args,
+                                                  std::size_t idx,
+                                                  PackOptions& options,
+                                                  bool& skip_next)
+{
+    if (arg == "--input" || arg == "--in") {
+        auto value = read_option_value(args, idx, arg);
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+        options.input = *value;
         skip_next = true;
         return sappp::Result<bool>{true};
     }
@@ -1184,6 +1760,19 @@ write_analysis_config_output(const AnalyzePaths& paths,
         skip_next = true;
         return sappp::Result<bool>{true};
     }
+    if (arg == "--jobs" || arg == "-j") {
+        auto value = read_option_value(args, idx, arg);
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+        auto parsed = parse_jobs_value(*value);
+        if (!parsed) {
+            return std::unexpected(parsed.error());
+        }
+        options.jobs = *parsed;
+        skip_next = true;
+        return sappp::Result<bool>{true};
+    }
     if (arg == "--repro-level") {
         auto value = read_option_value(args, idx, arg);
         if (!value) {
@@ -1328,6 +1917,10 @@ write_analysis_config_output(const AnalyzePaths& paths,
                            .repo_root = std::string{},
                            .output_path = "build_snapshot.json",
                            .schema_dir = "schemas",
+                           .jobs = 0,
+                           .base = std::string{},
+                           .change_set_path = std::string{},
+                           .scan_deps = false,
                            .versions = sappp::default_version_triple(),
                            .logging = LoggingOptions{},
                            .show_help = false};
@@ -1381,6 +1974,7 @@ write_analysis_config_output(const AnalyzePaths& paths,
                            .analysis_config = std::string{},
                            .emit_sarif = std::string{},
                            .repro_level = std::string{},
+                           .pipeline = false,
                            .versions = sappp::default_version_triple(),
                            .logging = LoggingOptions{},
                            .show_help = false};
@@ -1428,8 +2022,10 @@ write_analysis_config_output(const AnalyzePaths& paths,
 {
     ValidateOptions options{.input = std::string{},
                             .strict = false,
+                            .cache_dir = std::string{},
                             .output = std::string{},
                             .schema_dir = "schemas",
+                            .emit_sarif = std::string{},
                             .versions = sappp::default_version_triple(),
                             .logging = LoggingOptions{},
                             .show_help = false};
@@ -1481,6 +2077,7 @@ write_analysis_config_output(const AnalyzePaths& paths,
                         .schema_dir = "schemas",
                         .repro_level = "L0",
                         .include_analyzer_candidates = false,
+                        .jobs = 0,
                         .show_help = false};
     bool skip_next = false;
     for (auto [i, arg_ptr] : std::views::enumerate(args)) {
@@ -1607,14 +2204,187 @@ write_analysis_config_output(const AnalyzePaths& paths,
     return options;
 }
 
+constexpr std::array<std::string_view, 9> kBenchWorkloads{
+    {"canonical_hash",
+     "schema_validation",
+     "certstore_put",
+     "certstore_get",
+     "certstore_get_cold",
+     "fixpoint_lifetime",
+     "fixpoint_heap_lifetime",
+     "fixpoint_init",
+     "fixpoint_points_to"}
+};
+
+[[nodiscard]] sappp::Result<std::size_t> parse_iterations_value(std::string_view value)
+{
+    std::size_t parsed = 0;
+    const char* begin = value.data();
+    const char* end = value.data() + value.size();
+    auto [ptr, ec] = std::from_chars(begin, end, parsed);
+    if (ec != std::errc{} || ptr != end || parsed == 0) {
+        return std::unexpected(
+            sappp::Error::make("InvalidArgument",
+                               std::string("Invalid --iterations value: ") + std::string(value)));
+    }
+    return parsed;
+}
+
+// NOLINTBEGIN(bugprone-easily-swappable-parameters) - CLI parsing signature is stable.
+// NOLINTNEXTLINE(readability-function-size) - Flat option table.
+[[nodiscard]] sappp::Result<bool> set_bench_option(std::string_view arg,
+                                                   std::span<char*> args,
+                                                   std::size_t idx,
+                                                   BenchOptions& options,
+                                                   bool& skip_next)
+{
+    if (arg == "--keep") {
+        options.keep = true;
+        return sappp::Result<bool>{true};
+    }
+    if (arg != "--dir" && arg != "--iterations" && arg != "--workload" && arg != "--out"
+        && arg != "--output" && arg != "-o" && arg != "--schema-dir") {
+        return sappp::Result<bool>{false};
+    }
+    auto value = read_option_value(args, idx, arg);
+    if (!value) {
+        return std::unexpected(value.error());
+    }
+    skip_next = true;
+    if (arg == "--dir") {
+        options.dir = *value;
+    } else if (arg == "--iterations") {
+        auto parsed = parse_iterations_value(*value);
+        if (!parsed) {
+            return std::unexpected(parsed.error());
+        }
+        options.iterations = *parsed;
+    } else if (arg == "--workload") {
+        if (std::ranges::find(kBenchWorkloads, std::string_view(*value)) == kBenchWorkloads.end()) {
+            return std::unexpected(
+                sappp::Error::make("InvalidArgument", "Unknown --workload: " + *value));
+        }
+        // A repeated workload would only rerun the same operations on a warmed-up store.
+        if (std::ranges::find(options.workloads, *value) == options.workloads.end()) {
+            options.workloads.push_back(*value);
+        }
+    } else if (arg == "--schema-dir") {
+        options.schema_dir = *value;
+    } else {
+        options.output = *value;
+    }
+    return sappp::Result<bool>{true};
+}
+// NOLINTEND(bugprone-easily-swappable-parameters)
+
+[[nodiscard]] sappp::Result<BenchOptions> parse_bench_args(std::span<char*> args)
+{
+    BenchOptions options{.dir = ".",
+                         .iterations = 200,
+                         .workloads = std::vector<std::string>{},
+                         .keep = false,
+                         .output = std::string{},
+                         .schema_dir = "schemas",
+                         .show_help = false};
+    bool skip_next = false;
+    for (auto [i, arg_ptr] : std::views::enumerate(args)) {
+        if (skip_next) {
+            skip_next = false;
+            continue;
+        }
+        if (arg_ptr == nullptr) {
+            continue;
+        }
+        const auto idx = static_cast<std::size_t>(i);
+        std::string_view arg(arg_ptr);
+        if (arg == "--help" || arg == "-h") {
+            options.show_help = true;
+            continue;
+        }
+        auto handled = set_bench_option(arg, args, idx, options, skip_next);
+        if (!handled) {
+            return std::unexpected(handled.error());
+        }
+    }
+    return options;
+}
+
+#if defined(SAPPP_HAS_CLANG_FRONTEND)
+[[nodiscard]] sappp::VoidResult attach_dependencies(sappp::build_capture::BuildSnapshot& snapshot,
+                                                    const CaptureOptions& options,
+                                                    sappp::common::FileHashCache& file_hashes)
+{
+    sappp::frontend_clang::DependencyScanner scanner(
+        options.repo_root,
+        options.jobs > 0 ? static_cast<std::size_t>(options.jobs) : std::size_t{0});
+    scanner.set_file_hash_cache(&file_hashes);
+    auto dependencies = scanner.scan(snapshot.json());
+    if (!dependencies) {
+        return std::unexpected(dependencies.error());
+    }
+    snapshot.json()["dependencies"] = std::move(*dependencies);
+    auto schema_path =
+        (std::filesystem::path(options.schema_dir) / "build_snapshot.v1.schema.json").string();
+    return sappp::common::validate_json(snapshot.json(), schema_path);
+}
+#endif
+
+// NOLINTNEXTLINE(readability-function-size) - CLI orchestration keeps the flow together.
 [[nodiscard]] int run_capture(const CaptureOptions& options)
 {
-    sappp::build_capture::BuildCapture capture(options.repo_root, options.schema_dir);
-    auto snapshot = capture.capture(options.compile_commands);
+#if !defined(SAPPP_HAS_CLANG_FRONTEND)
+    if (options.scan_deps) {
+        std::println(
+            stderr,
+            "Error: frontend_clang is not built. Reconfigure with -DSAPPP_BUILD_CLANG_FRONTEND=ON");
+        return static_cast<int>(ExitCode::kInternalError);
+    }
+#endif
+    std::optional<sappp::build_capture::BuildSnapshot> base;
+    if (!options.base.empty()) {
+        auto base_json = read_and_validate_json(options.base,
+                                                options.schema_dir,
+                                                "build_snapshot.v1.schema.json");
+        if (!base_json) {
+            std::println(stderr, "Error: base snapshot: {}", base_json.error().message);
+            return exit_code_for_error(base_json.error());
+        }
+        base.emplace(std::move(*base_json));
+    }
+
+    sappp::build_capture::BuildCapture capture(
+        options.repo_root,
+        options.schema_dir,
+        options.jobs > 0 ? static_cast<std::size_t>(options.jobs) : std::size_t{0});
+    auto file_hashes = open_file_hash_cache();
+    capture.set_file_hash_cache(file_hashes.get());
+    std::optional<nlohmann::json> change_set;
+    auto snapshot = [&]() -> sappp::Result<sappp::build_capture::BuildSnapshot> {
+        if (!base) {
+            return capture.capture(options.compile_commands);
+        }
+        auto delta = capture.capture_delta(options.compile_commands, *base);
+        if (!delta) {
+            return std::unexpected(delta.error());
+        }
+        change_set = std::move(delta->change_set);
+        return std::move(delta->snapshot);
+    }();
     if (!snapshot) {
+        save_file_hash_cache(*file_hashes);
         std::println(stderr, "Error: capture failed: {}", snapshot.error().message);
         return exit_code_for_error(snapshot.error());
     }
+#if defined(SAPPP_HAS_CLANG_FRONTEND)
+    if (options.scan_deps) {
+        if (auto result = attach_dependencies(*snapshot, options, *file_hashes); !result) {
+            save_file_hash_cache(*file_hashes);
+            std::println(stderr, "Error: dependency scan failed: {}", result.error().message);
+            return exit_code_for_error(result.error());
+        }
+    }
+#endif
+    save_file_hash_cache(*file_hashes);
 
     std::filesystem::path output_file(options.output_path);
     auto output_parent = output_file.parent_path();
@@ -1635,6 +2405,34 @@ write_analysis_config_output(const AnalyzePaths& paths,
     std::println("[capture] Wrote build_snapshot.json");
     std::println("  input: {}", options.compile_commands);
     std::println("  output: {}", output_file.string());
+
+    if (change_set) {
+        const std::filesystem::path change_set_file =
+            options.change_set_path.empty() ? output_parent / "build_change_set.json"
+                                            : std::filesystem::path(options.change_set_path);
+        if (!change_set_file.parent_path().empty()) {
+            if (auto result = ensure_directory(change_set_file.parent_path(), "change set");
+                !result) {
+                std::println(stderr, "Error: {}", result.error().message);
+                return exit_code_for_error(result.error());
+            }
+        }
+        if (auto result = write_canonical_json_file(change_set_file, *change_set); !result) {
+            std::println(stderr,
+                         "Error: failed to serialize build change set: {}",
+                         result.error().message);
+            return exit_code_for_error(result.error());
+        }
+        std::println("  change set: {} (added {}, removed {}, modified {}, unchanged {})",
+                     change_set_file.string(),
+                     change_set->at("added").size(),
+                     change_set->at("removed").size(),
+                     change_set->at("modified").size(),
+                     change_set->at("unchanged").get<std::size_t>());
+        if (change_set->contains("dependency_changed")) {
+            std::println("  dependency changed: {}", change_set->at("dependency_changed").size());
+        }
+    }
     return static_cast<int>(ExitCode::kOk);
 }
 
@@ -1648,14 +2446,49 @@ write_analysis_config_output(const AnalyzePaths& paths,
         "Error: frontend_clang is not built. Reconfigure with -DSAPPP_BUILD_CLANG_FRONTEND=ON");
     return static_cast<int>(ExitCode::kInternalError);
 #else
+    sappp::common::stats::RunStats run_stats("analyze");
     auto snapshot_json = read_json_file(options.build);
     if (!snapshot_json) {
         std::println(stderr, "Error: {}", snapshot_json.error().message);
         return exit_code_for_error(snapshot_json.error());
     }
 
+    const std::string generated_at = generated_at_from_json(*snapshot_json);
+    auto file_hashes = open_file_hash_cache();
+
+    // With --pipeline SpecDB is built in memory while the frontend and PO generation run,
+    // and artifacts are written behind the following stage; otherwise every job runs
+    // inline, in the staged order. Nothing is written under the output directory until
+    // the frontend has succeeded, so the speculative SpecDB build holds its contract
+    // cache write back until then. Jobs own or outlive everything they touch, so an
+    // early return can join them safely.
+    nlohmann::json specdb_snapshot_json;
+    PipelineStage specdb_stage(options.pipeline ? 1 : 0);
+    // Declared after the stage: a promise abandoned by an early exit releases the job.
+    std::promise<bool> frontend_succeeded;
+    if (options.pipeline) {
+        auto may_save_cache = [frontend_done = frontend_succeeded.get_future().share()]() {
+            try {
+                return frontend_done.get();
+            } catch (const std::future_error&) {
+                return false;
+            }
+        };
+        specdb_stage.submit("specdb snapshot failed", [&, may_save_cache]() -> sappp::VoidResult {
+            auto snapshot = load_specdb_snapshot(
+                options, generated_at, *snapshot_json, *file_hashes, may_save_cache);
+            if (!snapshot) {
+                return std::unexpected(snapshot.error());
+            }
+            specdb_snapshot_json = std::move(*snapshot);
+            return {};
+        });
+    }
+
+    run_stats.begin_phase("frontend");
     sappp::frontend_clang::FrontendClang frontend(options.schema_dir);
     auto result = frontend.analyze(*snapshot_json, options.versions);
+    frontend_succeeded.set_value(result.has_value());
     if (!result) {
         std::println(stderr, "Error: analyze failed: {}", result.error().message);
         return exit_code_for_error(result.error());
@@ -1666,56 +2499,79 @@ write_analysis_config_output(const AnalyzePaths& paths,
         std::println(stderr, "Error: {}", paths.error().message);
         return exit_code_for_error(paths.error());
     }
+    PipelineStage artifact_writer(options.pipeline ? kArtifactQueueDepth : 0);
 
-    if (auto write = write_canonical_json_file(paths->nir_path, result->nir); !write) {
-        std::println(stderr, "Error: failed to serialize NIR: {}", write.error().message);
-        return exit_code_for_error(write.error());
-    }
-    if (auto write = write_canonical_json_file(paths->source_map_path, result->source_map);
-        !write) {
-        std::println(stderr, "Error: failed to serialize source map: {}", write.error().message);
-        return exit_code_for_error(write.error());
-    }
+    // The NIR is shared with the later stages; the source map is released once written.
+    const auto nir = std::make_shared<const nlohmann::json>(std::move(result->nir));
+    artifact_writer.submit("failed to serialize NIR", [&paths, nir]() {
+        return write_canonical_json_file(paths->nir_path, *nir);
+    });
+    artifact_writer.submit(
+        "failed to serialize source map",
+        [&paths, source_map = std::move(result->source_map)]() {
+            return write_canonical_json_file(paths->source_map_path, source_map);
+        });
 
-    sappp::po::PoGenerator po_generator;
-    auto po_list_result = po_generator.generate(result->nir);
-    if (!po_list_result) {
-        std::println(stderr, "Error: PO generation failed: {}", po_list_result.error().message);
-        return exit_code_for_error(po_list_result.error());
+    run_stats.begin_phase("po_generation");
+    sappp::po::PoGenerator po_generator(
+        options.jobs > 0 ? static_cast<std::size_t>(options.jobs) : std::size_t{0});
+    po_generator.set_file_hash_cache(file_hashes.get());
+    auto generated = generate_po_list(po_generator, *nir, *paths);
+    if (!generated) {
+        std::println(stderr, "Error: PO generation failed: {}", generated.error().message);
+        return exit_code_for_error(generated.error());
     }
+    const auto po_generation =
+        std::make_shared<const sappp::po::PoGeneration>(std::move(*generated));
+    const nlohmann::json& po_list = po_generation->po_list;
 
     const std::filesystem::path po_schema_path =
         std::filesystem::path(options.schema_dir) / "po.v1.schema.json";
-    if (auto validation = sappp::common::validate_json(*po_list_result, po_schema_path.string());
+    if (auto validation = sappp::common::validate_json(po_list, po_schema_path.string());
         !validation) {
         std::println(stderr, "Error: po schema validation failed: {}", validation.error().message);
         return exit_code_for_error(validation.error());
     }
 
-    if (auto write = write_canonical_json_file(paths->po_path, *po_list_result); !write) {
-        std::println(stderr, "Error: failed to serialize PO list: {}", write.error().message);
-        return exit_code_for_error(write.error());
-    }
+    artifact_writer.submit("failed to serialize PO list", [&paths, po_generation]() {
+        if (auto write = write_canonical_json_file(paths->po_path, po_generation->po_list);
+            !write) {
+            return write;
+        }
+        write_po_function_digests(*paths, *po_generation);
+        return sappp::VoidResult{};
+    });
 
-    const std::string generated_at = generated_at_from_json(*snapshot_json);
+    run_stats.begin_phase("analysis_config");
     auto analysis_config = write_analysis_config_output(*paths, options, generated_at);
     if (!analysis_config) {
         std::println(stderr, "Error: analysis_config failed: {}", analysis_config.error().message);
         return exit_code_for_error(analysis_config.error());
     }
-    if (auto write_result =
-            write_specdb_snapshot_output(*paths, options, generated_at, *snapshot_json);
-        !write_result) {
-        std::println(stderr, "Error: specdb snapshot failed: {}", write_result.error().message);
-        return exit_code_for_error(write_result.error());
+    if (!options.pipeline) {
+        run_stats.begin_phase("specdb");
+        specdb_stage.submit("specdb snapshot failed", [&]() -> sappp::VoidResult {
+            auto snapshot = write_specdb_snapshot_output(
+                *paths, options, generated_at, *snapshot_json, *file_hashes);
+            if (!snapshot) {
+                return std::unexpected(snapshot.error());
+            }
+            specdb_snapshot_json = std::move(*snapshot);
+            return {};
+        });
     }
-    auto specdb_snapshot_json = read_json_file(paths->specdb_snapshot_path);
-    if (!specdb_snapshot_json) {
-        std::println(stderr,
-                     "Error: specdb snapshot read failed: {}",
-                     specdb_snapshot_json.error().message);
-        return exit_code_for_error(specdb_snapshot_json.error());
+    auto specdb_built = specdb_stage.finish();
+    save_file_hash_cache(*file_hashes);
+    if (!specdb_built) {
+        std::println(stderr, "Error: {}", specdb_built.error().message);
+        return exit_code_for_error(specdb_built.error());
     }
+    if (options.pipeline) {
+        artifact_writer.submit("specdb snapshot failed", [&paths, &specdb_snapshot_json]() {
+            return write_canonical_json_file(paths->specdb_snapshot_path, specdb_snapshot_json);
+        });
+    }
+    run_stats.begin_phase("analyze");
     auto analysis_budget = parse_analysis_budget(*analysis_config);
     auto memory_domain = parse_memory_domain(*analysis_config);
     sappp::analyzer::Analyzer analyzer({.schema_dir = options.schema_dir,
@@ -1725,36 +2581,93 @@ write_analysis_config_output(const AnalyzePaths& paths,
                                         .memory_domain = memory_domain});
     auto match_context = build_contract_match_context(*snapshot_json);
     auto analyzer_output =
-        analyzer.analyze(result->nir, *po_list_result, &*specdb_snapshot_json, match_context);
+        analyzer.analyze(*nir, po_list, &specdb_snapshot_json, match_context);
+    run_stats.begin_phase("artifact_flush");
+    if (auto written = artifact_writer.finish(); !written) {
+        std::println(stderr, "Error: {}", written.error().message);
+        return exit_code_for_error(written.error());
+    }
     if (!analyzer_output) {
         std::println(stderr, "Error: analyzer failed: {}", analyzer_output.error().message);
         return exit_code_for_error(analyzer_output.error());
     }
+    run_stats.begin_phase("unknown_ledger");
     if (auto write =
-            write_canonical_json_file(paths->unknown_ledger_path, analyzer_output->unknown_ledger);
+            write_unknown_ledger(paths->unknown_ledger_path, analyzer_output->unknown_ledger);
         !write) {
         std::println(stderr, "Error: unknown ledger failed: {}", write.error().message);
         return exit_code_for_error(write.error());
     }
+    // Nothing is validated yet, so the SARIF log carries the ledger's UNKNOWNs only.
+    if (!options.emit_sarif.empty()) {
+        run_stats.begin_phase("sarif");
+        const OutputSource source{.root = paths->output_dir, .pack = std::nullopt};
+        if (auto sarif = emit_sarif(source, {}, options.emit_sarif); !sarif) {
+            std::println(stderr, "Error: failed to write SARIF: {}", sarif.error().message);
+            return exit_code_for_error(sarif.error());
+        }
+    }
+
+    const bool stats_written = write_stats_output(paths->stats_path,
+                                                  run_stats,
+                                                  "analysis",
+                                                  analyze_stats_json(analyzer_output->stats),
+                                                  options.schema_dir);
 
     std::println("[analyze] Wrote frontend outputs");
     std::println("  build: {}", options.build);
     std::println("  output: {}", paths->output_dir.string());
     std::println("  nir: {}", paths->nir_path.string());
     std::println("  source_map: {}", paths->source_map_path.string());
-    std::println("  po: {}", paths->po_path.string());
+    std::println("  po: {} (functions reused: {}, regenerated: {})",
+                 paths->po_path.string(),
+                 po_generation->reused_functions,
+                 po_generation->regenerated_functions);
     std::println("  unknown_ledger: {}", paths->unknown_ledger_path.string());
     std::println("  analysis_config: {}", paths->analysis_config_path.string());
     std::println("  specdb_snapshot: {}", paths->specdb_snapshot_path.string());
+    if (!options.emit_sarif.empty()) {
+        std::println("  sarif: {}", options.emit_sarif);
+    }
+    if (stats_written) {
+        std::println("  stats: {}", paths->stats_path.string());
+    }
     return static_cast<int>(ExitCode::kOk);
 #endif
 }
 
+/// Result counts of a validated_results document, per category.
+[[nodiscard]] nlohmann::json validate_stats_json(const nlohmann::json& validated_results)
+{
+    nlohmann::json categories = nlohmann::json::object();
+    std::size_t count = 0;
+    for (const auto& result : validated_results.at("results")) {
+        auto& category = categories[result.at("category").get<std::string>()];
+        category = category.is_null() ? 1 : category.get<std::size_t>() + 1;
+        ++count;
+    }
+    return nlohmann::json{
+        {   "results",                 count},
+        {"categories", std::move(categories)}
+    };
+}
+
+/// stats.json of a validate run: validated_results.json -> validated_results.stats.json.
+[[nodiscard]] std::filesystem::path validate_stats_path(std::filesystem::path results_path)
+{
+    return results_path.replace_extension(".stats.json");
+}
+
 [[nodiscard]] int run_validate(const ValidateOptions& options)
 {
+    sappp::common::stats::RunStats run_stats("validate");
     std::filesystem::path output_path(options.output);
     if (output_path.empty()) {
-        output_path = std::filesystem::path(options.input) / "results" / "validated_results.json";
+        // A pack is validated in place and never modified.
+        output_path = sappp::pack::is_pack_archive(options.input)
+                          ? std::filesystem::path("validated_results.json")
+                          : std::filesystem::path(options.input) / "results"
+                                / "validated_results.json";
     }
 
     auto output_parent = output_path.parent_path();
@@ -1766,20 +2679,43 @@ write_analysis_config_output(const AnalyzePaths& paths,
     }
 
     sappp::validator::Validator validator(options.input, options.schema_dir, options.versions);
+    validator.set_result_cache_dir(options.cache_dir);
+    run_stats.begin_phase("validate");
     auto results = validator.validate(options.strict);
     if (!results) {
         std::println(stderr, "Error: validate failed: {}", results.error().message);
         return exit_code_for_error(results.error());
     }
+    run_stats.begin_phase("write_results");
     if (auto write = validator.write_results(*results, output_path.string()); !write) {
         std::println(stderr, "Error: failed to write validated results: {}", write.error().message);
         return exit_code_for_error(write.error());
     }
+    std::optional<std::size_t> sarif_results;
+    if (!options.emit_sarif.empty()) {
+        run_stats.begin_phase("sarif");
+        auto sarif = emit_validated_sarif(options.input, output_path, options.emit_sarif);
+        if (!sarif) {
+            std::println(stderr, "Error: failed to write SARIF: {}", sarif.error().message);
+            return exit_code_for_error(sarif.error());
+        }
+        sarif_results = *sarif;
+    }
+    const auto stats_path = validate_stats_path(output_path);
+    const bool stats_written = write_stats_output(
+        stats_path, run_stats, "validation", validate_stats_json(*results), options.schema_dir);
 
     std::println("[validate] Wrote validated_results.json");
     std::println("  input: {}", options.input);
     std::println("  output: {}", output_path.string());
     std::println("  strict: {}", options.strict ? "yes" : "no");
+    if (sarif_results) {
+        std::println("  sarif: {} ({} results)", options.emit_sarif, *sarif_results);
+    }
+    std::println("  cache: {}", options.cache_dir.empty() ? "no" : options.cache_dir);
+    if (stats_written) {
+        std::println("  stats: {}", stats_path.string());
+    }
     return static_cast<int>(ExitCode::kOk);
 }
 
@@ -1789,91 +2725,77 @@ write_analysis_config_output(const AnalyzePaths& paths,
     const std::filesystem::path input_dir(options.input);
     const std::filesystem::path schema_dir(options.schema_dir);
 
-    auto temp_dir = prepare_temp_dir("pack", options.input);
-    if (!temp_dir) {
-        std::println(stderr, "Error: {}", temp_dir.error().message);
-        return exit_code_for_error(temp_dir.error());
-    }
-    auto pack_root = prepare_pack_root(*temp_dir);
-    if (!pack_root) {
-        std::println(stderr, "Error: {}", pack_root.error().message);
-        return exit_code_for_error(pack_root.error());
-    }
-
     struct PackItem
     {
         std::filesystem::path source;
-        std::filesystem::path dest;
+        std::string name;
         std::string schema;
     };
 
     std::vector<PackItem> required_files = {
         {               .source = input_dir / "build_snapshot.json",
-         .dest = *pack_root / "inputs" / "build_snapshot.json",
+         .name = "inputs/build_snapshot.json",
          .schema = "build_snapshot.v1.schema.json"   },
         {             .source = input_dir / "frontend" / "nir.json",
-         .dest = *pack_root / "frontend" / "nir.json",
+         .name = "frontend/nir.json",
          .schema = "nir.v1.schema.json"              },
         {      .source = input_dir / "frontend" / "source_map.json",
-         .dest = *pack_root / "frontend" / "source_map.json",
+         .name = "frontend/source_map.json",
          .schema = "source_map.v1.schema.json"       },
         {               .source = input_dir / "po" / "po_list.json",
-         .dest = *pack_root / "po" / "po_list.json",
+         .name = "po/po_list.json",
          .schema = "po.v1.schema.json"               },
         {  .source = input_dir / "analyzer" / "unknown_ledger.json",
-         .dest = *pack_root / "analyzer" / "unknown_ledger.json",
+         .name = "analyzer/unknown_ledger.json",
          .schema = "unknown.v1.schema.json"          },
         {          .source = input_dir / "specdb" / "snapshot.json",
-         .dest = *pack_root / "specdb" / "snapshot.json",
+         .name = "specdb/snapshot.json",
          .schema = "specdb_snapshot.v1.schema.json"  },
         {.source = input_dir / "results" / "validated_results.json",
-         .dest = *pack_root / "results" / "validated_results.json",
+         .name = "results/validated_results.json",
          .schema = "validated_results.v1.schema.json"},
         {   .source = input_dir / "config" / "analysis_config.json",
-         .dest = *pack_root / "config" / "analysis_config.json",
+         .name = "config/analysis_config.json",
          .schema = "analysis_config.v1.schema.json"  },
     };
 
-    std::vector<nlohmann::json> file_entries;
+    // Members are streamed from their sources by the pack writer; nothing is staged on disk.
+    std::vector<sappp::pack::PackEntry> pack_entries;
+    const auto add_file = [&pack_entries](std::string_view name,
+                                          const std::filesystem::path& source) {
+        pack_entries.push_back(sappp::pack::PackEntry{.name = std::string(kPackRootPrefix)
+                                                              + std::string(name),
+                                                      .source = source,
+                                                      .contents = std::nullopt});
+    };
 
     for (const auto& item : required_files) {
-        if (auto result = ensure_directory(item.dest.parent_path(), "pack item"); !result) {
-            std::println(stderr, "Error: {}", result.error().message);
-            return exit_code_for_error(result.error());
-        }
         auto json = read_and_validate_json(item.source, schema_dir, item.schema);
         if (!json) {
             std::println(stderr, "Error: {}", json.error().message);
             return exit_code_for_error(json.error());
         }
-        if (auto copied = copy_file_checked(item.source, item.dest); !copied) {
-            std::println(stderr, "Error: {}", copied.error().message);
-            return exit_code_for_error(copied.error());
+        add_file(item.name, item.source);
+    }
+
+    const auto add_tree = [&add_file](const std::filesystem::path& root,
+                                      std::string_view prefix) {
+        std::vector<std::filesystem::path> files;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(root)) {
+            if (entry.is_regular_file()) {
+                files.push_back(entry.path());
+            }
         }
-        auto digest = sha256_for_file(item.dest);
-        if (!digest) {
-            std::println(stderr, "Error: {}", digest.error().message);
-            return exit_code_for_error(digest.error());
+        for (const auto& path : files) {
+            const auto relative = std::filesystem::relative(path, root).generic_string();
+            add_file(std::string(prefix) + "/" + relative, path);
         }
-        auto size = std::filesystem::file_size(item.dest);
-        file_entries.push_back(nlohmann::json{
-            {"path", std::filesystem::relative(item.dest, *pack_root).generic_string()},
-            {"sha256", *digest},
-            {"size_bytes", static_cast<std::int64_t>(size)}
-        });
-    }
+    };
 
     std::filesystem::path certstore_src = input_dir / "certstore";
-    std::filesystem::path certstore_dst = *pack_root / "certstore";
     if (std::filesystem::exists(certstore_src)) {
-        std::vector<std::filesystem::path> cert_files;
         try {
-            for (const auto& entry : std::filesystem::recursive_directory_iterator(certstore_src)) {
-                if (!entry.is_regular_file()) {
-                    continue;
-                }
-                cert_files.push_back(entry.path());
-            }
+            add_tree(certstore_src, "certstore");
         } catch (const std::filesystem::filesystem_error& e) {
             std::println(stderr,
                          "Error iterating certstore directory '{}': {}",
@@ -1881,107 +2803,39 @@ write_analysis_config_output(const AnalyzePaths& paths,
                          e.what());
             return EXIT_FAILURE;
         }
-        std::ranges::stable_sort(cert_files, [](const auto& lhs, const auto& rhs) {
-            return lhs.generic_string() < rhs.generic_string();
-        });
-        for (const auto& path : cert_files) {
-            auto relative = std::filesystem::relative(path, certstore_src);
-            auto dest = certstore_dst / relative;
-            if (auto result = ensure_directory(dest.parent_path(), "certstore"); !result) {
-                std::println(stderr, "Error: {}", result.error().message);
-                return exit_code_for_error(result.error());
-            }
-            if (auto copied = copy_file_checked(path, dest); !copied) {
-                std::println(stderr, "Error: {}", copied.error().message);
-                return exit_code_for_error(copied.error());
-            }
-            auto digest = sha256_for_file(dest);
-            if (!digest) {
-                std::println(stderr, "Error: {}", digest.error().message);
-                return exit_code_for_error(digest.error());
-            }
-            auto size = std::filesystem::file_size(dest);
-            file_entries.push_back(nlohmann::json{
-                {"path", std::filesystem::relative(dest, *pack_root).generic_string()},
-                {"sha256", *digest},
-                {"size_bytes", static_cast<std::int64_t>(size)}
-            });
-        }
     }
 
     if (options.include_analyzer_candidates) {
         std::filesystem::path candidates_src = input_dir / "analyzer" / "cert_candidates";
-        std::filesystem::path candidates_dst = *pack_root / "analyzer" / "cert_candidates";
         if (std::filesystem::exists(candidates_src)) {
-            for (const auto& entry :
-                 std::filesystem::recursive_directory_iterator(candidates_src)) {
-                if (!entry.is_regular_file()) {
-                    continue;
-                }
-                auto relative = std::filesystem::relative(entry.path(), candidates_src);
-                auto dest = candidates_dst / relative;
-                if (auto result = ensure_directory(dest.parent_path(), "cert_candidates");
-                    !result) {
-                    std::println(stderr, "Error: {}", result.error().message);
-                    return exit_code_for_error(result.error());
-                }
-                if (auto copied = copy_file_checked(entry.path(), dest); !copied) {
-                    std::println(stderr, "Error: {}", copied.error().message);
-                    return exit_code_for_error(copied.error());
-                }
-                auto digest = sha256_for_file(dest);
-                if (!digest) {
-                    std::println(stderr, "Error: {}", digest.error().message);
-                    return exit_code_for_error(digest.error());
-                }
-                auto size = std::filesystem::file_size(dest);
-                file_entries.push_back(nlohmann::json{
-                    {"path", std::filesystem::relative(dest, *pack_root).generic_string()},
-                    {"sha256", *digest},
-                    {"size_bytes", static_cast<std::int64_t>(size)}
-                });
-            }
+            add_tree(candidates_src, "analyzer/cert_candidates");
         }
     }
 
-    std::filesystem::path semantics_path = *pack_root / "semantics" / "sem.v1.md";
-    if (auto result = ensure_directory(semantics_path.parent_path(), "semantics"); !result) {
-        std::println(stderr, "Error: {}", result.error().message);
-        return exit_code_for_error(result.error());
-    }
     const std::filesystem::path semantics_source =
         std::filesystem::current_path() / "docs" / "sem.v1.md";
     if (std::filesystem::exists(semantics_source)) {
-        if (auto copied = copy_file_checked(semantics_source, semantics_path); !copied) {
-            std::println(stderr, "Error: {}", copied.error().message);
-            return exit_code_for_error(copied.error());
-        }
+        add_file("semantics/sem.v1.md", semantics_source);
     } else {
         std::println(stderr,
                      "Warning: semantics document not found at {}; writing placeholder",
                      semantics_source.string());
-        std::ofstream out(semantics_path);
-        if (!out) {
-            std::println(stderr, "Error: failed to write semantics stub");
-            return static_cast<int>(ExitCode::kInputError);
-        }
-        out << "# sem.v1\n\nThis is a placeholder semantics document.\n";
-        out.flush();
-        if (!out) {
-            std::println(stderr, "Error: failed to flush semantics stub to disk");
-            return static_cast<int>(ExitCode::kInputError);
-        }
+        pack_entries.push_back(sappp::pack::PackEntry{
+            .name = std::string(kPackRootPrefix) + "semantics/sem.v1.md",
+            .source = {},
+            .contents = "# sem.v1\n\nThis is a placeholder semantics document.\n"});
     }
-    auto semantics_digest = sha256_for_file(semantics_path);
-    if (!semantics_digest) {
-        std::println(stderr, "Error: {}", semantics_digest.error().message);
-        return exit_code_for_error(semantics_digest.error());
+
+    const std::size_t jobs =
+        options.jobs > 0 ? static_cast<std::size_t>(options.jobs) : std::size_t{0};
+    auto file_hashes = open_file_hash_cache();
+    auto file_entries_result = build_pack_file_entries(*file_hashes, pack_entries, jobs);
+    save_file_hash_cache(*file_hashes);
+    if (!file_entries_result) {
+        std::println(stderr, "Error: {}", file_entries_result.error().message);
+        return exit_code_for_error(file_entries_result.error());
     }
-    file_entries.push_back(nlohmann::json{
-        {"path", std::filesystem::relative(semantics_path, *pack_root).generic_string()},
-        {"sha256", *semantics_digest},
-        {"size_bytes", static_cast<std::int64_t>(std::filesystem::file_size(semantics_path))}
-    });
+    std::vector<nlohmann::json> file_entries = std::move(*file_entries_result);
 
     std::ranges::stable_sort(file_entries,
                              [](const nlohmann::json& lhs, const nlohmann::json& rhs) {
@@ -2011,24 +2865,26 @@ write_analysis_config_output(const AnalyzePaths& paths,
         return exit_code_for_error(validation.error());
     }
 
-    std::filesystem::path manifest_in_pack = *pack_root / "manifest.json";
-    if (auto write = write_canonical_json_file(manifest_in_pack, *manifest); !write) {
-        std::println(stderr, "Error: {}", write.error().message);
-        return exit_code_for_error(write.error());
+    auto manifest_text = sappp::canonical::canonicalize(*manifest);
+    if (!manifest_text) {
+        std::println(stderr, "Error: {}", manifest_text.error().message);
+        return exit_code_for_error(manifest_text.error());
     }
+    pack_entries.push_back(
+        sappp::pack::PackEntry{.name = std::string(kPackRootPrefix) + "manifest.json",
+                               .source = {},
+                               .contents = *manifest_text + "\n"});
     if (auto write = write_canonical_json_file(options.manifest, *manifest); !write) {
         std::println(stderr, "Error: {}", write.error().message);
         return exit_code_for_error(write.error());
     }
 
-    const std::string command =
-        std::format("GZIP=-n tar -czf \"{}\" --sort=name --mtime='UTC 1970-01-01' "
-                    "--owner=0 --group=0 --numeric-owner -C \"{}\" pack",
-                    options.output,
-                    temp_dir->string());
-    if (std::system(command.c_str()) != 0) {
-        std::println(stderr, "Error: failed to create tar.gz");
-        return static_cast<int>(ExitCode::kInputError);
+    if (auto written = sappp::pack::write_pack(options.output,
+                                               std::move(pack_entries),
+                                               sappp::pack::PackWriteOptions{.jobs = jobs});
+        !written) {
+        std::println(stderr, "Error: failed to create tar.gz: {}", written.error().message);
+        return exit_code_for_error(written.error());
     }
 
     std::println("[pack] Wrote pack");
@@ -2041,46 +2897,73 @@ write_analysis_config_output(const AnalyzePaths& paths,
 // NOLINTNEXTLINE(readability-function-size) - CLI routine keeps diff flow together.
 [[nodiscard]] int run_diff(const DiffOptions& options)
 {
+    constexpr std::string_view kResultsSchemaName = "validated_results.v1.schema.json";
     const std::filesystem::path schema_dir(options.schema_dir);
-    auto before_root = extract_pack_if_needed(options.before);
-    if (!before_root) {
-        std::println(stderr, "Error: {}", before_root.error().message);
-        return exit_code_for_error(before_root.error());
+    auto before_source = open_output_source(options.before);
+    if (!before_source) {
+        std::println(stderr, "Error: {}", before_source.error().message);
+        return exit_code_for_error(before_source.error());
     }
-    auto after_root = extract_pack_if_needed(options.after);
-    if (!after_root) {
-        std::println(stderr, "Error: {}", after_root.error().message);
-        return exit_code_for_error(after_root.error());
+    auto after_source = open_output_source(options.after);
+    if (!after_source) {
+        std::println(stderr, "Error: {}", after_source.error().message);
+        return exit_code_for_error(after_source.error());
     }
 
+    auto results_schema =
+        sappp::common::SchemaValidator::load((schema_dir / kResultsSchemaName).string());
+    if (!results_schema) {
+        std::println(stderr, "Error: {}", results_schema.error().message);
+        return exit_code_for_error(results_schema.error());
+    }
+    auto diff_schema = sappp::common::SchemaValidator::load(
+        (schema_dir / "diff.v1.schema.json").string());
+    if (!diff_schema) {
+        std::println(stderr, "Error: {}", diff_schema.error().message);
+        return exit_code_for_error(diff_schema.error());
+    }
+
+    std::optional<sappp::common::MappedFile> before_mapped;
+    std::optional<sappp::common::MappedFile> after_mapped;
     auto before_results =
-        read_and_validate_json(*before_root / "results" / "validated_results.json",
-                               schema_dir,
-                               "validated_results.v1.schema.json");
+        open_output_results(*before_source, "results/validated_results.json", before_mapped);
     if (!before_results) {
         std::println(stderr, "Error: {}", before_results.error().message);
         return exit_code_for_error(before_results.error());
     }
-    auto after_results = read_and_validate_json(*after_root / "results" / "validated_results.json",
-                                                schema_dir,
-                                                "validated_results.v1.schema.json");
+    auto after_results =
+        open_output_results(*after_source, "results/validated_results.json", after_mapped);
     if (!after_results) {
         std::println(stderr, "Error: {}", after_results.error().message);
         return exit_code_for_error(after_results.error());
     }
 
+    // First pass: schema check and results_digest, one entry at a time.
+    auto before_scan =
+        sappp::report::scan_diff_results(*before_results, *results_schema, kResultsSchemaName);
+    if (!before_scan) {
+        std::println(stderr, "Error: {}", before_scan.error().message);
+        return exit_code_for_error(before_scan.error());
+    }
+    auto after_scan =
+        sappp::report::scan_diff_results(*after_results, *results_schema, kResultsSchemaName);
+    if (!after_scan) {
+        std::println(stderr, "Error: {}", after_scan.error().message);
+        return exit_code_for_error(after_scan.error());
+    }
+
     nlohmann::json before_manifest;
     nlohmann::json after_manifest;
-    if (auto manifest = read_json_file(*before_root / "manifest.json"); manifest) {
+    if (auto manifest = read_output_json(*before_source, "manifest.json"); manifest) {
         before_manifest = *manifest;
     }
-    if (auto manifest = read_json_file(*after_root / "manifest.json"); manifest) {
+    if (auto manifest = read_output_json(*after_source, "manifest.json"); manifest) {
         after_manifest = *manifest;
     }
     if (!before_manifest.contains("input_digest")) {
-        auto build_snapshot = read_json_file(*before_root / "inputs" / "build_snapshot.json");
+        auto build_snapshot = read_output_json(*before_source, "inputs/build_snapshot.json");
         if (!build_snapshot) {
-            build_snapshot = read_json_file(*before_root / "build_snapshot.json");
+            build_snapshot = read_output_json(*before_source, "build_snapshot.json");
         }
         if (build_snapshot) {
             if (auto digest = input_digest_from_build_snapshot(*build_snapshot); digest) {
@@ -2089,9 +2972,9 @@ write_analysis_config_output(const AnalyzePaths& paths,
         }
     }
     if (!after_manifest.contains("input_digest")) {
-        auto build_snapshot = read_json_file(*after_root / "inputs" / "build_snapshot.json");
+        auto build_snapshot = read_output_json(*after_source, "inputs/build_snapshot.json");
         if (!build_snapshot) {
-            build_snapshot = read_json_file(*after_root / "build_snapshot.json");
+            build_snapshot = read_output_json(*after_source, "build_snapshot.json");
         }
         if (build_snapshot) {
             if (auto digest = input_digest_from_build_snapshot(*build_snapshot); digest) {
@@ -2100,62 +2983,78 @@ write_analysis_config_output(const AnalyzePaths& paths,
         }
     }
 
-    auto before_digest = sappp::canonical::hash_canonical(*before_results);
-    if (!before_digest) {
-        std::println(stderr, "Error: {}", before_digest.error().message);
-        return exit_code_for_error(before_digest.error());
-    }
-    auto after_digest = sappp::canonical::hash_canonical(*after_results);
-    if (!after_digest) {
-        std::println(stderr, "Error: {}", after_digest.error().message);
-        return exit_code_for_error(after_digest.error());
-    }
-
-    auto before_side = build_diff_side(before_manifest, *before_results, *before_digest);
+    const nlohmann::json& before_header = before_results->header();
+    const nlohmann::json& after_header = after_results->header();
+    auto before_side = build_diff_side(before_manifest, before_header, before_scan->digest);
     if (!before_side) {
         std::println(stderr, "Error: {}", before_side.error().message);
         return exit_code_for_error(before_side.error());
     }
-    auto after_side = build_diff_side(after_manifest, *after_results, *after_digest);
+    auto after_side = build_diff_side(after_manifest, after_header, after_scan->digest);
     if (!after_side) {
         std::println(stderr, "Error: {}", after_side.error().message);
         return exit_code_for_error(after_side.error());
     }
 
-    const std::string reason = diff_reason_for(*before_side, *after_side);
-    auto changes = sappp::report::build_diff_changes(*before_results, *after_results, reason);
-    if (!changes) {
-        std::println(stderr, "Error: {}", changes.error().message);
-        return exit_code_for_error(changes.error());
-    }
-
     std::string generated_at = generated_at_from_json(after_manifest);
     if (generated_at == kDeterministicGeneratedAt) {
         generated_at = generated_at_from_json(before_manifest);
     }
     if (generated_at == kDeterministicGeneratedAt) {
-        generated_at = generated_at_from_json(*after_results);
+        generated_at = generated_at_from_json(after_header);
     }
     if (generated_at == kDeterministicGeneratedAt) {
-        generated_at = generated_at_from_json(*before_results);
+        generated_at = generated_at_from_json(before_header);
     }
 
-    nlohmann::json diff_json = {
+    const nlohmann::json diff_header = {
         {"schema_version",            "diff.v1"},
         {          "tool", tool_metadata_json()},
         {  "generated_at",         generated_at},
         {        "before",         *before_side},
-        {         "after",          *after_side},
-        {       "changes",             *changes}
+        {         "after",          *after_side}
     };
 
-    auto diff_schema = (schema_dir / "diff.v1.schema.json").string();
-    if (auto validation = sappp::common::validate_json(diff_json, diff_schema); !validation) {
-        std::println(stderr, "Error: diff schema invalid: {}", validation.error().message);
-        return exit_code_for_error(validation.error());
+    // Second pass: merge-join the sorted results straight into diff.json. Results that
+    // were not written by the validator may be unsorted; those are diffed in memory.
+    const std::string reason = diff_reason_for(*before_side, *after_side);
+    sappp::report::DiffChangeSource changes;
+    if (before_scan->sorted && after_scan->sorted) {
+        before_results->rewind();
+        after_results->rewind();
+        changes = [&](const sappp::report::ChangeSink& sink) {
+            return sappp::report::merge_diff_changes([&] { return before_results->next(); },
+                                                     [&] { return after_results->next(); },
+                                                     reason,
+                                                     sink);
+        };
+    } else {
+        changes = [&](const sappp::report::ChangeSink& sink) -> sappp::VoidResult {
+            auto before_json = read_whole_results(*before_results);
+            if (!before_json) {
+                return std::unexpected(before_json.error());
+            }
+            auto after_json = read_whole_results(*after_results);
+            if (!after_json) {
+                return std::unexpected(after_json.error());
+            }
+            auto all_changes =
+                sappp::report::build_diff_changes(*before_json, *after_json, reason);
+            if (!all_changes) {
+                return std::unexpected(all_changes.error());
+            }
+            for (auto& change : *all_changes) {
+                if (auto sunk = sink(std::move(change)); !sunk) {
+                    return sunk;
+                }
+            }
+            return {};
+        };
     }
 
-    if (auto write = write_canonical_json_file(options.output, diff_json); !write) {
+    if (auto write =
+            sappp::report::write_diff_json(options.output, diff_header, *diff_schema, changes);
+        !write) {
         std::println(stderr, "Error: failed to write diff: {}", write.error().message);
         return exit_code_for_error(write.error());
     }
@@ -2276,6 +3175,30 @@ int cmd_diff(int argc, char** argv)
     return run_diff(*options);
 }
 
+/**
+ * Answer a --po / --unknown-id query through the ledger's sidecar index.
+ *
+ * Returns the ledger header with only the matching entries, or std::nullopt when
+ * the whole ledger has to be read (no point query, a pack, or a missing/stale index).
+ */
+[[nodiscard]] std::optional<nlohmann::json> find_indexed_unknowns(const ExplainOptions& options)
+{
+    if ((options.po_id.empty() && options.unknown_id.empty())
+        || sappp::pack::is_pack_archive(options.unknown)) {
+        return std::nullopt;
+    }
+    auto index = sappp::report::UnknownIndex::open(options.unknown);
+    if (!index) {
+        return std::nullopt;
+    }
+    auto found = options.unknown_id.empty() ? index->find_by_po_id(options.po_id)
+                                            : index->find_by_unknown_id(options.unknown_id);
+    if (!found) {
+        return std::nullopt;
+    }
+    return std::move(*found);
+}
+
 // NOLINTNEXTLINE(readability-function-size) - CLI routine keeps explain flow together.
 int cmd_explain(int argc, char** argv)
 {
@@ -2300,8 +3223,36 @@ int cmd_explain(int argc, char** argv)
     }
 
     const std::filesystem::path schema_dir(options->schema_dir);
-    auto unknown_ledger =
-        read_and_validate_json(options->unknown, schema_dir, "unknown.v1.schema.json");
+    // Pack archives are read in place; the same pack given twice is indexed once.
+    std::optional<OutputSource> pack_source;
+    const auto read_input = [&](const std::string& input,
+                                std::string_view pack_member,
+                                std::string_view schema_name) -> sappp::Result<nlohmann::json> {
+        if (!sappp::pack::is_pack_archive(input)) {
+            return read_and_validate_json(input, schema_dir, schema_name);
+        }
+        if (!pack_source || pack_source->root != std::filesystem::path(input)) {
+            auto opened = open_output_source(input);
+            if (!opened) {
+                return std::unexpected(opened.error());
+            }
+            pack_source = std::move(*opened);
+        }
+        return read_and_validate_output_json(*pack_source, pack_member, schema_dir, schema_name);
+    };
+
+    auto unknown_ledger = [&]() -> sappp::Result<nlohmann::json> {
+        if (auto indexed = find_indexed_unknowns(*options)) {
+            if (auto checked = check_json_schema(*indexed, schema_dir, "unknown.v1.schema.json");
+                !checked) {
+                return std::unexpected(checked.error());
+            }
+            return std::move(*indexed);
+        }
+        return read_input(options->unknown,
+                          "analyzer/unknown_ledger.json",
+                          "unknown.v1.schema.json");
+    }();
     if (!unknown_ledger) {
         std::println(stderr, "Error: {}", unknown_ledger.error().message);
         return exit_code_for_error(unknown_ledger.error());
@@ -2309,9 +3260,9 @@ int cmd_explain(int argc, char** argv)
 
     std::optional<nlohmann::json> validated_results;
     if (!options->validated.empty()) {
-        auto validated = read_and_validate_json(options->validated,
-                                                schema_dir,
-                                                "validated_results.v1.schema.json");
+        auto validated = read_input(options->validated,
+                                    "results/validated_results.json",
+                                    "validated_results.v1.schema.json");
         if (!validated) {
             std::println(stderr, "Error: {}", validated.error().message);
             return exit_code_for_error(validated.error());
@@ -2386,19 +3337,595 @@ int cmd_explain(int argc, char** argv)
     return static_cast<int>(ExitCode::kOk);
 }
 
+/// Per-operation latencies of one bench workload and the bytes it moved.
+struct BenchSamples
+{
+    std::vector<std::chrono::nanoseconds> latencies{};
+    std::uint64_t bytes = 0;
+    /// Page cache state of the reads ("warm" or "cold"); empty for other workloads
+    std::string_view cache{};
+};
+
+/// A certstore object of the bench: its path in the certstore layout and its canonical bytes.
+struct BenchObject
+{
+    std::filesystem::path path{};
+    std::string bytes{};
+};
+
+/// State shared by the workloads of one `sappp bench` run.
+struct BenchContext
+{
+    std::filesystem::path work_dir{};
+    std::string schema_dir{};
+    std::size_t iterations = 0;
+    nlohmann::json nir{};
+    std::vector<nlohmann::json> certs{};
+    std::vector<BenchObject> objects{};
+    bool objects_written = false;
+};
+
+/// Time @p op(i) for every iteration; @p op returns the bytes it moved.
+template <typename Op>
+[[nodiscard]] sappp::Result<BenchSamples> time_bench_ops(std::size_t iterations, Op&& op)
+{
+    BenchSamples samples;
+    samples.latencies.reserve(iterations);
+    for (std::size_t i = 0; i < iterations; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        auto bytes = op(i);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        if (!bytes) {
+            return std::unexpected(bytes.error());
+        }
+        samples.latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+        samples.bytes += *bytes;
+    }
+    return samples;
+}
+
+[[nodiscard]] std::uint64_t per_second(std::uint64_t amount, std::uint64_t total_ns)
+{
+    if (total_ns == 0) {
+        return 0;
+    }
+    // Canonical JSON has no floats; the rate is truncated to an integer.
+    return static_cast<std::uint64_t>(static_cast<long double>(amount) * 1'000'000'000.0L
+                                      / static_cast<long double>(total_ns));
+}
+
+[[nodiscard]] nlohmann::json bench_workload_json(std::string_view name, BenchSamples samples)
+{
+    std::ranges::sort(samples.latencies);
+    std::uint64_t total_ns = 0;
+    for (const auto latency : samples.latencies) {
+        total_ns += static_cast<std::uint64_t>(latency.count());
+    }
+    const std::size_t ops = samples.latencies.size();
+    // Nearest-rank percentile over the sorted samples.
+    const auto percentile = [&samples, ops](std::size_t pct) -> std::uint64_t {
+        if (ops == 0) {
+            return 0;
+        }
+        const std::size_t rank = std::max<std::size_t>((pct * ops + 99) / 100, 1);
+        return static_cast<std::uint64_t>(samples.latencies[rank - 1].count());
+    };
+
+    nlohmann::json workload = {
+        {          "name",                 std::string(name)},
+        {           "ops",                               ops},
+        {      "total_ns",                          total_ns},
+        {"ops_per_second", per_second(ops, total_ns)},
+        {    "latency_ns",
+         nlohmann::json{{"min", percentile(0)},
+         {"p50", percentile(50)},
+         {"p90", percentile(90)},
+         {"p99", percentile(99)},
+         {"max", percentile(100)}}                        }
+    };
+    if (samples.bytes > 0) {
+        workload["bytes"] = samples.bytes;
+        workload["bytes_per_second"] = per_second(samples.bytes, total_ns);
+    }
+    if (!samples.cache.empty()) {
+        workload["cache"] = std::string(samples.cache);
+    }
+    return workload;
+}
+
+/// Distinct PoDef certificates, one per iteration, built from generated POs.
+[[nodiscard]] sappp::Result<std::vector<nlohmann::json>> make_bench_certs(const nlohmann::json& nir,
+                                                                          std::size_t count)
+{
+    auto po_list = sappp::po::PoGenerator(1).generate(nir);
+    if (!po_list) {
+        return std::unexpected(po_list.error());
+    }
+    const auto& pos = po_list->at("pos");
+    if (pos.empty()) {
+        return std::unexpected(
+            sappp::Error::make("InternalError", "Synthetic NIR produced no POs"));
+    }
+    std::vector<nlohmann::json> certs;
+    certs.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        nlohmann::json po = pos.at(i % pos.size());
+        po["po_id"] = sappp::common::sha256_prefixed("bench:" + std::to_string(i));
+        certs.push_back(nlohmann::json{
+            {"schema_version", "cert.v1"},
+            {          "kind",   "PoDef"},
+            {            "po",        po}
+        });
+    }
+    return certs;
+}
+
+/// Canonical bytes of every bench certificate, laid out as certstore objects under @p root.
+[[nodiscard]] sappp::Result<std::vector<BenchObject>>
+make_bench_objects(const std::vector<nlohmann::json>& certs, const std::filesystem::path& root)
+{
+    std::vector<BenchObject> objects;
+    objects.reserve(certs.size());
+    for (const auto& cert : certs) {
+        auto canonical = sappp::canonical::canonicalize(cert);
+        if (!canonical) {
+            return std::unexpected(canonical.error());
+        }
+        const std::string hash = sappp::common::sha256_prefixed(*canonical);
+        const std::string shard = hash.substr(hash.find(':') + 1, 2);
+        objects.push_back(BenchObject{.path = root / "objects" / shard / (hash + ".json"),
+                                      .bytes = std::move(*canonical)});
+    }
+    return objects;
+}
+
+[[nodiscard]] sappp::Error bench_io_error(std::string_view what, const std::filesystem::path& path)
+{
+    return sappp::Error::make("IOError", std::format("Failed to {} {}", what, path.string()));
+}
+
+/// Write @p object and flush it to stable storage (fsync where the platform has it).
+[[nodiscard]] sappp::Result<std::uint64_t> write_bench_object(const BenchObject& object)
+{
+#if !defined(_WIN32)
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg) - POSIX open(2).
+    const int fd = ::open(object.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return std::unexpected(bench_io_error("open", object.path));
+    }
+    std::string_view rest = object.bytes;
+    while (!rest.empty()) {
+        const auto written = ::write(fd, rest.data(), rest.size());
+        if (written <= 0) {
+            ::close(fd);
+            return std::unexpected(bench_io_error("write", object.path));
+        }
+        rest.remove_prefix(static_cast<std::size_t>(written));
+    }
+    const bool synced = ::fsync(fd) == 0;
+    if (::close(fd) != 0 || !synced) {
+        return std::unexpected(bench_io_error("sync", object.path));
+    }
+#else
+    std::ofstream out(object.path, std::ios::binary | std::ios::trunc);
+    out << object.bytes;
+    out.flush();
+    if (!out) {
+        return std::unexpected(bench_io_error("write", object.path));
+    }
+#endif
+    return object.bytes.size();
+}
+
+/// Read @p object back whole and check its size.
+[[nodiscard]] sappp::Result<std::uint64_t> read_bench_object(const BenchObject& object)
+{
+    std::string buffer(object.bytes.size() + 1, '\0');
+    std::size_t size = 0;
+#if !defined(_WIN32)
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg) - POSIX open(2).
+    const int fd = ::open(object.path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::unexpected(bench_io_error("open", object.path));
+    }
+    while (size < buffer.size()) {
+        const auto got = ::read(fd, buffer.data() + size, buffer.size() - size);
+        if (got < 0) {
+            ::close(fd);
+            return std::unexpected(bench_io_error("read", object.path));
+        }
+        if (got == 0) {
+            break;
+        }
+        size += static_cast<std::size_t>(got);
+    }
+    ::close(fd);
+#else
+    std::ifstream in(object.path, std::ios::binary);
+    in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    size = static_cast<std::size_t>(in.gcount());
+#endif
+    if (size != object.bytes.size()) {
+        return std::unexpected(bench_io_error("read back", object.path));
+    }
+    return size;
+}
+
+/// Empty the bench certstore and create its shard directories, untimed.
+[[nodiscard]] sappp::VoidResult reset_bench_objects(const BenchContext& context)
+{
+    std::error_code ec;
+    std::filesystem::remove_all(context.work_dir / "certstore", ec);
+    if (ec) {
+        return std::unexpected(bench_io_error("clear", context.work_dir / "certstore"));
+    }
+    for (const auto& object : context.objects) {
+        std::filesystem::create_directories(object.path.parent_path(), ec);
+        if (ec) {
+            return std::unexpected(bench_io_error("create", object.path.parent_path()));
+        }
+    }
+    return {};
+}
+
+/// Write every object untimed unless certstore_put already did.
+[[nodiscard]] sappp::VoidResult ensure_bench_objects(BenchContext& context)
+{
+    if (context.objects_written) {
+        return {};
+    }
+    if (auto reset = reset_bench_objects(context); !reset) {
+        return reset;
+    }
+    for (const auto& object : context.objects) {
+        if (auto written = write_bench_object(object); !written) {
+            return std::unexpected(written.error());
+        }
+    }
+    context.objects_written = true;
+    return {};
+}
+
+/// Evict the objects from the page cache; false where the platform cannot.
+[[nodiscard]] bool evict_bench_objects(const BenchContext& context)
+{
+#if defined(POSIX_FADV_DONTNEED)
+    // The objects were fsync'ed, so their pages are clean and DONTNEED drops them.
+    bool evicted = true;
+    for (const auto& object : context.objects) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg) - POSIX open(2).
+        const int fd = ::open(object.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        evicted = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0 && evicted;
+        ::close(fd);
+    }
+    return evicted;
+#else
+    (void)context;
+    return false;
+#endif
+}
+
+[[nodiscard]] sappp::Result<BenchSamples> run_fixpoint_workload(const BenchContext& context,
+                                                                sappp::analyzer::FixpointDomain domain)
+{
+    return time_bench_ops(context.iterations,
+                          [&context, domain](std::size_t) -> sappp::Result<std::uint64_t> {
+                              auto stats = sappp::analyzer::run_fixpoint(domain, context.nir);
+                              if (!stats) {
+                                  return std::unexpected(stats.error());
+                              }
+                              return std::uint64_t{0};
+                          });
+}
+
+// NOLINTNEXTLINE(readability-function-size) - One branch per workload.
+[[nodiscard]] sappp::Result<BenchSamples> run_bench_workload(std::string_view name,
+                                                             BenchContext& context)
+{
+    using sappp::analyzer::FixpointDomain;
+    if (name == "canonical_hash") {
+        const auto& functions = context.nir.at("functions");
+        return time_bench_ops(
+            context.iterations,
+            [&functions](std::size_t idx) -> sappp::Result<std::uint64_t> {
+                auto canonical = sappp::canonical::canonicalize(functions.at(idx % functions.size()));
+                if (!canonical) {
+                    return std::unexpected(canonical.error());
+                }
+                if (sappp::common::sha256_prefixed(*canonical).empty()) {
+                    return std::unexpected(sappp::Error::make("InternalError", "Empty hash"));
+                }
+                return canonical->size();
+            });
+    }
+    if (name == "schema_validation") {
+        auto validator = sappp::common::SchemaValidator::load(
+            (std::filesystem::path(context.schema_dir) / "cert.v1.schema.json").string());
+        if (!validator) {
+            return std::unexpected(validator.error());
+        }
+        return time_bench_ops(context.iterations,
+                              [&context, &validator](std::size_t idx) -> sappp::Result<std::uint64_t> {
+                                  if (auto valid = validator->validate(context.certs[idx]); !valid) {
+                                      return std::unexpected(valid.error());
+                                  }
+                                  return std::uint64_t{0};
+                              });
+    }
+    // The storage workloads time raw writes and reads of pre-canonicalized objects, so
+    // canonicalization and schema validation (measured above) stay out of them.
+    if (name == "certstore_put") {
+        if (auto reset = reset_bench_objects(context); !reset) {
+            return std::unexpected(reset.error());
+        }
+        context.objects_written = false;
+        auto samples = time_bench_ops(context.iterations, [&context](std::size_t idx) {
+            return write_bench_object(context.objects[idx]);
+        });
+        context.objects_written = samples.has_value();
+        return samples;
+    }
+    if (name == "certstore_get" || name == "certstore_get_cold") {
+        if (auto ensured = ensure_bench_objects(context); !ensured) {
+            return std::unexpected(ensured.error());
+        }
+        // Warm reads are served from the page cache the writes left behind.
+        const bool cold = name == "certstore_get_cold" && evict_bench_objects(context);
+        auto samples = time_bench_ops(context.iterations, [&context](std::size_t idx) {
+            return read_bench_object(context.objects[idx]);
+        });
+        if (samples) {
+            samples->cache = cold ? "cold" : "warm";
+        }
+        return samples;
+    }
+    if (name == "fixpoint_lifetime") {
+        return run_fixpoint_workload(context, FixpointDomain::kLifetime);
+    }
+    if (name == "fixpoint_heap_lifetime") {
+        return run_fixpoint_workload(context, FixpointDomain::kHeapLifetime);
+    }
+    if (name == "fixpoint_init") {
+        return run_fixpoint_workload(context, FixpointDomain::kInit);
+    }
+    if (name == "fixpoint_points_to") {
+        return run_fixpoint_workload(context, FixpointDomain::kPointsTo);
+    }
+    return std::unexpected(
+        sappp::Error::make("InvalidArgument", "Unknown workload: " + std::string(name)));
+}
+
+[[nodiscard]] sappp::Result<nlohmann::json> run_bench(const BenchOptions& options,
+                                                      const std::filesystem::path& work_dir)
+{
+    // Four functions with nested loops and an exception edge: large enough that the
+    // fixpoints iterate, small enough that a default run finishes in seconds.
+    sappp::analyzer::SyntheticNirOptions shape;
+    shape.functions = 4;
+    shape.blocks_per_function = 16;
+    shape.loop_depth = 2;
+    shape.variables = 8;
+
+    BenchContext context;
+    context.work_dir = work_dir;
+    context.schema_dir = options.schema_dir;
+    context.iterations = options.iterations;
+    context.nir = sappp::analyzer::make_synthetic_nir(shape);
+    auto certs = make_bench_certs(context.nir, options.iterations);
+    if (!certs) {
+        return std::unexpected(certs.error());
+    }
+    context.certs = std::move(*certs);
+    auto objects = make_bench_objects(context.certs, work_dir / "certstore");
+    if (!objects) {
+        return std::unexpected(objects.error());
+    }
+    context.objects = std::move(*objects);
+
+    std::vector<std::string> names = options.workloads;
+    if (names.empty()) {
+        names.assign(kBenchWorkloads.begin(), kBenchWorkloads.end());
+    }
+    nlohmann::json workloads = nlohmann::json::array();
+    for (const auto& name : names) {
+        const sappp::common::trace::Span span("bench", name);
+        auto samples = run_bench_workload(name, context);
+        if (!samples) {
+            return std::unexpected(samples.error());
+        }
+        workloads.push_back(bench_workload_json(name, std::move(*samples)));
+    }
+
+    return nlohmann::json{
+        {"schema_version",                                                       "bench.v1"},
+        {          "tool",                                            tool_metadata_json()},
+        {  "generated_at",                                              current_time_utc()},
+        {          "host", nlohmann::json{{"hardware_threads", std::thread::hardware_concurrency()}}},
+        {           "dir",                                               work_dir.string()},
+        {    "iterations",                                              options.iterations},
+        {"peak_rss_bytes",           sappp::common::stats::resource_usage().peak_rss_bytes},
+        {     "workloads",                                           std::move(workloads)}
+    };
+}
+
+/// Marks a DIR/.sappp-bench created by sappp bench; without it a non-empty one is kept.
+constexpr std::string_view kBenchDirMarker = ".sappp_bench";
+
+/// Clear @p work_dir left by an earlier run and recreate it with the marker.
+[[nodiscard]] sappp::VoidResult prepare_bench_dir(const std::filesystem::path& work_dir)
+{
+    std::error_code ec;
+    const auto marker = work_dir / kBenchDirMarker;
+    if (std::filesystem::exists(work_dir, ec)) {
+        const bool ours = std::filesystem::is_directory(work_dir, ec)
+                          && (std::filesystem::is_empty(work_dir, ec)
+                              || std::filesystem::exists(marker, ec));
+        if (!ours) {
+            return std::unexpected(sappp::Error::make(
+                "IOError",
+                std::format("Refusing to clear {}: it is not empty and was not created by "
+                            "sappp bench",
+                            work_dir.string())));
+        }
+        std::filesystem::remove_all(work_dir, ec);
+        if (ec) {
+            return std::unexpected(sappp::Error::make(
+                "IOError", std::format("Failed to clear {}: {}", work_dir.string(), ec.message())));
+        }
+    } else if (ec) {
+        return std::unexpected(sappp::Error::make(
+            "IOError", std::format("Failed to inspect {}: {}", work_dir.string(), ec.message())));
+    }
+    std::filesystem::create_directories(work_dir, ec);
+    if (ec) {
+        return std::unexpected(sappp::Error::make(
+            "IOError", std::format("Failed to create {}: {}", work_dir.string(), ec.message())));
+    }
+    std::ofstream out(marker);
+    if (!out) {
+        return std::unexpected(bench_io_error("create", marker));
+    }
+    return {};
+}
+
+int cmd_bench(int argc, char** argv)
+{
+    auto args = std::span<char*>(argv, static_cast<std::size_t>(argc));
+    auto options = parse_bench_args(args);
+    if (!options) {
+        std::println(stderr, "Error: {}", options.error().message);
+        return exit_code_for_error(options.error());
+    }
+    if (options->show_help) {
+        print_bench_help();
+        return static_cast<int>(ExitCode::kOk);
+    }
+
+    std::error_code ec;
+    const auto work_dir = std::filesystem::absolute(options->dir, ec) / ".sappp-bench";
+    if (ec) {
+        std::println(stderr, "Error: Invalid --dir {}: {}", options->dir, ec.message());
+        return static_cast<int>(ExitCode::kCliError);
+    }
+    // Start from an empty directory; certstore_put also empties its store before each pass.
+    if (auto prepared = prepare_bench_dir(work_dir); !prepared) {
+        std::println(stderr, "Error: {}", prepared.error().message);
+        return exit_code_for_error(prepared.error());
+    }
+
+    auto report = run_bench(*options, work_dir);
+    if (!options->keep) {
+        std::filesystem::remove_all(work_dir, ec);
+        if (ec) {
+            std::println(
+                stderr, "Warning: failed to remove {}: {}", work_dir.string(), ec.message());
+        }
+    }
+    if (!report) {
+        std::println(stderr, "Error: {}", report.error().message);
+        return exit_code_for_error(report.error());
+    }
+    if (auto valid = sappp::common::validate_json(
+            *report,
+            (std::filesystem::path(options->schema_dir) / "bench.v1.schema.json").string());
+        !valid) {
+        std::println(stderr, "Error: {}", valid.error().message);
+        return exit_code_for_error(valid.error());
+    }
+
+    if (!options->output.empty()) {
+        if (auto write = write_canonical_json_file(options->output, *report); !write) {
+            std::println(stderr, "Error: {}", write.error().message);
+            return exit_code_for_error(write.error());
+        }
+        return static_cast<int>(ExitCode::kOk);
+    }
+    auto canonical = sappp::canonical::canonicalize(*report);
+    if (!canonical) {
+        std::println(stderr, "Error: {}", canonical.error().message);
+        return exit_code_for_error(canonical.error());
+    }
+    std::println("{}", *canonical);
+    return static_cast<int>(ExitCode::kOk);
+}
+
 }  // namespace
 
 namespace {
 
+/// Remove `--trace-out FILE` (accepted anywhere on the command line) from @p args.
+[[nodiscard]] sappp::Result<std::string> take_trace_out_option(std::vector<char*>& args)
+{
+    std::string trace_out;
+    for (std::size_t idx = 0; idx < args.size();) {
+        if (args[idx] == nullptr || std::string_view(args[idx]) != "--trace-out") {
+            ++idx;
+            continue;
+        }
+        auto value = read_option_value(args, idx, "--trace-out");
+        if (!value) {
+            return std::unexpected(value.error());
+        }
+        trace_out = *value;
+        args.erase(args.begin() + static_cast<std::ptrdiff_t>(idx),
+                   args.begin() + static_cast<std::ptrdiff_t>(idx + 2));
+    }
+    return trace_out;
+}
+
+[[nodiscard]] int dispatch_command(std::string_view cmd, std::vector<char*>& args)
+{
+    const int sub_argc = static_cast<int>(args.size());
+    args.push_back(nullptr);
+    char** sub_argv = args.data();
+
+    if (cmd == "capture") {
+        return cmd_capture(sub_argc, sub_argv);
+    }
+    if (cmd == "analyze") {
+        return cmd_analyze(sub_argc, sub_argv);
+    }
+    if (cmd == "validate") {
+        return cmd_validate(sub_argc, sub_argv);
+    }
+    if (cmd == "pack") {
+        return cmd_pack(sub_argc, sub_argv);
+    }
+    if (cmd == "diff") {
+        return cmd_diff(sub_argc, sub_argv);
+    }
+    if (cmd == "explain") {
+        return cmd_explain(sub_argc, sub_argv);
+    }
+    if (cmd == "bench") {
+        return cmd_bench(sub_argc, sub_argv);
+    }
+
+    std::println(stderr, "Unknown command: {}", cmd);
+    print_help();
+    return static_cast<int>(ExitCode::kCliError);
+}
+
 [[nodiscard]] int run_cli(int argc, char** argv)
 {
     try {
-        if (argc < 2) {
+        // --trace-out is global and may appear before or after the subcommand.
+        std::vector<char*> sub_args(argc > 0 ? argv + 1 : argv, argv + argc);
+        auto trace_out = take_trace_out_option(sub_args);
+        if (!trace_out) {
+            std::println(stderr, "Error: {}", trace_out.error().message);
+            return exit_code_for_error(trace_out.error());
+        }
+        if (sub_args.empty()) {
             print_help();
             return static_cast<int>(ExitCode::kCliError);
         }
 
-        std::string_view cmd = argv[1];
+        std::string_view cmd = sub_args.front();
+        sub_args.erase(sub_args.begin());
 
         if (cmd == "--help" || cmd == "-h") {
             print_help();
@@ -2409,31 +3936,20 @@ namespace {
             return 0;
         }
 
-        int sub_argc = argc - 2;
-        char** sub_argv = argv + 2;
-
-        if (cmd == "capture") {
-            return cmd_capture(sub_argc, sub_argv);
-        }
-        if (cmd == "analyze") {
-            return cmd_analyze(sub_argc, sub_argv);
+        if (!trace_out->empty()) {
+            sappp::common::trace::start();
         }
-        if (cmd == "validate") {
-            return cmd_validate(sub_argc, sub_argv);
-        }
-        if (cmd == "pack") {
-            return cmd_pack(sub_argc, sub_argv);
-        }
-        if (cmd == "diff") {
-            return cmd_diff(sub_argc, sub_argv);
-        }
-        if (cmd == "explain") {
-            return cmd_explain(sub_argc, sub_argv);
+        const int exit_code = [&] {
+            const sappp::common::trace::Span span("cli", cmd);
+            return dispatch_command(cmd, sub_args);
+        }();
+        if (!trace_out->empty()) {
+            if (auto written = sappp::common::trace::write(*trace_out); !written) {
+                std::println(stderr, "Error: {}", written.error().message);
+                return exit_code == 0 ? exit_code_for_error(written.error()) : exit_code;
+            }
         }
-
-        std::println(stderr, "Unknown command: {}", cmd);
-        print_help();
-        return static_cast<int>(ExitCode::kCliError);
+        return exit_code;
     } catch (const std::exception& ex) {
         try {
             std::println(stderr, "Error: {}", ex.what());